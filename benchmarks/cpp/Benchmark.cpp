@@ -0,0 +1,398 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <json/json.h>
+
+#include "Scaling.hpp"
+
+namespace bench
+{
+
+namespace
+{
+
+/*!
+ * \brief A registered benchmark.
+ */
+struct Entry
+{
+    const char* name;
+    benchmark_func func;
+};
+
+/*!
+ * \brief Returns the list of registered benchmarks.
+ *
+ * This is a function local static so that it is constructed before any
+ * Registrar uses it, regardless of static initialisation order.
+ */
+std::vector<Entry>& get_registry()
+{
+    static std::vector<Entry> registry;
+    return registry;
+}
+
+/*!
+ * \brief Performs a single run of the benchmark with the given number of
+ *        iterations and returns the elapsed nanoseconds.
+ *
+ * \param allocations If not null, the allocations performed during the timed
+ *                    part of the run are added to this.
+ */
+double run_once(
+        const Entry& entry,
+        std::size_t iterations,
+        alloc::Counts* allocations = nullptr)
+{
+    State state(iterations);
+    entry.func(state);
+    if(allocations != nullptr)
+    {
+        *allocations += state.get_allocations();
+    }
+    return state.get_elapsed();
+}
+
+/*!
+ * \brief Runs the benchmark and returns its results as a JSON object.
+ */
+Json::Value run_benchmark(
+        const Entry& entry,
+        double min_time,
+        std::size_t repetitions)
+{
+    // find the number of iterations needed to fill the minimum time
+    std::size_t iterations = 1;
+    while(true)
+    {
+        double elapsed = run_once(entry, iterations);
+        if(elapsed >= min_time || iterations >= 1000000000)
+        {
+            break;
+        }
+
+        // aim slightly past the minimum time, but grow by a bounded factor
+        double per_op = std::max(elapsed / iterations, 1.0);
+        double target = (min_time * 1.2) / per_op;
+        iterations = static_cast<std::size_t>(std::min(
+            std::max(target, static_cast<double>(iterations) * 2.0),
+            static_cast<double>(iterations) * 100.0
+        ));
+    }
+
+    // timed repetitions
+    std::vector<double> samples;
+    alloc::Counts allocations;
+    for(std::size_t i = 0; i < repetitions; ++i)
+    {
+        samples.push_back(
+            run_once(entry, iterations, &allocations) / iterations);
+    }
+    double operations = static_cast<double>(iterations * repetitions);
+    std::sort(samples.begin(), samples.end());
+
+    double mean = 0.0;
+    ARC_CONST_FOR_EACH(sample, samples)
+    {
+        mean += *sample;
+    }
+    mean /= samples.size();
+    double variance = 0.0;
+    ARC_CONST_FOR_EACH(sample, samples)
+    {
+        variance += (*sample - mean) * (*sample - mean);
+    }
+    variance /= samples.size();
+
+    double median = samples[samples.size() / 2];
+    if(samples.size() % 2 == 0)
+    {
+        median = (samples[samples.size() / 2 - 1] + median) / 2.0;
+    }
+
+    Json::Value result(Json::objectValue);
+    result["name"]         = entry.name;
+    result["iterations"]   = Json::UInt64(iterations);
+    result["repetitions"]  = Json::UInt64(repetitions);
+    result["median_ns"]    = median;
+    result["mean_ns"]      = mean;
+    result["min_ns"]       = samples.front();
+    result["max_ns"]       = samples.back();
+    result["stddev_ns"]    = std::sqrt(variance);
+    result["allocations_per_op"] = allocations.allocations / operations;
+    result["bytes_per_op"]       = allocations.bytes / operations;
+    return result;
+}
+
+/*!
+ * \brief Writes the primitive values of a nested document level.
+ */
+void fill_level(Json::Value& level)
+{
+    level["bool"]   = true;
+    level["int"]    = 42;
+    level["float"]  = 3.5;
+    level["string"] = "Hello world!";
+    Json::Value& int_array = level["int_array"] = Json::arrayValue;
+    Json::Value& string_array = level["string_array"] = Json::arrayValue;
+    for(int i = 0; i < 8; ++i)
+    {
+        int_array.append(i);
+        string_array.append("element");
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                     STATE
+//------------------------------------------------------------------------------
+
+State::State(std::size_t iterations)
+    :
+    m_iterations(iterations),
+    m_remaining (iterations),
+    m_started   (false),
+    m_elapsed   (0)
+{
+}
+
+bool State::keep_running()
+{
+    if(!m_started)
+    {
+        m_started = true;
+        m_alloc_start = alloc::current();
+        m_start = std::chrono::steady_clock::now();
+    }
+    if(m_remaining == 0)
+    {
+        pause_timing();
+        return false;
+    }
+    --m_remaining;
+    return true;
+}
+
+void State::pause_timing()
+{
+    m_elapsed += std::chrono::steady_clock::now() - m_start;
+    m_allocations += alloc::current() - m_alloc_start;
+}
+
+void State::resume_timing()
+{
+    m_alloc_start = alloc::current();
+    m_start = std::chrono::steady_clock::now();
+}
+
+std::size_t State::get_iterations() const
+{
+    return m_iterations;
+}
+
+double State::get_elapsed() const
+{
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(m_elapsed).count()
+    );
+}
+
+const alloc::Counts& State::get_allocations() const
+{
+    return m_allocations;
+}
+
+//------------------------------------------------------------------------------
+//                                   REGISTRAR
+//------------------------------------------------------------------------------
+
+Registrar::Registrar(const char* name, benchmark_func func)
+{
+    Entry entry;
+    entry.name = name;
+    entry.func = func;
+    get_registry().push_back(entry);
+}
+
+//------------------------------------------------------------------------------
+//                                   TEMP FILE
+//------------------------------------------------------------------------------
+
+TempFile::TempFile(
+        const arc::str::UTF8String& name,
+        const arc::str::UTF8String& data)
+{
+    m_path << name;
+    std::ofstream file(m_path.to_native().get_raw());
+    file << data.get_raw();
+}
+
+TempFile::~TempFile()
+{
+    std::remove(m_path.to_native().get_raw());
+}
+
+const arc::io::sys::Path& TempFile::get_path() const
+{
+    return m_path;
+}
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::str::UTF8String make_nested_document(std::size_t depth)
+{
+    Json::Value root(Json::objectValue);
+    Json::Value* level = &root;
+    for(std::size_t i = 0; i < depth; ++i)
+    {
+        fill_level(*level);
+        if(i + 1 < depth)
+        {
+            level = &((*level)["nested"] = Json::objectValue);
+        }
+    }
+
+    Json::StyledWriter writer;
+    return arc::str::UTF8String(writer.write(root).c_str());
+}
+
+arc::str::UTF8String nested_key(std::size_t depth, const char* name)
+{
+    arc::str::UTF8String key;
+    for(std::size_t i = 1; i < depth; ++i)
+    {
+        key << "nested.";
+    }
+    key << name;
+    return key;
+}
+
+int run(int argc, char* argv[])
+{
+    std::string filter;
+    std::string output_path;
+    double min_time = 100.0;
+    std::size_t repetitions = 5;
+    bool list = false;
+    bool scaling = false;
+    arc::uint64 max_size = 64 * 1024 * 1024;
+
+    // parse arguments
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if(arg == "--list")
+        {
+            list = true;
+            continue;
+        }
+        if(arg == "--scaling")
+        {
+            scaling = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            std::cerr << "Missing value for argument: " << arg << std::endl;
+            return 1;
+        }
+        if(arg == "--filter")
+        {
+            filter = argv[++i];
+        }
+        else if(arg == "--output")
+        {
+            output_path = argv[++i];
+        }
+        else if(arg == "--min_time")
+        {
+            min_time = std::atof(argv[++i]);
+        }
+        else if(arg == "--repetitions")
+        {
+            repetitions = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if(arg == "--max_size")
+        {
+            max_size = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    Json::Value root(Json::objectValue);
+    Json::Value& context = root["context"] = Json::objectValue;
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    context["date"]        = date;
+    context["min_time_ms"] = min_time;
+    context["repetitions"] = Json::UInt64(repetitions);
+    Json::Value& results = root["benchmarks"] = Json::arrayValue;
+
+    if(scaling)
+    {
+        context["max_size"] = Json::UInt64(max_size);
+        root["scaling"] = run_scaling(max_size);
+    }
+
+    ARC_CONST_FOR_EACH(entry, get_registry())
+    {
+        if(scaling)
+        {
+            break;
+        }
+        if(!filter.empty() && std::strstr(entry->name, filter.c_str()) == 0)
+        {
+            continue;
+        }
+        if(list)
+        {
+            std::cout << entry->name << std::endl;
+            continue;
+        }
+
+        std::cerr << "Running " << entry->name << "..." << std::endl;
+        results.append(
+            run_benchmark(*entry, min_time * 1000000.0, repetitions));
+    }
+
+    if(list)
+    {
+        return 0;
+    }
+
+    Json::StyledWriter writer;
+    std::string json(writer.write(root));
+    if(output_path.empty())
+    {
+        std::cout << json;
+        return 0;
+    }
+
+    std::ofstream output(output_path.c_str());
+    if(!output.good())
+    {
+        std::cerr << "Failed to open output file: " << output_path << std::endl;
+        return 1;
+    }
+    output << json;
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,229 @@
+/*!
+ * \file
+ * \brief Minimal framework for timing MetaEngine operations.
+ * \author David Saxon
+ */
+#ifndef METAENGINE_BENCHMARKS_BENCHMARK_HPP_
+#define METAENGINE_BENCHMARKS_BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+#include <arcanecore/io/sys/Path.hpp>
+
+#include <metaengine/Document.hpp>
+
+#include "AllocationCounter.hpp"
+
+namespace bench
+{
+
+/*!
+ * \brief Controls the timed loop of a single run of a benchmark.
+ *
+ * Benchmark functions should perform any setup, and then loop while
+ * keep_running() returns ```true```, performing the operation being measured
+ * once per iteration:
+ *
+ * \code
+ * BENCHMARK(my_benchmark)
+ * {
+ *     metaengine::Document doc(&data);
+ *     while(state.keep_running())
+ *     {
+ *         bench::keep(doc.get("key", metaengine::BoolV::instance()));
+ *     }
+ * }
+ * \endcode
+ */
+class State
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(State);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    explicit State(std::size_t iterations);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether another iteration should be performed, the first
+     *        call starts the timer and the last call stops it.
+     */
+    bool keep_running();
+
+    /*!
+     * \brief Stops the timer, used to exclude per-iteration setup from the
+     *        measurement.
+     */
+    void pause_timing();
+
+    /*!
+     * \brief Restarts the timer after pause_timing() has been called.
+     */
+    void resume_timing();
+
+    /*!
+     * \brief Returns the number of iterations this run performs.
+     */
+    std::size_t get_iterations() const;
+
+    /*!
+     * \brief Returns the total number of nanoseconds that were timed.
+     */
+    double get_elapsed() const;
+
+    /*!
+     * \brief Returns the heap allocations that were performed by the current
+     *        thread while the timer was running.
+     */
+    const alloc::Counts& get_allocations() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    std::size_t m_iterations;
+    std::size_t m_remaining;
+    bool m_started;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::duration m_elapsed;
+    alloc::Counts m_alloc_start;
+    alloc::Counts m_allocations;
+};
+
+/*!
+ * \brief Visitor that accepts any JSON value, used to measure lookups without
+ *        any conversion.
+ */
+class AnyV : public metaengine::Visitor<const Json::Value*>
+{
+public:
+
+    // override
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            metaengine::Document* requester,
+            metaengine::Diagnostic& diagnostic)
+    {
+        m_value = data;
+        return true;
+    }
+};
+
+/*!
+ * \brief Function signature of a benchmark.
+ */
+typedef void (*benchmark_func)(State& state);
+
+/*!
+ * \brief Registers a benchmark function with the runner, see BENCHMARK.
+ */
+class Registrar
+{
+public:
+
+    Registrar(const char* name, benchmark_func func);
+};
+
+/*!
+ * \brief A file that is written when constructed and deleted when destroyed,
+ *        used to benchmark loading data from the file system.
+ */
+class TempFile
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(TempFile);
+
+public:
+
+    /*!
+     * \brief Writes the data to a file with the given name in the current
+     *        working directory.
+     */
+    TempFile(
+            const arc::str::UTF8String& name,
+            const arc::str::UTF8String& data);
+
+    ~TempFile();
+
+    const arc::io::sys::Path& get_path() const;
+
+private:
+
+    arc::io::sys::Path m_path;
+};
+
+/*!
+ * \brief Prevents the compiler from optimising away the computation of the
+ *        given value.
+ */
+template <typename T>
+inline void keep(const T& value)
+{
+    // reading through a volatile pointer forces the value to be materialised
+    const volatile char* p = reinterpret_cast<const volatile char*>(&value);
+    (void) *p;
+}
+
+/*!
+ * \brief Builds a JSON object which has nested objects down to the given depth
+ *        (at least 1), each object contains one value of each of the
+ *        primitive types retrieved by the built-in visitors.
+ *
+ * Values at depth 1 are accessed with "bool", "int", etc, values at depth 2
+ * with "nested.bool", and so on.
+ */
+arc::str::UTF8String make_nested_document(std::size_t depth);
+
+/*!
+ * \brief Returns the key to access the named value at the given depth of a
+ *        document built with make_nested_document().
+ */
+arc::str::UTF8String nested_key(std::size_t depth, const char* name);
+
+/*!
+ * \brief Runs the registered benchmarks and writes the results as JSON.
+ *
+ * Supported arguments:
+ *
+ * - ```--filter <text>```: Only run benchmarks whose name contains the text.
+ * - ```--output <path>```: Write results to the file instead of stdout.
+ * - ```--min_time <ms>```: Minimum time each repetition should take
+ *   (default 100).
+ * - ```--repetitions <n>```: Number of repetitions of each benchmark
+ *   (default 5).
+ * - ```--list```: List the names of the benchmarks and exit.
+ * - ```--scaling```: Run the scaling suite (see run_scaling()) instead of the
+ *   benchmarks.
+ * - ```--max_size <bytes>```: The largest document the scaling suite
+ *   generates (default 64 MB).
+ */
+int run(int argc, char* argv[]);
+
+} // namespace bench
+
+/*!
+ * \brief Defines and registers a benchmark function with the given name, the
+ *        body of the function has access to a bench::State named ```state```.
+ */
+#define BENCHMARK(name)                                                        \
+    static void bench_func_##name(bench::State& state);                        \
+    static bench::Registrar bench_registrar_##name(#name, bench_func_##name);  \
+    static void bench_func_##name(bench::State& state)
+
+#endif
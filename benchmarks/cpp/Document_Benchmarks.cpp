@@ -0,0 +1,570 @@
+#include "Benchmark.hpp"
+#include "Generator.hpp"
+
+#include <string>
+
+#include <metaengine/Children.hpp>
+#include <metaengine/Document.hpp>
+#include <metaengine/FileData.hpp>
+#include <metaengine/Handle.hpp>
+#include <metaengine/ParseCache.hpp>
+#include <metaengine/Query.hpp>
+#include <metaengine/Schema.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief The number of levels in the document used to benchmark loading.
+ */
+static const std::size_t LOAD_DEPTH = 64;
+
+/*!
+ * \brief Returns the data used to benchmark loading.
+ */
+const arc::str::UTF8String& load_data()
+{
+    static arc::str::UTF8String data(bench::make_nested_document(LOAD_DEPTH));
+    return data;
+}
+
+/*!
+ * \brief Returns a document containing a single array of a million integers.
+ */
+const arc::str::UTF8String& table_data()
+{
+    static arc::str::UTF8String data;
+    if(data.is_empty())
+    {
+        std::string json("{\"table\": [");
+        for(std::size_t i = 0; i < 1000000; ++i)
+        {
+            json += i == 0 ? "" : ", ";
+            json += std::to_string(i);
+        }
+        json += "]}";
+        data = json.c_str();
+    }
+    return data;
+}
+
+/*!
+ * \brief Returns the file used to benchmark loading.
+ */
+const bench::TempFile& load_file()
+{
+    static bench::TempFile file("metaengine_bench_load.json", load_data());
+    return file;
+}
+
+/*!
+ * \brief Benchmarks retrieving the named value at the given depth using the
+ *        visitor.
+ */
+template <typename VisitorType>
+void run_get(
+        bench::State& state,
+        std::size_t depth,
+        const char* name,
+        VisitorType& visitor)
+{
+    arc::str::UTF8String data(bench::make_nested_document(depth));
+    metaengine::Document doc(&data);
+    arc::str::UTF8String key(bench::nested_key(depth, name));
+
+    while(state.keep_running())
+    {
+        bench::keep(*doc.get(key, visitor));
+    }
+}
+
+/*!
+ * \brief Reporter which discards all reports.
+ */
+void null_reporter(
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& message)
+{
+}
+
+/*!
+ * \brief Benchmarks reloading a generated 1MB file, optionally streamed or
+ *        with a projection of a single key.
+ *
+ * When sharded, each reload also retrieves a single key so that the section
+ * it is in is parsed.
+ */
+void run_load_file_generated(
+        bench::State& state,
+        bool streaming,
+        bool projected,
+        bool sharded = false)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    bench::Generator generator(spec);
+    bench::TempFile file(
+        "metaengine_bench_stream.json",
+        generator.document()
+    );
+
+    metaengine::Document doc(file.get_path());
+    doc.set_streaming(streaming);
+    if(projected)
+    {
+        std::vector<arc::str::UTF8String> projection;
+        projection.push_back(generator.sample_keys(1)[0]);
+        doc.set_projection(projection);
+    }
+    doc.set_sharding_enabled(sharded);
+    arc::str::UTF8String key(generator.sample_keys(1)[0]);
+    bench::AnyV v;
+    while(state.keep_running())
+    {
+        doc.reload();
+        bench::keep(doc.get_version());
+        if(sharded)
+        {
+            bench::keep(*doc.get(key, v));
+        }
+    }
+}
+
+/*!
+ * \brief Reloads generated data that alternates between two versions which
+ *        differ by a single value.
+ */
+void run_reload_edited_generated(bench::State& state, bool sharing)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    std::string original(bench::Generator(spec).document().get_raw());
+
+    // change the last digit, which is never the first digit of a number
+    std::string edited(original);
+    std::size_t digit = edited.find_last_of("0123456789");
+    edited[digit] = edited[digit] == '9' ? '8' : edited[digit] + 1;
+
+    arc::str::UTF8String versions[2] = {
+        arc::str::UTF8String(original.c_str()),
+        arc::str::UTF8String(edited.c_str())
+    };
+    arc::str::UTF8String data(versions[0]);
+    metaengine::Document doc(&data);
+    doc.set_subtree_sharing_enabled(sharing);
+    std::size_t version = 0;
+    while(state.keep_running())
+    {
+        version = 1 - version;
+        data = versions[version];
+        doc.reload();
+        bench::keep(doc.get_version());
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                      LOAD
+//------------------------------------------------------------------------------
+
+BENCHMARK(load_file_cold)
+{
+    const arc::io::sys::Path& path = load_file().get_path();
+    while(state.keep_running())
+    {
+        metaengine::Document doc(path);
+        bench::keep(doc.get_version());
+    }
+}
+
+BENCHMARK(load_file_warm)
+{
+    metaengine::Document doc(load_file().get_path());
+    while(state.keep_running())
+    {
+        doc.reload();
+        bench::keep(doc.get_version());
+    }
+}
+
+BENCHMARK(load_memory_cold)
+{
+    const arc::str::UTF8String& data = load_data();
+    while(state.keep_running())
+    {
+        metaengine::Document doc(&data);
+        bench::keep(doc.get_version());
+    }
+}
+
+BENCHMARK(load_memory_warm)
+{
+    metaengine::Document doc(&load_data());
+    while(state.keep_running())
+    {
+        doc.reload();
+        bench::keep(doc.get_version());
+    }
+}
+
+BENCHMARK(load_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+
+    // reloading discards the previous tree as well as parsing the new one
+    metaengine::Document doc(&data);
+    while(state.keep_running())
+    {
+        doc.reload();
+        bench::keep(doc.get_version());
+    }
+}
+
+BENCHMARK(load_generated_1mb_shared)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+
+    // another Document holds the parsed data, so each reload only hashes the
+    // data and shares the existing tree
+    metaengine::ParseCache cache;
+    metaengine::Document::set_parse_cache(&cache);
+    metaengine::Document holder(&data);
+    metaengine::Document doc(&data);
+    while(state.keep_running())
+    {
+        doc.reload();
+        bench::keep(doc.get_version());
+    }
+    metaengine::Document::set_parse_cache(nullptr);
+}
+
+BENCHMARK(reload_edited_generated_1mb)
+{
+    run_reload_edited_generated(state, false);
+}
+
+BENCHMARK(reload_edited_generated_1mb_shared_subtrees)
+{
+    run_reload_edited_generated(state, true);
+}
+
+BENCHMARK(load_file_generated_1mb)
+{
+    run_load_file_generated(state, false, false);
+}
+
+BENCHMARK(load_file_generated_1mb_streamed)
+{
+    run_load_file_generated(state, true, false);
+}
+
+BENCHMARK(load_file_generated_1mb_projected)
+{
+    run_load_file_generated(state, true, true);
+}
+
+BENCHMARK(load_file_generated_1mb_sharded)
+{
+    run_load_file_generated(state, false, false, true);
+}
+
+BENCHMARK(read_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    bench::TempFile file(
+        "metaengine_bench_read.json",
+        bench::Generator(spec).document()
+    );
+
+    arc::str::UTF8String data(arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+    while(state.keep_running())
+    {
+        bench::keep(metaengine::FileData::read(file.get_path(), data));
+    }
+}
+
+BENCHMARK(validate_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+
+    while(state.keep_running())
+    {
+        bench::keep(metaengine::FileData::is_plain_utf8(
+            data.get_raw(),
+            data.get_byte_length() - 1
+        ));
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                      GET
+//------------------------------------------------------------------------------
+
+#define GET_BENCHMARKS(name, visitor)                                          \
+    BENCHMARK(get_##name##_depth_1)                                            \
+    {                                                                          \
+        run_get(state, 1, #name, visitor);                                     \
+    }                                                                          \
+    BENCHMARK(get_##name##_depth_4)                                            \
+    {                                                                          \
+        run_get(state, 4, #name, visitor);                                     \
+    }                                                                          \
+    BENCHMARK(get_##name##_depth_16)                                           \
+    {                                                                          \
+        run_get(state, 16, #name, visitor);                                    \
+    }
+
+GET_BENCHMARKS(bool, metaengine::BoolV::instance())
+GET_BENCHMARKS(int, metaengine::IntV<arc::int32>::instance())
+GET_BENCHMARKS(float, metaengine::FloatV<float>::instance())
+GET_BENCHMARKS(string, metaengine::UTF8StringV::instance())
+GET_BENCHMARKS(int_array, metaengine::IntVectorV<arc::int32>::instance())
+GET_BENCHMARKS(string_array, metaengine::UTF8StringVectorV::instance())
+
+BENCHMARK(handle_float_depth_16)
+{
+    arc::str::UTF8String data(bench::make_nested_document(16));
+    metaengine::Document doc(&data);
+    metaengine::Handle<metaengine::FloatV<float>> handle(
+        &doc,
+        bench::nested_key(16, "float")
+    );
+
+    while(state.keep_running())
+    {
+        bench::keep(*handle);
+    }
+}
+
+BENCHMARK(handle_string_array_depth_16)
+{
+    arc::str::UTF8String data(bench::make_nested_document(16));
+    metaengine::Document doc(&data);
+    metaengine::Handle<metaengine::UTF8StringVectorV> handle(
+        &doc,
+        bench::nested_key(16, "string_array")
+    );
+
+    while(state.keep_running())
+    {
+        bench::keep(handle->size());
+    }
+}
+
+BENCHMARK(get_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    bench::Generator generator(spec);
+    arc::str::UTF8String data(generator.document());
+    metaengine::Document doc(&data);
+
+    // the keys lead to leaves of mixed types so only measure the lookup
+    std::vector<arc::str::UTF8String> keys(generator.sample_keys(1024));
+    bench::AnyV v;
+    std::size_t i = 0;
+    while(state.keep_running())
+    {
+        bench::keep(*doc.get(keys[i++ % keys.size()], v));
+    }
+}
+
+BENCHMARK(get_element_of_1m_array)
+{
+    metaengine::Document doc(&table_data());
+    arc::str::UTF8String key("table.42");
+    metaengine::IntV<arc::int32>& v = metaengine::IntV<arc::int32>::instance();
+    while(state.keep_running())
+    {
+        bench::keep(*doc.get(key, v));
+    }
+}
+
+BENCHMARK(get_element_of_1m_array_vector)
+{
+    // the whole array is converted to retrieve one element
+    metaengine::Document doc(&table_data());
+    arc::str::UTF8String key("table");
+    metaengine::IntVectorV<arc::int32> v;
+    while(state.keep_running())
+    {
+        bench::keep((*doc.get(key, v))[42]);
+    }
+}
+
+BENCHMARK(get_element_of_1m_array_vector_proven)
+{
+    // the schema lets the Visitor skip checking the type of each element
+    std::shared_ptr<metaengine::Schema> schema(new metaengine::Schema());
+    schema->add("table", metaengine::Schema::TYPE_INT_ARRAY);
+    metaengine::Document doc(&table_data());
+    doc.set_schema(schema);
+    doc.reload();
+    arc::str::UTF8String key("table");
+    metaengine::IntVectorV<arc::int32> v;
+    while(state.keep_running())
+    {
+        bench::keep((*doc.get(key, v))[42]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                    CHILDREN
+//------------------------------------------------------------------------------
+
+BENCHMARK(get_top_level_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+    metaengine::Document doc(&data);
+
+    // every top level key is known in advance and retrieved by key
+    std::vector<arc::str::UTF8String> keys;
+    ARC_CONST_FOR_EACH(child, doc.get_children(""))
+    {
+        keys.push_back(child->get_key());
+    }
+    bench::AnyV v;
+    while(state.keep_running())
+    {
+        ARC_CONST_FOR_EACH(key, keys)
+        {
+            bench::keep(*doc.get(*key, v));
+        }
+    }
+}
+
+BENCHMARK(iterate_top_level_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+    metaengine::Document doc(&data);
+
+    bench::AnyV v;
+    while(state.keep_running())
+    {
+        metaengine::Children children(doc.get_children(""));
+        ARC_CONST_FOR_EACH(child, children)
+        {
+            bench::keep(*child->get(v));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                     QUERY
+//------------------------------------------------------------------------------
+
+BENCHMARK(get_wildcard_keys_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.chains = 0;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+    metaengine::Document doc(&data);
+
+    // the keys matched by "*.k3" are known in advance and retrieved by key
+    std::vector<arc::str::UTF8String> keys;
+    ARC_CONST_FOR_EACH(child, doc.get_children(""))
+    {
+        arc::str::UTF8String key(child->get_key());
+        key += ".k3";
+        keys.push_back(key);
+    }
+    bench::AnyV v;
+    while(state.keep_running())
+    {
+        ARC_CONST_FOR_EACH(key, keys)
+        {
+            bench::keep(*doc.get(*key, v));
+        }
+    }
+}
+
+BENCHMARK(query_wildcard_generated_1mb)
+{
+    bench::WorkloadSpec spec;
+    spec.fan_out = 8;
+    spec.chains = 0;
+    spec.roots = bench::Generator::roots_for_size(spec, 1024 * 1024);
+    arc::str::UTF8String data(bench::Generator(spec).document());
+    metaengine::Document doc(&data);
+
+    // compiled once and matched in a single traversal
+    metaengine::Query query("*.k3");
+    bench::AnyV v;
+    while(state.keep_running())
+    {
+        doc.query(
+            query,
+            v,
+            [&](const arc::str::UTF8String&)
+            {
+                bench::keep(*v);
+            }
+        );
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                    FALLBACK
+//------------------------------------------------------------------------------
+
+BENCHMARK(get_fallback_key)
+{
+    // the file data doesn't contain the key
+    arc::str::UTF8String memory("{\"missing\": 12}");
+    metaengine::Document doc(load_file().get_path(), &memory);
+    while(state.keep_running())
+    {
+        bench::keep(
+            *doc.get("missing", metaengine::IntV<arc::int32>::instance()));
+    }
+}
+
+BENCHMARK(get_fallback_type)
+{
+    // the file data contains the key with the wrong type
+    arc::str::UTF8String memory("{\"string\": 12}");
+    metaengine::Document doc(load_file().get_path(), &memory);
+    while(state.keep_running())
+    {
+        bench::keep(
+            *doc.get("string", metaengine::IntV<arc::int32>::instance()));
+    }
+}
+
+BENCHMARK(get_fallback_type_reported)
+{
+    arc::str::UTF8String memory("{\"int_array\": 12}");
+    metaengine::Document doc(load_file().get_path(), &memory);
+    metaengine::Document::set_get_fallback_reporter(null_reporter);
+    while(state.keep_running())
+    {
+        bench::keep(
+            *doc.get("int_array", metaengine::IntV<arc::int32>::instance()));
+    }
+    metaengine::Document::set_get_fallback_reporter(nullptr);
+}
@@ -0,0 +1,341 @@
+#include "Generator.hpp"
+
+#include <sstream>
+
+namespace bench
+{
+
+namespace
+{
+
+/*!
+ * \brief The size the write buffer is flushed to the stream at.
+ */
+static const std::size_t FLUSH_SIZE = 64 * 1024;
+
+/*!
+ * \brief splitmix64 hash, used to derive every random choice from the seed and
+ *        the id of the value so any part of a document can be generated
+ *        independently.
+ */
+arc::uint64 mix(arc::uint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/*!
+ * \brief Returns a number in the range [0, 1) derived from the hash.
+ */
+double unit(arc::uint64 hash)
+{
+    return static_cast<double>(hash >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*!
+ * \brief Appends a number to the buffer.
+ */
+void append_number(std::string& buffer, arc::uint64 n)
+{
+    char digits[24];
+    std::size_t length = 0;
+    do
+    {
+        digits[length++] = static_cast<char>('0' + (n % 10));
+        n /= 10;
+    }
+    while(n != 0);
+    while(length > 0)
+    {
+        buffer += digits[--length];
+    }
+}
+
+/*!
+ * \brief Writes the buffer to the stream if it has grown large enough.
+ */
+void maybe_flush(std::ostream& stream, std::string& buffer)
+{
+    if(buffer.size() >= FLUSH_SIZE)
+    {
+        stream.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+/*!
+ * \brief Returns the id of the child of the given object.
+ */
+arc::uint64 child_id(arc::uint64 parent, std::size_t index, std::size_t fan_out)
+{
+    return parent * (fan_out + 1) + index + 1;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                 WORKLOAD SPEC
+//------------------------------------------------------------------------------
+
+WorkloadSpec::WorkloadSpec()
+    :
+    seed         (1),
+    roots        (4),
+    depth        (2),
+    fan_out      (4),
+    string_ratio (0.4),
+    array_ratio  (0.1),
+    string_length(16),
+    array_size   (8),
+    chains       (1),
+    chain_length (4),
+    variant_ratio(0.1)
+{
+}
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Generator::Generator(const WorkloadSpec& spec)
+    :
+    m_spec(spec)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+const WorkloadSpec& Generator::get_spec() const
+{
+    return m_spec;
+}
+
+arc::uint64 Generator::get_leaf_count() const
+{
+    arc::uint64 count = m_spec.roots;
+    for(std::size_t i = 0; i <= m_spec.depth; ++i)
+    {
+        count *= m_spec.fan_out;
+    }
+    return count;
+}
+
+void Generator::write_document(std::ostream& stream) const
+{
+    std::string buffer;
+    buffer += "{";
+    bool first = true;
+    for(std::size_t r = 0; r < m_spec.roots; ++r)
+    {
+        buffer += first ? "\n\"r" : ",\n\"r";
+        first = false;
+        append_number(buffer, r);
+        buffer += "\":";
+        write_object(stream, r, 0, -1, buffer);
+    }
+
+    // reference chains
+    for(std::size_t c = 0; c < m_spec.chains; ++c)
+    {
+        for(std::size_t i = 0; i <= m_spec.chain_length; ++i)
+        {
+            buffer += first ? "\n\"chain_" : ",\n\"chain_";
+            first = false;
+            append_number(buffer, c);
+            buffer += "_";
+            append_number(buffer, i);
+            if(i == 0)
+            {
+                buffer += "\":[\"base_";
+                append_number(buffer, c);
+                buffer += "\"]";
+            }
+            else
+            {
+                buffer += "\":[\"@{chain_";
+                append_number(buffer, c);
+                buffer += "_";
+                append_number(buffer, i - 1);
+                buffer += "}\",\"e";
+                append_number(buffer, i);
+                buffer += "\"]";
+            }
+        }
+    }
+
+    buffer += "\n}\n";
+    stream.write(buffer.data(), buffer.size());
+}
+
+arc::str::UTF8String Generator::document() const
+{
+    std::ostringstream stream;
+    write_document(stream);
+    return arc::str::UTF8String(stream.str().c_str());
+}
+
+void Generator::write_variant(std::size_t index, std::ostream& stream) const
+{
+    std::string buffer;
+    buffer += "{";
+    for(std::size_t r = 0; r < m_spec.roots; ++r)
+    {
+        buffer += r == 0 ? "\n\"r" : ",\n\"r";
+        append_number(buffer, r);
+        buffer += "\":";
+        write_object(stream, r, 0, static_cast<long>(index), buffer);
+    }
+    buffer += "\n}\n";
+    stream.write(buffer.data(), buffer.size());
+}
+
+arc::str::UTF8String Generator::variant(std::size_t index) const
+{
+    std::ostringstream stream;
+    write_variant(index, stream);
+    return arc::str::UTF8String(stream.str().c_str());
+}
+
+std::vector<arc::str::UTF8String> Generator::sample_keys(
+        std::size_t count) const
+{
+    std::vector<arc::str::UTF8String> keys;
+    arc::uint64 state = mix(m_spec.seed ^ 0x5A5A5A5A5A5A5A5AULL);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        std::string key("r");
+        state = mix(state);
+        append_number(key, state % m_spec.roots);
+        for(std::size_t level = 0; level <= m_spec.depth; ++level)
+        {
+            key += ".k";
+            state = mix(state);
+            append_number(key, state % m_spec.fan_out);
+        }
+        keys.push_back(arc::str::UTF8String(key.c_str()));
+    }
+    return keys;
+}
+
+arc::str::UTF8String Generator::chain_key(std::size_t chain) const
+{
+    arc::str::UTF8String key;
+    key << "chain_" << chain << "_" << m_spec.chain_length;
+    return key;
+}
+
+std::size_t Generator::roots_for_size(WorkloadSpec spec, arc::uint64 bytes)
+{
+    // measure the size of a document with a single root and no chains
+    spec.roots = 1;
+    spec.chains = 0;
+    std::ostringstream stream;
+    Generator(spec).write_document(stream);
+    arc::uint64 per_root = stream.str().size();
+
+    arc::uint64 roots = bytes / per_root;
+    return static_cast<std::size_t>(roots > 0 ? roots : 1);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Generator::write_object(
+        std::ostream& stream,
+        arc::uint64 id,
+        std::size_t level,
+        long variant,
+        std::string& buffer) const
+{
+    buffer += "{";
+    bool first = true;
+    for(std::size_t i = 0; i < m_spec.fan_out; ++i)
+    {
+        arc::uint64 child = child_id(id, i, m_spec.fan_out);
+
+        // variants only contain a subset of the leaves
+        if(variant >= 0 && level == m_spec.depth)
+        {
+            arc::uint64 h = mix(m_spec.seed ^ mix(child + variant + 1));
+            if(unit(h) >= m_spec.variant_ratio)
+            {
+                continue;
+            }
+        }
+
+        buffer += first ? "\"k" : ",\"k";
+        first = false;
+        append_number(buffer, i);
+        buffer += "\":";
+
+        if(level < m_spec.depth)
+        {
+            write_object(stream, child, level + 1, variant, buffer);
+        }
+        else
+        {
+            write_leaf(stream, child, variant, buffer);
+        }
+        maybe_flush(stream, buffer);
+    }
+    buffer += "}";
+}
+
+void Generator::write_leaf(
+        std::ostream& stream,
+        arc::uint64 id,
+        long variant,
+        std::string& buffer) const
+{
+    // the type only depends on the leaf so variants override with the same
+    // type, the value also depends on the variant
+    arc::uint64 type_hash = mix(m_spec.seed ^ mix(id));
+    arc::uint64 value_hash = mix(type_hash + static_cast<arc::uint64>(variant));
+    double u = unit(type_hash);
+
+    if(u < m_spec.string_ratio)
+    {
+        buffer += "\"";
+        for(std::size_t i = 0; i < m_spec.string_length; ++i)
+        {
+            value_hash = mix(value_hash);
+            buffer += static_cast<char>('a' + value_hash % 26);
+        }
+        buffer += "\"";
+    }
+    else if(u < m_spec.string_ratio + m_spec.array_ratio)
+    {
+        buffer += "[";
+        for(std::size_t i = 0; i < m_spec.array_size; ++i)
+        {
+            if(i != 0)
+            {
+                buffer += ",";
+            }
+            value_hash = mix(value_hash);
+            append_number(buffer, value_hash % 100000);
+        }
+        buffer += "]";
+    }
+    else if((type_hash & 0xF) == 0)
+    {
+        buffer += (value_hash & 1) ? "true" : "false";
+    }
+    else if((type_hash & 0xF) < 4)
+    {
+        append_number(buffer, value_hash % 100000);
+        buffer += ".";
+        append_number(buffer, (value_hash >> 20) % 1000);
+    }
+    else
+    {
+        append_number(buffer, value_hash % 1000000);
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,163 @@
+/*!
+ * \file
+ * \brief Deterministic generator of synthetic MetaEngine workloads.
+ * \author David Saxon
+ */
+#ifndef METAENGINE_BENCHMARKS_GENERATOR_HPP_
+#define METAENGINE_BENCHMARKS_GENERATOR_HPP_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+namespace bench
+{
+
+/*!
+ * \brief Describes the shape of a generated document.
+ *
+ * A document consists of ```roots``` top level objects ("r0", "r1", ...),
+ * each of which is a tree of nested objects ```depth``` levels deep where
+ * every object has ```fan_out``` children ("k0", "k1", ...). The children of
+ * the deepest objects are leaf values whose types are chosen from the given
+ * ratios. Documents also contain ```chains``` PathV reference chains
+ * ("chain_<c>_<i>") of ```chain_length``` references each.
+ *
+ * The same spec (including the seed) always generates exactly the same
+ * document.
+ */
+struct WorkloadSpec
+{
+    /// Seed of the pseudo random number generator.
+    arc::uint64 seed;
+    /// The number of top level objects.
+    std::size_t roots;
+    /// The number of nested object levels under each top level object.
+    std::size_t depth;
+    /// The number of children of each object.
+    std::size_t fan_out;
+    /// The fraction of leaves which are strings.
+    double string_ratio;
+    /// The fraction of leaves which are arrays.
+    double array_ratio;
+    /// The number of characters in each string leaf.
+    std::size_t string_length;
+    /// The number of elements in each array leaf.
+    std::size_t array_size;
+    /// The number of reference chains.
+    std::size_t chains;
+    /// The number of references in each chain.
+    std::size_t chain_length;
+    /// The fraction of leaves which are overridden by each variant.
+    double variant_ratio;
+
+    WorkloadSpec();
+};
+
+/*!
+ * \brief Generates documents, variants and key sets from a WorkloadSpec.
+ */
+class Generator
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    explicit Generator(const WorkloadSpec& spec);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    const WorkloadSpec& get_spec() const;
+
+    /*!
+     * \brief Returns the number of leaf values in the document.
+     */
+    arc::uint64 get_leaf_count() const;
+
+    /*!
+     * \brief Writes the document to the stream.
+     *
+     * The document is written incrementally so arbitrarily large documents can
+     * be written straight to a file.
+     */
+    void write_document(std::ostream& stream) const;
+
+    /*!
+     * \brief Returns the document as a string.
+     */
+    arc::str::UTF8String document() const;
+
+    /*!
+     * \brief Writes the variant with the given index to the stream.
+     *
+     * A variant has the same structure as the document but only contains
+     * ```variant_ratio``` of its leaves (with different values), the leaves
+     * chosen depend on the variant index.
+     */
+    void write_variant(std::size_t index, std::ostream& stream) const;
+
+    /*!
+     * \brief Returns the variant with the given index as a string.
+     */
+    arc::str::UTF8String variant(std::size_t index) const;
+
+    /*!
+     * \brief Returns the given number of keys to leaves of the document,
+     *        chosen uniformly at random (using the spec's seed).
+     */
+    std::vector<arc::str::UTF8String> sample_keys(std::size_t count) const;
+
+    /*!
+     * \brief Returns the key of the last reference in the given chain.
+     */
+    arc::str::UTF8String chain_key(std::size_t chain) const;
+
+    /*!
+     * \brief Returns the number of roots needed for the document to be
+     *        approximately the given number of bytes, keeping the rest of the
+     *        spec the same.
+     */
+    static std::size_t roots_for_size(WorkloadSpec spec, arc::uint64 bytes);
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    WorkloadSpec m_spec;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Writes the object at the given level, variant is -1 for the
+     *        document itself.
+     */
+    void write_object(
+            std::ostream& stream,
+            arc::uint64 id,
+            std::size_t level,
+            long variant,
+            std::string& buffer) const;
+
+    /*!
+     * \brief Writes the leaf with the given id.
+     */
+    void write_leaf(
+            std::ostream& stream,
+            arc::uint64 id,
+            long variant,
+            std::string& buffer) const;
+};
+
+} // namespace bench
+
+#endif
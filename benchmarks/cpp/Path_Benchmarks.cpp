@@ -0,0 +1,101 @@
+#include "Benchmark.hpp"
+
+#include <metaengine/Document.hpp>
+#include <metaengine/visitors/Path.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Builds a document where "path_<n>" references "path_<n - 1>" down to
+ *        "path_0", so retrieving "path_<length>" expands a chain of references
+ *        with the given length.
+ */
+arc::str::UTF8String make_chain_document(std::size_t length)
+{
+    arc::str::UTF8String data;
+    data << "{\"path_0\": [\"root\"]";
+    for(std::size_t i = 1; i <= length; ++i)
+    {
+        data << ", \"path_" << i << "\": [\"@{path_" << (i - 1) << "}\", \"p"
+             << i << "\"]";
+    }
+    data << "}";
+    return data;
+}
+
+/*!
+ * \brief Benchmarks retrieving the end of a reference chain from a Document
+ *        which has already resolved it.
+ */
+void run_chain(bench::State& state, std::size_t length)
+{
+    arc::str::UTF8String data(make_chain_document(length));
+    metaengine::Document doc(&data);
+    arc::str::UTF8String key;
+    key << "path_" << length;
+
+    while(state.keep_running())
+    {
+        bench::keep(*doc.get(key, metaengine::PathV::instance()));
+    }
+}
+
+/*!
+ * \brief Benchmarks resolving the end of a reference chain from a newly loaded
+ *        Document.
+ */
+void run_chain_uncached(bench::State& state, std::size_t length)
+{
+    arc::str::UTF8String data(make_chain_document(length));
+    arc::str::UTF8String key;
+    key << "path_" << length;
+
+    while(state.keep_running())
+    {
+        state.pause_timing();
+        {
+            metaengine::Document doc(&data);
+            state.resume_timing();
+            bench::keep(*doc.get(key, metaengine::PathV::instance()));
+            state.pause_timing();
+        }
+        state.resume_timing();
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                REFERENCE CHAINS
+//------------------------------------------------------------------------------
+
+BENCHMARK(path_chain_1)
+{
+    run_chain(state, 1);
+}
+
+BENCHMARK(path_chain_8)
+{
+    run_chain(state, 8);
+}
+
+BENCHMARK(path_chain_32)
+{
+    run_chain(state, 32);
+}
+
+BENCHMARK(path_chain_1_uncached)
+{
+    run_chain_uncached(state, 1);
+}
+
+BENCHMARK(path_chain_8_uncached)
+{
+    run_chain_uncached(state, 8);
+}
+
+BENCHMARK(path_chain_32_uncached)
+{
+    run_chain_uncached(state, 32);
+}
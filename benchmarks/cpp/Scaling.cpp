@@ -0,0 +1,217 @@
+#include "Scaling.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+
+#include "Benchmark.hpp"
+#include "Generator.hpp"
+
+namespace bench
+{
+
+namespace
+{
+
+/*!
+ * \brief The name of the file documents are written to.
+ */
+static const char* SCALING_FILE = "metaengine_bench_scaling.json";
+
+/*!
+ * \brief The number of distinct keys looked up at each size.
+ */
+static const std::size_t LOOKUP_KEYS = 1024;
+
+/*!
+ * \brief Sizes below this are excluded when fitting exponents since they are
+ *        dominated by constant overheads.
+ */
+static const arc::uint64 FIT_MIN_SIZE = 64 * 1024;
+
+/*!
+ * \brief Returns the resident memory of this process in bytes, or 0 if it
+ *        can't be measured on this platform.
+ */
+arc::uint64 resident_memory()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    arc::uint64 size = 0;
+    arc::uint64 resident = 0;
+    if(statm >> size >> resident)
+    {
+        return resident * static_cast<arc::uint64>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+/*!
+ * \brief Returns the nanoseconds elapsed since the given time.
+ */
+double elapsed_ns(const std::chrono::steady_clock::time_point& start)
+{
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count()
+    );
+}
+
+/*!
+ * \brief Returns the exponent of the power law y = a * x^b fitted to the
+ *        given member of the results.
+ */
+double fit_exponent(const Json::Value& results, const char* member)
+{
+    double n = 0.0;
+    double sx = 0.0;
+    double sy = 0.0;
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for(Json::ArrayIndex i = 0; i < results.size(); ++i)
+    {
+        double bytes = results[i]["bytes"].asDouble();
+        double value = results[i][member].asDouble();
+        if(bytes < FIT_MIN_SIZE || value <= 0.0)
+        {
+            continue;
+        }
+        double x = std::log(bytes);
+        double y = std::log(value);
+        n   += 1.0;
+        sx  += x;
+        sy  += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    if(n < 2.0)
+    {
+        return 0.0;
+    }
+    return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+/*!
+ * \brief Measures a single document size.
+ */
+Json::Value measure(arc::uint64 target_size)
+{
+    WorkloadSpec spec;
+    // small roots so that documents can be sized with a fine granularity
+    spec.depth   = 1;
+    spec.fan_out = 6;
+    spec.chains  = 0;
+    spec.roots   = Generator::roots_for_size(spec, target_size);
+    Generator generator(spec);
+
+    // write the document
+    arc::io::sys::Path path;
+    path << SCALING_FILE;
+    {
+        std::ofstream file(path.to_native().get_raw(), std::ios::binary);
+        generator.write_document(file);
+    }
+    std::ifstream written(path.to_native().get_raw(), std::ios::binary);
+    written.seekg(0, std::ios::end);
+    arc::uint64 bytes = static_cast<arc::uint64>(written.tellg());
+    written.close();
+
+    // load time: the fastest of enough loads to fill a minimum time
+    double load_time = 0.0;
+    double total_time = 0.0;
+    arc::uint64 memory = 0;
+    std::size_t loads = 0;
+    while(loads < 3 || (total_time < 200000000.0 && loads < 1000))
+    {
+        arc::uint64 before = resident_memory();
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        metaengine::Document doc(path);
+        double elapsed = elapsed_ns(start);
+        arc::uint64 after = resident_memory();
+
+        if(loads == 0 || elapsed < load_time)
+        {
+            load_time = elapsed;
+        }
+        if(after > before && after - before > memory)
+        {
+            memory = after - before;
+        }
+        total_time += elapsed;
+        ++loads;
+
+        // very large documents are only loaded once
+        if(bytes > 64 * 1024 * 1024)
+        {
+            break;
+        }
+    }
+
+    // lookup latency
+    metaengine::Document doc(path);
+    std::vector<arc::str::UTF8String> keys(generator.sample_keys(LOOKUP_KEYS));
+    AnyV v;
+    ARC_CONST_FOR_EACH(key, keys)
+    {
+        doc.get(*key, v);
+    }
+    std::size_t lookups = 0;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    while(lookups < 100000)
+    {
+        ARC_CONST_FOR_EACH(key, keys)
+        {
+            keep(*doc.get(*key, v));
+        }
+        lookups += keys.size();
+    }
+    double lookup_time = elapsed_ns(start) / lookups;
+
+    std::remove(path.to_native().get_raw());
+
+    Json::Value result(Json::objectValue);
+    result["bytes"]             = Json::UInt64(bytes);
+    result["leaves"]            = Json::UInt64(generator.get_leaf_count());
+    result["load_ns"]           = load_time;
+    result["load_ns_per_byte"]  = load_time / bytes;
+    result["memory_bytes"]      = Json::UInt64(memory);
+    result["lookup_ns"]         = lookup_time;
+    return result;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+Json::Value run_scaling(arc::uint64 max_size)
+{
+    Json::Value results(Json::arrayValue);
+    for(arc::uint64 size = 1024; size <= max_size; size *= 4)
+    {
+        std::cerr << "Measuring " << size << " byte document..." << std::endl;
+        results.append(measure(size));
+    }
+
+    Json::Value root(Json::objectValue);
+    root["sizes"] = results;
+    root["load_exponent"] = fit_exponent(results, "load_ns");
+    root["memory_exponent"] = fit_exponent(results, "memory_bytes");
+    root["lookup_exponent"] = fit_exponent(results, "lookup_ns");
+    return root;
+}
+
+} // namespace bench
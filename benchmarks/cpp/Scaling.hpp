@@ -0,0 +1,29 @@
+/*!
+ * \file
+ * \brief Measures how MetaEngine scales with the size of documents.
+ * \author David Saxon
+ */
+#ifndef METAENGINE_BENCHMARKS_SCALING_HPP_
+#define METAENGINE_BENCHMARKS_SCALING_HPP_
+
+#include <json/json.h>
+
+#include <arcanecore/base/Types.hpp>
+
+namespace bench
+{
+
+/*!
+ * \brief Generates documents from 1 KB up to the given size (growing by a
+ *        factor of 4 each step) and measures the load time, memory usage, and
+ *        lookup latency of each.
+ *
+ * The results include the exponent of a power law fitted to the load time and
+ * lookup latency against document size, an exponent noticeably greater than 1
+ * for load time (or 0 for lookups) indicates superlinear behaviour.
+ */
+Json::Value run_scaling(arc::uint64 max_size);
+
+} // namespace bench
+
+#endif
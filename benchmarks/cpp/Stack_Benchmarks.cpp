@@ -0,0 +1,65 @@
+#include "Benchmark.hpp"
+
+#include <string>
+
+#include <metaengine/Stack.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+
+namespace
+{
+
+/*!
+ * \brief The number of levels of the data at the bottom of the stack.
+ */
+static const std::size_t STACK_DEPTH = 16;
+
+/*!
+ * \brief Benchmarks retrieving a value which only the bottom of a stack with
+ *        the given number of layers has.
+ */
+void run_stack_get(bench::State& state, std::size_t layer_count)
+{
+    arc::str::UTF8String data(bench::make_nested_document(STACK_DEPTH));
+    metaengine::Stack stack(&data);
+
+    std::vector<arc::str::UTF8String> layers(layer_count);
+    for(std::size_t i = 0; i < layer_count; ++i)
+    {
+        std::string json("{\"layer_");
+        json += std::to_string(i);
+        json += "\": 1}";
+        layers[i] = json.c_str();
+    }
+    ARC_CONST_FOR_EACH(layer, layers)
+    {
+        stack.push_layer(&(*layer));
+    }
+
+    arc::str::UTF8String key(bench::nested_key(STACK_DEPTH, "int"));
+    metaengine::IntV<arc::int32>& v = metaengine::IntV<arc::int32>::instance();
+    while(state.keep_running())
+    {
+        bench::keep(*stack.get(key, v));
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                      GET
+//------------------------------------------------------------------------------
+
+BENCHMARK(stack_get_1_layer)
+{
+    run_stack_get(state, 1);
+}
+
+BENCHMARK(stack_get_8_layers)
+{
+    run_stack_get(state, 8);
+}
+
+BENCHMARK(stack_get_32_layers)
+{
+    run_stack_get(state, 32);
+}
@@ -0,0 +1,106 @@
+#include "Benchmark.hpp"
+
+#include <json/json.h>
+
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Returns the path to the language variant test data.
+ */
+arc::io::sys::Path lang_path()
+{
+    arc::io::sys::Path path;
+    path << "tests" << "meta" << "variants" << "lang.json";
+    return path;
+}
+
+/*!
+ * \brief Returns the language variants to load into a table.
+ */
+std::vector<arc::str::UTF8String> lang_variants()
+{
+    std::vector<arc::str::UTF8String> ret;
+    ret.push_back("de");
+    ret.push_back("ko");
+    return ret;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  SET VARIANT
+//------------------------------------------------------------------------------
+
+BENCHMARK(variant_switch)
+{
+    metaengine::Variant v(lang_path(), "uk");
+    std::size_t i = 0;
+    while(state.keep_running())
+    {
+        v.set_variant(i++ % 2 == 0 ? "de" : "ko");
+        bench::keep(v.get_version());
+    }
+}
+
+BENCHMARK(variant_switch_to_default)
+{
+    metaengine::Variant v(lang_path(), "uk");
+    std::size_t i = 0;
+    while(state.keep_running())
+    {
+        v.set_variant(i++ % 2 == 0 ? "de" : "uk");
+        bench::keep(v.get_version());
+    }
+}
+
+BENCHMARK(variant_table_switch)
+{
+    metaengine::Variant v(lang_path(), "uk");
+    v.load_table(lang_variants());
+    std::size_t i = 0;
+    while(state.keep_running())
+    {
+        v.set_variant(i++ % 2 == 0 ? "de" : "ko");
+        bench::keep(v.get_version());
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                      GET
+//------------------------------------------------------------------------------
+
+BENCHMARK(variant_get_hit)
+{
+    metaengine::Variant v(lang_path(), "uk");
+    v.set_variant("de");
+    while(state.keep_running())
+    {
+        bench::keep(*v.get("hello_world", metaengine::UTF8StringV::instance()));
+    }
+}
+
+BENCHMARK(variant_get_miss)
+{
+    // "sentence" is not in the German variant so comes from the default
+    metaengine::Variant v(lang_path(), "uk");
+    v.set_variant("de");
+    while(state.keep_running())
+    {
+        bench::keep(*v.get("sentence", metaengine::UTF8StringV::instance()));
+    }
+}
+
+BENCHMARK(variant_table_get_miss)
+{
+    metaengine::Variant v(lang_path(), "uk");
+    v.load_table(lang_variants());
+    v.set_variant("de");
+    while(state.keep_running())
+    {
+        bench::keep(*v.get("sentence", metaengine::UTF8StringV::instance()));
+    }
+}
@@ -646,6 +646,145 @@ enum CommentPlacement {
 //   typedef CppTL::AnyEnumerator<const Value &> EnumValues;
 //# endif
 
+/**
+ * MetaEngine extension: a source of memory for the nodes and strings of
+ * Values.
+ *
+ * While a MemoryResource::Scope exists every Value allocation made on the
+ * same thread is taken from the resource. Memory that is taken from a resource
+ * is never handed back to it, so a tree of Values built inside a Scope can be
+ * discarded by releasing the resource without visiting the tree. Values that
+ * are copied out of such a tree outside of a Scope are allocated from the heap
+ * as usual.
+ */
+class JSON_API MemoryResource {
+public:
+  virtual ~MemoryResource();
+
+  /// Returns size bytes of memory, suitably aligned for any type.
+  virtual void* allocate(size_t size) = 0;
+
+  /// Returns the resource that allocations on this thread are taken from, or
+  /// null if they are taken from the heap.
+  static MemoryResource* current();
+
+  /// Makes a resource current on this thread for the lifetime of the Scope.
+  class JSON_API Scope {
+  public:
+    explicit Scope(MemoryResource* resource);
+    ~Scope();
+
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+
+    MemoryResource* previous_;
+  };
+};
+
+/**
+ * MetaEngine extension: a table that the object keys of Values share storage
+ * from.
+ *
+ * While a KeyInterner::Scope exists, keys that are inserted into objects on
+ * the same thread are taken from the interner rather than being copied into
+ * each object, so identical keys in any number of trees share one string.
+ * Keys that are compared against a key from the same interner are compared
+ * by pointer. The storage returned by an interner must outlive every Value
+ * built in its Scope. When a Value is copied outside of a Scope its keys are
+ * duplicated as usual, so copies do not depend on the interner.
+ */
+class JSON_API KeyInterner {
+public:
+  virtual ~KeyInterner();
+
+  /// Returns null terminated storage for the key of the given length, equal
+  /// keys must always return the same storage.
+  virtual const char* intern(const char* key, unsigned length) = 0;
+
+  /// Returns the interner that keys on this thread are taken from, or null.
+  static KeyInterner* current();
+
+  /// Makes an interner current on this thread for the lifetime of the Scope.
+  class JSON_API Scope {
+  public:
+    explicit Scope(KeyInterner* interner);
+    ~Scope();
+
+  private:
+    Scope(const Scope&);
+    Scope& operator=(const Scope&);
+
+    KeyInterner* previous_;
+  };
+};
+
+/// Allocates memory for a Value from the current MemoryResource, or the heap.
+JSON_API void* allocateValueMemory(size_t size);
+
+/// Releases memory returned by allocateValueMemory(), memory which was taken
+/// from a MemoryResource is left to be released with the resource.
+JSON_API void releaseValueMemory(void* p);
+
+/**
+ * Allocator used for the containers of Values, see MemoryResource.
+ */
+template<typename T>
+class ValueAllocator {
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		pointer allocate(size_type n) {
+			return static_cast<pointer>(allocateValueMemory(n * sizeof(T)));
+		}
+
+		void deallocate(pointer p, size_type) {
+			releaseValueMemory(p);
+		}
+
+		template<typename U, typename... Args>
+		void construct(U* p, Args&&... args) {
+			::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+		}
+
+		template<typename U>
+		void destroy(U* p) {
+			p->~U();
+		}
+
+		size_type max_size() const {
+			return size_t(-1) / sizeof(T);
+		}
+
+		pointer address(reference x) const {
+			return std::addressof(x);
+		}
+
+		const_pointer address(const_reference x) const {
+			return std::addressof(x);
+		}
+
+		ValueAllocator() {}
+		template<typename U> ValueAllocator(const ValueAllocator<U>&) {}
+		template<typename U> struct rebind { typedef ValueAllocator<U> other; };
+};
+
+template<typename T, typename U>
+bool operator==(const ValueAllocator<T>&, const ValueAllocator<U>&) {
+	return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const ValueAllocator<T>&, const ValueAllocator<U>&) {
+	return false;
+}
+
 /** \brief Lightweight wrapper to tag static string.
  *
  * Value constructor and objectValue member assignement takes advantage of the
@@ -754,7 +893,8 @@ private:
     enum DuplicationPolicy {
       noDuplication = 0,
       duplicate,
-      duplicateOnCopy
+      duplicateOnCopy,
+      interned // MetaEngine extension, see KeyInterner
     };
     CZString(ArrayIndex index);
     CZString(char const* str, unsigned length, DuplicationPolicy allocate);
@@ -789,7 +929,9 @@ private:
 
 public:
 #ifndef JSON_USE_CPPTL_SMALLMAP
-  typedef std::map<CZString, Value> ObjectValues;
+  typedef std::map<CZString, Value, std::less<CZString>,
+                   ValueAllocator<std::pair<const CZString, Value> > >
+      ObjectValues;
 #else
   typedef CppTL::SmallMap<CZString, Value> ObjectValues;
 #endif // ifndef JSON_USE_CPPTL_SMALLMAP
@@ -857,6 +999,15 @@ Json::Value obj_value(Json::objectValue); // {}
   void swap(Value& other);
   /// Swap values but leave comments and source offsets in place.
   void swapPayload(Value& other);
+  /// MetaEngine extension: makes this null value refer to the payload of
+  /// other rather than copying it. Both values must be in trees that are
+  /// never destroyed value by value (see MemoryResource), since destroying
+  /// either would destroy the payload of both, and other must outlive this
+  /// value.
+  void sharePayload(const Value& other);
+  /// MetaEngine extension: returns whether this value and other are arrays or
+  /// objects that refer to the same payload, see sharePayload().
+  bool sharesPayload(const Value& other) const;
 
   ValueType type() const;
 
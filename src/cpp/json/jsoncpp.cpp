@@ -232,7 +232,7 @@ static inline void fixNumericLocale(char* begin, char* end) {
 #endif
 
 static int const stackLimit_g = 1000;
-static int       stackDepth_g = 0;  // see readValue()
+static thread_local int stackDepth_g = 0;  // see readValue()
 
 namespace Json {
 
@@ -2495,6 +2495,57 @@ static inline bool InRange(double d, T min, U max) {
 }
 #endif // if !defined(JSON_USE_INT64_DOUBLE_CONVERSION)
 
+// MetaEngine extension: Value memory is prefixed by the MemoryResource it was
+// taken from (null for the heap) so that it can be released correctly no
+// matter which resource is current when it is released. The prefix is sized to
+// keep the memory that follows it aligned for any type.
+static thread_local MemoryResource* currentMemoryResource = 0;
+static const size_t valueMemoryPrefix = 2 * sizeof(void*);
+
+MemoryResource::~MemoryResource() {}
+
+MemoryResource* MemoryResource::current() { return currentMemoryResource; }
+
+MemoryResource::Scope::Scope(MemoryResource* resource)
+    : previous_(currentMemoryResource) {
+  currentMemoryResource = resource;
+}
+
+MemoryResource::Scope::~Scope() { currentMemoryResource = previous_; }
+
+static thread_local KeyInterner* currentKeyInterner = 0;
+
+KeyInterner::~KeyInterner() {}
+
+KeyInterner* KeyInterner::current() { return currentKeyInterner; }
+
+KeyInterner::Scope::Scope(KeyInterner* interner)
+    : previous_(currentKeyInterner) {
+  currentKeyInterner = interner;
+}
+
+KeyInterner::Scope::~Scope() { currentKeyInterner = previous_; }
+
+void* allocateValueMemory(size_t size) {
+  MemoryResource* resource = currentMemoryResource;
+  char* memory = 0;
+  if (resource) {
+    memory = static_cast<char*>(resource->allocate(valueMemoryPrefix + size));
+  } else {
+    memory = static_cast<char*>(::operator new(valueMemoryPrefix + size));
+  }
+  *reinterpret_cast<MemoryResource**>(memory) = resource;
+  return memory + valueMemoryPrefix;
+}
+
+void releaseValueMemory(void* p) {
+  if (!p)
+    return;
+  char* memory = static_cast<char*>(p) - valueMemoryPrefix;
+  if (*reinterpret_cast<MemoryResource**>(memory) == 0)
+    ::operator delete(memory);
+}
+
 /** Duplicates the specified string value.
  * @param value Pointer to the string to duplicate. Must be zero-terminated if
  *              length is "unknown".
@@ -2510,7 +2561,7 @@ static inline char* duplicateStringValue(const char* value,
   if (length >= static_cast<size_t>(Value::maxInt))
     length = Value::maxInt - 1;
 
-  char* newString = static_cast<char*>(malloc(length + 1));
+  char* newString = static_cast<char*>(allocateValueMemory(length + 1));
   if (newString == NULL) {
     throwRuntimeError(
         "in Json::Value::duplicateStringValue(): "
@@ -2533,7 +2584,7 @@ static inline char* duplicateAndPrefixStringValue(
                       "in Json::Value::duplicateAndPrefixStringValue(): "
                       "length too big for prefixing");
   unsigned actualLength = length + static_cast<unsigned>(sizeof(unsigned)) + 1U;
-  char* newString = static_cast<char*>(malloc(actualLength));
+  char* newString = static_cast<char*>(allocateValueMemory(actualLength));
   if (newString == 0) {
     throwRuntimeError(
         "in Json::Value::duplicateAndPrefixStringValue(): "
@@ -2565,23 +2616,43 @@ static inline void releasePrefixedStringValue(char* value) {
   decodePrefixedString(true, value, &length, &valueDecoded);
   size_t const size = sizeof(unsigned) + length + 1U;
   memset(value, 0, size);
-  free(value);
+  releaseValueMemory(value);
 }
 static inline void releaseStringValue(char* value, unsigned length) {
   // length==0 => we allocated the strings memory
   size_t size = (length==0) ? strlen(value) : length;
   memset(value, 0, size);
-  free(value);
+  releaseValueMemory(value);
 }
 #else // !JSONCPP_USING_SECURE_MEMORY
 static inline void releasePrefixedStringValue(char* value) {
-  free(value);
+  releaseValueMemory(value);
 }
 static inline void releaseStringValue(char* value, unsigned length) {
-  free(value);
+  releaseValueMemory(value);
 }
 #endif // JSONCPP_USING_SECURE_MEMORY
 
+/** Allocates and constructs count objects with memory from
+ * allocateValueMemory().
+ */
+template <typename T, typename... Args>
+static inline T* newValueObjects(size_t count, Args&&... args) {
+  T* objects = static_cast<T*>(allocateValueMemory(count * sizeof(T)));
+  for (size_t i = 0; i < count; ++i)
+    new (objects + i) T(std::forward<Args>(args)...);
+  return objects;
+}
+
+/** Destroys and releases objects created by newValueObjects().
+ */
+template <typename T>
+static inline void deleteValueObjects(T* objects, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    objects[i].~T();
+  releaseValueMemory(objects);
+}
+
 } // namespace Json
 
 // //////////////////////////////////////////////////////////////////
@@ -2672,13 +2743,18 @@ Value::CZString::CZString(char const* str, unsigned ulength, DuplicationPolicy a
 }
 
 Value::CZString::CZString(const CZString& other) {
-  cstr_ = (other.storage_.policy_ != noDuplication && other.cstr_ != 0
+  unsigned policy = other.storage_.policy_;
+  // MetaEngine: interned keys are only shared while an interner is current,
+  // otherwise the copy takes its own storage
+  if (other.cstr_ && policy == interned && !KeyInterner::current())
+    policy = duplicateOnCopy;
+  cstr_ = (policy != noDuplication && policy != interned && other.cstr_ != 0
 				 ? duplicateStringValue(other.cstr_, other.storage_.length_)
 				 : other.cstr_);
-  storage_.policy_ = static_cast<unsigned>(other.cstr_
-                 ? (static_cast<DuplicationPolicy>(other.storage_.policy_) == noDuplication
-                     ? noDuplication : duplicate)
-                 : static_cast<DuplicationPolicy>(other.storage_.policy_)) & 3U;
+  storage_.policy_ = (other.cstr_
+                 ? (policy == noDuplication || policy == interned
+                     ? policy : static_cast<unsigned>(duplicate))
+                 : policy) & 3U;
   storage_.length_ = other.storage_.length_;
 }
 
@@ -2711,6 +2787,8 @@ bool Value::CZString::operator<(const CZString& other) const {
   // Assume both are strings.
   unsigned this_len = this->storage_.length_;
   unsigned other_len = other.storage_.length_;
+  // MetaEngine: interned keys are equal if they share storage
+  if (this->cstr_ == other.cstr_ && this_len == other_len) return false;
   unsigned min_len = std::min(this_len, other_len);
   JSON_ASSERT(this->cstr_ && other.cstr_);
   int comp = memcmp(this->cstr_, other.cstr_, min_len);
@@ -2726,6 +2804,7 @@ bool Value::CZString::operator==(const CZString& other) const {
   unsigned this_len = this->storage_.length_;
   unsigned other_len = other.storage_.length_;
   if (this_len != other_len) return false;
+  if (this->cstr_ == other.cstr_) return true;
   JSON_ASSERT(this->cstr_ && other.cstr_);
   int comp = memcmp(this->cstr_, other.cstr_, this_len);
   return comp == 0;
@@ -2767,7 +2846,7 @@ Value::Value(ValueType vtype) {
     break;
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues();
+    value_.map_ = newValueObjects<ObjectValues>(1);
     break;
   case booleanValue:
     value_.bool_ = false;
@@ -2864,13 +2943,13 @@ Value::Value(Value const& other)
     break;
   case arrayValue:
   case objectValue:
-    value_.map_ = new ObjectValues(*other.value_.map_);
+    value_.map_ = newValueObjects<ObjectValues>(1, *other.value_.map_);
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
   }
   if (other.comments_) {
-    comments_ = new CommentInfo[numberOfCommentPlacement];
+    comments_ = newValueObjects<CommentInfo>(numberOfCommentPlacement);
     for (int comment = 0; comment < numberOfCommentPlacement; ++comment) {
       const CommentInfo& otherComment = other.comments_[comment];
       if (otherComment.comment_)
@@ -2902,14 +2981,14 @@ Value::~Value() {
     break;
   case arrayValue:
   case objectValue:
-    delete value_.map_;
+    deleteValueObjects(value_.map_, 1);
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
   }
 
   if (comments_)
-    delete[] comments_;
+    deleteValueObjects(comments_, numberOfCommentPlacement);
 
   value_.uint_ = 0;
 }
@@ -2929,6 +3008,19 @@ void Value::swapPayload(Value& other) {
   other.allocated_ = temp2 & 0x1;
 }
 
+void Value::sharePayload(const Value& other) {
+  JSON_ASSERT_MESSAGE(type_ == nullValue,
+                      "in Json::Value::sharePayload(): requires nullValue");
+  type_ = other.type_;
+  value_ = other.value_;
+  allocated_ = other.allocated_;
+}
+
+bool Value::sharesPayload(const Value& other) const {
+  return (type_ == arrayValue || type_ == objectValue) &&
+         type_ == other.type_ && value_.map_ == other.value_.map_;
+}
+
 void Value::swap(Value& other) {
   swapPayload(other);
   std::swap(comments_, other.comments_);
@@ -3467,6 +3559,14 @@ Value& Value::resolveReference(char const* key, char const* cend)
   if (it != value_.map_->end() && (*it).first == actualKey)
     return (*it).second;
 
+  // MetaEngine: take the storage of new keys from the current interner
+  KeyInterner* interner = KeyInterner::current();
+  if (interner) {
+    unsigned length = static_cast<unsigned>(cend-key);
+    actualKey = CZString(
+        interner->intern(key, length), length, CZString::interned);
+  }
+
   ObjectValues::value_type defaultValue(actualKey, nullRef);
   it = value_.map_->insert(it, defaultValue);
   Value& value = (*it).second;
@@ -3491,6 +3591,15 @@ Value const* Value::find(char const* key, char const* cend) const
   if (it == value_.map_->end()) return NULL;
   return &(*it).second;
 }
+// MetaEngine: demand() is declared by this version of JsonCpp but was never
+// defined
+Value const* Value::demand(char const* key, char const* cend)
+{
+  JSON_ASSERT_MESSAGE(
+      type_ == nullValue || type_ == objectValue,
+      "in Json::Value::demand(key, end): requires objectValue or nullValue");
+  return &resolveReference(key, cend);
+}
 const Value& Value::operator[](const char* key) const
 {
   Value const* found = find(key, key + strlen(key));
@@ -3773,7 +3882,7 @@ bool Value::isObject() const { return type_ == objectValue; }
 
 void Value::setComment(const char* comment, size_t len, CommentPlacement placement) {
   if (!comments_)
-    comments_ = new CommentInfo[numberOfCommentPlacement];
+    comments_ = newValueObjects<CommentInfo>(numberOfCommentPlacement);
   if ((len > 0) && (comment[len-1] == '\n')) {
     // Always discard trailing newline, to aid indentation.
     len -= 1;
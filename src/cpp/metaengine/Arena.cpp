@@ -0,0 +1,164 @@
+#include "metaengine/Arena.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The alignment of all memory handed out by an Arena, suitable for any
+ *        type stored in a JSON tree.
+ */
+const std::size_t ALIGNMENT = 2 * sizeof(void*);
+
+/*!
+ * \brief The largest block an Arena will grow to, larger allocations still
+ *        get a block of their own.
+ */
+const std::size_t MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+
+/*!
+ * \brief Rounds the size up to a multiple of ALIGNMENT.
+ */
+inline std::size_t align(std::size_t size)
+{
+    return (size + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1);
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                     ARENA
+//------------------------------------------------------------------------------
+
+Arena::Arena(std::size_t block_size)
+    :
+    m_block     (nullptr),
+    m_next      (nullptr),
+    m_end       (nullptr),
+    m_block_size(std::max(align(block_size), ALIGNMENT)),
+    m_used      (0),
+    m_reserved  (0)
+{
+}
+
+Arena::~Arena()
+{
+    while(m_block != nullptr)
+    {
+        Block* previous = m_block->previous;
+        ::operator delete(m_block);
+        m_block = previous;
+    }
+}
+
+void* Arena::allocate(std::size_t size)
+{
+    size = align(size);
+    if(static_cast<std::size_t>(m_end - m_next) < size)
+    {
+        new_block(size);
+    }
+
+    void* ret = m_next;
+    m_next += size;
+    m_used += size;
+    return ret;
+}
+
+std::size_t Arena::get_used() const
+{
+    return m_used;
+}
+
+std::size_t Arena::get_reserved() const
+{
+    return m_reserved;
+}
+
+void Arena::new_block(std::size_t size)
+{
+    std::size_t block_size = std::max(size, m_block_size);
+    std::size_t header_size = align(sizeof(Block));
+
+    Block* block = static_cast<Block*>(
+        ::operator new(header_size + block_size));
+    block->previous = m_block;
+    block->size     = block_size;
+    m_block = block;
+    m_next  = reinterpret_cast<char*>(block) + header_size;
+    m_end   = m_next + block_size;
+    m_reserved += header_size + block_size;
+
+    // grow geometrically so that large trees only need a few blocks
+    m_block_size = std::min(m_block_size * 2, MAX_BLOCK_SIZE);
+}
+
+//------------------------------------------------------------------------------
+//                                   ARENA TREE
+//------------------------------------------------------------------------------
+
+ArenaTree::ArenaTree(
+        std::size_t size_hint,
+        const std::shared_ptr<KeyPool>& key_pool)
+    :
+    m_arena   (std::min(
+        std::max(size_hint, sizeof(Json::Value)),
+        MAX_BLOCK_SIZE
+    )),
+    m_key_pool(key_pool),
+    m_root    (nullptr)
+{
+    m_root = new(m_arena.allocate(sizeof(Json::Value))) Json::Value();
+}
+
+Json::Value* ArenaTree::get_root()
+{
+    return m_root;
+}
+
+const Json::Value* ArenaTree::get_root() const
+{
+    return m_root;
+}
+
+Arena& ArenaTree::get_arena()
+{
+    return m_arena;
+}
+
+const Arena& ArenaTree::get_arena() const
+{
+    return m_arena;
+}
+
+KeyPool* ArenaTree::get_key_pool() const
+{
+    return m_key_pool.get();
+}
+
+void ArenaTree::add_section(const Section& section)
+{
+    m_sections.push_back(section);
+}
+
+const std::vector<ArenaTree::Section>& ArenaTree::get_sections() const
+{
+    return m_sections;
+}
+
+void ArenaTree::set_shards(const std::shared_ptr<Shards>& shards)
+{
+    m_shards = shards;
+}
+
+Shards* ArenaTree::get_shards() const
+{
+    return m_shards.get();
+}
+
+} // namespace metaengine
@@ -0,0 +1,275 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_ARENA_HPP_
+#define METAENGINE_ARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+class KeyPool;
+class Shards;
+
+/*!
+ * \brief Monotonic memory resource that parsed JSON trees are allocated from.
+ *
+ * Memory is handed out by bumping a pointer through large blocks, and is only
+ * returned when the Arena is destroyed, at which point each block is freed in
+ * one go. Individual allocations are never freed, so an Arena should only be
+ * used for data that lives and dies together, see ArenaTree.
+ *
+ * Arenas are not thread safe, but any number of threads can each build into
+ * their own Arena.
+ */
+class Arena : public Json::MemoryResource
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Arena);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new Arena.
+     *
+     * \param block_size The size of the first block of memory the Arena will
+     *                   allocate. Subsequent blocks grow geometrically.
+     */
+    explicit Arena(std::size_t block_size = 4096);
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    virtual ~Arena();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    // override
+    virtual void* allocate(std::size_t size);
+
+    /*!
+     * \brief Returns the number of bytes that have been handed out by this
+     *        Arena.
+     */
+    std::size_t get_used() const;
+
+    /*!
+     * \brief Returns the number of bytes this Arena has reserved from the heap.
+     */
+    std::size_t get_reserved() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The header at the start of each block of memory.
+     */
+    struct Block
+    {
+        Block* previous;
+        std::size_t size;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The most recently allocated block.
+     */
+    Block* m_block;
+    /*!
+     * \brief The next free byte of the current block.
+     */
+    char* m_next;
+    /*!
+     * \brief The end of the current block.
+     */
+    char* m_end;
+    /*!
+     * \brief The size of the next block to allocate.
+     */
+    std::size_t m_block_size;
+    std::size_t m_used;
+    std::size_t m_reserved;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Allocates a new block which has at least the given number of
+     *        usable bytes.
+     */
+    void new_block(std::size_t size);
+};
+
+/*!
+ * \brief A tree of JSON values that is allocated entirely from an Arena it
+ *        owns.
+ *
+ * The tree must only be built (e.g. parsed) inside a
+ * Json::MemoryResource::Scope for get_arena() (and a Json::KeyInterner::Scope
+ * for get_key_pool() if there is one), and must not be modified afterwards.
+ * Destroying an ArenaTree releases the Arena without visiting any of the
+ * values in the tree.
+ *
+ * Large subtrees may be built into ArenaTrees of their own (sections), which
+ * the values of this tree refer to rather than copy so that they can be
+ * shared with other trees, see SectionParser. The tree keeps its sections
+ * alive.
+ *
+ * The members of the root object of a sharded tree are the exception to the
+ * tree being immutable: each is a null placeholder until its shard is parsed
+ * on first access, see Shards.
+ */
+class ArenaTree
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ArenaTree);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                  STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A subtree that is built in an ArenaTree of its own, identified
+     *        by the data it was parsed from.
+     */
+    struct Section
+    {
+        /*!
+         * \brief The length of the data the subtree was parsed from,
+         *        excluding whitespace and comments.
+         */
+        std::size_t length;
+        /*!
+         * \brief The hash of the data the subtree was parsed from, excluding
+         *        whitespace and comments.
+         */
+        arc::uint64 hash;
+        /*!
+         * \brief The data the subtree was parsed from, excluding whitespace,
+         *        comments and the data of the sections within it, which is
+         *        compared to confirm a match on the hash.
+         */
+        std::string content;
+        /*!
+         * \brief The tree the root value of which is the subtree.
+         */
+        std::shared_ptr<const ArenaTree> tree;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new tree with a null root value.
+     *
+     * \param size_hint The size of the data the tree will be built from, used
+     *                  to size the first block of the Arena.
+     * \param key_pool The pool the keys of the tree will be interned in (may
+     *                 be null), the tree keeps it alive.
+     */
+    explicit ArenaTree(
+            std::size_t size_hint = 0,
+            const std::shared_ptr<KeyPool>& key_pool = nullptr);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the root value of the tree.
+     */
+    Json::Value* get_root();
+
+    /*!
+     * \brief Returns the root value of the tree.
+     */
+    const Json::Value* get_root() const;
+
+    /*!
+     * \brief Returns the Arena the values of this tree are allocated from.
+     */
+    Arena& get_arena();
+
+    /*!
+     * \brief Returns the Arena the values of this tree are allocated from.
+     */
+    const Arena& get_arena() const;
+
+    /*!
+     * \brief Returns the pool the keys of this tree are interned in (may be
+     *        null).
+     */
+    KeyPool* get_key_pool() const;
+
+    /*!
+     * \brief Adds a section that values of this tree refer to.
+     */
+    void add_section(const Section& section);
+
+    /*!
+     * \brief Returns the sections that values of this tree refer to directly
+     *        (not including the sections of those sections).
+     */
+    const std::vector<Section>& get_sections() const;
+
+    /*!
+     * \brief Sets the shards the members of the root object of this tree are
+     *        parsed from on first access, the tree keeps them alive.
+     */
+    void set_shards(const std::shared_ptr<Shards>& shards);
+
+    /*!
+     * \brief Returns the shards the members of the root object of this tree
+     *        are parsed from, or null if the tree is not sharded.
+     */
+    Shards* get_shards() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    Arena m_arena;
+    std::shared_ptr<KeyPool> m_key_pool;
+    /*!
+     * \brief The root value, which is itself allocated from the Arena and so
+     *        is never destroyed.
+     */
+    Json::Value* m_root;
+    std::vector<Section> m_sections;
+    std::shared_ptr<Shards> m_shards;
+};
+
+} // namespace metaengine
+
+#endif
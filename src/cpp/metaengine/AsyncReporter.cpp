@@ -0,0 +1,488 @@
+#include "metaengine/AsyncReporter.hpp"
+
+#include <cstring>
+
+#include "metaengine/Diagnostic.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Adds the null terminated string to the FNV-1a hash, including the
+ *        terminator so that adjacent strings can't run into each other.
+ */
+inline void hash_string(arc::uint64& hash, const char* c)
+{
+    for(; *c != '\0'; ++c)
+    {
+        hash ^= static_cast<unsigned char>(*c);
+        hash *= 1099511628211ULL;
+    }
+    hash *= 1099511628211ULL;
+}
+
+/*!
+ * \brief Returns the hash used to choose the deduplication slot of an event.
+ *
+ * The file path is left out since it is comparatively expensive to hash, and
+ * rarely differs between events that are otherwise identical.
+ *
+ * \param details_hash The hash of the details of the event.
+ */
+arc::uint64 hash_event(
+        FallbackEvent::Type type,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        arc::uint64 details_hash,
+        const arc::str::UTF8String& variant)
+{
+    arc::uint64 hash = 14695981039346656037ULL;
+    hash ^= static_cast<arc::uint64>(type);
+    hash *= 1099511628211ULL;
+    hash ^= details_hash;
+    hash *= 1099511628211ULL;
+    hash_string(hash, description);
+    hash_string(hash, key.get_raw());
+    hash_string(hash, error_type.get_raw());
+    hash_string(hash, variant.get_raw());
+    return hash;
+}
+
+/*!
+ * \brief Returns whether the event describes the same failure as the given
+ *        components (ignoring the suppressed count and the details).
+ */
+bool is_identical(
+        const FallbackEvent& event,
+        FallbackEvent::Type type,
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        const arc::str::UTF8String& variant)
+{
+    return event.type       == type                           &&
+           std::strcmp(event.description, description) == 0  &&
+           event.key        == key                            &&
+           event.error_type == error_type                     &&
+           event.file_path  == file_path                      &&
+           event.variant    == variant;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTORS
+//------------------------------------------------------------------------------
+
+AsyncReporter::Slot::Slot()
+    :
+    used        (false),
+    diagnosed   (false),
+    details_hash(0)
+{
+}
+
+AsyncReporter::AsyncReporter(
+        event_reporter func,
+        std::size_t capacity,
+        arc::uint64 rate_limit)
+    :
+    m_func           (func),
+    m_rate_limit     (rate_limit),
+    m_buffer         (nullptr),
+    m_mask           (0),
+    m_enqueue_pos    (0),
+    m_dequeue_pos    (0),
+    m_dropped        (0),
+    m_slots          (nullptr),
+    m_sleeping       (false),
+    m_flush_requested(0),
+    m_flush_completed(0),
+    m_stop           (false)
+{
+    // round the capacity up to a power of two
+    std::size_t size = 2;
+    while(size < capacity)
+    {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+
+    m_buffer = new Cell[size];
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_slots = new Slot[size];
+
+    m_thread = std::thread(&AsyncReporter::run, this);
+}
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+AsyncReporter::~AsyncReporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+    delete[] m_slots;
+    delete[] m_buffer;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool AsyncReporter::push(const FallbackEvent& event)
+{
+    return push(
+        event.type,
+        event.file_path,
+        event.key,
+        event.description,
+        event.error_type,
+        event.details,
+        event.variant
+    );
+}
+
+bool AsyncReporter::push(
+        FallbackEvent::Type type,
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        const arc::str::UTF8String& details,
+        const arc::str::UTF8String& variant)
+{
+    return push(
+        type,
+        file_path,
+        key,
+        description,
+        error_type,
+        &details,
+        nullptr,
+        variant
+    );
+}
+
+bool AsyncReporter::push(
+        FallbackEvent::Type type,
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        const Diagnostic& diagnostic,
+        const arc::str::UTF8String& variant)
+{
+    return push(
+        type,
+        file_path,
+        key,
+        description,
+        error_type,
+        nullptr,
+        &diagnostic,
+        variant
+    );
+}
+
+void AsyncReporter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    arc::uint64 flush = ++m_flush_requested;
+    m_condition.notify_all();
+    m_condition.wait(lock, [&]()
+    {
+        return m_flush_completed >= flush;
+    });
+}
+
+arc::uint64 AsyncReporter::get_dropped_count() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool AsyncReporter::push(
+        FallbackEvent::Type type,
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        const arc::str::UTF8String* details,
+        const Diagnostic* diagnostic,
+        const arc::str::UTF8String& variant)
+{
+    // the details of diagnosed events are compared by their hash, so that
+    // they are only formatted if the event is not suppressed
+    bool diagnosed = diagnostic != nullptr;
+    arc::uint64 details_hash = 14695981039346656037ULL;
+    if(diagnosed)
+    {
+        details_hash = diagnostic->hash();
+    }
+    else
+    {
+        hash_string(details_hash, details->get_raw());
+    }
+
+    Slot& slot = m_slots[
+        hash_event(type, key, description, error_type, details_hash, variant) &
+        m_mask
+    ];
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+
+    FallbackEvent event;
+    FallbackEvent evicted;
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if(slot.used                         &&
+           slot.diagnosed    == diagnosed    &&
+           slot.details_hash == details_hash &&
+           (diagnosed || slot.event.details == *details) &&
+           is_identical(
+                slot.event,
+                type,
+                file_path,
+                key,
+                description,
+                error_type,
+                variant
+           ))
+        {
+            // still within the rate limit?
+            if(now - slot.last_reported < m_rate_limit)
+            {
+                ++slot.event.suppressed;
+                return true;
+            }
+            // report along with how many were suppressed
+            event = slot.event;
+            slot.event.suppressed = 0;
+        }
+        else
+        {
+            // the count of the event being evicted must still be reported
+            if(slot.used && slot.event.suppressed > 0)
+            {
+                evicted = slot.event;
+            }
+            slot.event = FallbackEvent(
+                type,
+                file_path,
+                key,
+                description,
+                error_type,
+                diagnosed ? diagnostic->format() : *details,
+                variant
+            );
+            slot.used = true;
+            slot.diagnosed = diagnosed;
+            slot.details_hash = details_hash;
+            event = slot.event;
+        }
+        slot.last_reported = now;
+    }
+
+    if(evicted.suppressed > 0)
+    {
+        enqueue(evicted);
+    }
+    return enqueue(event);
+}
+
+bool AsyncReporter::enqueue(const FallbackEvent& event)
+{
+    Cell* cell = nullptr;
+    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    while(true)
+    {
+        cell = &m_buffer[pos & m_mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(sequence) -
+            static_cast<std::ptrdiff_t>(pos);
+
+        if(diff == 0)
+        {
+            // the cell is free, attempt to claim it
+            if(m_enqueue_pos.compare_exchange_weak(
+                    pos,
+                    pos + 1,
+                    std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if(diff < 0)
+        {
+            // the queue is full
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            // another producer claimed the cell
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->event = event;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    // only wake the background thread if it has found the queue empty, the
+    // fence orders the store of the event before reading whether it sleeps
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_sleeping.load(std::memory_order_relaxed))
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+        m_condition.notify_all();
+    }
+    return true;
+}
+
+bool AsyncReporter::pop(FallbackEvent& event)
+{
+    // there is only a single consumer so no need to contend for the position
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Cell* cell = &m_buffer[pos & m_mask];
+    std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if(sequence != pos + 1)
+    {
+        // empty
+        return false;
+    }
+
+    m_dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    event = cell->event;
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncReporter::is_empty() const
+{
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    return m_buffer[pos & m_mask].sequence.load(std::memory_order_acquire) !=
+           pos + 1;
+}
+
+void AsyncReporter::run()
+{
+    while(true)
+    {
+        // these must be checked before draining the queue so that any event
+        // pushed before the request is guaranteed to be drained
+        bool stopping = false;
+        arc::uint64 flush = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stopping = m_stop;
+            flush = m_flush_requested;
+        }
+
+        FallbackEvent event;
+        bool processed = false;
+        while(pop(event))
+        {
+            report(event);
+            processed = true;
+        }
+
+        if(stopping || flush != m_flush_completed)
+        {
+            report_suppressed();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_flush_completed = flush;
+            }
+            m_condition.notify_all();
+        }
+        if(stopping)
+        {
+            return;
+        }
+
+        if(processed)
+        {
+            continue;
+        }
+
+        // the queue is checked again after announcing that this thread is
+        // sleeping, since an event pushed before the announcement is seen
+        // does not wake it
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(!is_empty())
+        {
+            m_sleeping.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]()
+        {
+            return !m_sleeping.load(std::memory_order_relaxed) ||
+                   m_stop                                     ||
+                   m_flush_requested != m_flush_completed;
+        });
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AsyncReporter::report_suppressed()
+{
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i <= m_mask; ++i)
+    {
+        FallbackEvent event;
+        {
+            std::lock_guard<std::mutex> lock(m_slots[i].mutex);
+            if(m_slots[i].event.suppressed == 0)
+            {
+                continue;
+            }
+            event = m_slots[i].event;
+            m_slots[i].event.suppressed = 0;
+            m_slots[i].last_reported = now;
+        }
+        report(event);
+    }
+}
+
+void AsyncReporter::report(const FallbackEvent& event)
+{
+    if(m_func == nullptr)
+    {
+        return;
+    }
+
+    // don't let the reporter kill the background thread
+    try
+    {
+        m_func(event);
+    }
+    catch(...)
+    {
+    }
+}
+
+} // namespace metaengine
@@ -0,0 +1,345 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_ASYNCREPORTER_HPP_
+#define METAENGINE_ASYNCREPORTER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "metaengine/FallbackEvent.hpp"
+
+namespace metaengine
+{
+
+class Diagnostic;
+
+/*!
+ * \brief Reports FallbackEvents from a background thread, deduplicating and
+ *        rate limiting repeated events.
+ *
+ * Once an AsyncReporter has been passed to Document::set_async_reporter(),
+ * Documents will push FallbackEvents into the reporter's bounded lock-free
+ * queue instead of synchronously calling the load and get fallback reporters.
+ * Pushing never waits for the queue or the reporter function: if the queue is
+ * full the event is dropped and counted (see get_dropped_count()).
+ *
+ * Identical events (those with the same type, file path, key, description,
+ * error type, details and variant) are reported at most once per rate limit
+ * interval, any others are suppressed and counted. Events are deduplicated as
+ * they are pushed against a fixed size table of the events reported most
+ * recently, so a suppressed event costs no more than hashing and comparing
+ * its components, and the details of events pushed with a Diagnostic are
+ * only formatted if the event is not suppressed (see Diagnostic::hash()).
+ * Each slot of the table is guarded by a mutex, which is held by the pushing
+ * thread while it compares the event and, if the event is not suppressed,
+ * copies it into the slot, so pushes of events which share a slot (and the
+ * background thread while it is flushed) wait for each other. The table has
+ * a slot for each cell of the queue, which bounds the memory used, and when
+ * distinct events share a slot the event that was in it is evicted (and any
+ * count of suppressed events is reported). The count of suppressed events is
+ * delivered with the next identical event that is reported, or when the
+ * reporter is flushed or destroyed, via FallbackEvent::suppressed.
+ *
+ * The background thread drains the queue and passes each event to the
+ * reporter function. It sleeps while the queue is empty, and is only woken
+ * by the push that finds it sleeping.
+ *
+ * \note The reporter function is always called from the background thread.
+ */
+class AsyncReporter
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(AsyncReporter);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Function used to report fallback events.
+     */
+    typedef void (*event_reporter)(const FallbackEvent& event);
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new AsyncReporter and starts its background thread.
+     *
+     * \param func The function that will be called to report events.
+     * \param capacity The maximum number of events the queue can hold, and
+     *                 the number of distinct events that are deduplicated,
+     *                 this will be rounded up to the next power of two.
+     * \param rate_limit The minimum number of milliseconds between reports of
+     *                   identical events.
+     */
+    AsyncReporter(
+            event_reporter func,
+            std::size_t capacity = 1024,
+            arc::uint64 rate_limit = 1000);
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Reports any remaining events (and suppressed counts) and stops the
+     *        background thread.
+     */
+    ~AsyncReporter();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Queues the given event to be reported.
+     *
+     * \return ```false``` if the event was dropped because the queue was full,
+     *         otherwise the event was either queued or suppressed.
+     */
+    bool push(const FallbackEvent& event);
+
+    /*!
+     * \brief Queues an event built from the given components to be reported.
+     *
+     * The event is only built if it is not suppressed.
+     *
+     * \param description Static string describing the fallback, this is not
+     *                    copied so must outlive the event.
+     * \param variant The variant being loaded, if the event concerns one.
+     * \return ```false``` if the event was dropped because the queue was full,
+     *         otherwise the event was either queued or suppressed.
+     */
+    bool push(
+            FallbackEvent::Type type,
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& key,
+            const char* description,
+            const arc::str::UTF8String& error_type,
+            const arc::str::UTF8String& details,
+            const arc::str::UTF8String& variant = arc::str::UTF8String());
+
+    /*!
+     * \brief Queues an event whose details are formatted from the given
+     *        Diagnostic to be reported.
+     *
+     * The Diagnostic is only formatted if the event is not suppressed, since
+     * identical events are recognised by the hash of the Diagnostic.
+     *
+     * \param description Static string describing the fallback, this is not
+     *                    copied so must outlive the event.
+     * \param variant The variant being loaded, if the event concerns one.
+     * \return ```false``` if the event was dropped because the queue was full,
+     *         otherwise the event was either queued or suppressed.
+     */
+    bool push(
+            FallbackEvent::Type type,
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& key,
+            const char* description,
+            const arc::str::UTF8String& error_type,
+            const Diagnostic& diagnostic,
+            const arc::str::UTF8String& variant = arc::str::UTF8String());
+
+    /*!
+     * \brief Blocks until every event queued before this call has been
+     *        processed, and any suppressed counts have been reported.
+     */
+    void flush();
+
+    /*!
+     * \brief Returns the number of events that have been dropped because the
+     *        queue was full.
+     */
+    arc::uint64 get_dropped_count() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A slot in the queue.
+     */
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        FallbackEvent event;
+    };
+
+    /*!
+     * \brief The deduplication state of the event reported most recently out
+     *        of those that hash to a slot.
+     */
+    struct Slot
+    {
+        /*!
+         * \brief Guards the slot, since it is accessed by every producer of
+         *        the events which hash to it, and by the background thread.
+         */
+        std::mutex mutex;
+        /*!
+         * \brief Whether the slot holds an event.
+         */
+        bool used;
+        /*!
+         * \brief The event, whose suppressed count is the number of identical
+         *        events suppressed since it was last reported.
+         */
+        FallbackEvent event;
+        /*!
+         * \brief Whether the details of the event were formatted from a
+         *        Diagnostic.
+         */
+        bool diagnosed;
+        /*!
+         * \brief The hash of the details of the event, or of the Diagnostic
+         *        they were formatted from.
+         */
+        arc::uint64 details_hash;
+        std::chrono::steady_clock::time_point last_reported;
+
+        Slot();
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The function events are reported to.
+     */
+    event_reporter m_func;
+    /*!
+     * \brief The minimum time between reports of identical events.
+     */
+    std::chrono::milliseconds m_rate_limit;
+
+    /*!
+     * \brief The ring buffer of the queue.
+     */
+    Cell* m_buffer;
+    /*!
+     * \brief Mask used to wrap positions into the ring buffer.
+     */
+    std::size_t m_mask;
+    /*!
+     * \brief The position the next event will be pushed to.
+     */
+    std::atomic<std::size_t> m_enqueue_pos;
+    /*!
+     * \brief The position the next event will be popped from.
+     */
+    std::atomic<std::size_t> m_dequeue_pos;
+    /*!
+     * \brief The number of events dropped because the queue was full.
+     */
+    std::atomic<arc::uint64> m_dropped;
+
+    /*!
+     * \brief The deduplication table, which is the same size as the ring
+     *        buffer.
+     */
+    Slot* m_slots;
+
+    /*!
+     * \brief Set by the background thread when it has found the queue empty
+     *        and is about to sleep, cleared by the push that wakes it.
+     */
+    std::atomic<bool> m_sleeping;
+
+    /*!
+     * \brief Guards the flush and stop requests.
+     */
+    std::mutex m_mutex;
+    /*!
+     * \brief Notified when a flush or stop is requested, and when a flush has
+     *        completed.
+     */
+    std::condition_variable m_condition;
+    /*!
+     * \brief The number of flushes that have been requested.
+     */
+    arc::uint64 m_flush_requested;
+    /*!
+     * \brief The number of requested flushes that have completed.
+     */
+    arc::uint64 m_flush_completed;
+    /*!
+     * \brief Set to request that the background thread stops.
+     */
+    bool m_stop;
+
+    /*!
+     * \brief The background thread.
+     */
+    std::thread m_thread;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Implementation of push, the event's details are either given or
+     *        formatted from the Diagnostic (one of which is null).
+     */
+    bool push(
+            FallbackEvent::Type type,
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& key,
+            const char* description,
+            const arc::str::UTF8String& error_type,
+            const arc::str::UTF8String* details,
+            const Diagnostic* diagnostic,
+            const arc::str::UTF8String& variant);
+
+    /*!
+     * \brief Adds the event to the queue without deduplicating it, waking the
+     *        background thread if it is sleeping.
+     *
+     * \return ```false``` if the queue was full.
+     */
+    bool enqueue(const FallbackEvent& event);
+
+    /*!
+     * \brief Pops the next event from the queue.
+     *
+     * \return ```false``` if the queue was empty.
+     */
+    bool pop(FallbackEvent& event);
+
+    /*!
+     * \brief Returns whether there is no event ready to be popped.
+     */
+    bool is_empty() const;
+
+    /*!
+     * \brief The function run by the background thread.
+     */
+    void run();
+
+    /*!
+     * \brief Reports all events that have suppressed counts.
+     */
+    void report_suppressed();
+
+    /*!
+     * \brief Passes the event to the reporter function.
+     */
+    void report(const FallbackEvent& event);
+};
+
+} // namespace metaengine
+
+#endif
@@ -0,0 +1,266 @@
+#include "metaengine/Children.hpp"
+
+#include <string>
+
+namespace metaengine
+{
+
+//------------------------------------------------------------------------------
+//                                     CHILD
+//------------------------------------------------------------------------------
+
+Child::Child(
+        const Children* parent,
+        const char* key,
+        std::size_t index,
+        const Json::Value* value)
+    :
+    m_parent(parent),
+    m_key   (key),
+    m_index (index),
+    m_value (value)
+{
+}
+
+bool Child::is_element() const
+{
+    return m_key == nullptr;
+}
+
+const char* Child::get_key() const
+{
+    return m_key;
+}
+
+std::size_t Child::get_index() const
+{
+    return m_index;
+}
+
+const Json::Value* Child::get_value() const
+{
+    return m_value;
+}
+
+arc::str::UTF8String Child::get_full_key() const
+{
+    return m_parent->build_key(*this);
+}
+
+void Child::retrieve(VisitorBase* visitor) const
+{
+    const arc::str::UTF8String& full_key = m_parent->build_key(*this);
+
+    // attempt to use the value directly
+    bool retrieve_success = false;
+    Diagnostic diagnostic;
+    try
+    {
+        retrieve_success = visitor->retrieve(
+            m_value,
+            full_key,
+            m_parent->get_document(),
+            diagnostic
+        );
+    }
+    catch(...)
+    {
+        retrieve_success = false;
+    }
+    if(retrieve_success)
+    {
+        return;
+    }
+
+    // the Document handles falling back and reporting errors, the key is
+    // copied since getting the value may use these children again
+    m_parent->get_document()->get(arc::str::UTF8String(full_key), *visitor);
+}
+
+//------------------------------------------------------------------------------
+//                                CONST ITERATOR
+//------------------------------------------------------------------------------
+
+Children::const_iterator::const_iterator(
+        const Children* parent,
+        Json::Value::const_iterator position,
+        Json::Value::const_iterator end)
+    :
+    m_parent  (parent),
+    m_position(position),
+    m_end     (end),
+    m_index   (0),
+    m_child   (parent, nullptr, 0, nullptr)
+{
+    settle();
+}
+
+const Child& Children::const_iterator::operator*() const
+{
+    return m_child;
+}
+
+const Child* Children::const_iterator::operator->() const
+{
+    return &m_child;
+}
+
+Children::const_iterator& Children::const_iterator::operator++()
+{
+    ++m_position;
+    ++m_index;
+    settle();
+    return *this;
+}
+
+Children::const_iterator Children::const_iterator::operator++(int)
+{
+    const_iterator ret(*this);
+    ++(*this);
+    return ret;
+}
+
+bool Children::const_iterator::operator==(const const_iterator& other) const
+{
+    return m_position == other.m_position;
+}
+
+bool Children::const_iterator::operator!=(const const_iterator& other) const
+{
+    return m_position != other.m_position;
+}
+
+void Children::const_iterator::settle()
+{
+    while(m_position != m_end && (*m_position).isNull())
+    {
+        ++m_position;
+        ++m_index;
+    }
+    if(m_position == m_end)
+    {
+        return;
+    }
+
+    // the elements of arrays are keyed by their index, which does not
+    // allocate to read
+    if(m_parent->is_array())
+    {
+        m_child = Child(
+            m_parent,
+            nullptr,
+            m_position.index(),
+            &(*m_position)
+        );
+    }
+    else
+    {
+        const char* name_end = nullptr;
+        m_child = Child(
+            m_parent,
+            m_position.memberName(&name_end),
+            m_index,
+            &(*m_position)
+        );
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                   CHILDREN
+//------------------------------------------------------------------------------
+
+Children::Children(
+        Document* document,
+        const arc::str::UTF8String& key,
+        const Json::Value* container)
+    :
+    m_document (document),
+    m_key      (key),
+    m_container(container),
+    m_prefix   (key.get_raw(), key.get_byte_length() - 1),
+    m_full_key (arc::str::UTF8String::Opt::SKIP_VALID_CHECK)
+{
+    if(!m_prefix.empty())
+    {
+        m_prefix += '.';
+    }
+}
+
+Children::Children(const Children& other)
+    :
+    m_document (other.m_document),
+    m_key      (other.m_key),
+    m_container(other.m_container),
+    m_prefix   (other.m_prefix),
+    m_full_key (arc::str::UTF8String::Opt::SKIP_VALID_CHECK)
+{
+}
+
+Document* Children::get_document() const
+{
+    return m_document;
+}
+
+const arc::str::UTF8String& Children::get_key() const
+{
+    return m_key;
+}
+
+bool Children::is_array() const
+{
+    return m_container != nullptr && m_container->isArray();
+}
+
+const Json::Value* Children::get_container() const
+{
+    return m_container;
+}
+
+Children::const_iterator Children::begin() const
+{
+    if(m_container == nullptr)
+    {
+        return const_iterator(
+            this,
+            Json::Value::const_iterator(),
+            Json::Value::const_iterator()
+        );
+    }
+    return const_iterator(this, m_container->begin(), m_container->end());
+}
+
+Children::const_iterator Children::end() const
+{
+    if(m_container == nullptr)
+    {
+        return const_iterator(
+            this,
+            Json::Value::const_iterator(),
+            Json::Value::const_iterator()
+        );
+    }
+    return const_iterator(this, m_container->end(), m_container->end());
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+const arc::str::UTF8String& Children::build_key(const Child& child) const
+{
+    // the key is built from parts that are already valid, so is assigned
+    // without being checked again
+    m_buffer.assign(m_prefix);
+    if(child.get_key() != nullptr)
+    {
+        m_buffer += child.get_key();
+    }
+    else
+    {
+        m_buffer += std::to_string(child.get_index());
+    }
+    m_full_key.assign(m_buffer.data(), m_buffer.size());
+    return m_full_key;
+}
+
+} // namespace metaengine
@@ -0,0 +1,313 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_CHILDREN_HPP_
+#define METAENGINE_CHILDREN_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Document.hpp"
+
+namespace metaengine
+{
+
+class Children;
+
+/*!
+ * \brief A child of an object or array in a Document, see
+ *        Document::get_children().
+ */
+class Child
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new child.
+     *
+     * \param parent The children this is one of.
+     * \param key The name of the member, or null if this is an element of an
+     *            array.
+     * \param index The index of the element, or the position of the member.
+     * \param value The JSON value of this child.
+     */
+    Child(
+            const Children* parent,
+            const char* key,
+            std::size_t index,
+            const Json::Value* value);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether this child is an element of an array rather than
+     *        a member of an object.
+     */
+    bool is_element() const;
+
+    /*!
+     * \brief Returns the name of this member, or null if this child is an
+     *        element of an array.
+     *
+     * The name is owned by the Document's data and remains valid until the
+     * Document is next loaded.
+     */
+    const char* get_key() const;
+
+    /*!
+     * \brief Returns the index of this element within its array, or the
+     *        position of this member within its object.
+     */
+    std::size_t get_index() const;
+
+    /*!
+     * \brief Returns the JSON value of this child.
+     */
+    const Json::Value* get_value() const;
+
+    /*!
+     * \brief Returns the full key of this child, i.e. the key of its parent
+     *        followed by its name (or index).
+     */
+    arc::str::UTF8String get_full_key() const;
+
+    /*!
+     * \brief Retrieves the value of this child using the given Visitor
+     *        object.
+     *
+     * The visitor is passed the value of this child directly, without the
+     * key being looked up again (the full key is built in a buffer owned by
+     * the Children, so a Children object should not be used by multiple
+     * threads at once). If the value is not a valid type for the
+     * visitor, this falls back to retrieving the full key of this child with
+     * Document::get(), which handles falling back to other data and reporting
+     * the error.
+     *
+     * \throws arc::ex::KeyError If the value is not a valid type for the
+     *                           visitor and no other data has a value for the
+     *                           full key.
+     * \throws arc::ex::TypeError If the value is not a valid type for the
+     *                            visitor and neither is the value in any
+     *                            other data.
+     */
+    template <typename VisitorType>
+    VisitorType& get(VisitorType& visitor) const
+    {
+        retrieve(static_cast<VisitorBase*>(&visitor));
+        return visitor;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    const Children* m_parent;
+    const char* m_key;
+    std::size_t m_index;
+    const Json::Value* m_value;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Untemplated implementation of get().
+     */
+    void retrieve(VisitorBase* visitor) const;
+};
+
+/*!
+ * \brief The children of an object or array in a Document, see
+ *        Document::get_children().
+ *
+ * Iterating over the children does not allocate, and each Child refers to
+ * the data of the Document directly, so Children are only valid until the
+ * Document is next loaded. Null values are skipped, since Document::get()
+ * treats them as missing.
+ */
+class Children
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                               PUBLIC CLASSES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Forward iterator over Children.
+     */
+    class const_iterator
+    {
+    public:
+
+        //----------------------------------------------------------------------
+        //                           TYPE DEFINITIONS
+        //----------------------------------------------------------------------
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Child value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Child* pointer;
+        typedef const Child& reference;
+
+        //----------------------------------------------------------------------
+        //                             CONSTRUCTOR
+        //----------------------------------------------------------------------
+
+        const_iterator(
+                const Children* parent,
+                Json::Value::const_iterator position,
+                Json::Value::const_iterator end);
+
+        //----------------------------------------------------------------------
+        //                              OPERATORS
+        //----------------------------------------------------------------------
+
+        const Child& operator*() const;
+
+        const Child* operator->() const;
+
+        const_iterator& operator++();
+
+        const_iterator operator++(int);
+
+        bool operator==(const const_iterator& other) const;
+
+        bool operator!=(const const_iterator& other) const;
+
+    private:
+
+        //----------------------------------------------------------------------
+        //                          PRIVATE ATTRIBUTES
+        //----------------------------------------------------------------------
+
+        const Children* m_parent;
+        Json::Value::const_iterator m_position;
+        Json::Value::const_iterator m_end;
+        /*!
+         * \brief The position of the current child within its container.
+         */
+        std::size_t m_index;
+        /*!
+         * \brief The current child.
+         */
+        Child m_child;
+
+        //----------------------------------------------------------------------
+        //                       PRIVATE MEMBER FUNCTIONS
+        //----------------------------------------------------------------------
+
+        /*!
+         * \brief Advances past any null values and updates the current
+         *        child.
+         */
+        void settle();
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates the children of the given container.
+     *
+     * \param document The Document the container belongs to.
+     * \param key The key of the container.
+     * \param container The object or array, or null if there are no
+     *                  children.
+     */
+    Children(
+            Document* document,
+            const arc::str::UTF8String& key,
+            const Json::Value* container);
+
+    /*!
+     * \brief Copies the children, but not the key buffer.
+     */
+    Children(const Children& other);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the Document these children belong to.
+     */
+    Document* get_document() const;
+
+    /*!
+     * \brief Returns the key of the container of these children.
+     */
+    const arc::str::UTF8String& get_key() const;
+
+    /*!
+     * \brief Returns whether the container of these children is an array.
+     */
+    bool is_array() const;
+
+    /*!
+     * \brief Returns the JSON object or array these are the children of (may
+     *        be null).
+     */
+    const Json::Value* get_container() const;
+
+    /*!
+     * \brief Returns an iterator to the first child.
+     */
+    const_iterator begin() const;
+
+    /*!
+     * \brief Returns an iterator past the last child.
+     */
+    const_iterator end() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    // the child builds its full key with build_key()
+    friend class Child;
+
+    Document* m_document;
+    arc::str::UTF8String m_key;
+    const Json::Value* m_container;
+    /*!
+     * \brief The key followed by a separator, if the key is not empty.
+     */
+    std::string m_prefix;
+    /*!
+     * \brief Reused to build the full keys of children without allocating.
+     */
+    mutable std::string m_buffer;
+    mutable arc::str::UTF8String m_full_key;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Builds the full key of the given child, which remains valid until
+     *        the next call.
+     */
+    const arc::str::UTF8String& build_key(const Child& child) const;
+};
+
+} // namespace metaengine
+
+#endif
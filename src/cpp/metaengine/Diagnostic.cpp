@@ -0,0 +1,456 @@
+#include "metaengine/Diagnostic.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The maximum number of characters of a JSON value that are printed.
+ */
+static std::atomic<std::size_t> g_max_value_length(128);
+
+/*!
+ * \brief Returns the length the string can be cut to without splitting a UTF-8
+ *        sequence, that is no more than the given length.
+ */
+std::size_t utf8_boundary(const char* str, std::size_t length)
+{
+    while(length > 0 &&
+          (static_cast<unsigned char>(str[length]) & 0xC0) == 0x80)
+    {
+        --length;
+    }
+    return length;
+}
+
+/*!
+ * \brief Writes a quoted JSON string to the output, only copying the
+ *        characters that fit within the limit.
+ */
+void write_string(
+        const char* begin,
+        const char* end,
+        std::string& out,
+        std::size_t limit)
+{
+    std::size_t length = static_cast<std::size_t>(end - begin);
+    std::size_t remaining = limit - std::min(limit, out.size());
+    if(length > remaining)
+    {
+        length = utf8_boundary(begin, remaining);
+    }
+    out += Json::valueToQuotedString(std::string(begin, length).c_str());
+}
+
+/*!
+ * \brief Writes the JSON value to the output, stopping once the output has
+ *        reached the limit.
+ */
+void write_bounded(const Json::Value& value, std::string& out, std::size_t limit)
+{
+    if(out.size() >= limit)
+    {
+        return;
+    }
+
+    switch(value.type())
+    {
+        case Json::arrayValue:
+        {
+            out += "[";
+            for(Json::ArrayIndex i = 0;
+                i < value.size() && out.size() < limit;
+                ++i)
+            {
+                if(i != 0)
+                {
+                    out += ",";
+                }
+                write_bounded(value[i], out, limit);
+            }
+            out += "]";
+            break;
+        }
+        case Json::objectValue:
+        {
+            out += "{";
+            Json::Value::const_iterator child;
+            for(child = value.begin();
+                child != value.end() && out.size() < limit;
+                ++child)
+            {
+                if(child != value.begin())
+                {
+                    out += ",";
+                }
+                std::string name(child.name());
+                write_string(
+                    name.c_str(),
+                    name.c_str() + name.size(),
+                    out,
+                    limit
+                );
+                out += ":";
+                write_bounded(*child, out, limit);
+            }
+            out += "}";
+            break;
+        }
+        case Json::stringValue:
+        {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+            value.getString(&begin, &end);
+            write_string(begin, end, out, limit);
+            break;
+        }
+        default:
+        {
+            Json::FastWriter writer;
+            std::string scalar(writer.write(value));
+            // remove the trailing new line
+            if(!scalar.empty() && scalar[scalar.size() - 1] == '\n')
+            {
+                scalar.resize(scalar.size() - 1);
+            }
+            out += scalar;
+            break;
+        }
+    }
+}
+
+/*!
+ * \brief Returns the name of the JSON type of the given value.
+ */
+const char* json_type_name(const Json::Value& value)
+{
+    switch(value.type())
+    {
+        case Json::nullValue:
+            return "null";
+        case Json::intValue:
+        case Json::uintValue:
+            return "integer";
+        case Json::realValue:
+            return "real";
+        case Json::stringValue:
+            return "string";
+        case Json::booleanValue:
+            return "boolean";
+        case Json::arrayValue:
+            return "array";
+        case Json::objectValue:
+            return "object";
+    }
+    return "unknown";
+}
+
+/*!
+ * \brief Returns a description of the given data source.
+ */
+const char* source_name(Statistics::Source source)
+{
+    switch(source)
+    {
+        case Statistics::SOURCE_VARIANT:
+            return "variant data";
+        case Statistics::SOURCE_FILE:
+            return "file data";
+        case Statistics::SOURCE_MEMORY:
+            return "memory data";
+    }
+    return "data";
+}
+
+/*!
+ * \brief Adds the bytes to the FNV-1a hash.
+ */
+inline void hash_bytes(arc::uint64& hash, const void* data, std::size_t size)
+{
+    const unsigned char* c = static_cast<const unsigned char*>(data);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= c[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+/*!
+ * \brief Adds the null terminated string to the FNV-1a hash, including the
+ *        terminator so that adjacent strings can't run into each other.
+ */
+inline void hash_string(arc::uint64& hash, const char* str)
+{
+    hash_bytes(hash, str, std::strlen(str) + 1);
+}
+
+/*!
+ * \brief Adds the part of the JSON value that is printed to the FNV-1a hash,
+ *        without visiting the elements of containers.
+ */
+void hash_value(arc::uint64& hash, const Json::Value& value)
+{
+    Json::ValueType type = value.type();
+    hash_bytes(hash, &type, sizeof(type));
+    switch(type)
+    {
+        case Json::intValue:
+        {
+            Json::LargestInt i = value.asLargestInt();
+            hash_bytes(hash, &i, sizeof(i));
+            break;
+        }
+        case Json::uintValue:
+        {
+            Json::LargestUInt u = value.asLargestUInt();
+            hash_bytes(hash, &u, sizeof(u));
+            break;
+        }
+        case Json::realValue:
+        {
+            double d = value.asDouble();
+            hash_bytes(hash, &d, sizeof(d));
+            break;
+        }
+        case Json::booleanValue:
+        {
+            bool b = value.asBool();
+            hash_bytes(hash, &b, sizeof(b));
+            break;
+        }
+        case Json::stringValue:
+        {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+            value.getString(&begin, &end);
+            std::size_t length = static_cast<std::size_t>(end - begin);
+            hash_bytes(
+                hash,
+                begin,
+                std::min(length, g_max_value_length.load())
+            );
+            break;
+        }
+        case Json::arrayValue:
+        case Json::objectValue:
+        {
+            Json::ArrayIndex size = value.size();
+            hash_bytes(hash, &size, sizeof(size));
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Diagnostic::Diagnostic()
+    :
+    m_key              (nullptr),
+    m_source           (Statistics::SOURCE_FILE),
+    m_expected_type    (nullptr),
+    m_value            (nullptr),
+    m_has_element_index(false),
+    m_element_index    (0),
+    m_proven           (false),
+    m_proven_type      (Schema::TYPE_BOOL)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::size_t Diagnostic::get_max_value_length()
+{
+    return g_max_value_length.load(std::memory_order_relaxed);
+}
+
+void Diagnostic::set_max_value_length(std::size_t length)
+{
+    g_max_value_length.store(length, std::memory_order_relaxed);
+}
+
+arc::str::UTF8String Diagnostic::write_value(const Json::Value& value)
+{
+    std::size_t limit = get_max_value_length();
+
+    std::string out;
+    write_bounded(value, out, limit);
+    if(out.size() > limit)
+    {
+        out.resize(utf8_boundary(out.c_str(), limit));
+        out += "...";
+    }
+    return arc::str::UTF8String(out.c_str());
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Diagnostic::set_type_mismatch(
+        const Json::Value* value,
+        const char* expected_type)
+{
+    m_value             = value;
+    m_expected_type     = expected_type;
+    m_has_element_index = false;
+}
+
+void Diagnostic::set_element_type_mismatch(
+        const Json::Value* value,
+        std::size_t index,
+        const char* expected_type)
+{
+    m_value             = value;
+    m_expected_type     = expected_type;
+    m_has_element_index = true;
+    m_element_index     = index;
+}
+
+void Diagnostic::set_context(
+        const arc::str::UTF8String& key,
+        Statistics::Source source)
+{
+    m_key    = &key;
+    m_source = source;
+}
+
+void Diagnostic::set_proven_type(Schema::Type type)
+{
+    m_proven = true;
+    m_proven_type = type;
+}
+
+bool Diagnostic::is_proven(Schema::Type type) const
+{
+    return m_proven && m_proven_type == type;
+}
+
+bool Diagnostic::is_empty() const
+{
+    return m_value == nullptr && (!m_message || m_message->is_empty());
+}
+
+const arc::str::UTF8String* Diagnostic::get_key() const
+{
+    return m_key;
+}
+
+Statistics::Source Diagnostic::get_source() const
+{
+    return m_source;
+}
+
+const char* Diagnostic::get_expected_type() const
+{
+    return m_expected_type;
+}
+
+const char* Diagnostic::get_actual_type() const
+{
+    if(m_value == nullptr)
+    {
+        return nullptr;
+    }
+    return json_type_name(*m_value);
+}
+
+const Json::Value* Diagnostic::get_value() const
+{
+    return m_value;
+}
+
+bool Diagnostic::has_element_index() const
+{
+    return m_has_element_index;
+}
+
+std::size_t Diagnostic::get_element_index() const
+{
+    return m_element_index;
+}
+
+const arc::str::UTF8String& Diagnostic::get_message() const
+{
+    static const arc::str::UTF8String empty;
+    if(!m_message)
+    {
+        return empty;
+    }
+    return *m_message;
+}
+
+arc::str::UTF8String Diagnostic::format() const
+{
+    arc::str::UTF8String ret;
+    ret << "Failed to retrieve value";
+    if(m_key != nullptr)
+    {
+        ret << " for key \"" << *m_key << "\"";
+    }
+    ret << " from " << source_name(m_source) << " ";
+
+    if(is_empty())
+    {
+        ret << "as the requested type.";
+        return ret;
+    }
+
+    ret << "with message: ";
+    if(m_value != nullptr)
+    {
+        if(m_has_element_index)
+        {
+            ret << "Array element " << m_element_index << ": ";
+        }
+        ret << write_value(*m_value) << " (" << get_actual_type()
+            << ") cannot be converted to " << m_expected_type << " type.";
+        if(!get_message().is_empty())
+        {
+            ret << " ";
+        }
+    }
+    ret << get_message();
+    return ret;
+}
+
+arc::uint64 Diagnostic::hash() const
+{
+    arc::uint64 hash = 14695981039346656037ULL;
+    if(m_key != nullptr)
+    {
+        hash_string(hash, m_key->get_raw());
+    }
+    hash_bytes(hash, &m_source, sizeof(m_source));
+    if(m_value != nullptr)
+    {
+        hash_string(hash, m_expected_type);
+        hash_value(hash, *m_value);
+        if(m_has_element_index)
+        {
+            hash_bytes(hash, &m_element_index, sizeof(m_element_index));
+        }
+    }
+    hash_string(hash, get_message().get_raw());
+    return hash;
+}
+
+} // namespace metaengine
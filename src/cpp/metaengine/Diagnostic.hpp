@@ -0,0 +1,248 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_DIAGNOSTIC_HPP_
+#define METAENGINE_DIAGNOSTIC_HPP_
+
+#include <cstddef>
+#include <memory>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "metaengine/Schema.hpp"
+#include "metaengine/Statistics.hpp"
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+namespace Json
+{
+class Value;
+} // namespace Json
+
+namespace metaengine
+{
+
+/*!
+ * \brief Describes why a Visitor failed to retrieve a value.
+ *
+ * A Diagnostic is passed to Visitor::retrieve() to be filled in if the JSON
+ * value cannot be converted. Rather than formatting a message up front,
+ * Visitors record what went wrong as structured data: the type that was
+ * expected and the offending JSON value. The Document fills in the key and the
+ * source of the data. Nothing is formatted until format() is called, which only
+ * happens if an exception is thrown or a fallback is actually reported, and
+ * printed JSON values are truncated to get_max_value_length() characters.
+ *
+ * \warning A Diagnostic only references the offending JSON value, so it must
+ *          not be formatted after the Document it came from has been
+ *          reloaded or destroyed.
+ *
+ * Visitors that need to describe a failure which isn't a simple type mismatch
+ * can stream an explicit message into the Diagnostic:
+ *
+ * \code
+ * diagnostic << "Value " << value << " is out of range.";
+ * \endcode
+ */
+class Diagnostic
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Diagnostic);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    Diagnostic();
+
+    //--------------------------------------------------------------------------
+    //                                 OPERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Appends the given value to the explicit message of this
+     *        Diagnostic.
+     */
+    template <typename T>
+    Diagnostic& operator<<(const T& value)
+    {
+        if(!m_message)
+        {
+            m_message.reset(new arc::str::UTF8String());
+        }
+        *m_message << value;
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the maximum number of characters of a JSON value that will
+     *        be printed when a Diagnostic is formatted.
+     */
+    static std::size_t get_max_value_length();
+
+    /*!
+     * \brief Sets the maximum number of characters of a JSON value that will
+     *        be printed when a Diagnostic is formatted (defaults to 128).
+     */
+    static void set_max_value_length(std::size_t length);
+
+    /*!
+     * \brief Writes the given JSON value as a compact string, truncated to
+     *        get_max_value_length() characters.
+     *
+     * Only the part of the value that will be printed is visited, so this is
+     * cheap even for very large values.
+     */
+    static arc::str::UTF8String write_value(const Json::Value& value);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Records that the given JSON value could not be converted to the
+     *        expected type.
+     *
+     * \param value The offending value, this is not copied.
+     * \param expected_type Static string naming the expected type, e.g.
+     *                      "integral".
+     */
+    void set_type_mismatch(const Json::Value* value, const char* expected_type);
+
+    /*!
+     * \brief Records that an element of a JSON array could not be converted to
+     *        the expected type.
+     *
+     * \param value The offending element, this is not copied.
+     * \param index The index of the element in the array.
+     * \param expected_type Static string naming the expected type of the
+     *                      element.
+     */
+    void set_element_type_mismatch(
+            const Json::Value* value,
+            std::size_t index,
+            const char* expected_type);
+
+    /*!
+     * \brief Sets the key and data source of the value being retrieved.
+     *
+     * This is called by the Document, the key is not copied.
+     */
+    void set_context(
+            const arc::str::UTF8String& key,
+            Statistics::Source source);
+
+    /*!
+     * \brief Records that the value being retrieved has been proven to match
+     *        the given type by the Document's Schema.
+     *
+     * This is called by the Document.
+     */
+    void set_proven_type(Schema::Type type);
+
+    /*!
+     * \brief Returns whether the value being retrieved has been proven to match
+     *        the given type, in which case a Visitor may convert it without
+     *        checking its type.
+     */
+    bool is_proven(Schema::Type type) const;
+
+    /*!
+     * \brief Returns whether neither a type mismatch nor an explicit message
+     *        has been recorded.
+     */
+    bool is_empty() const;
+
+    /*!
+     * \brief Returns the key of the value being retrieved (may be null).
+     */
+    const arc::str::UTF8String* get_key() const;
+
+    /*!
+     * \brief Returns the source of the data the value was being retrieved
+     *        from.
+     */
+    Statistics::Source get_source() const;
+
+    /*!
+     * \brief Returns the name of the type that was expected, or null if no type
+     *        mismatch was recorded.
+     */
+    const char* get_expected_type() const;
+
+    /*!
+     * \brief Returns the name of the JSON type of the offending value, or null
+     *        if no type mismatch was recorded.
+     */
+    const char* get_actual_type() const;
+
+    /*!
+     * \brief Returns the offending JSON value, or null if no type mismatch was
+     *        recorded.
+     */
+    const Json::Value* get_value() const;
+
+    /*!
+     * \brief Returns whether the offending value is an element of an array.
+     */
+    bool has_element_index() const;
+
+    /*!
+     * \brief Returns the index of the offending element if
+     *        has_element_index() is ```true```.
+     */
+    std::size_t get_element_index() const;
+
+    /*!
+     * \brief Returns the explicit message of this Diagnostic.
+     */
+    const arc::str::UTF8String& get_message() const;
+
+    /*!
+     * \brief Formats this Diagnostic as a human readable message.
+     */
+    arc::str::UTF8String format() const;
+
+    /*!
+     * \brief Returns a hash of the message format() would return, without
+     *        formatting it.
+     *
+     * This is cheap enough to compute on every reported fallback, so is used
+     * to deduplicate events before they are formatted (see AsyncReporter).
+     * The elements of containers are not visited, so Diagnostics of
+     * containers which only differ in their elements hash the same.
+     */
+    arc::uint64 hash() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    const arc::str::UTF8String* m_key;
+    Statistics::Source m_source;
+    const char* m_expected_type;
+    const Json::Value* m_value;
+    bool m_has_element_index;
+    std::size_t m_element_index;
+    bool m_proven;
+    Schema::Type m_proven_type;
+    // only allocated once something is streamed into the Diagnostic, so that
+    // constructing one on every get() is free
+    std::unique_ptr<arc::str::UTF8String> m_message;
+};
+
+} // namespace metaengine
+
+#endif
@@ -1,19 +1,128 @@
 #include "metaengine/Document.hpp"
 
+#include <cstring>
+#include <string>
+#include <thread>
+
 #include <arcanecore/base/Exceptions.hpp>
-#include <arcanecore/io/sys/FileReader.hpp>
 
 #include <json/json.h>
 
+#include "metaengine/Arena.hpp"
+#include "metaengine/AsyncReporter.hpp"
+#include "metaengine/Children.hpp"
+#include "metaengine/FileData.hpp"
+#include "metaengine/KeyPool.hpp"
+#include "metaengine/LoadReport.hpp"
+#include "metaengine/ParseCache.hpp"
+#include "metaengine/Query.hpp"
+#include "metaengine/SectionParser.hpp"
+#include "metaengine/Shards.hpp"
+#include "metaengine/StreamParser.hpp"
+#include "metaengine/visitors/PathCache.hpp"
+
 namespace metaengine
 {
 
+namespace
+{
+
+/*!
+ * \brief Returns whether the two values (which may be null) are equal,
+ *        without comparing subtrees that are shared between them.
+ */
+bool equal_values(const Json::Value* a, const Json::Value* b)
+{
+    // values within shared subtrees are the same
+    if(a == b || (a != nullptr && b != nullptr && a->sharesPayload(*b)))
+    {
+        return true;
+    }
+    if(a == nullptr || b == nullptr || a->type() != b->type())
+    {
+        return false;
+    }
+
+    if(a->isObject())
+    {
+        if(a->size() != b->size())
+        {
+            return false;
+        }
+        for(Json::Value::const_iterator member = a->begin();
+            member != a->end();
+            ++member)
+        {
+            const char* name_end = nullptr;
+            const char* name = member.memberName(&name_end);
+            if(!equal_values(&(*member), b->find(name, name_end)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    if(a->isArray())
+    {
+        if(a->size() != b->size())
+        {
+            return false;
+        }
+        for(Json::ArrayIndex i = 0; i < a->size(); ++i)
+        {
+            if(!equal_values(&(*a)[i], &(*b)[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return *a == *b;
+}
+
+/*!
+ * \brief Visitor that retrieves the object or array children are enumerated
+ *        from, see Document::get_children().
+ */
+class ContainerV : public Visitor<const Json::Value*>
+{
+public:
+
+    ContainerV()
+    {
+        m_value = nullptr;
+    }
+
+    // override
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            Document* requester,
+            Diagnostic& diagnostic)
+    {
+        if(!data->isObject() && !data->isArray())
+        {
+            diagnostic.set_type_mismatch(data, "object or array");
+            return false;
+        }
+        m_value = data;
+        return true;
+    }
+};
+
+} // namespace anonymous
+
 //------------------------------------------------------------------------------
 //                           PRIVATE STATIC ATTRIBUTES
 //------------------------------------------------------------------------------
 
 Document::fallback_reporter Document::s_load_reporter = nullptr;
 Document::fallback_reporter Document::s_get_reporter = nullptr;
+std::atomic<AsyncReporter*> Document::s_async_reporter(nullptr);
+std::atomic<ParseCache*> Document::s_parse_cache(nullptr);
+std::atomic<LoadReport*> Document::s_load_report(nullptr);
+std::atomic<arc::uint64> Document::s_next_version(1);
+thread_local const Document* Document::s_async_loading = nullptr;
 
 //------------------------------------------------------------------------------
 //                                  CONSTRUCTORS
@@ -23,11 +132,19 @@ Document::Document(
         const arc::io::sys::Path& file_path,
         bool load_immediately)
     :
-    m_file_root (nullptr),
-    m_mem_root  (nullptr),
-    m_file_path (file_path),
-    m_using_path(true),
-    m_memory    (nullptr)
+    m_file_root        (nullptr),
+    m_mem_root         (nullptr),
+    m_key_pool         (new KeyPool()),
+    m_file_path        (file_path),
+    m_using_path       (true),
+    m_version          (0),
+    m_memory           (nullptr),
+    m_path_cache       (new PathCache()),
+    m_loading          (false),
+    m_streaming        (false),
+    m_subtree_sharing  (false),
+    m_sharding         (false),
+    m_next_subscription(1)
 {
     if(load_immediately)
     {
@@ -39,10 +156,18 @@ Document::Document(
         const arc::str::UTF8String* memory,
         bool load_immediately)
     :
-    m_file_root (nullptr),
-    m_mem_root  (nullptr),
-    m_using_path(false),
-    m_memory    (memory)
+    m_file_root        (nullptr),
+    m_mem_root         (nullptr),
+    m_key_pool         (new KeyPool()),
+    m_using_path       (false),
+    m_version          (0),
+    m_memory           (memory),
+    m_path_cache       (new PathCache()),
+    m_loading          (false),
+    m_streaming        (false),
+    m_subtree_sharing  (false),
+    m_sharding         (false),
+    m_next_subscription(1)
 {
     if(load_immediately)
     {
@@ -55,11 +180,19 @@ Document::Document(
         const arc::str::UTF8String* memory,
         bool load_immediately)
     :
-    m_file_root (nullptr),
-    m_mem_root  (nullptr),
-    m_file_path (file_path),
-    m_using_path(true),
-    m_memory    (memory)
+    m_file_root        (nullptr),
+    m_mem_root         (nullptr),
+    m_key_pool         (new KeyPool()),
+    m_file_path        (file_path),
+    m_using_path       (true),
+    m_version          (0),
+    m_memory           (memory),
+    m_path_cache       (new PathCache()),
+    m_loading          (false),
+    m_streaming        (false),
+    m_subtree_sharing  (false),
+    m_sharding         (false),
+    m_next_subscription(1)
 {
     if(load_immediately)
     {
@@ -73,6 +206,7 @@ Document::Document(
 
 Document::~Document()
 {
+    wait_for_load();
 }
 
 //------------------------------------------------------------------------------
@@ -89,6 +223,21 @@ void Document::set_get_fallback_reporter(fallback_reporter func)
     s_get_reporter = func;
 }
 
+void Document::set_async_reporter(AsyncReporter* reporter)
+{
+    s_async_reporter.store(reporter, std::memory_order_release);
+}
+
+void Document::set_parse_cache(ParseCache* cache)
+{
+    s_parse_cache.store(cache, std::memory_order_release);
+}
+
+void Document::set_load_report(LoadReport* report)
+{
+    s_load_report.store(report, std::memory_order_release);
+}
+
 //------------------------------------------------------------------------------
 //                            PUBLIC MEMBER FUNCTIONS
 //------------------------------------------------------------------------------
@@ -105,41 +254,264 @@ bool Document::is_using_memory() const
 
 bool Document::has_valid_file_data() const
 {
+    wait_for_load();
     return m_file_root != nullptr;
 }
 
 bool Document::has_valid_memory_data() const
 {
+    wait_for_load();
     return m_mem_root != nullptr;
 }
 
+arc::uint64 Document::get_version() const
+{
+    wait_for_load();
+    return m_version.load(std::memory_order_relaxed);
+}
+
+void Document::set_statistics_enabled(bool enabled)
+{
+    if(!enabled)
+    {
+        m_statistics.reset();
+    }
+    else if(!m_statistics)
+    {
+        m_statistics.reset(new Statistics());
+    }
+}
+
+Statistics* Document::get_statistics() const
+{
+    return m_statistics.get();
+}
+
+const KeyPool& Document::get_key_pool() const
+{
+    return *m_key_pool;
+}
+
+const LoadTimings& Document::get_load_timings() const
+{
+    wait_for_load();
+    return m_load_timings;
+}
+
+void Document::set_streaming(bool streaming)
+{
+    wait_for_load();
+    m_streaming = streaming;
+}
+
+bool Document::is_streaming() const
+{
+    return m_streaming;
+}
+
+void Document::set_projection(const std::vector<arc::str::UTF8String>& keys)
+{
+    wait_for_load();
+    m_projection = keys;
+}
+
+const std::vector<arc::str::UTF8String>& Document::get_projection() const
+{
+    return m_projection;
+}
+
+void Document::set_subtree_sharing_enabled(bool enabled)
+{
+    wait_for_load();
+    m_subtree_sharing = enabled;
+}
+
+bool Document::is_subtree_sharing_enabled() const
+{
+    return m_subtree_sharing;
+}
+
+void Document::set_sharding_enabled(bool enabled)
+{
+    wait_for_load();
+    m_sharding = enabled;
+}
+
+bool Document::is_sharding_enabled() const
+{
+    return m_sharding;
+}
+
+void Document::set_schema(std::shared_ptr<const Schema> schema)
+{
+    wait_for_load();
+    m_schema = schema;
+}
+
+const std::shared_ptr<const Schema>& Document::get_schema() const
+{
+    return m_schema;
+}
+
 void Document::reload()
 {
+    wait_for_load();
+
+    // the previous data is only kept if there is anything to compare it for
+    std::vector<std::shared_ptr<const ArenaTree>> previous;
+    if(has_subscriptions())
+    {
+        get_trees(previous);
+    }
+    timed_load();
+    notify_subscribers(previous);
+}
+
+std::shared_future<void> Document::load_async()
+{
+    // only one load may be in progress at a time
+    wait_for_load();
+
+    std::vector<std::shared_ptr<const ArenaTree>> previous;
+    if(has_subscriptions())
+    {
+        get_trees(previous);
+    }
+
+    std::packaged_task<void()> task([this, previous]()
+    {
+        // the load is in progress until the callbacks have returned, so that
+        // this Document can't be modified or destroyed while they run, but the
+        // callbacks may access the new data without waiting for the load
+        s_async_loading = this;
+        try
+        {
+            timed_load();
+            notify_subscribers(previous);
+        }
+        catch(...)
+        {
+            s_async_loading = nullptr;
+            m_loading.store(false, std::memory_order_release);
+            throw;
+        }
+        s_async_loading = nullptr;
+        m_loading.store(false, std::memory_order_release);
+    });
+
+    // the future must be assigned before any other thread can observe that
+    // a load is in progress
+    m_pending = task.get_future().share();
+    m_loading.store(true, std::memory_order_release);
+    std::thread(std::move(task)).detach();
+    return m_pending;
+}
+
+bool Document::is_loading() const
+{
+    return m_loading.load(std::memory_order_acquire);
+}
+
+arc::uint64 Document::subscribe(
+        const arc::str::UTF8String& key,
+        change_callback callback)
+{
+    wait_for_load();
+
+    Subscription subscription;
+    subscription.id = m_next_subscription++;
+    subscription.key = key;
+    subscription.callback = callback;
+    m_subscriptions.push_back(subscription);
+    return subscription.id;
+}
+
+void Document::unsubscribe(arc::uint64 id)
+{
+    wait_for_load();
+
+    for(std::size_t i = 0; i < m_subscriptions.size(); ++i)
+    {
+        if(m_subscriptions[i].id == id)
+        {
+            m_subscriptions.erase(m_subscriptions.begin() + i);
+            return;
+        }
+    }
+}
+
+Children Document::get_children(const arc::str::UTF8String& key)
+{
+    // the root of the data is the root of the first tree it is retrieved from
+    if(key.is_empty())
+    {
+        wait_for_load();
+        std::vector<std::shared_ptr<const ArenaTree>> trees;
+        get_trees(trees);
+        ARC_CONST_FOR_EACH(tree, trees)
+        {
+            if(*tree != nullptr)
+            {
+                return Children(this, key, get_tree_root(**tree, key));
+            }
+        }
+        return Children(this, key, nullptr);
+    }
+
+    ContainerV visitor;
+    get(key, visitor);
+    return Children(this, key, *visitor);
+}
+
+//------------------------------------------------------------------------------
+//                           PROTECTED MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Document::load()
+{
+    // keep the existing data until the new data has been parsed if its
+    // subtrees may be shared
+    std::shared_ptr<const ArenaTree> previous_file;
+    std::shared_ptr<const ArenaTree> previous_mem;
+    if(m_subtree_sharing)
+    {
+        previous_file = m_file_root;
+        previous_mem = m_mem_root;
+    }
+
     // clean up any existing data
+    m_proven.clear();
     m_file_root.reset();
     m_mem_root.reset();
+    new_version();
 
     // load file system data
     if(m_using_path)
     {
-        // construct an optimised string to contain the file data
-        arc::str::UTF8String file_data(
-            arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+        // construct an optimised string to contain the file data, which is
+        // kept alive by sharded data
+        std::shared_ptr<arc::str::UTF8String> file_data(
+            new arc::str::UTF8String(
+                arc::str::UTF8String::Opt::SKIP_VALID_CHECK));
+        // or the chunks of the file when streaming
+        std::unique_ptr<FileChunks> chunks;
 
         // attempt to read data from the file
         bool read_success = false;
         try
         {
-            // open the reader
-            arc::io::sys::FileReader json_file(
-                m_file_path,
-                arc::io::sys::FileReader::ENCODING_DETECT,
-                arc::io::sys::FileReader::NEWLINE_UNIX
-            );
-            // read
-            json_file.read(file_data);
-            // close
-            json_file.close();
+            LoadTimings::Scope timing(
+                m_load_timings.phases[LoadTimings::PHASE_READ]);
+            if(m_streaming)
+            {
+                // the file is read as it is parsed
+                chunks.reset(new FileChunks(m_file_path));
+            }
+            else
+            {
+                FileData::read(m_file_path, *file_data);
+                timing.add_bytes(file_data->get_byte_length() - 1);
+            }
             read_success = true;
         }
         catch(const arc::ex::ArcException& exc)
@@ -152,14 +524,17 @@ void Document::reload()
                 error_message << exc.get_message();
                 throw arc::ex::IOError(error_message);
             }
-            else if(s_load_reporter != nullptr)
+            else
             {
                 // trigger a warning, and prepare to fallback
-                arc::str::UTF8String error_message;
-                error_message << "Falling back to loading data from memory "
-                              << "only. " << exc.get_type() << ": "
-                              << exc.get_message();
-                s_load_reporter(m_file_path, error_message);
+                report_fallback(
+                    FallbackEvent::TYPE_LOAD,
+                    m_file_path,
+                    "",
+                    "Falling back to loading data from memory only.",
+                    exc.get_type(),
+                    exc.get_message()
+                );
             }
         }
 
@@ -168,7 +543,38 @@ void Document::reload()
         {
             try
             {
-                parse(file_data, m_file_root);
+                if(chunks != nullptr)
+                {
+                    stream_parse(
+                        *chunks,
+                        m_file_path,
+                        m_file_root,
+                        LoadTimings::PHASE_READ,
+                        LoadTimings::PHASE_PARSE
+                    );
+                }
+                else
+                {
+                    LoadTimings::Scope timing(
+                        m_load_timings.phases[LoadTimings::PHASE_PARSE]);
+                    timing.add_bytes(file_data->get_byte_length() - 1);
+                    // only the structure of sharded data is scanned now,
+                    // falling through to parsing the data as a whole if it is
+                    // not an object
+                    if(m_sharding && m_projection.empty())
+                    {
+                        m_file_root = build_shards(file_data);
+                    }
+                    if(m_file_root == nullptr)
+                    {
+                        parse(
+                            *file_data,
+                            m_file_root,
+                            ParseCache::file_source(m_file_path),
+                            previous_file
+                        );
+                    }
+                }
             }
             catch(const arc::ex::ParseError& exc)
             {
@@ -180,14 +586,18 @@ void Document::reload()
                                   << "with message:\n" << exc.what();
                     throw arc::ex::ParseError(error_message);
                 }
-                else if(s_load_reporter != nullptr)
+                else
                 {
                     // trigger a warning, and prepare to fallback
-                    arc::str::UTF8String error_message;
-                    error_message << "Falling back to loading data from memory "
-                                  << "only. Failed to parse JSON data from "
-                                  << "file with message:\n" << exc.what();
-                    s_load_reporter(m_file_path, error_message);
+                    report_fallback(
+                        FallbackEvent::TYPE_LOAD,
+                        m_file_path,
+                        "",
+                        "Falling back to loading data from memory only. "
+                        "Failed to parse JSON data from file with",
+                        exc.get_type(),
+                        exc.what()
+                    );
                 }
             }
         }
@@ -198,7 +608,15 @@ void Document::reload()
     {
         try
         {
-            parse(*m_memory, m_mem_root);
+            LoadTimings::Scope timing(
+                m_load_timings.phases[LoadTimings::PHASE_MEMORY_PARSE]);
+            timing.add_bytes(m_memory->get_byte_length() - 1);
+            parse(
+                *m_memory,
+                m_mem_root,
+                ParseCache::memory_source(m_memory),
+                previous_mem
+            );
         }
         catch(const arc::ex::ParseError& exc)
         {
@@ -211,52 +629,435 @@ void Document::reload()
                               << "> with message:\n" << exc.what();
                 throw arc::ex::ParseError(error_message);
             }
-            else if(s_load_reporter != nullptr)
+            else
             {
                 // trigger a warning
-                arc::str::UTF8String error_message;
-                error_message << "Fallback to memory not available, Memory "
-                              << "data failed to load with " << exc.get_type()
-                              << ": " << exc.what();
-                s_load_reporter(m_file_path, error_message);
+                report_fallback(
+                    FallbackEvent::TYPE_LOAD,
+                    m_file_path,
+                    "",
+                    "Fallback to memory not available, Memory data failed to "
+                    "load with",
+                    exc.get_type(),
+                    exc.what()
+                );
             }
 
         }
     }
+
+    validate();
 }
 
-//------------------------------------------------------------------------------
-//                            PRIVATE MEMBER FUNCTIONS
-//------------------------------------------------------------------------------
+void Document::validate()
+{
+    if(m_schema == nullptr)
+    {
+        return;
+    }
+    LoadTimings::Scope timing(
+        m_load_timings.phases[LoadTimings::PHASE_VALIDATE]);
+
+    ARC_CONST_FOR_EACH(entry, m_schema->get_entries())
+    {
+        Proven proven;
+        proven.data = nullptr;
+        proven.source = Statistics::SOURCE_FILE;
+        proven.type = entry->type;
+
+        if(m_file_root != nullptr)
+        {
+            Diagnostic diagnostic;
+            proven.data = find_value(
+                get_tree_root(*m_file_root, entry->key),
+                entry->key
+            );
+            if(proven.data != nullptr &&
+               Schema::matches(entry->type, *proven.data, diagnostic))
+            {
+                m_proven[entry->key] = proven;
+                continue;
+            }
+
+            // without a fallback get() raises the error
+            if(m_mem_root == nullptr)
+            {
+                continue;
+            }
+            // report the fallback once now rather than on each get
+            if(is_reporting(FallbackEvent::TYPE_LOAD))
+            {
+                arc::str::UTF8String error_type("TypeError");
+                arc::str::UTF8String details;
+                if(proven.data == nullptr)
+                {
+                    error_type = "KeyError";
+                    details << "No value exists with the key \""
+                            << entry->key << "\".";
+                }
+                else
+                {
+                    diagnostic.set_context(entry->key, Statistics::SOURCE_FILE);
+                    details = diagnostic.format();
+                }
+                report_fallback(
+                    FallbackEvent::TYPE_LOAD,
+                    m_file_path,
+                    entry->key,
+                    "Schema validation failed, falling back to retrieving "
+                    "value from memory.",
+                    error_type,
+                    details
+                );
+            }
+        }
+
+        if(m_mem_root != nullptr)
+        {
+            Diagnostic diagnostic;
+            proven.data = find_value(m_mem_root->get_root(), entry->key);
+            proven.source = Statistics::SOURCE_MEMORY;
+            if(proven.data != nullptr &&
+               Schema::matches(entry->type, *proven.data, diagnostic))
+            {
+                m_proven[entry->key] = proven;
+            }
+        }
+    }
+}
+
+bool Document::is_reporting(FallbackEvent::Type type)
+{
+    if(s_async_reporter.load(std::memory_order_acquire) != nullptr)
+    {
+        return true;
+    }
+    if(type == FallbackEvent::TYPE_LOAD)
+    {
+        return s_load_reporter != nullptr;
+    }
+    return s_get_reporter != nullptr;
+}
+
+void Document::report_fallback(
+        FallbackEvent::Type type,
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        const arc::str::UTF8String& details,
+        const arc::str::UTF8String& variant)
+{
+    AsyncReporter* async_reporter =
+        s_async_reporter.load(std::memory_order_acquire);
+    if(async_reporter != nullptr)
+    {
+        // only built into an event if it is not suppressed
+        async_reporter->push(
+            type,
+            file_path,
+            key,
+            description,
+            error_type,
+            details,
+            variant
+        );
+        return;
+    }
+
+    fallback_reporter func = s_get_reporter;
+    if(type == FallbackEvent::TYPE_LOAD)
+    {
+        func = s_load_reporter;
+    }
+    if(func != nullptr)
+    {
+        FallbackEvent event(
+            type,
+            file_path,
+            key,
+            description,
+            error_type,
+            details,
+            variant
+        );
+        func(file_path, event.format());
+    }
+}
+
+void Document::report_fallback(
+        FallbackEvent::Type type,
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& key,
+        const char* description,
+        const arc::str::UTF8String& error_type,
+        const Diagnostic& diagnostic)
+{
+    AsyncReporter* async_reporter =
+        s_async_reporter.load(std::memory_order_acquire);
+    if(async_reporter != nullptr)
+    {
+        async_reporter->push(
+            type,
+            file_path,
+            key,
+            description,
+            error_type,
+            diagnostic
+        );
+        return;
+    }
+
+    report_fallback(
+        type,
+        file_path,
+        key,
+        description,
+        error_type,
+        diagnostic.format()
+    );
+}
+
+void Document::new_version()
+{
+    m_version.store(s_next_version++, std::memory_order_relaxed);
+}
+
+bool Document::has_subscriptions() const
+{
+    return !m_subscriptions.empty();
+}
+
+void Document::get_trees(
+        std::vector<std::shared_ptr<const ArenaTree>>& trees) const
+{
+    trees.push_back(m_file_root);
+    trees.push_back(m_mem_root);
+}
+
+void Document::notify_subscribers(
+        const std::vector<std::shared_ptr<const ArenaTree>>& previous)
+{
+    if(previous.empty() || m_subscriptions.empty())
+    {
+        return;
+    }
+
+    std::vector<std::shared_ptr<const ArenaTree>> current;
+    get_trees(current);
+    // trees are only added or removed at the front, so the shorter list is
+    // aligned with the longer list by treating its missing trees as null
+    std::vector<std::shared_ptr<const ArenaTree>> aligned(previous);
+    if(aligned.size() < current.size())
+    {
+        aligned.insert(
+            aligned.begin(),
+            current.size() - aligned.size(),
+            nullptr
+        );
+    }
+    else if(current.size() < aligned.size())
+    {
+        current.insert(
+            current.begin(),
+            aligned.size() - current.size(),
+            nullptr
+        );
+    }
+
+    // find every subscription whose value changed in any of the trees before
+    // calling any callbacks, since callbacks may change the subscriptions
+    std::vector<Subscription> changed;
+    ARC_CONST_FOR_EACH(subscription, m_subscriptions)
+    {
+        for(std::size_t i = 0; i < current.size(); ++i)
+        {
+            if(current[i] == aligned[i])
+            {
+                continue;
+            }
+
+            const Json::Value* before = nullptr;
+            if(aligned[i] != nullptr)
+            {
+                before = get_tree_root(*aligned[i], subscription->key);
+                if(!subscription->key.is_empty())
+                {
+                    before = find_value(before, subscription->key);
+                }
+            }
+            const Json::Value* after = nullptr;
+            if(current[i] != nullptr)
+            {
+                after = get_tree_root(*current[i], subscription->key);
+                if(!subscription->key.is_empty())
+                {
+                    after = find_value(after, subscription->key);
+                }
+            }
+
+            if(!equal_values(before, after))
+            {
+                changed.push_back(*subscription);
+                break;
+            }
+        }
+    }
+
+    ARC_CONST_FOR_EACH(subscription, changed)
+    {
+        subscription->callback(subscription->key);
+    }
+}
+
+void Document::wait_for_load() const
+{
+    if(s_async_loading != this && m_loading.load(std::memory_order_acquire))
+    {
+        m_pending.wait();
+    }
+}
+
+std::size_t Document::run_query(
+        const Query& query,
+        VisitorBase* visitor,
+        const query_callback& callback)
+{
+    const Json::Value* root = nullptr;
+    try
+    {
+        root = get_children(query.get_prefix()).get_container();
+    }
+    catch(const arc::ex::KeyError&)
+    {
+        return 0;
+    }
+    catch(const arc::ex::TypeError&)
+    {
+        return 0;
+    }
+
+    // the keys of matches are built from parts that are already valid, so are
+    // assigned without being checked again
+    const arc::str::UTF8String& prefix = query.get_prefix();
+    std::string root_key(prefix.get_raw(), prefix.get_byte_length() - 1);
+    arc::str::UTF8String full_key(arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+    return query.match(
+        root,
+        root_key,
+        [&](const Json::Value* value, const std::string& key)
+        {
+            full_key.assign(key.data(), key.size());
+
+            // attempt to use the value directly
+            bool retrieve_success = false;
+            Diagnostic diagnostic;
+            try
+            {
+                retrieve_success =
+                    visitor->retrieve(value, full_key, this, diagnostic);
+            }
+            catch(...)
+            {
+                retrieve_success = false;
+            }
+            if(!retrieve_success)
+            {
+                get(arc::str::UTF8String(full_key), visitor);
+            }
+            callback(full_key);
+        }
+    );
+}
+
+VisitorBase* Document::instrumented_get(
+        const arc::str::UTF8String& key,
+        VisitorBase* visitor)
+{
+    wait_for_load();
+
+    if(m_statistics == nullptr)
+    {
+        return get(key, visitor);
+    }
+
+    Statistics::Scope scope(*m_statistics, key);
+    return get(key, visitor);
+}
 
 VisitorBase* Document::get(
         const arc::str::UTF8String& key,
         VisitorBase* visitor)
 {
+    // the values of keys proven by the schema were resolved during the load
+    if(!m_proven.empty())
+    {
+        std::map<arc::str::UTF8String, Proven>::const_iterator proven =
+            m_proven.find(key);
+        if(proven != m_proven.end())
+        {
+            bool retrieve_success = false;
+            Diagnostic diagnostic;
+            diagnostic.set_proven_type(proven->second.type);
+            try
+            {
+                retrieve_success = visitor->retrieve(
+                    proven->second.data,
+                    key,
+                    this,
+                    diagnostic
+                );
+            }
+            catch(...)
+            {
+                retrieve_success = false;
+            }
+            if(retrieve_success)
+            {
+                if(m_statistics != nullptr)
+                {
+                    m_statistics->record_hit(proven->second.source);
+                }
+                return visitor;
+            }
+            // the visitor expects another type, so the key is retrieved as if
+            // it were not in the schema
+        }
+    }
+
     // attempt to retrieve the data from the file system
     const Json::Value* data = nullptr;
     if(m_file_root != nullptr)
     {
         try
         {
-            data = get_value(m_file_root.get(), key);
+            data = get_value(get_tree_root(*m_file_root, key), key);
         }
         catch(const arc::ex::KeyError& exc)
         {
             // rethrow if there's no memory fallback
             if(m_mem_root == nullptr)
             {
+                if(m_statistics != nullptr)
+                {
+                    m_statistics->record_key_error();
+                }
                 throw exc;
             }
-            else if(s_get_reporter != nullptr)
+
+            if(m_statistics != nullptr)
             {
-                // trigger a warning and prepare to fallback
-                arc::str::UTF8String error_message;
-                error_message << "Falling back to retrieving value from "
-                              << "memory. " << exc.get_type() << ": "
-                              << exc.get_message();
-                s_get_reporter(m_file_path, error_message);
+                m_statistics->record_fallback();
             }
+            // trigger a warning and prepare to fallback
+            report_fallback(
+                FallbackEvent::TYPE_GET,
+                m_file_path,
+                key,
+                "Falling back to retrieving value from memory.",
+                exc.get_type(),
+                exc.get_message()
+            );
         }
     }
 
@@ -266,17 +1067,17 @@ VisitorBase* Document::get(
 VisitorBase* Document::get(
         const Json::Value* data,
         const arc::str::UTF8String& key,
-        VisitorBase* visitor)
+        VisitorBase* visitor,
+        Statistics::Source source)
 {
     // attempt to retrieve from the provided data first
     if(data != nullptr)
     {
         bool retrieve_success = false;
-        arc::str::UTF8String retrieve_error;
+        Diagnostic diagnostic;
         try
         {
-            retrieve_success =
-                visitor->retrieve(data, key, this, retrieve_error);
+            retrieve_success = visitor->retrieve(data, key, this, diagnostic);
         }
         catch(...)
         {
@@ -286,35 +1087,41 @@ VisitorBase* Document::get(
         // if everything was successful we're done
         if(retrieve_success)
         {
+            if(m_statistics != nullptr)
+            {
+                m_statistics->record_hit(source);
+            }
             return visitor;
         }
 
-        // begin building the error message
-        arc::str::UTF8String error_message;
-        error_message << "Failed to retrieve value for key \"" << key
-                      << "\" ";
-        // was there an explicit message from the Visitor?
-        if(!retrieve_error.is_empty())
-        {
-            error_message << "with message: " << retrieve_error;
-        }
-        else
+        if(m_statistics != nullptr)
         {
-            error_message << "as the requested type.";
+            m_statistics->record_type_error();
         }
+        diagnostic.set_context(key, source);
 
         // throw if there's no memory fallback
         if(m_mem_root == nullptr)
         {
-            throw arc::ex::TypeError(error_message);
+            throw arc::ex::TypeError(diagnostic.format());
         }
-        else if(s_get_reporter != nullptr)
+
+        if(m_statistics != nullptr)
         {
-            // trigger a warning and prepare to fallback
-            arc::str::UTF8String report_message;
-            report_message << "Falling back to retrieving value from "
-                           << "memory. " << error_message;
-            s_get_reporter(m_file_path, report_message);
+            m_statistics->record_fallback();
+        }
+        // trigger a warning and prepare to fallback (the diagnostic is only
+        // formatted if something is listening and it is not a duplicate)
+        if(is_reporting(FallbackEvent::TYPE_GET))
+        {
+            report_fallback(
+                FallbackEvent::TYPE_GET,
+                m_file_path,
+                key,
+                "Falling back to retrieving value from memory.",
+                "TypeError",
+                diagnostic
+            );
         }
     }
 
@@ -324,18 +1131,28 @@ VisitorBase* Document::get(
         const Json::Value* data = nullptr;
         // attempt to get the data from the JSON root, if this fails we
         // just let it throw out of this function
-        data = get_value(m_mem_root.get(), key);
+        try
+        {
+            data = get_value(m_mem_root->get_root(), key);
+        }
+        catch(const arc::ex::KeyError&)
+        {
+            if(m_statistics != nullptr)
+            {
+                m_statistics->record_key_error();
+            }
+            throw;
+        }
         // if the above function didn't throw, the data should never be
         // null
         assert(data != nullptr);
 
         // hand off to the visitor
         bool retrieve_success = false;
-        arc::str::UTF8String retrieve_error;
+        Diagnostic diagnostic;
         try
         {
-            retrieve_success =
-                visitor->retrieve(data, key, this, retrieve_error);
+            retrieve_success = visitor->retrieve(data, key, this, diagnostic);
         }
         catch(...)
         {
@@ -345,22 +1162,21 @@ VisitorBase* Document::get(
         // if everything was successful we're done
         if(retrieve_success)
         {
+            if(m_statistics != nullptr)
+            {
+                m_statistics->record_hit(Statistics::SOURCE_MEMORY);
+            }
             return visitor;
         }
 
-        // throw
-        arc::str::UTF8String error_message;
-        error_message << "Failed to retrieve value for key: \""
-                      << key << "\" ";
-        if(!retrieve_error.is_empty())
-        {
-            error_message << "with error: " << retrieve_error;
-        }
-        else
+        if(m_statistics != nullptr)
         {
-            error_message << "as the requested type.";
+            m_statistics->record_type_error();
         }
-        throw arc::ex::TypeError(error_message);
+
+        // throw
+        diagnostic.set_context(key, Statistics::SOURCE_MEMORY);
+        throw arc::ex::TypeError(diagnostic.format());
 
     }
 
@@ -369,53 +1185,343 @@ VisitorBase* Document::get(
 
 void Document::parse(
         const arc::str::UTF8String& json_data,
-        std::unique_ptr<Json::Value>& value)
+        std::shared_ptr<const ArenaTree>& tree,
+        const arc::str::UTF8String& source,
+        const std::shared_ptr<const ArenaTree>& previous)
 {
-    // create new JSON value
-    value.reset(new Json::Value());
+    // projected data is built by a TreeBuilder, and is not shared
+    if(!m_projection.empty())
+    {
+        tree.reset();
+        std::shared_ptr<ArenaTree> parsed(new ArenaTree(0, m_key_pool));
+        {
+            Json::MemoryResource::Scope scope(&parsed->get_arena());
+            Json::KeyInterner::Scope key_scope(m_key_pool.get());
+            TreeBuilder builder(*parsed->get_root(), m_projection);
+            StreamParser parser(builder);
+            parser.feed(json_data.get_raw(), json_data.get_byte_length() - 1);
+            parser.finish();
+        }
+        tree = parsed;
+        return;
+    }
 
-    // parse JSON
+    // has the same data already been parsed from the source?
+    ParseCache* cache = nullptr;
+    if(!source.is_empty())
+    {
+        cache = s_parse_cache.load(std::memory_order_acquire);
+    }
+    if(cache != nullptr)
+    {
+        tree = cache->find(source, json_data);
+        if(tree != nullptr)
+        {
+            return;
+        }
+    }
+
+    // share the unchanged sections of the previous tree, this falls through
+    // to parsing the data as a whole if it has no sections or is invalid
+    if(m_subtree_sharing)
+    {
+        SectionParser section_parser(m_key_pool);
+        section_parser.add_previous(previous);
+        tree = section_parser.parse(
+            json_data.get_raw(),
+            json_data.get_raw() + (json_data.get_byte_length() - 1)
+        );
+        if(tree != nullptr)
+        {
+            if(cache != nullptr)
+            {
+                cache->insert(source, json_data, tree);
+            }
+            return;
+        }
+    }
+
+    // create a new tree, sized from the data
+    std::shared_ptr<ArenaTree> parsed(
+        new ArenaTree(json_data.get_byte_length(), m_key_pool));
+
+    // parse JSON, allocating the values from the tree's arena and sharing keys
+    // with the other trees of this Document
     Json::Reader reader;
-    bool parse_sucess = reader.parse(
-        json_data.get_raw(),
-        json_data.get_raw() + (json_data.get_byte_length() - 1),
-        *value
-    );
+    bool parse_sucess = false;
+    {
+        Json::MemoryResource::Scope scope(&parsed->get_arena());
+        Json::KeyInterner::Scope key_scope(m_key_pool.get());
+        parse_sucess = reader.parse(
+            json_data.get_raw(),
+            json_data.get_raw() + (json_data.get_byte_length() - 1),
+            *parsed->get_root()
+        );
+    }
 
     // if parsing failed, clean up and throw
     if(!parse_sucess)
     {
-        value.reset();
+        tree.reset();
         throw arc::ex::ParseError(reader.getFormattedErrorMessages().c_str());
     }
+
+    // the tree is immutable from here on so may be shared
+    tree = parsed;
+    if(cache != nullptr)
+    {
+        cache->insert(source, json_data, tree);
+    }
+}
+
+void Document::stream_parse(
+        FileChunks& chunks,
+        const arc::io::sys::Path& file_path,
+        std::shared_ptr<const ArenaTree>& tree,
+        LoadTimings::Phase read_phase,
+        LoadTimings::Phase parse_phase)
+{
+    LoadTimings::Timing& read_timing = m_load_timings.phases[read_phase];
+    LoadTimings::Timing& parse_timing = m_load_timings.phases[parse_phase];
+
+    tree.reset();
+    // size the tree from the file, unless only part of it will be kept
+    std::shared_ptr<ArenaTree> parsed(new ArenaTree(
+        m_projection.empty() ? chunks.get_size() : 0,
+        m_key_pool
+    ));
+    try
+    {
+        Json::MemoryResource::Scope scope(&parsed->get_arena());
+        Json::KeyInterner::Scope key_scope(m_key_pool.get());
+        TreeBuilder builder(*parsed->get_root(), m_projection);
+        StreamParser parser(builder);
+
+        const char* data = nullptr;
+        std::size_t length = 0;
+        while(!parser.is_complete())
+        {
+            {
+                LoadTimings::Scope timing(read_timing);
+                if(!chunks.next(data, length))
+                {
+                    break;
+                }
+                timing.add_bytes(length);
+            }
+            LoadTimings::Scope timing(parse_timing);
+            timing.add_bytes(length);
+            parser.feed(data, length);
+        }
+        LoadTimings::Scope timing(parse_timing);
+        parser.finish();
+    }
+    catch(const arc::ex::ParseError&)
+    {
+        // if the file is not plain UTF-8 it may parse once it has been
+        // decoded, otherwise the error stands
+        arc::str::UTF8String file_data(
+            arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+        bool plain = true;
+        try
+        {
+            LoadTimings::Scope timing(read_timing);
+            plain = FileData::read(file_path, file_data);
+            timing.add_bytes(file_data.get_byte_length() - 1);
+        }
+        catch(const arc::ex::IOError&)
+        {
+        }
+        if(plain)
+        {
+            throw;
+        }
+
+        LoadTimings::Scope timing(parse_timing);
+        timing.add_bytes(file_data.get_byte_length() - 1);
+        parse(file_data, tree, ParseCache::file_source(file_path));
+        return;
+    }
+
+    tree = parsed;
 }
 
 const Json::Value* Document::get_value(
     const Json::Value* root,
     const arc::str::UTF8String& key) const
 {
-    // the value to be returned
+    std::size_t failed_at = 0;
+    const Json::Value* value = find_value(root, key, &failed_at);
+    if(value == nullptr)
+    {
+        std::string key_so_far(key.get_raw(), failed_at);
+        arc::str::UTF8String error_message;
+        error_message << "No value exists with the key \""
+                      << key_so_far.c_str() << "\".";
+        throw arc::ex::KeyError(error_message);
+    }
+
+    return value;
+}
+
+const Json::Value* Document::find_resolved(
+        const arc::str::UTF8String& key) const
+{
+    if(m_file_root != nullptr)
+    {
+        const Json::Value* data =
+            find_value(get_tree_root(*m_file_root, key), key);
+        if(data != nullptr)
+        {
+            return data;
+        }
+    }
+    if(m_mem_root != nullptr)
+    {
+        return find_value(m_mem_root->get_root(), key);
+    }
+    return nullptr;
+}
+
+const Json::Value* Document::get_tree_root(
+        const ArenaTree& tree,
+        const arc::str::UTF8String& key) const
+{
+    Shards* shards = tree.get_shards();
+    if(shards == nullptr)
+    {
+        return tree.get_root();
+    }
+
+    // only the shard of the first element of the key is needed
+    if(key.is_empty())
+    {
+        shards->load_all();
+        return tree.get_root();
+    }
+    const char* name = key.get_raw();
+    const char* name_end = std::strchr(name, '.');
+    if(name_end == nullptr)
+    {
+        name_end = name + std::strlen(name);
+    }
+    const Json::Value* member = tree.get_root()->find(name, name_end);
+    if(member != nullptr)
+    {
+        shards->load(member);
+    }
+    return tree.get_root();
+}
+
+const Json::Value* Document::find_value(
+    const Json::Value* root,
+    const arc::str::UTF8String& key,
+    std::size_t* failed_at) const
+{
+    // walk the hierarchy of the key in place rather than splitting it
     const Json::Value* value = root;
-    // split the hierarchy of the key
-    std::vector<arc::str::UTF8String> key_elements(key.split("."));
-    arc::str::UTF8String key_so_far;
-    ARC_CONST_FOR_EACH(it, key_elements)
-    {
-        key_so_far += *it;
-        // get the value associated with this key in the hierarchy
-        value = &(*value)[it->get_raw()];
+    const char* key_begin = key.get_raw();
+    const char* element = key_begin;
+    while(true)
+    {
+        const char* element_end = std::strchr(element, '.');
+        if(element_end == nullptr)
+        {
+            element_end = element + std::strlen(element);
+        }
+
+        // get the value associated with this element in the hierarchy, the
+        // elements of arrays are addressed by their index which is read in
+        // place so no other element is touched
+        const Json::Value* child = nullptr;
+        Json::ArrayIndex index = 0;
+        if(value->isObject())
+        {
+            child = value->find(element, element_end);
+        }
+        else if(value->isArray() &&
+                Query::parse_index(element, element_end, index) &&
+                index < value->size())
+        {
+            child = &(*value)[index];
+        }
         // did we get back a valid value?
-        if(value->isNull())
+        if(child == nullptr || child->isNull())
         {
-            arc::str::UTF8String error_message;
-            error_message << "No value exists with the key \"" << key_so_far
-                          << "\".";
-            throw arc::ex::KeyError(error_message);
+            if(failed_at != nullptr)
+            {
+                *failed_at = static_cast<std::size_t>(element_end - key_begin);
+            }
+            return nullptr;
+        }
+        value = child;
+
+        if(*element_end == '\0')
+        {
+            return value;
         }
-        key_so_far += ".";
+        element = element_end + 1;
     }
+}
 
-    return value;
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+PathCache& Document::get_path_cache()
+{
+    // the cache is created with the Document so that concurrent gets never
+    // race to create it
+    return *m_path_cache;
+}
+
+std::shared_ptr<const ArenaTree> Document::build_shards(
+        const std::shared_ptr<const arc::str::UTF8String>& data) const
+{
+    // a shard that fails to parse is only found when it is first accessed,
+    // so is reported then and treated as missing
+    arc::io::sys::Path file_path(m_file_path);
+    Shards::error_callback on_error =
+        [file_path](
+            const arc::str::UTF8String& name,
+            const arc::str::UTF8String& message)
+        {
+            report_fallback(
+                FallbackEvent::TYPE_LOAD,
+                file_path,
+                name,
+                "Treating the section as missing. Failed to parse the section "
+                "of the file with",
+                "ParseError",
+                message
+            );
+        };
+    return Shards::build(data, m_key_pool, on_error);
+}
+
+void Document::timed_load()
+{
+    m_load_timings.reset();
+    try
+    {
+        LoadTimings::Scope timing(m_load_timings.total);
+        load();
+    }
+    catch(...)
+    {
+        LoadReport* report = s_load_report.load(std::memory_order_acquire);
+        if(report != nullptr)
+        {
+            report->add(m_file_path, m_load_timings);
+        }
+        throw;
+    }
+
+    LoadReport* report = s_load_report.load(std::memory_order_acquire);
+    if(report != nullptr)
+    {
+        report->add(m_file_path, m_load_timings);
+    }
 }
 
 } // namespace metaengine
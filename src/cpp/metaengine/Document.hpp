@@ -5,13 +5,22 @@
 #ifndef METAENGINE_DOCUMENT_HPP_
 #define METAENGINE_DOCUMENT_HPP_
 
+#include <atomic>
 #include <cassert>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include <arcanecore/base/Exceptions.hpp>
 #include <arcanecore/base/str/UTF8String.hpp>
 #include <arcanecore/io/sys/Path.hpp>
 
+#include "metaengine/FallbackEvent.hpp"
+#include "metaengine/LoadTimings.hpp"
+#include "metaengine/Schema.hpp"
+#include "metaengine/Statistics.hpp"
 #include "metaengine/Visitor.hpp"
 
 //------------------------------------------------------------------------------
@@ -26,6 +35,17 @@ class Value;
 namespace metaengine
 {
 
+class ArenaTree;
+class AsyncReporter;
+class Children;
+class FileChunks;
+class KeyPool;
+class LoadReport;
+class ParseCache;
+class PathCache;
+class PathV;
+class Query;
+
 /*!
  * \brief Object that is used to load and store MetaEngine data from JSON.
  *
@@ -56,6 +76,23 @@ public:
         const arc::io::sys::Path& file_path,
         const arc::str::UTF8String& message);
 
+    /*!
+     * \brief Function called when the data at a subscribed key has changed.
+     *
+     * \param key The key that was subscribed to.
+     */
+    typedef std::function<void(const arc::str::UTF8String& key)>
+        change_callback;
+
+    /*!
+     * \brief Function called for each value matched by a query, once the
+     *        value has been retrieved by the visitor.
+     *
+     * \param key The full key of the matched value.
+     */
+    typedef std::function<void(const arc::str::UTF8String& key)>
+        query_callback;
+
     //--------------------------------------------------------------------------
     //                                CONSTRUCTORS
     //--------------------------------------------------------------------------
@@ -161,6 +198,41 @@ public:
      */
     static void set_get_fallback_reporter(fallback_reporter func);
 
+    /*!
+     * \brief Sets the AsyncReporter that fallbacks will be reported to.
+     *
+     * While an AsyncReporter is set, fallbacks are queued as FallbackEvents
+     * and reported from the AsyncReporter's background thread instead of
+     * calling the load and get fallback reporters, so that reporting does not
+     * block loading or get(). Pass null to revert to the synchronous
+     * reporters.
+     *
+     * \note The AsyncReporter must outlive its use by any Document.
+     */
+    static void set_async_reporter(AsyncReporter* reporter);
+
+    /*!
+     * \brief Sets the ParseCache that parsed data is shared through.
+     *
+     * While a ParseCache is set, Documents which load identical data from the
+     * same source share a single parsed tree of it instead of each parsing
+     * their own copy. Pass null to stop sharing (trees that are already
+     * shared remain so until the Documents holding them are reloaded).
+     *
+     * \note The ParseCache must outlive its use by any Document.
+     */
+    static void set_parse_cache(ParseCache* cache);
+
+    /*!
+     * \brief Sets the LoadReport that the LoadTimings of every completed load
+     *        are added to.
+     *
+     * Pass null to stop adding loads to the report.
+     *
+     * \note The LoadReport must outlive its use by any Document.
+     */
+    static void set_load_report(LoadReport* report);
+
     //--------------------------------------------------------------------------
     //                          PUBLIC MEMBER FUNCTIONS
     //--------------------------------------------------------------------------
@@ -198,6 +270,189 @@ public:
      */
     bool has_valid_memory_data() const;
 
+    /*!
+     * \brief Returns the version of the snapshot of data this Document
+     *        currently holds.
+     *
+     * A new version is assigned every time the data of this Document changes
+     * (e.g. on reload()). Versions are unique across all Documents in the
+     * process, so a version can be used to identify a snapshot of data without
+     * also needing to know which Document it came from. A version of ```0```
+     * means the Document has never been loaded.
+     */
+    arc::uint64 get_version() const;
+
+    /*!
+     * \brief Returns the version of the snapshot of data this Document
+     *        currently holds without waiting for a load in progress.
+     *
+     * This is a single relaxed atomic load, intended for cheaply polling
+     * whether the data has changed since a value was retrieved (see Handle).
+     * While a load is in progress this may return either the previous or the
+     * new version, so the data should still be retrieved through a function
+     * that waits for the load (e.g. get()).
+     */
+    arc::uint64 peek_version() const
+    {
+        return m_version.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Sets whether this Document records statistics about how its
+     *        values are accessed.
+     *
+     * Enabling statistics when they are already enabled does nothing, and
+     * disabling them discards any statistics recorded so far.
+     *
+     * \note This should not be called while other threads are retrieving
+     *       values from this Document.
+     */
+    void set_statistics_enabled(bool enabled);
+
+    /*!
+     * \brief Returns the statistics recorded by this Document, or null if
+     *        statistics are not enabled.
+     */
+    Statistics* get_statistics() const;
+
+    /*!
+     * \brief Returns the pool that the object keys of this Document's data are
+     *        interned in.
+     *
+     * Every tree the Document parses (including each variant of a Variant)
+     * shares the keys in this pool, so identical keys are only stored once.
+     * Trees shared from a ParseCache keep the pool of the Document that parsed
+     * them.
+     */
+    const KeyPool& get_key_pool() const;
+
+    /*!
+     * \brief Returns the breakdown of the time spent the last time this
+     *        Document was loaded.
+     */
+    const LoadTimings& get_load_timings() const;
+
+    /*!
+     * \brief Sets whether this Document's file (and the files of a Variant's
+     *        variants) are parsed while they are read.
+     *
+     * When streaming, a file is read in chunks of
+     * FileChunks::DEFAULT_CHUNK_SIZE bytes and each chunk is parsed as soon as
+     * it has been read, so the file is never held in memory as a whole and
+     * peak memory during a load is little more than the parsed data itself.
+     * Streamed data is not shared through a ParseCache, and a file that is not
+     * UTF-8 is decoded and parsed as a whole as usual.
+     *
+     * \note Takes effect the next time this Document is loaded.
+     */
+    void set_streaming(bool streaming);
+
+    /*!
+     * \brief Returns whether this Document's file is parsed while it is read,
+     *        see set_streaming().
+     */
+    bool is_streaming() const;
+
+    /*!
+     * \brief Limits the data this Document keeps to the values at the given
+     *        keys.
+     *
+     * When a projection is set, only the values at the given keys (and
+     * everything below them) are kept from the file and memory data, every
+     * other value is discarded while it is being parsed and behaves as if it
+     * does not exist. Arrays are either kept as a whole or discarded. Pass an
+     * empty list to keep all data. Combined with set_streaming() this bounds
+     * peak memory by the size of the projected data.
+     *
+     * Projected data is not shared through a ParseCache.
+     *
+     * \note Takes effect the next time this Document is loaded.
+     */
+    void set_projection(const std::vector<arc::str::UTF8String>& keys);
+
+    /*!
+     * \brief Returns the keys the data of this Document is limited to, or
+     *        empty if all data is kept.
+     */
+    const std::vector<arc::str::UTF8String>& get_projection() const;
+
+    /*!
+     * \brief Sets whether reloading this Document shares the subtrees of its
+     *        data that have not changed with the previous data.
+     *
+     * When enabled, each object or array in the data that is at least
+     * SectionParser::DEFAULT_SECTION_SIZE bytes is parsed into a section of
+     * its own, and when the Document is reloaded every section whose data is
+     * unchanged is shared with the new data rather than parsed again (see
+     * SectionParser). Reloading after an edit then only parses the sections
+     * containing the edit, and values within unchanged sections keep their
+     * addresses. Streamed and projected data is never shared.
+     *
+     * \note Takes effect the next time this Document is loaded.
+     */
+    void set_subtree_sharing_enabled(bool enabled);
+
+    /*!
+     * \brief Returns whether reloading this Document shares unchanged subtrees
+     *        with the previous data, see set_subtree_sharing_enabled().
+     */
+    bool is_subtree_sharing_enabled() const;
+
+    /*!
+     * \brief Sets whether the top-level sections of the file system data of
+     *        this Document are only parsed when they are first accessed.
+     *
+     * When enabled, loading the file only scans it to find where the value of
+     * each member of its root object begins and ends, and each value (a
+     * section) is parsed the first time a key within it is retrieved (see
+     * Shards), so loading large files of many independent sections does not
+     * pay for the sections that are never used. Sections are parsed exactly
+     * once, and retrieving keys from any number of threads at the same time
+     * remains safe. Retrieving the children of the root, or validating against
+     * a Schema, parses the sections it needs.
+     *
+     * A section that fails to parse is reported to the load reporter when it
+     * is first accessed, and is treated as if it does not exist. The whole
+     * file is still read when loading, and data whose root is not an object
+     * is parsed as a whole. Streamed and projected data is never sharded, and
+     * sharded data is neither shared through a ParseCache nor shares its
+     * subtrees with the previous data.
+     *
+     * \note Takes effect the next time this Document is loaded.
+     */
+    void set_sharding_enabled(bool enabled);
+
+    /*!
+     * \brief Returns whether the top-level sections of the file system data
+     *        of this Document are parsed on first access, see
+     *        set_sharding_enabled().
+     */
+    bool is_sharding_enabled() const;
+
+    /*!
+     * \brief Sets the Schema the data of this Document is validated against
+     *        each time it is loaded, or null to not validate the data.
+     *
+     * Validation resolves the value of each key of the schema once per load:
+     * if the value in the file system data is missing or does not match its
+     * type, the fallback to the memory data is reported to the load reporter
+     * then rather than to the get reporter on each get(). Retrieving a key
+     * whose value matched does not look the key up again, and the built-in
+     * Visitors for the type skip checking the value (see
+     * Diagnostic::is_proven()). Keys whose value matched in neither source
+     * are retrieved as if they were not in the schema, so errors are still
+     * raised by get().
+     *
+     * \note Takes effect the next time this Document is loaded.
+     */
+    void set_schema(std::shared_ptr<const Schema> schema);
+
+    /*!
+     * \brief Returns the Schema the data of this Document is validated
+     *        against (may be null).
+     */
+    const std::shared_ptr<const Schema>& get_schema() const;
+
     /*!
      * \brief Reloads the data of this document.
      *
@@ -215,6 +470,64 @@ public:
      */
     virtual void reload();
 
+    /*!
+     * \brief Reloads the data of this Document on a worker thread.
+     *
+     * This performs the same load as reload() but returns immediately, so
+     * loading can be overlapped with other work. While the load is pending
+     * any function that accesses the data of this Document (e.g. get(),
+     * reload(), or get_version()) blocks until the load has completed and
+     * then uses the newly loaded data. If the load fails, the Document is
+     * left in the same state as it would be after reload() failed.
+     *
+     * Calling this while a load is already pending waits for that load to
+     * complete first.
+     *
+     * \note This should not be called while other threads are accessing this
+     *       Document.
+     *
+     * \return A future that becomes ready once the load has completed, and
+     *         which rethrows any exception the load failed with (see
+     *         reload()).
+     */
+    std::shared_future<void> load_async();
+
+    /*!
+     * \brief Returns whether a load started by load_async() is still in
+     *        progress.
+     */
+    bool is_loading() const;
+
+    /*!
+     * \brief Subscribes to changes of the data at the given key.
+     *
+     * Whenever the data of this Document is reloaded (or a Variant switches
+     * variant) the value at the key in each of the Document's sources is
+     * compared against the value it had before, and the callback is called if
+     * the value or anything below it was added, removed or changed. Subtrees
+     * that are shared between the previous and new data are not compared. An
+     * empty key subscribes to any change of the Document's data.
+     *
+     * Callbacks are called in the order they were subscribed once the new data
+     * is in place, on the thread that loaded it (for load_async() this is the
+     * worker thread, and the load is in progress until the callbacks have
+     * returned). Exceptions thrown by a callback propagate out of reload(), or
+     * the future returned by load_async().
+     *
+     * \note While there are subscriptions the previous data is kept until the
+     *       new data has been loaded, so both are in memory during a load.
+     *
+     * \return An id that can be passed to unsubscribe().
+     */
+    arc::uint64 subscribe(
+            const arc::str::UTF8String& key,
+            change_callback callback);
+
+    /*!
+     * \brief Removes the subscription with the given id, if it exists.
+     */
+    void unsubscribe(arc::uint64 id);
+
     /*!
      * \brief Retrieves data from the Document using the given Visitor object.
      *
@@ -222,6 +535,10 @@ public:
      * from it's internal data, and then pass it to the Visitor object for it
      * to interpret the JSON and store the result internally.
      *
+     * The elements of the key are separated by ```.```, and an element which
+     * is a number addresses an element of an array, e.g.
+     * ```fonts.default_colour.1```.
+     *
      * If this Document has JSON data loaded from both the file system and
      * memory, the requested value will first be attempted to be retrieved from
      * the file system data and if this fails, the Document will fallback to
@@ -246,10 +563,64 @@ public:
             const arc::str::UTF8String& key,
             VisitorType& visitor)
     {
-        get(key, static_cast<VisitorBase*>(&visitor));
+        instrumented_get(key, static_cast<VisitorBase*>(&visitor));
         return visitor;
     }
 
+    /*!
+     * \brief Returns the children of the object or array with the given key.
+     *
+     * The object or array is retrieved following the same rules as get(), so
+     * if the file system data has no object or array with the key the
+     * children are enumerated from the memory data instead (the children of
+     * the two are not merged). An empty key returns the children of the root
+     * of the data.
+     *
+     * Iterating over the children does not allocate or look up any keys, see
+     * Children. Including metaengine/Children.hpp is required to use the
+     * returned object.
+     *
+     * \throws arc::ex::KeyError If there is no value in the data with the given
+     *                           key.
+     * \throws arc::ex::TypeError If the value in the data is not an object or
+     *                            array.
+     */
+    Children get_children(const arc::str::UTF8String& key);
+
+    /*!
+     * \brief Retrieves every value matched by the given Query using the given
+     *        Visitor object.
+     *
+     * The object or array at the prefix of the query (see Query::get_prefix())
+     * is retrieved following the same rules as get_children(), and the rest of
+     * the query is matched within it in a single traversal. Each matched
+     * value is passed to the visitor directly and then the callback is called
+     * with its full key, so the visitor holds the value for the duration of
+     * the callback. If a matched value is not a valid type for the visitor,
+     * this falls back to retrieving its full key with get().
+     *
+     * The Query holds no data of the Document, so it only needs to be compiled
+     * once and can be run again after the Document is reloaded.
+     *
+     * \return The number of values matched, which is 0 if there is no object
+     *         or array at the prefix of the query.
+     *
+     * \throws arc::ex::KeyError If a matched value is not a valid type for
+     *                           the visitor and no other data has a value for
+     *                           its full key.
+     * \throws arc::ex::TypeError If a matched value is not a valid type for
+     *                            the visitor and neither is the value in any
+     *                            other data.
+     */
+    template <typename VisitorType>
+    std::size_t query(
+            const Query& query,
+            VisitorType& visitor,
+            const query_callback& callback)
+    {
+        return run_query(query, static_cast<VisitorBase*>(&visitor), callback);
+    }
+
 protected:
 
     //--------------------------------------------------------------------------
@@ -264,21 +635,37 @@ protected:
      * \brief The function to use to report fallback when get a value.
      */
     static fallback_reporter s_get_reporter;
+    /*!
+     * \brief The AsyncReporter fallbacks are reported to (may be null).
+     */
+    static std::atomic<AsyncReporter*> s_async_reporter;
+    /*!
+     * \brief The ParseCache parsed data is shared through (may be null).
+     */
+    static std::atomic<ParseCache*> s_parse_cache;
+    /*!
+     * \brief The LoadReport loads are added to (may be null).
+     */
+    static std::atomic<LoadReport*> s_load_report;
 
     //--------------------------------------------------------------------------
     //                            PROTECTED ATTRIBUTES
     //--------------------------------------------------------------------------
 
     /*!
-     * \brief The root JSON root value that has been loaded and parsed from the
-     *        file system.
+     * \brief The JSON tree that has been loaded and parsed from the file
+     *        system.
      */
-    std::unique_ptr<Json::Value> m_file_root;
+    std::shared_ptr<const ArenaTree> m_file_root;
     /*!
-     * \brief The root JSON root value that has been loaded and parsed from
-     *        memory.
+     * \brief The JSON tree that has been loaded and parsed from memory.
+     */
+    std::shared_ptr<const ArenaTree> m_mem_root;
+    /*!
+     * \brief The pool the object keys of every tree this Document parses are
+     *        interned in.
      */
-    std::unique_ptr<Json::Value> m_mem_root;
+    std::shared_ptr<KeyPool> m_key_pool;
 
     /*!
      * \brief The path to the file to load JSON data from.
@@ -288,11 +675,159 @@ protected:
      * \brief Whether the path is being used to load this Document's data.
      */
     bool m_using_path;
+    /*!
+     * \brief The version of the snapshot of data this Document currently
+     *        holds.
+     */
+    std::atomic<arc::uint64> m_version;
+    /*!
+     * \brief The statistics being recorded for this Document (null if
+     *        statistics are not enabled).
+     */
+    std::unique_ptr<Statistics> m_statistics;
+    /*!
+     * \brief The time spent the last time this Document was loaded.
+     */
+    LoadTimings m_load_timings;
+
+    //--------------------------------------------------------------------------
+    //                         PROTECTED STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether there is anything to report fallbacks of the given
+     *        type to.
+     *
+     * This can be used to avoid building expensive details that would never be
+     * reported.
+     */
+    static bool is_reporting(FallbackEvent::Type type);
+
+    /*!
+     * \brief Reports a fallback to the AsyncReporter if one is set, otherwise
+     *        to the load or get fallback reporter depending on the type.
+     *
+     * Nothing is formatted if there is nothing to report to.
+     *
+     * \param description Static string describing the fallback, this is not
+     *                    copied so must outlive the event.
+     * \param variant The variant being loaded, if the fallback concerns one.
+     */
+    static void report_fallback(
+            FallbackEvent::Type type,
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& key,
+            const char* description,
+            const arc::str::UTF8String& error_type,
+            const arc::str::UTF8String& details,
+            const arc::str::UTF8String& variant = arc::str::UTF8String());
+
+    /*!
+     * \brief Reports a fallback whose details are formatted from the given
+     *        Diagnostic.
+     *
+     * The AsyncReporter only formats the Diagnostic if the fallback is not
+     * suppressed as a duplicate.
+     */
+    static void report_fallback(
+            FallbackEvent::Type type,
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& key,
+            const char* description,
+            const arc::str::UTF8String& error_type,
+            const Diagnostic& diagnostic);
 
     //--------------------------------------------------------------------------
     //                         PROTECTED MEMBER FUNCTIONS
     //--------------------------------------------------------------------------
 
+    /*!
+     * \brief Assigns a new snapshot version to this Document.
+     *
+     * This should be called by any function that changes the data this
+     * Document holds, so that anything caching values derived from the
+     * previous data knows to revalidate them.
+     */
+    void new_version();
+
+    /*!
+     * \brief Returns whether anything is subscribed to changes of this
+     *        Document's data.
+     */
+    bool has_subscriptions() const;
+
+    /*!
+     * \brief Appends the trees of this Document's data to the given list, in
+     *        the order values are retrieved from them.
+     *
+     * Trees that are not loaded are appended as null. Derived Documents which
+     * hold extra data should override this, appending their trees before
+     * calling the base implementation. If the number of trees a derived
+     * Document holds can change (e.g. the layers of a Stack) trees must only be
+     * added or removed at the front of the list.
+     */
+    virtual void get_trees(
+            std::vector<std::shared_ptr<const ArenaTree>>& trees) const;
+
+    /*!
+     * \brief Calls the callbacks of the subscriptions whose data has changed
+     *        since the given trees (from get_trees()) were this Document's
+     *        data.
+     *
+     * Does nothing if the previous trees are empty.
+     */
+    void notify_subscribers(
+            const std::vector<std::shared_ptr<const ArenaTree>>& previous);
+
+    /*!
+     * \brief Loads the data of this Document from its sources.
+     *
+     * This is the implementation of both reload() and load_async(), derived
+     * Documents that load extra data should override this rather than
+     * reload(). It must not call any function that waits for a pending load.
+     */
+    virtual void load();
+
+    /*!
+     * \brief Validates the loaded data against the Schema, reporting any
+     *        fallback and recording the values which were proven to match.
+     *
+     * Called at the end of load(). Derived Documents which resolve values
+     * from other data than the memory and file system data should override
+     * this to validate the values they resolve instead.
+     */
+    virtual void validate();
+
+    /*!
+     * \brief Blocks until the load started by load_async() has completed, if
+     *        there is one.
+     *
+     * The load is only complete once the callbacks of the subscriptions have
+     * returned, so this Document is not modified or destroyed while they are
+     * running. The callbacks themselves do not wait, since they are called by
+     * the thread performing the load.
+     *
+     * Derived Documents which override load() must call this in their
+     * destructor.
+     */
+    void wait_for_load() const;
+
+    /*!
+     * \brief Untemplated implementation of query().
+     */
+    std::size_t run_query(
+            const Query& query,
+            VisitorBase* visitor,
+            const query_callback& callback);
+
+    /*!
+     * \brief Entry point for retrieving values which records statistics (if
+     *        enabled) and then calls the internal implementation of get.
+     */
+    VisitorBase* instrumented_get(
+            const arc::str::UTF8String& key,
+            VisitorBase* visitor);
+
     /*!
      * \brief Internal implementation of get.
      *
@@ -303,23 +838,99 @@ protected:
             const arc::str::UTF8String& key,
             VisitorBase* visitor);
 
+    /*!
+     * \brief Returns the JSON value get() would hand to a Visitor which accepts
+     *        any value for the key, or null if there is no value for the key.
+     *
+     * Unlike get() this does not wait for a pending load, record statistics or
+     * report fallbacks, so is used to check values internally (e.g. by
+     * PathCache). Derived Documents which override get() should override this
+     * to match.
+     */
+    virtual const Json::Value* find_resolved(
+            const arc::str::UTF8String& key) const;
+
     /*!
      * \brief Internal implementation of get that takes a pre-resolved JSON
      *        value.
+     *
+     * \param source The source the pre-resolved JSON value was retrieved
+     *               from, used for recording statistics.
      */
     VisitorBase* get(
             const Json::Value* data,
             const arc::str::UTF8String& key,
-            VisitorBase* visitor);
+            VisitorBase* visitor,
+            Statistics::Source source = Statistics::SOURCE_FILE);
 
     /*!
-     * \brief Parses JSON data from the given string into the root JSON value.
+     * \brief Parses JSON data from the given string into a new JSON tree.
+     *
+     * The values of the tree are allocated from an Arena owned by the tree, so
+     * discarding it (e.g. on reload) is a single release rather than a walk of
+     * every value.
+     *
+     * If a ParseCache is set and the source is not empty, a tree already
+     * parsed from identical data of the source is shared instead, and a newly
+     * parsed tree is stored in the cache.
+     *
+     * If subtree sharing is enabled, the sections of the previous tree whose
+     * data is unchanged are shared with the new tree.
+     *
+     * \param source The name of the source the data was loaded from (see
+     *               ParseCache::file_source() and
+     *               ParseCache::memory_source()).
+     * \param previous The tree previously parsed from the source (may be
+     *                 null).
      *
      * \throws arc::ex::ParseError If the data is not valid JSON.
      */
     void parse(
             const arc::str::UTF8String& json_data,
-            std::unique_ptr<Json::Value>& value);
+            std::shared_ptr<const ArenaTree>& tree,
+            const arc::str::UTF8String& source = "",
+            const std::shared_ptr<const ArenaTree>& previous = nullptr);
+
+    /*!
+     * \brief Parses the data of a file into a new JSON tree while it is read.
+     *
+     * If the file cannot be parsed as it is read, it is read again as a whole
+     * with FileData::read(), which decodes files that are not plain UTF-8, and
+     * parsed with parse().
+     *
+     * \param chunks The chunks of the file to read.
+     * \param file_path The path of the file.
+     * \param read_phase The phase to record the time spent reading in.
+     * \param parse_phase The phase to record the time spent parsing in.
+     *
+     * \throws arc::ex::ParseError If the data is not valid JSON.
+     */
+    void stream_parse(
+            FileChunks& chunks,
+            const arc::io::sys::Path& file_path,
+            std::shared_ptr<const ArenaTree>& tree,
+            LoadTimings::Phase read_phase,
+            LoadTimings::Phase parse_phase);
+
+    /*!
+     * \brief Finds the JSON value associated with the given key in the JSON
+     *        data without throwing or allocating.
+     *
+     * Elements of the key which are indices (see Query::parse_index())
+     * address the elements of arrays.
+     *
+     * \param root The root JSON value to find the value in.
+     * \param key The key to find the value for.
+     * \param failed_at If not null and there is no value for the key, this is
+     *                  set to the number of bytes of the key up to the end of
+     *                  the first element of the key that could not be found.
+     * \return Pointer to the JSON value associated with the key, or null if
+     *         there is no value for the key.
+     */
+    const Json::Value* find_value(
+            const Json::Value* root,
+            const arc::str::UTF8String& key,
+            std::size_t* failed_at = nullptr) const;
 
     /*!
      * \brief Retrieves the JSON value associated with the given key from the
@@ -335,8 +946,75 @@ protected:
         const Json::Value* root,
         const arc::str::UTF8String& key) const;
 
+    /*!
+     * \brief Returns the root value of the tree, first parsing the section
+     *        the given key is within if the tree is sharded.
+     *
+     * An empty key parses every section, see set_sharding_enabled().
+     */
+    const Json::Value* get_tree_root(
+            const ArenaTree& tree,
+            const arc::str::UTF8String& key) const;
+
 private:
 
+    // the path visitor needs access to the path cache, which checks the
+    // values paths depend on
+    friend class PathV;
+    friend class PathCache;
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The value of a key of the Schema resolved when the data was
+     *        loaded.
+     *
+     * A value is only proven once it has been checked to be of the type the
+     * Schema declares for its key, so get() may return it without resolving
+     * the key again as long as the requested type matches.
+     */
+    struct Proven
+    {
+        /*!
+         * \brief The value, which matches the type of the key.
+         */
+        const Json::Value* data;
+        /*!
+         * \brief The source the value was resolved from.
+         */
+        Statistics::Source source;
+        /*!
+         * \brief The type the Schema declares for the key.
+         */
+        Schema::Type type;
+    };
+
+    /*!
+     * \brief A callback subscribed to changes of the data at a key.
+     */
+    struct Subscription
+    {
+        arc::uint64 id;
+        arc::str::UTF8String key;
+        change_callback callback;
+    };
+
+    //--------------------------------------------------------------------------
+    //                         PRIVATE STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The next snapshot version that will be assigned to a Document.
+     */
+    static std::atomic<arc::uint64> s_next_version;
+    /*!
+     * \brief The Document whose load_async() is running on this thread (null
+     *        if there is none), which must not wait for its own load.
+     */
+    static thread_local const Document* s_async_loading;
+
     //--------------------------------------------------------------------------
     //                             PRIVATE ATTRIBUTES
     //--------------------------------------------------------------------------
@@ -346,6 +1024,81 @@ private:
      *        used).
      */
     const arc::str::UTF8String* m_memory;
+
+    /*!
+     * \brief Cache of the paths that have been resolved from this Document by
+     *        PathV visitors.
+     */
+    std::unique_ptr<PathCache> m_path_cache;
+
+    /*!
+     * \brief Whether a load started by load_async() is in progress, which
+     *        includes calling the callbacks of the subscriptions.
+     */
+    std::atomic<bool> m_loading;
+    /*!
+     * \brief The result of the last load started by load_async().
+     */
+    std::shared_future<void> m_pending;
+    /*!
+     * \brief Whether files are parsed while they are read.
+     */
+    bool m_streaming;
+    /*!
+     * \brief The keys the data is limited to (empty to keep all data).
+     */
+    std::vector<arc::str::UTF8String> m_projection;
+    /*!
+     * \brief Whether unchanged subtrees are shared with the previous data.
+     */
+    bool m_subtree_sharing;
+    /*!
+     * \brief Whether the sections of the file system data are parsed on first
+     *        access.
+     */
+    bool m_sharding;
+    /*!
+     * \brief The Schema the data is validated against (may be null).
+     */
+    std::shared_ptr<const Schema> m_schema;
+    /*!
+     * \brief The values of the keys of the Schema that were proven to match
+     *        when the data was loaded.
+     */
+    std::map<arc::str::UTF8String, Proven> m_proven;
+    /*!
+     * \brief The subscriptions to changes of the data, in the order they were
+     *        made.
+     */
+    std::vector<Subscription> m_subscriptions;
+    /*!
+     * \brief The id that will be given to the next subscription.
+     */
+    arc::uint64 m_next_subscription;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the path cache of this Document.
+     */
+    PathCache& get_path_cache();
+
+    /*!
+     * \brief Builds a sharded tree from the file system data, see Shards.
+     *
+     * \return The sharded tree, or null if the data should be parsed as a
+     *         whole.
+     */
+    std::shared_ptr<const ArenaTree> build_shards(
+            const std::shared_ptr<const arc::str::UTF8String>& data) const;
+
+    /*!
+     * \brief Calls load(), recording its total time, and adds the timings to
+     *        the LoadReport if there is one.
+     */
+    void timed_load();
 };
 
 } // namespace metaengine
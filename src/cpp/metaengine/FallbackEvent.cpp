@@ -0,0 +1,57 @@
+#include "metaengine/FallbackEvent.hpp"
+
+namespace metaengine
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTORS
+//------------------------------------------------------------------------------
+
+FallbackEvent::FallbackEvent()
+    :
+    type       (TYPE_LOAD),
+    description(""),
+    suppressed (0)
+{
+}
+
+FallbackEvent::FallbackEvent(
+        Type type_,
+        const arc::io::sys::Path& file_path_,
+        const arc::str::UTF8String& key_,
+        const char* description_,
+        const arc::str::UTF8String& error_type_,
+        const arc::str::UTF8String& details_,
+        const arc::str::UTF8String& variant_)
+    :
+    type       (type_),
+    file_path  (file_path_),
+    key        (key_),
+    description(description_),
+    error_type (error_type_),
+    details    (details_),
+    variant    (variant_),
+    suppressed (0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::str::UTF8String FallbackEvent::format() const
+{
+    arc::str::UTF8String message;
+    if(!variant.is_empty())
+    {
+        message << "Variant \"" << variant << "\": ";
+    }
+    message << description << " " << error_type << ": " << details;
+    if(suppressed > 0)
+    {
+        message << " (" << suppressed << " identical reports suppressed)";
+    }
+    return message;
+}
+
+} // namespace metaengine
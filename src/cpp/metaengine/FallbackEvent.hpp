@@ -0,0 +1,105 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_FALLBACKEVENT_HPP_
+#define METAENGINE_FALLBACKEVENT_HPP_
+
+#include <arcanecore/base/str/UTF8String.hpp>
+#include <arcanecore/io/sys/Path.hpp>
+
+namespace metaengine
+{
+
+/*!
+ * \brief Structured record of a Document falling back from one source of data
+ *        to another.
+ *
+ * Rather than holding a preformatted message, events hold the individual
+ * components of the failure so they can be compared (for deduplication) and
+ * only formatted when a message is actually required, see format().
+ */
+struct FallbackEvent
+{
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The operations that can cause a fallback.
+     */
+    enum Type
+    {
+        /// Loading data from a source failed.
+        TYPE_LOAD = 0,
+        /// Retrieving a value from a source failed.
+        TYPE_GET
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PUBLIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The operation that caused the fallback.
+     */
+    Type type;
+    /*!
+     * \brief The path of the file the Document was using.
+     */
+    arc::io::sys::Path file_path;
+    /*!
+     * \brief The key being retrieved (empty for load events).
+     */
+    arc::str::UTF8String key;
+    /*!
+     * \brief Static description of the fallback that was performed.
+     */
+    const char* description;
+    /*!
+     * \brief The type of error that caused the fallback, e.g. "KeyError".
+     */
+    arc::str::UTF8String error_type;
+    /*!
+     * \brief The message of the error that caused the fallback.
+     */
+    arc::str::UTF8String details;
+    /*!
+     * \brief The variant of a Variant Document being loaded (empty if the
+     *        event does not concern a variant).
+     */
+    arc::str::UTF8String variant;
+    /*!
+     * \brief The number of identical events that were suppressed since this
+     *        event was last reported (see AsyncReporter).
+     */
+    arc::uint64 suppressed;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTORS
+    //--------------------------------------------------------------------------
+
+    FallbackEvent();
+
+    FallbackEvent(
+            Type type_,
+            const arc::io::sys::Path& file_path_,
+            const arc::str::UTF8String& key_,
+            const char* description_,
+            const arc::str::UTF8String& error_type_,
+            const arc::str::UTF8String& details_,
+            const arc::str::UTF8String& variant_ = arc::str::UTF8String());
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Formats this event as a human readable message.
+     */
+    arc::str::UTF8String format() const;
+};
+
+} // namespace metaengine
+
+#endif
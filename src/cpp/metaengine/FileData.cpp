@@ -0,0 +1,266 @@
+#include "metaengine/FileData.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define METAENGINE_FILEDATA_SSE2
+    #include <emmintrin.h>
+#endif
+
+#include <arcanecore/base/Exceptions.hpp>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Returns the first byte from c that is not a non-null ASCII
+ *        character, or end if there is no such byte.
+ */
+const unsigned char* skip_ascii(
+        const unsigned char* c,
+        const unsigned char* end)
+{
+    #ifdef METAENGINE_FILEDATA_SSE2
+
+        const __m128i zero = _mm_setzero_si128();
+        while(end - c >= 16)
+        {
+            __m128i block =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(c));
+            // the high bit is set for non-ASCII bytes, and null bytes compare
+            // equal to zero
+            __m128i special =
+                _mm_or_si128(block, _mm_cmpeq_epi8(block, zero));
+            if(_mm_movemask_epi8(special) != 0)
+            {
+                break;
+            }
+            c += 16;
+        }
+
+    #else
+
+        static const arc::uint64 LOW_BITS  = 0x0101010101010101ULL;
+        static const arc::uint64 HIGH_BITS = 0x8080808080808080ULL;
+        while(end - c >= 8)
+        {
+            arc::uint64 word;
+            std::memcpy(&word, c, 8);
+            // the high bit is set for non-ASCII bytes, and the second term is
+            // non-zero if any byte is null
+            if(((word | ((word - LOW_BITS) & ~word)) & HIGH_BITS) != 0)
+            {
+                break;
+            }
+            c += 8;
+        }
+
+    #endif
+
+    // find the byte within the block
+    while(c != end && *c != 0 && *c < 0x80)
+    {
+        ++c;
+    }
+    return c;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool FileData::read(
+        const arc::io::sys::Path& path,
+        arc::str::UTF8String& data)
+{
+    // read the raw bytes
+    {
+        arc::io::sys::FileReader file(
+            path,
+            arc::io::sys::FileReader::ENCODING_RAW
+        );
+        arc::int64 size = file.get_size();
+        if(size == 0)
+        {
+            file.close();
+            data.assign("", 0);
+            return true;
+        }
+
+        if(size > 0)
+        {
+            std::vector<char> buffer(static_cast<std::size_t>(size));
+            arc::int64 read_size = file.read(&buffer[0], size);
+            file.close();
+
+            if(read_size == size &&
+               is_plain_utf8(&buffer[0], buffer.size()))
+            {
+                data.assign(&buffer[0], buffer.size());
+                return true;
+            }
+        }
+    }
+
+    // fall back to decoding the file
+    arc::io::sys::FileReader file(
+        path,
+        arc::io::sys::FileReader::ENCODING_DETECT,
+        arc::io::sys::FileReader::NEWLINE_UNIX
+    );
+    file.read(data);
+    file.close();
+    return false;
+}
+
+bool FileData::is_plain_utf8(const char* data, std::size_t length)
+{
+    // a UTF-8 byte order mark is valid UTF-8 but must be skipped, UTF-16 and
+    // UTF-32 byte order marks are caught by validation
+    const unsigned char* c = reinterpret_cast<const unsigned char*>(data);
+    if(length >= 3 && c[0] == 0xEF && c[1] == 0xBB && c[2] == 0xBF)
+    {
+        return false;
+    }
+
+    return is_valid_utf8(data, length);
+}
+
+bool FileData::is_valid_utf8(const char* data, std::size_t length)
+{
+    const unsigned char* c = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = c + length;
+
+    while(true)
+    {
+        c = skip_ascii(c, end);
+        if(c == end)
+        {
+            return true;
+        }
+
+        // the number of continuation bytes and the valid range of the first
+        // continuation byte, following RFC 3629
+        unsigned char lead = *c;
+        std::size_t continuations = 0;
+        unsigned char min = 0x80;
+        unsigned char max = 0xBF;
+        if(lead >= 0xC2 && lead <= 0xDF)
+        {
+            continuations = 1;
+        }
+        else if(lead == 0xE0)
+        {
+            // overlong
+            continuations = 2;
+            min = 0xA0;
+        }
+        else if(lead == 0xED)
+        {
+            // surrogates
+            continuations = 2;
+            max = 0x9F;
+        }
+        else if(lead >= 0xE1 && lead <= 0xEF)
+        {
+            continuations = 2;
+        }
+        else if(lead == 0xF0)
+        {
+            // overlong
+            continuations = 3;
+            min = 0x90;
+        }
+        else if(lead >= 0xF1 && lead <= 0xF3)
+        {
+            continuations = 3;
+        }
+        else if(lead == 0xF4)
+        {
+            // beyond U+10FFFF
+            continuations = 3;
+            max = 0x8F;
+        }
+        else
+        {
+            // null, a stray continuation byte, or an invalid lead byte
+            return false;
+        }
+
+        if(static_cast<std::size_t>(end - c) <= continuations ||
+           c[1] < min ||
+           c[1] > max)
+        {
+            return false;
+        }
+        for(std::size_t i = 2; i <= continuations; ++i)
+        {
+            if((c[i] & 0xC0) != 0x80)
+            {
+                return false;
+            }
+        }
+        c += continuations + 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                  FILE CHUNKS
+//------------------------------------------------------------------------------
+
+const std::size_t FileChunks::DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+FileChunks::FileChunks(
+        const arc::io::sys::Path& path,
+        std::size_t chunk_size)
+    :
+    m_file     (path, arc::io::sys::FileReader::ENCODING_RAW),
+    m_size     (0),
+    m_remaining(0),
+    m_buffer   (chunk_size)
+{
+    arc::int64 size = m_file.get_size();
+    if(size > 0)
+    {
+        m_size = static_cast<std::size_t>(size);
+        m_remaining = m_size;
+    }
+}
+
+std::size_t FileChunks::get_size() const
+{
+    return m_size;
+}
+
+bool FileChunks::next(const char*& data, std::size_t& length)
+{
+    if(m_remaining == 0 || m_buffer.empty())
+    {
+        return false;
+    }
+
+    arc::int64 read_size = m_file.read(
+        &m_buffer[0],
+        static_cast<arc::int64>(std::min(m_remaining, m_buffer.size()))
+    );
+    if(read_size <= 0)
+    {
+        m_remaining = 0;
+        return false;
+    }
+
+    data = &m_buffer[0];
+    length = static_cast<std::size_t>(read_size);
+    m_remaining -= length;
+    return true;
+}
+
+} // namespace metaengine
@@ -0,0 +1,141 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_FILEDATA_HPP_
+#define METAENGINE_FILEDATA_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+#include <arcanecore/io/sys/FileReader.hpp>
+#include <arcanecore/io/sys/Path.hpp>
+
+namespace metaengine
+{
+
+/*!
+ * \brief Functions for reading the data of JSON files.
+ *
+ * Nearly all JSON files are plain UTF-8 without a byte order mark, which can
+ * be parsed exactly as they are stored. So rather than always reading files
+ * through an arc::io::sys::FileReader that detects the encoding and rewrites
+ * newlines, the raw bytes of the file are read in one go and validated as
+ * UTF-8, and only if the file has a byte order mark or is not valid UTF-8 is
+ * it read again through the FileReader. Newlines do not need to be rewritten
+ * since JSON treats carriage returns as whitespace.
+ */
+class FileData
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Reads the data of the file at the given path into data.
+     *
+     * \return Whether the file could be read directly, false if it was read
+     *         through an arc::io::sys::FileReader instead.
+     *
+     * \throws arc::ex::IOError If the file cannot be opened or read.
+     */
+    static bool read(
+            const arc::io::sys::Path& path,
+            arc::str::UTF8String& data);
+
+    /*!
+     * \brief Returns whether the given data is valid UTF-8 that can be used
+     *        without decoding.
+     *
+     * This is false if the data starts with a UTF-8 byte order mark, or is
+     * not valid (see is_valid_utf8()).
+     */
+    static bool is_plain_utf8(const char* data, std::size_t length);
+
+    /*!
+     * \brief Returns whether the given data is valid UTF-8.
+     *
+     * This is false if the data contains any null bytes, overlong encodings,
+     * surrogates or code points beyond U+10FFFF. Runs of ASCII are checked 16
+     * bytes at a time using SSE2 where it is available, and 8 bytes at a time
+     * otherwise.
+     */
+    static bool is_valid_utf8(const char* data, std::size_t length);
+};
+
+/*!
+ * \brief Reads the raw bytes of a file in fixed size chunks, so that it can be
+ *        parsed with a StreamParser without holding the whole file in memory.
+ */
+class FileChunks
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(FileChunks);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The default size of each chunk in bytes.
+     */
+    static const std::size_t DEFAULT_CHUNK_SIZE;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Opens the file at the given path.
+     *
+     * \throws arc::ex::IOError If the file cannot be opened.
+     */
+    explicit FileChunks(
+            const arc::io::sys::Path& path,
+            std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the size of the file in bytes.
+     */
+    std::size_t get_size() const;
+
+    /*!
+     * \brief Reads the next chunk of the file.
+     *
+     * \param data Returns the data of the chunk, which remains valid until the
+     *             next call.
+     * \param length Returns the length of the chunk.
+     * \return False if the end of the file has been reached.
+     */
+    bool next(const char*& data, std::size_t& length);
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    arc::io::sys::FileReader m_file;
+    std::size_t m_size;
+    /*!
+     * \brief The number of bytes that have not been read yet.
+     */
+    std::size_t m_remaining;
+    std::vector<char> m_buffer;
+};
+
+} // namespace metaengine
+
+#endif
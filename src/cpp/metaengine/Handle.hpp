@@ -0,0 +1,190 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_HANDLE_HPP_
+#define METAENGINE_HANDLE_HPP_
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include "metaengine/Document.hpp"
+
+namespace metaengine
+{
+
+/*!
+ * \brief A value of a Document bound to a key, which is only retrieved again
+ *        when the data of the Document changes.
+ *
+ * The handle owns its own instance of the Visitor type and holds the version
+ * of the Document's data (see Document::get_version()) the value was
+ * retrieved from. Reading the value only compares that version with the
+ * current version of the Document (a relaxed atomic load), so values that are
+ * read often (e.g. every frame) do not pay for looking up the key, dispatching
+ * to the Visitor or converting the data, until the Document is reloaded:
+ *
+ * \code
+ * metaengine::Handle<metaengine::FloatV<float>> gravity(&doc, "gravity");
+ * ...
+ * // only retrieved again after doc has been reloaded
+ * velocity += *gravity * delta_time;
+ * \endcode
+ *
+ * Since the value is held by the handle, it may be read while the Document is
+ * being loaded asynchronously, in which case it returns the previous value
+ * until the load has progressed far enough to assign the new version (at
+ * which point reading blocks until the load has completed). As with the
+ * Document itself, a handle should not be read by multiple threads at once.
+ *
+ * \tparam VisitorType The Visitor used to retrieve the value, which must be
+ *                     default constructible.
+ */
+template <typename VisitorType>
+class Handle
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The type of the value this handle holds.
+     */
+    typedef typename VisitorType::value_type value_type;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new handle to the value at the given key of the
+     *        Document, retrieving the value immediately.
+     *
+     * \param document The Document to retrieve the value from, which must
+     *                 outlive this handle.
+     * \param key The key of the value, see Document::get().
+     *
+     * \throws arc::ex::KeyError If there is no value in the data with the given
+     *                           key.
+     * \throws arc::ex::TypeError If the value is not a valid type for the
+     *                            Visitor.
+     */
+    Handle(Document* document, const arc::str::UTF8String& key)
+        :
+        m_document(document),
+        m_key     (key),
+        m_version (0)
+    {
+        refresh();
+    }
+
+    //--------------------------------------------------------------------------
+    //                                 OPERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the value this handle holds, see get().
+     */
+    const value_type& operator*() const
+    {
+        return get();
+    }
+
+    /*!
+     * \brief Provides access to the members of the value this handle holds, see
+     *        get().
+     */
+    const value_type* operator->() const
+    {
+        return &get();
+    }
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the value this handle holds, first retrieving it again if
+     *        the data of the Document has changed since it was last retrieved.
+     *
+     * \throws arc::ex::KeyError If the value must be retrieved again and there
+     *                           is no longer a value in the data with the key.
+     * \throws arc::ex::TypeError If the value must be retrieved again and it is
+     *                            no longer a valid type for the Visitor.
+     */
+    const value_type& get() const
+    {
+        if(m_document->peek_version() != m_version)
+        {
+            refresh();
+        }
+        return *m_visitor;
+    }
+
+    /*!
+     * \brief Retrieves the value from the Document again, regardless of whether
+     *        its data has changed.
+     *
+     * If retrieving the value fails the previous value is kept, and retrieving
+     * is attempted again the next time the value is read.
+     *
+     * \throws arc::ex::KeyError If there is no value in the data with the key.
+     * \throws arc::ex::TypeError If the value is not a valid type for the
+     *                            Visitor.
+     */
+    void refresh() const
+    {
+        // the version is read first (waiting for any load in progress) so
+        // that a reload during the get leaves this handle out of date rather
+        // than marking an old value as current
+        arc::uint64 version = m_document->get_version();
+        m_document->get(m_key, m_visitor);
+        m_version = version;
+    }
+
+    /*!
+     * \brief Returns the Document this handle retrieves its value from.
+     */
+    Document* get_document() const
+    {
+        return m_document;
+    }
+
+    /*!
+     * \brief Returns the key of the value this handle holds.
+     */
+    const arc::str::UTF8String& get_key() const
+    {
+        return m_key;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The Document the value is retrieved from, which must outlive
+     *        this handle.
+     */
+    Document* m_document;
+    /*!
+     * \brief The key of the value in the Document.
+     */
+    arc::str::UTF8String m_key;
+    /*!
+     * \brief The version of the Document's data the value was retrieved from.
+     */
+    mutable arc::uint64 m_version;
+    /*!
+     * \brief The instance of the Visitor owned by this handle, which holds the
+     *        value last retrieved.
+     */
+    mutable VisitorType m_visitor;
+};
+
+} // namespace metaengine
+
+#endif
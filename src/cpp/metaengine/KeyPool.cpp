@@ -0,0 +1,127 @@
+#include "metaengine/KeyPool.hpp"
+
+#include <cstring>
+
+#include <arcanecore/base/Types.hpp>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The initial number of slots in the hash table.
+ */
+const std::size_t INITIAL_CAPACITY = 256;
+
+/*!
+ * \brief FNV-1a hash of a key.
+ */
+std::size_t hash_key(const char* key, unsigned length)
+{
+    arc::uint64 hash = 14695981039346656037ULL;
+    for(unsigned i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+KeyPool::KeyPool()
+    :
+    m_storage(4096),
+    m_size   (0)
+{
+    Slot empty = {0, 0, nullptr};
+    m_table.resize(INITIAL_CAPACITY, empty);
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+const char* KeyPool::intern(const char* key, unsigned length)
+{
+    std::size_t hash = hash_key(key, length);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // keep the load factor below a half
+    if((m_size + 1) * 2 > m_table.size())
+    {
+        grow();
+    }
+
+    // linear probe for the key
+    std::size_t mask = m_table.size() - 1;
+    std::size_t i = hash & mask;
+    while(m_table[i].key != nullptr)
+    {
+        const Slot& slot = m_table[i];
+        if(slot.hash   == hash   &&
+           slot.length == length &&
+           std::memcmp(slot.key, key, length) == 0)
+        {
+            return slot.key;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // insert a copy of the key
+    char* storage = static_cast<char*>(m_storage.allocate(length + 1));
+    std::memcpy(storage, key, length);
+    storage[length] = '\0';
+
+    m_table[i].hash   = hash;
+    m_table[i].length = length;
+    m_table[i].key    = storage;
+    ++m_size;
+    return storage;
+}
+
+std::size_t KeyPool::get_size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+std::size_t KeyPool::get_bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_storage.get_used();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void KeyPool::grow()
+{
+    Slot empty = {0, 0, nullptr};
+    std::vector<Slot> table(m_table.size() * 2, empty);
+    std::size_t mask = table.size() - 1;
+    ARC_CONST_FOR_EACH(slot, m_table)
+    {
+        if(slot->key == nullptr)
+        {
+            continue;
+        }
+        std::size_t i = slot->hash & mask;
+        while(table[i].key != nullptr)
+        {
+            i = (i + 1) & mask;
+        }
+        table[i] = *slot;
+    }
+    m_table.swap(table);
+}
+
+} // namespace metaengine
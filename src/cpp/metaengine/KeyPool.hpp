@@ -0,0 +1,107 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_KEYPOOL_HPP_
+#define METAENGINE_KEYPOOL_HPP_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Arena.hpp"
+
+namespace metaengine
+{
+
+/*!
+ * \brief Intern table that the object keys of parsed JSON trees share storage
+ *        from.
+ *
+ * Each Document owns a KeyPool which is used for every tree it parses, so a
+ * Variant's default data, memory data, and each variant it loads all share a
+ * single copy of each key. Key storage is never released until the KeyPool is
+ * destroyed, and each ArenaTree keeps the KeyPool its keys came from alive.
+ *
+ * Interning is thread safe.
+ */
+class KeyPool : public Json::KeyInterner
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(KeyPool);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    KeyPool();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    // override
+    virtual const char* intern(const char* key, unsigned length);
+
+    /*!
+     * \brief Returns the number of unique keys in this pool.
+     */
+    std::size_t get_size() const;
+
+    /*!
+     * \brief Returns the number of bytes used to store the keys of this pool.
+     */
+    std::size_t get_bytes() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A slot of the hash table.
+     */
+    struct Slot
+    {
+        std::size_t hash;
+        unsigned length;
+        const char* key;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    mutable std::mutex m_mutex;
+    /*!
+     * \brief The storage of the keys.
+     */
+    Arena m_storage;
+    /*!
+     * \brief Open addressing hash table of the keys, the size is always a
+     *        power of two.
+     */
+    std::vector<Slot> m_table;
+    std::size_t m_size;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Doubles the size of the hash table.
+     */
+    void grow();
+};
+
+} // namespace metaengine
+
+#endif
@@ -0,0 +1,97 @@
+#include "metaengine/LoadReport.hpp"
+
+#include <algorithm>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Orders entries from the longest total wall time to the shortest.
+ */
+bool slower(const LoadReport::Entry& a, const LoadReport::Entry& b)
+{
+    return a.timings.total.wall_time > b.timings.total.wall_time;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+LoadReport::LoadReport()
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void LoadReport::add(
+        const arc::io::sys::Path& file_path,
+        const LoadTimings& timings)
+{
+    Entry e;
+    e.file_path = file_path;
+    e.timings   = timings;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.push_back(e);
+}
+
+std::vector<LoadReport::Entry> LoadReport::get_entries() const
+{
+    std::vector<Entry> ret;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ret = m_entries;
+    }
+    std::stable_sort(ret.begin(), ret.end(), slower);
+    return ret;
+}
+
+LoadTimings LoadReport::get_totals() const
+{
+    LoadTimings ret;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ARC_CONST_FOR_EACH(entry, m_entries)
+    {
+        for(std::size_t i = 0; i < LoadTimings::PHASE_COUNT; ++i)
+        {
+            ret.phases[i] += entry->timings.phases[i];
+        }
+        ret.total += entry->timings.total;
+    }
+    return ret;
+}
+
+arc::str::UTF8String LoadReport::to_json() const
+{
+    Json::Value root(Json::objectValue);
+    get_totals().write_json(root["totals"]);
+
+    Json::Value& loads = root["loads"] = Json::Value(Json::arrayValue);
+    std::vector<Entry> entries(get_entries());
+    ARC_CONST_FOR_EACH(entry, entries)
+    {
+        Json::Value& load = loads.append(Json::Value(Json::objectValue));
+        load["file_path"] = entry->file_path.to_unix().get_raw();
+        entry->timings.write_json(load);
+    }
+
+    Json::StyledWriter writer;
+    return arc::str::UTF8String(writer.write(root).c_str());
+}
+
+void LoadReport::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+} // namespace metaengine
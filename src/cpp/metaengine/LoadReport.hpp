@@ -0,0 +1,101 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_LOADREPORT_HPP_
+#define METAENGINE_LOADREPORT_HPP_
+
+#include <mutex>
+#include <vector>
+
+#include <arcanecore/io/sys/Path.hpp>
+
+#include "metaengine/LoadTimings.hpp"
+
+namespace metaengine
+{
+
+/*!
+ * \brief Collects the LoadTimings of every Document load in the process, e.g.
+ *        to report where start up time was spent.
+ *
+ * Once a LoadReport has been passed to Document::set_load_report(), every
+ * completed call to Document::reload() or Document::load_async() (including
+ * those made by constructors) adds an entry to the report. Adding entries is
+ * thread safe.
+ */
+class LoadReport
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(LoadReport);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                  STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The timings of a single load.
+     */
+    struct Entry
+    {
+        /*!
+         * \brief The file path of the Document that was loaded (empty if the
+         *        Document is only using memory).
+         */
+        arc::io::sys::Path file_path;
+        LoadTimings timings;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    LoadReport();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the timings of a load to this report.
+     */
+    void add(const arc::io::sys::Path& file_path, const LoadTimings& timings);
+
+    /*!
+     * \brief Returns a copy of the entries of this report, ordered from the
+     *        load with the longest total wall time to the shortest.
+     */
+    std::vector<Entry> get_entries() const;
+
+    /*!
+     * \brief Returns the sum of the timings of every entry in this report.
+     */
+    LoadTimings get_totals() const;
+
+    /*!
+     * \brief Exports the totals and the entries (in the order of
+     *        get_entries()) as a JSON string.
+     */
+    arc::str::UTF8String to_json() const;
+
+    /*!
+     * \brief Removes all entries from this report.
+     */
+    void clear();
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+};
+
+} // namespace metaengine
+
+#endif
@@ -0,0 +1,170 @@
+#include "metaengine/LoadTimings.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Converts a timing to a JSON value.
+ */
+Json::Value timing_to_json(const LoadTimings::Timing& timing)
+{
+    Json::Value ret(Json::objectValue);
+    ret["wall_time_ns"] = Json::UInt64(timing.wall_time);
+    ret["cpu_time_ns"]  = Json::UInt64(timing.cpu_time);
+    ret["bytes"]        = Json::UInt64(timing.bytes);
+    return ret;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                     TIMING
+//------------------------------------------------------------------------------
+
+LoadTimings::Timing::Timing()
+    :
+    wall_time(0),
+    cpu_time (0),
+    bytes    (0)
+{
+}
+
+LoadTimings::Timing& LoadTimings::Timing::operator+=(const Timing& other)
+{
+    wall_time += other.wall_time;
+    cpu_time  += other.cpu_time;
+    bytes     += other.bytes;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//                                     SCOPE
+//------------------------------------------------------------------------------
+
+LoadTimings::Scope::Scope(Timing& timing)
+    :
+    m_timing    (timing),
+    m_wall_start(std::chrono::steady_clock::now()),
+    m_cpu_start (get_thread_cpu_time())
+{
+}
+
+LoadTimings::Scope::~Scope()
+{
+    m_timing.cpu_time += get_thread_cpu_time() - m_cpu_start;
+    m_timing.wall_time += static_cast<arc::uint64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_wall_start
+        ).count()
+    );
+}
+
+void LoadTimings::Scope::add_bytes(std::size_t bytes)
+{
+    m_timing.bytes += bytes;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+const char* LoadTimings::get_phase_name(Phase phase)
+{
+    switch(phase)
+    {
+        case PHASE_READ:
+            return "read";
+        case PHASE_PARSE:
+            return "parse";
+        case PHASE_MEMORY_PARSE:
+            return "memory_parse";
+        case PHASE_VARIANT_READ:
+            return "variant_read";
+        case PHASE_VARIANT_PARSE:
+            return "variant_parse";
+        case PHASE_LAYER_READ:
+            return "layer_read";
+        case PHASE_LAYER_PARSE:
+            return "layer_parse";
+        case PHASE_VALIDATE:
+            return "validate";
+        default:
+            return "unknown";
+    }
+}
+
+arc::uint64 LoadTimings::get_thread_cpu_time()
+{
+    #ifdef _WIN32
+        FILETIME creation;
+        FILETIME exit;
+        FILETIME kernel;
+        FILETIME user;
+        if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        {
+            return 0;
+        }
+        ULARGE_INTEGER k;
+        k.LowPart  = kernel.dwLowDateTime;
+        k.HighPart = kernel.dwHighDateTime;
+        ULARGE_INTEGER u;
+        u.LowPart  = user.dwLowDateTime;
+        u.HighPart = user.dwHighDateTime;
+        // in 100 nanosecond intervals
+        return static_cast<arc::uint64>(k.QuadPart + u.QuadPart) * 100;
+    #else
+        timespec t;
+        if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0)
+        {
+            return 0;
+        }
+        return static_cast<arc::uint64>(t.tv_sec) * 1000000000ULL +
+               static_cast<arc::uint64>(t.tv_nsec);
+    #endif
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void LoadTimings::reset()
+{
+    for(std::size_t i = 0; i < PHASE_COUNT; ++i)
+    {
+        phases[i] = Timing();
+    }
+    total = Timing();
+}
+
+void LoadTimings::write_json(Json::Value& value) const
+{
+    value["total"] = timing_to_json(total);
+    Json::Value& phase_values = value["phases"] = Json::Value(Json::objectValue);
+    for(std::size_t i = 0; i < PHASE_COUNT; ++i)
+    {
+        phase_values[get_phase_name(static_cast<Phase>(i))] =
+            timing_to_json(phases[i]);
+    }
+}
+
+arc::str::UTF8String LoadTimings::to_json() const
+{
+    Json::Value root(Json::objectValue);
+    write_json(root);
+
+    Json::StyledWriter writer;
+    return arc::str::UTF8String(writer.write(root).c_str());
+}
+
+} // namespace metaengine
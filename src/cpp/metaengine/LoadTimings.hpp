@@ -0,0 +1,169 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_LOADTIMINGS_HPP_
+#define METAENGINE_LOADTIMINGS_HPP_
+
+#include <chrono>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+namespace Json
+{
+class Value;
+} // namespace Json
+
+namespace metaengine
+{
+
+/*!
+ * \brief Breakdown of where the time went the last time a Document was loaded.
+ *
+ * Every Document records these for each load, see
+ * Document::get_load_timings(). Each phase records the wall time, the CPU time
+ * of the thread performing the load, and the number of bytes that were
+ * processed. Recording costs a few clock reads per phase, so is always
+ * enabled.
+ */
+struct LoadTimings
+{
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The phases of loading a Document.
+     */
+    enum Phase
+    {
+        /// Reading the file from the file system, including validating it as
+        /// UTF-8 (and decoding it if it is not).
+        PHASE_READ = 0,
+        /// Parsing the data read from the file.
+        PHASE_PARSE,
+        /// Parsing the data in memory.
+        PHASE_MEMORY_PARSE,
+        /// Reading the files of a Variant's variants.
+        PHASE_VARIANT_READ,
+        /// Parsing the files of a Variant's variants.
+        PHASE_VARIANT_PARSE,
+        /// Reading the files of a Stack's layers.
+        PHASE_LAYER_READ,
+        /// Parsing the data of a Stack's layers.
+        PHASE_LAYER_PARSE,
+        /// Validating the data against the Document's Schema.
+        PHASE_VALIDATE,
+        /// The number of phases.
+        PHASE_COUNT
+    };
+
+    //--------------------------------------------------------------------------
+    //                                  STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The time spent in a single phase.
+     */
+    struct Timing
+    {
+        /// The wall time spent in nanoseconds.
+        arc::uint64 wall_time;
+        /// The CPU time spent in nanoseconds.
+        arc::uint64 cpu_time;
+        /// The number of bytes processed.
+        arc::uint64 bytes;
+
+        Timing();
+
+        Timing& operator+=(const Timing& other);
+    };
+
+    /*!
+     * \brief Adds the time spent between its construction and destruction to
+     *        a Timing.
+     */
+    class Scope
+    {
+    private:
+
+        ARC_DISALLOW_COPY_AND_ASSIGN(Scope);
+
+    public:
+
+        explicit Scope(Timing& timing);
+
+        ~Scope();
+
+        /*!
+         * \brief Adds to the number of bytes processed by the phase.
+         */
+        void add_bytes(std::size_t bytes);
+
+    private:
+
+        Timing& m_timing;
+        std::chrono::steady_clock::time_point m_wall_start;
+        arc::uint64 m_cpu_start;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PUBLIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The time spent in each phase.
+     *
+     * Variant phases accumulate each variant file that has been loaded since
+     * the Document was last loaded, including those loaded by
+     * Variant::set_variant().
+     */
+    Timing phases[PHASE_COUNT];
+    /*!
+     * \brief The time spent in the load as a whole.
+     */
+    Timing total;
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the name of the given phase, e.g. "read".
+     */
+    static const char* get_phase_name(Phase phase);
+
+    /*!
+     * \brief Returns the CPU time the calling thread has used in nanoseconds.
+     */
+    static arc::uint64 get_thread_cpu_time();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Resets all timings to zero.
+     */
+    void reset();
+
+    /*!
+     * \brief Writes the timings into the given JSON object value.
+     */
+    void write_json(Json::Value& value) const;
+
+    /*!
+     * \brief Exports the timings as a JSON string.
+     */
+    arc::str::UTF8String to_json() const;
+};
+
+} // namespace metaengine
+
+#endif
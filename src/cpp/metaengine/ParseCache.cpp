@@ -0,0 +1,189 @@
+#include "metaengine/ParseCache.hpp"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <limits.h>
+#endif
+
+#include "metaengine/Arena.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Computes two independent hashes of the data in a single pass.
+ *
+ * \param hash Set to the FNV-1a hash of the data.
+ * \param check Set to a multiplicative hash of the data which uses a
+ *              different multiplier and rotation, so is independent of the
+ *              FNV-1a hash.
+ */
+void hash_data(
+        const arc::str::UTF8String& data,
+        arc::uint64& hash,
+        arc::uint64& check)
+{
+    hash = 14695981039346656037ULL;
+    check = 0x243F6A8885A308D3ULL;
+    const char* c = data.get_raw();
+    const char* end = c + (data.get_byte_length() - 1);
+    for(; c != end; ++c)
+    {
+        arc::uint64 byte = static_cast<unsigned char>(*c);
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+        check = ((check << 5) | (check >> 59)) ^ byte;
+        check *= 0x9E3779B97F4A7C15ULL;
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+ParseCache::ParseCache()
+    :
+    m_hits(0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::str::UTF8String ParseCache::file_source(const arc::io::sys::Path& path)
+{
+    arc::str::UTF8String native(path.to_native());
+
+    // resolve the canonical path so that different paths to the same file
+    // share a source
+    #ifdef _WIN32
+        char resolved[MAX_PATH];
+        if(_fullpath(resolved, native.get_raw(), MAX_PATH) != nullptr)
+        {
+            return arc::str::UTF8String(resolved);
+        }
+    #else
+        char resolved[PATH_MAX];
+        if(realpath(native.get_raw(), resolved) != nullptr)
+        {
+            return arc::str::UTF8String(resolved);
+        }
+    #endif
+
+    return native;
+}
+
+arc::str::UTF8String ParseCache::memory_source(
+        const arc::str::UTF8String* memory)
+{
+    arc::str::UTF8String ret;
+    ret << "<memory:" << reinterpret_cast<arc::uint64>(memory) << ">";
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::shared_ptr<const ArenaTree> ParseCache::find(
+        const arc::str::UTF8String& source,
+        const arc::str::UTF8String& data)
+{
+    arc::uint64 hash = 0;
+    arc::uint64 check = 0;
+    hash_data(data, hash, check);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<arc::str::UTF8String, Entry>::iterator entry =
+        m_entries.find(source);
+    if(entry == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    // has the data changed since the entry was parsed? both hashes and the
+    // length would have to collide at once to share the wrong tree
+    if(entry->second.hash   != hash  ||
+       entry->second.check  != check ||
+       entry->second.length != data.get_byte_length() - 1)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<const ArenaTree> tree(entry->second.tree.lock());
+    if(tree == nullptr)
+    {
+        // no longer in use
+        m_entries.erase(entry);
+        return nullptr;
+    }
+    ++m_hits;
+    return tree;
+}
+
+void ParseCache::insert(
+        const arc::str::UTF8String& source,
+        const arc::str::UTF8String& data,
+        const std::shared_ptr<const ArenaTree>& tree)
+{
+    Entry e;
+    hash_data(data, e.hash, e.check);
+    e.length = data.get_byte_length() - 1;
+    e.tree = tree;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // discard the entries of trees that are no longer in use
+    std::map<arc::str::UTF8String, Entry>::iterator entry = m_entries.begin();
+    while(entry != m_entries.end())
+    {
+        if(entry->second.tree.expired())
+        {
+            entry = m_entries.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+
+    m_entries[source] = e;
+}
+
+std::size_t ParseCache::get_size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t ret = 0;
+    ARC_CONST_FOR_EACH(entry, m_entries)
+    {
+        if(!entry->second.tree.expired())
+        {
+            ++ret;
+        }
+    }
+    return ret;
+}
+
+arc::uint64 ParseCache::get_hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+void ParseCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_hits = 0;
+}
+
+} // namespace metaengine
@@ -0,0 +1,165 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_PARSECACHE_HPP_
+#define METAENGINE_PARSECACHE_HPP_
+
+#include <map>
+#include <memory>
+#include <cstddef>
+#include <mutex>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+#include <arcanecore/io/sys/Path.hpp>
+
+namespace metaengine
+{
+
+class ArenaTree;
+
+/*!
+ * \brief Cache of parsed JSON trees that is shared between every Document in
+ *        the process.
+ *
+ * While a ParseCache is set with Document::set_parse_cache(), every tree a
+ * Document (or Variant) parses is stored in the cache under the source it was
+ * loaded from (the canonical file path, or the address of the memory string)
+ * along with two independent 64-bit hashes and the length of the data that
+ * was parsed. Any other Document that then loads the same source with data
+ * that matches all three shares the existing tree instead of parsing its own
+ * copy, so parsing time and the memory used by parsed data scale with the
+ * number of distinct sources rather than the number of Documents.
+ *
+ * The cache holds a fixed size entry for each source rather than a copy of
+ * its data, so its own memory does not grow with the size of the sources.
+ * The trees it refers to do grow with the size of their sources, but are
+ * owned by the Documents that use them.
+ *
+ * Trees are immutable once parsed and reference-counted, the cache itself
+ * only holds weak references so a tree is released as soon as the last
+ * Document using it is reloaded or destroyed. If the data of a source
+ * changes, the next Document to load it parses the new data and replaces the
+ * entry, while Documents still holding the old tree keep using it until they
+ * are reloaded.
+ *
+ * \note Sources are still read (and hashed) by each Document, it is only the
+ *       parsing that is shared.
+ */
+class ParseCache
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(ParseCache);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    ParseCache();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the name that identifies the given file as a source.
+     *
+     * This is the canonical absolute path of the file if it can be resolved,
+     * else the path as given.
+     */
+    static arc::str::UTF8String file_source(const arc::io::sys::Path& path);
+
+    /*!
+     * \brief Returns the name that identifies the given memory string as a
+     *        source.
+     */
+    static arc::str::UTF8String memory_source(
+            const arc::str::UTF8String* memory);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the tree parsed from the given data of the source, or
+     *        null if there is no such tree in the cache.
+     */
+    std::shared_ptr<const ArenaTree> find(
+            const arc::str::UTF8String& source,
+            const arc::str::UTF8String& data);
+
+    /*!
+     * \brief Stores the tree parsed from the given data of the source,
+     *        replacing any existing entry for the source.
+     */
+    void insert(
+            const arc::str::UTF8String& source,
+            const arc::str::UTF8String& data,
+            const std::shared_ptr<const ArenaTree>& tree);
+
+    /*!
+     * \brief Returns the number of sources which have a tree in the cache that
+     *        is still in use.
+     */
+    std::size_t get_size() const;
+
+    /*!
+     * \brief Returns the number of times find() has returned a tree.
+     */
+    arc::uint64 get_hits() const;
+
+    /*!
+     * \brief Removes all entries from this cache.
+     *
+     * Documents sharing trees from the cache are unaffected.
+     */
+    void clear();
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The tree parsed from a source and the identity of the data it
+     *        was parsed from.
+     */
+    struct Entry
+    {
+        /*!
+         * \brief FNV-1a hash of the data.
+         */
+        arc::uint64 hash;
+        /*!
+         * \brief A second hash of the data, independent of the first so that
+         *        a collision of both is vanishingly unlikely.
+         */
+        arc::uint64 check;
+        /*!
+         * \brief The length of the data in bytes.
+         */
+        std::size_t length;
+        std::weak_ptr<const ArenaTree> tree;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    mutable std::mutex m_mutex;
+    /*!
+     * \brief The entries mapped by source.
+     */
+    std::map<arc::str::UTF8String, Entry> m_entries;
+    arc::uint64 m_hits;
+};
+
+} // namespace metaengine
+
+#endif
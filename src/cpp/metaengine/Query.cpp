@@ -0,0 +1,638 @@
+#include "metaengine/Query.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <arcanecore/base/Exceptions.hpp>
+#include <arcanecore/base/Preproc.hpp>
+
+namespace metaengine
+{
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    HELPERS
+//------------------------------------------------------------------------------
+
+/*!
+ * \brief Returns the child of the value with the given name, or null if there
+ *        is no such child (or it is null).
+ */
+const Json::Value* find_child(const Json::Value& value, const std::string& name)
+{
+    const Json::Value* child = nullptr;
+    Json::ArrayIndex index = 0;
+    if(value.isObject())
+    {
+        child = value.find(name.data(), name.data() + name.size());
+    }
+    else if(value.isArray() &&
+            Query::parse_index(name.data(), name.data() + name.size(), index) &&
+            index < value.size())
+    {
+        child = &value[index];
+    }
+    if(child == nullptr || child->isNull())
+    {
+        return nullptr;
+    }
+    return child;
+}
+
+/*!
+ * \brief Appends the name of a child to a key.
+ */
+void append_key(std::string& key, const char* begin, const char* end)
+{
+    if(!key.empty())
+    {
+        key += '.';
+    }
+    key.append(begin, end);
+}
+
+/*!
+ * \brief Compiles query expressions.
+ */
+class Compiler
+{
+public:
+
+    Compiler(const arc::str::UTF8String& expression)
+        :
+        m_expression(expression),
+        m_c         (expression.get_raw()),
+        m_end       (expression.get_raw() + expression.get_byte_length() - 1)
+    {
+    }
+
+    /*!
+     * \brief Returns the next character, or 0 at the end of the expression.
+     */
+    char peek() const
+    {
+        if(m_c == m_end)
+        {
+            return '\0';
+        }
+        return *m_c;
+    }
+
+    bool at_end() const
+    {
+        return m_c == m_end;
+    }
+
+    /*!
+     * \brief Consumes the given character if it is next.
+     */
+    bool accept(char c)
+    {
+        if(peek() == c && !at_end())
+        {
+            ++m_c;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if(!accept(c))
+        {
+            std::string message("expected '");
+            message += c;
+            message += "'";
+            fail(message.c_str());
+        }
+    }
+
+    void skip_whitespace()
+    {
+        while(peek() == ' ' || peek() == '\t')
+        {
+            ++m_c;
+        }
+    }
+
+    /*!
+     * \brief Reads a name, ending at any of the given characters.
+     */
+    std::string name(const char* terminators)
+    {
+        const char* begin = m_c;
+        while(!at_end())
+        {
+            bool terminate = false;
+            for(const char* t = terminators; *t != '\0'; ++t)
+            {
+                terminate |= *m_c == *t;
+            }
+            if(terminate)
+            {
+                break;
+            }
+            ++m_c;
+        }
+        if(begin == m_c)
+        {
+            fail("expected a name");
+        }
+        return std::string(begin, m_c);
+    }
+
+    /*!
+     * \brief Reads an optional signed integer, returning whether there was
+     *        one.
+     */
+    bool integer(long& value)
+    {
+        const char* begin = m_c;
+        accept('-');
+        if(peek() < '0' || peek() > '9')
+        {
+            m_c = begin;
+            return false;
+        }
+        while(peek() >= '0' && peek() <= '9')
+        {
+            ++m_c;
+        }
+        value = std::strtol(std::string(begin, m_c).c_str(), nullptr, 10);
+        return true;
+    }
+
+    /*!
+     * \brief Reads a JSON scalar literal.
+     */
+    Json::Value literal()
+    {
+        const char* begin = m_c;
+        if(accept('"'))
+        {
+            while(!at_end() && peek() != '"')
+            {
+                if(peek() == '\\')
+                {
+                    ++m_c;
+                }
+                if(!at_end())
+                {
+                    ++m_c;
+                }
+            }
+            expect('"');
+        }
+        else
+        {
+            while(!at_end() && peek() != ']' && peek() != ' ' &&
+                  peek() != '\t')
+            {
+                ++m_c;
+            }
+        }
+
+        Json::Value ret;
+        Json::Reader reader;
+        if(begin == m_c ||
+           !reader.parse(begin, m_c, ret, false) ||
+           ret.isObject() ||
+           ret.isArray())
+        {
+            m_c = begin;
+            fail("expected a number, string, true, false or null");
+        }
+        return ret;
+    }
+
+    /*!
+     * \brief Throws a ParseError for the current position.
+     */
+    void fail(const char* message)
+    {
+        arc::str::UTF8String error_message;
+        error_message << "Invalid query \"" << m_expression << "\" at column "
+                      << (m_c - m_expression.get_raw() + 1) << ": "
+                      << message;
+        throw arc::ex::ParseError(error_message);
+    }
+
+private:
+
+    const arc::str::UTF8String& m_expression;
+    const char* m_c;
+    const char* m_end;
+};
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Query::Query(const arc::str::UTF8String& expression)
+    :
+    m_expression(expression)
+{
+    Compiler compiler(m_expression);
+    if(compiler.at_end())
+    {
+        compiler.fail("the query is empty");
+    }
+
+    std::vector<Step> steps;
+    do
+    {
+        // the name or wildcard
+        if(compiler.accept('*'))
+        {
+            steps.push_back(Step(Step::TYPE_WILDCARD));
+        }
+        else
+        {
+            steps.push_back(Step(Step::TYPE_NAME));
+            Step& step = steps.back();
+            step.name = compiler.name(".[]");
+            step.is_index = parse_index(
+                step.name.data(),
+                step.name.data() + step.name.size(),
+                step.index
+            );
+        }
+
+        // selectors
+        while(compiler.accept('['))
+        {
+            if(compiler.accept('?'))
+            {
+                Step filter(Step::TYPE_FILTER);
+                Predicate& predicate = filter.predicate;
+                compiler.skip_whitespace();
+                if(!compiler.accept('@'))
+                {
+                    do
+                    {
+                        predicate.path.push_back(
+                            compiler.name(".[] \t=!<>"));
+                    }
+                    while(compiler.accept('.'));
+                }
+                compiler.skip_whitespace();
+
+                if(compiler.accept('='))
+                {
+                    compiler.expect('=');
+                    predicate.op = Predicate::OPERATOR_EQUAL;
+                }
+                else if(compiler.accept('!'))
+                {
+                    compiler.expect('=');
+                    predicate.op = Predicate::OPERATOR_NOT_EQUAL;
+                }
+                else if(compiler.accept('<'))
+                {
+                    predicate.op = compiler.accept('=') ?
+                        Predicate::OPERATOR_LESS_EQUAL :
+                        Predicate::OPERATOR_LESS;
+                }
+                else if(compiler.accept('>'))
+                {
+                    predicate.op = compiler.accept('=') ?
+                        Predicate::OPERATOR_GREATER_EQUAL :
+                        Predicate::OPERATOR_GREATER;
+                }
+                if(predicate.op != Predicate::OPERATOR_EXISTS)
+                {
+                    compiler.skip_whitespace();
+                    predicate.literal = compiler.literal();
+                    compiler.skip_whitespace();
+                }
+                compiler.expect(']');
+                steps.push_back(filter);
+                continue;
+            }
+
+            // an index or slice selects from the elements of the current
+            // value
+            Step slice(Step::TYPE_SLICE);
+            slice.has_start = compiler.integer(slice.start);
+            slice.single = !compiler.accept(':');
+            if(slice.single)
+            {
+                if(!slice.has_start)
+                {
+                    compiler.fail("expected an index, slice or predicate");
+                }
+            }
+            else
+            {
+                slice.has_end = compiler.integer(slice.end);
+                if(compiler.accept(':'))
+                {
+                    if(!compiler.integer(slice.stride) || slice.stride <= 0)
+                    {
+                        compiler.fail("expected a positive step");
+                    }
+                }
+            }
+            compiler.expect(']');
+            steps.push_back(slice);
+        }
+    }
+    while(compiler.accept('.'));
+
+    if(!compiler.at_end())
+    {
+        compiler.fail("unexpected character");
+    }
+
+    // the leading names are retrieved by key, but the last step is always
+    // matched so that the prefix is an object or array
+    std::size_t prefix_steps = 0;
+    std::string prefix;
+    while(prefix_steps + 1 < steps.size() &&
+          steps[prefix_steps].type == Step::TYPE_NAME)
+    {
+        const std::string& name = steps[prefix_steps].name;
+        append_key(prefix, name.data(), name.data() + name.size());
+        ++prefix_steps;
+    }
+    m_prefix = prefix.c_str();
+    m_steps.assign(steps.begin() + prefix_steps, steps.end());
+}
+
+Query::Step::Step(Type type_)
+    :
+    type     (type_),
+    is_index (false),
+    index    (0),
+    start    (0),
+    end      (0),
+    stride   (1),
+    has_start(false),
+    has_end  (false),
+    single   (false)
+{
+    predicate.op = Predicate::OPERATOR_EXISTS;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool Query::parse_index(
+        const char* begin,
+        const char* end,
+        Json::ArrayIndex& index)
+{
+    if(begin == end || (*begin == '0' && end - begin > 1))
+    {
+        return false;
+    }
+    arc::uint64 value = 0;
+    for(const char* c = begin; c != end; ++c)
+    {
+        if(*c < '0' || *c > '9')
+        {
+            return false;
+        }
+        value = value * 10 + static_cast<arc::uint64>(*c - '0');
+        // larger than any array
+        if(value > Json::Value::maxUInt)
+        {
+            return false;
+        }
+    }
+    index = static_cast<Json::ArrayIndex>(value);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+const arc::str::UTF8String& Query::get_expression() const
+{
+    return m_expression;
+}
+
+const arc::str::UTF8String& Query::get_prefix() const
+{
+    return m_prefix;
+}
+
+std::size_t Query::match(
+        const Json::Value* root,
+        const std::string& root_key,
+        const match_callback& callback) const
+{
+    if(root == nullptr)
+    {
+        return 0;
+    }
+    std::string key(root_key);
+    return match_step(0, *root, key, callback);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool Query::test(const Predicate& predicate, const Json::Value& value)
+{
+    const Json::Value* operand = &value;
+    ARC_CONST_FOR_EACH(name, predicate.path)
+    {
+        operand = find_child(*operand, *name);
+        if(operand == nullptr)
+        {
+            return false;
+        }
+    }
+
+    // values of different types are never equal or ordered
+    const Json::Value& literal = predicate.literal;
+    int compare = 0;
+    bool ordered = true;
+    bool comparable = true;
+    if(predicate.op == Predicate::OPERATOR_EXISTS)
+    {
+        return true;
+    }
+    else if(operand->isNumeric() && !operand->isBool() &&
+            literal.isNumeric() && !literal.isBool())
+    {
+        double a = operand->asDouble();
+        double b = literal.asDouble();
+        compare = a < b ? -1 : (b < a ? 1 : 0);
+    }
+    else if(operand->isString() && literal.isString())
+    {
+        compare = operand->compare(literal);
+    }
+    else if(operand->type() == literal.type())
+    {
+        compare = *operand == literal ? 0 : 1;
+        ordered = false;
+    }
+    else
+    {
+        comparable = false;
+        ordered = false;
+    }
+
+    switch(predicate.op)
+    {
+        case Predicate::OPERATOR_EQUAL:
+            return comparable && compare == 0;
+        case Predicate::OPERATOR_NOT_EQUAL:
+            return !comparable || compare != 0;
+        case Predicate::OPERATOR_LESS:
+            return ordered && compare < 0;
+        case Predicate::OPERATOR_LESS_EQUAL:
+            return ordered && compare <= 0;
+        case Predicate::OPERATOR_GREATER:
+            return ordered && compare > 0;
+        case Predicate::OPERATOR_GREATER_EQUAL:
+            return ordered && compare >= 0;
+        default:
+            return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::size_t Query::match_step(
+        std::size_t index,
+        const Json::Value& value,
+        std::string& key,
+        const match_callback& callback) const
+{
+    const Step& step = m_steps[index];
+    std::size_t key_length = key.size();
+    std::size_t matches = 0;
+
+    if(step.type == Step::TYPE_NAME)
+    {
+        const Json::Value* child = nullptr;
+        if(value.isObject())
+        {
+            child = value.find(
+                step.name.data(),
+                step.name.data() + step.name.size()
+            );
+        }
+        else if(value.isArray() && step.is_index && step.index < value.size())
+        {
+            child = &value[step.index];
+        }
+        if(child != nullptr && child->isNull())
+        {
+            child = nullptr;
+        }
+        if(child != nullptr)
+        {
+            append_key(
+                key,
+                step.name.data(),
+                step.name.data() + step.name.size()
+            );
+            matches += match_child(index, *child, key, callback);
+            key.resize(key_length);
+        }
+    }
+    else if(step.type != Step::TYPE_SLICE && value.isObject())
+    {
+        for(Json::Value::const_iterator member = value.begin();
+            member != value.end();
+            ++member)
+        {
+            if((*member).isNull() ||
+               (step.type == Step::TYPE_FILTER &&
+                !test(step.predicate, *member)))
+            {
+                continue;
+            }
+            const char* name_end = nullptr;
+            const char* name = member.memberName(&name_end);
+            append_key(key, name, name_end);
+            matches += match_child(index, *member, key, callback);
+            key.resize(key_length);
+        }
+    }
+    else if(value.isArray())
+    {
+        // wildcards and filters are the slice of every element
+        long size = static_cast<long>(value.size());
+        long start = 0;
+        long end = size;
+        long stride = 1;
+        if(step.type == Step::TYPE_SLICE)
+        {
+            start = step.has_start ? step.start : 0;
+            if(start < 0)
+            {
+                start += size;
+            }
+            stride = step.stride;
+            if(step.single)
+            {
+                if(start < 0 || start >= size)
+                {
+                    return 0;
+                }
+                end = start + 1;
+            }
+            else
+            {
+                end = step.has_end ? step.end : size;
+                if(end < 0)
+                {
+                    end += size;
+                }
+                start = std::max(0L, std::min(start, size));
+                end = std::max(0L, std::min(end, size));
+            }
+        }
+
+        char digits[24];
+        for(long i = start; i < end; i += stride)
+        {
+            const Json::Value& element =
+                value[static_cast<Json::ArrayIndex>(i)];
+            if(element.isNull() ||
+               (step.type == Step::TYPE_FILTER &&
+                !test(step.predicate, element)))
+            {
+                continue;
+            }
+            int length = std::snprintf(digits, sizeof(digits), "%ld", i);
+            append_key(key, digits, digits + length);
+            matches += match_child(index, element, key, callback);
+            key.resize(key_length);
+        }
+    }
+    return matches;
+}
+
+std::size_t Query::match_child(
+        std::size_t index,
+        const Json::Value& child,
+        std::string& key,
+        const match_callback& callback) const
+{
+    if(index + 1 < m_steps.size())
+    {
+        return match_step(index + 1, child, key, callback);
+    }
+    callback(&child, key);
+    return 1;
+}
+
+} // namespace metaengine
@@ -0,0 +1,258 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_QUERY_HPP_
+#define METAENGINE_QUERY_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+/*!
+ * \brief A compiled query that matches many values of a Document in a single
+ *        traversal, see Document::query().
+ *
+ * Queries extend the dotted keys used by Document::get() with:
+ *
+ * - ```*``` matches every member of an object or element of an array, e.g.
+ *   ```abilities.*.cooldown```.
+ * - ```[n]``` and ```[start:end:step]``` select the elements of an array by
+ *   index or slice, where negative indices count from the end and any part
+ *   of a slice may be omitted, e.g. ```levels[0]``` or ```levels[-3:]```.
+ * - ```[?path op literal]``` matches the members or elements for which the
+ *   value at the relative path compares to the JSON literal, where op is one
+ *   of ```==```, ```!=```, ```<```, ```<=```, ```>``` or ```>=``` and ```@```
+ *   is the path of the member or element itself, e.g.
+ *   ```items[?type == "weapon"].name``` or ```levels[?@ >= 10]```.
+ *   ```[?path]``` matches the members or elements that have a value at the
+ *   path.
+ *
+ * Elements of arrays are addressed by a numeric name, as they are by
+ * Document::get(), e.g. ```levels.0```. A query is compiled once when it is constructed and does
+ * not refer to the data of any Document, so the same Query can be run any
+ * number of times, on any Document, including after it has been reloaded.
+ */
+class Query
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Function called with each value matched by a query and its full
+     *        key.
+     */
+    typedef std::function<
+        void(const Json::Value* value, const std::string& key)>
+        match_callback;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Compiles the given query expression.
+     *
+     * \throws arc::ex::ParseError If the expression is not a valid query.
+     */
+    explicit Query(const arc::str::UTF8String& expression);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Parses the given element of a key as the index of an element of
+     *        an array.
+     *
+     * An index is a decimal number without a sign or leading zeros, so each
+     * element of an array has exactly one key.
+     *
+     * \return Whether the element is an index.
+     */
+    static bool parse_index(
+            const char* begin,
+            const char* end,
+            Json::ArrayIndex& index);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the expression this query was compiled from.
+     */
+    const arc::str::UTF8String& get_expression() const;
+
+    /*!
+     * \brief Returns the key of the value all matches of this query are
+     *        below, i.e. the leading names of the expression (which may be
+     *        empty).
+     *
+     * Document::query() retrieves the value at this key with the same rules
+     * as Document::get(), and then matches the rest of the query within it.
+     */
+    const arc::str::UTF8String& get_prefix() const;
+
+    /*!
+     * \brief Matches the parts of this query after the prefix within the
+     *        given value.
+     *
+     * \param root The value at the prefix of this query.
+     * \param root_key The key of the root value, used to build the full keys
+     *                 of the matches.
+     * \param callback Called with each matched value in the order of the data.
+     * \return The number of values matched.
+     */
+    std::size_t match(
+            const Json::Value* root,
+            const std::string& root_key,
+            const match_callback& callback) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A condition the values matched by a filter must meet.
+     */
+    struct Predicate
+    {
+        /*!
+         * \brief The comparison operators.
+         */
+        enum Operator
+        {
+            /// The value at the path exists.
+            OPERATOR_EXISTS = 0,
+            OPERATOR_EQUAL,
+            OPERATOR_NOT_EQUAL,
+            OPERATOR_LESS,
+            OPERATOR_LESS_EQUAL,
+            OPERATOR_GREATER,
+            OPERATOR_GREATER_EQUAL
+        };
+
+        /*!
+         * \brief The names of the path relative to the matched value, empty
+         *        for the value itself.
+         */
+        std::vector<std::string> path;
+        Operator op;
+        /*!
+         * \brief The literal the value at the path is compared to.
+         */
+        Json::Value literal;
+    };
+
+    /*!
+     * \brief A step of the query, which selects some of the children of each
+     *        value matched by the previous step.
+     */
+    struct Step
+    {
+        /*!
+         * \brief The kinds of step.
+         */
+        enum Type
+        {
+            /// A member of an object, or element of an array by a numeric
+            /// name.
+            TYPE_NAME = 0,
+            /// Every member or element.
+            TYPE_WILDCARD,
+            /// The members or elements which meet a predicate.
+            TYPE_FILTER,
+            /// The elements of an array within a slice.
+            TYPE_SLICE
+        };
+
+        Type type;
+        std::string name;
+        /*!
+         * \brief Whether the name is an index, which is parsed when the query
+         *        is compiled.
+         */
+        bool is_index;
+        Json::ArrayIndex index;
+        Predicate predicate;
+        /*!
+         * \brief The slice, for TYPE_SLICE. A single index is a slice of one
+         *        element.
+         */
+        long start;
+        long end;
+        long stride;
+        bool has_start;
+        bool has_end;
+        /*!
+         * \brief Whether the slice is a single index, which is not clamped.
+         */
+        bool single;
+
+        explicit Step(Type type_);
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    arc::str::UTF8String m_expression;
+    arc::str::UTF8String m_prefix;
+    /*!
+     * \brief The steps after the prefix.
+     */
+    std::vector<Step> m_steps;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether the value meets the predicate.
+     */
+    static bool test(const Predicate& predicate, const Json::Value& value);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Matches the step with the given index within the value.
+     *
+     * \param key The key of the value, children are appended to it and
+     *            removed again.
+     */
+    std::size_t match_step(
+            std::size_t index,
+            const Json::Value& value,
+            std::string& key,
+            const match_callback& callback) const;
+
+    /*!
+     * \brief Continues matching from the step after the given index within
+     *        the child.
+     */
+    std::size_t match_child(
+            std::size_t index,
+            const Json::Value& child,
+            std::string& key,
+            const match_callback& callback) const;
+};
+
+} // namespace metaengine
+
+#endif
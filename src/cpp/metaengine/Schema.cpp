@@ -0,0 +1,125 @@
+#include "metaengine/Schema.hpp"
+
+#include <arcanecore/base/Preproc.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Diagnostic.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Returns whether a single value matches the type of a scalar, and if
+ *        not the name of the expected type.
+ */
+bool matches_scalar(
+        Schema::Type type,
+        const Json::Value& value,
+        const char*& expected_type)
+{
+    switch(type)
+    {
+        case Schema::TYPE_BOOL:
+        case Schema::TYPE_BOOL_ARRAY:
+            expected_type = "boolean";
+            return value.isBool();
+        case Schema::TYPE_INT:
+        case Schema::TYPE_INT_ARRAY:
+            expected_type = "integral";
+            return value.isInt();
+        case Schema::TYPE_FLOAT:
+        case Schema::TYPE_FLOAT_ARRAY:
+            expected_type = "floating point";
+            return value.isDouble();
+        case Schema::TYPE_STRING:
+        case Schema::TYPE_STRING_ARRAY:
+            expected_type = "UTF-8 string";
+            return value.isString();
+    }
+    return false;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Schema::Schema()
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool Schema::matches(
+        Type type,
+        const Json::Value& value,
+        Diagnostic& diagnostic)
+{
+    const char* expected_type = nullptr;
+    if(type < TYPE_BOOL_ARRAY)
+    {
+        if(!matches_scalar(type, value, expected_type))
+        {
+            diagnostic.set_type_mismatch(&value, expected_type);
+            return false;
+        }
+        return true;
+    }
+
+    if(!value.isArray())
+    {
+        diagnostic.set_type_mismatch(&value, "array");
+        return false;
+    }
+    std::size_t index = 0;
+    Json::Value::const_iterator child;
+    for(child = value.begin(); child != value.end(); ++child, ++index)
+    {
+        if(!matches_scalar(type, *child, expected_type))
+        {
+            diagnostic.set_element_type_mismatch(
+                &(*child),
+                index,
+                expected_type
+            );
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+Schema& Schema::add(const arc::str::UTF8String& key, Type type)
+{
+    ARC_FOR_EACH(entry, m_entries)
+    {
+        if(entry->key == key)
+        {
+            entry->type = type;
+            return *this;
+        }
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.type = type;
+    m_entries.push_back(entry);
+    return *this;
+}
+
+const std::vector<Schema::Entry>& Schema::get_entries() const
+{
+    return m_entries;
+}
+
+} // namespace metaengine
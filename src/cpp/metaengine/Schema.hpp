@@ -0,0 +1,132 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_SCHEMA_HPP_
+#define METAENGINE_SCHEMA_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+//------------------------------------------------------------------------------
+//                              FORWARD DECLARATIONS
+//------------------------------------------------------------------------------
+
+namespace Json
+{
+class Value;
+} // namespace Json
+
+namespace metaengine
+{
+
+class Diagnostic;
+
+/*!
+ * \brief Describes the types of the values at known keys of a Document.
+ *
+ * A Schema attached to a Document (see Document::set_schema()) is validated
+ * against the data each time the Document is loaded. If a value in the file
+ * system data does not match its schema type the fallback is reported once
+ * during the load rather than on each get, and the memory data is validated
+ * instead. Retrieving a key whose value was proven to match lets the built-in
+ * Visitors skip checking the type of the value (and every element of
+ * arrays), see Diagnostic::is_proven().
+ */
+class Schema
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The types values can be declared as, each of which matches the
+     *        values accepted by one of the built-in Visitors.
+     */
+    enum Type
+    {
+        /// See BoolV.
+        TYPE_BOOL = 0,
+        /// See IntV.
+        TYPE_INT,
+        /// See FloatV.
+        TYPE_FLOAT,
+        /// See UTF8StringV.
+        TYPE_STRING,
+        /// See BoolVectorV.
+        TYPE_BOOL_ARRAY,
+        /// See IntVectorV.
+        TYPE_INT_ARRAY,
+        /// See FloatVectorV.
+        TYPE_FLOAT_ARRAY,
+        /// See UTF8StringVectorV.
+        TYPE_STRING_ARRAY
+    };
+
+    //--------------------------------------------------------------------------
+    //                                  STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The type declared for a key.
+     */
+    struct Entry
+    {
+        arc::str::UTF8String key;
+        Type type;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    Schema();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether the JSON value matches the given type.
+     *
+     * \param diagnostic Used to describe why the value does not match.
+     */
+    static bool matches(
+            Type type,
+            const Json::Value& value,
+            Diagnostic& diagnostic);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Declares the type of the value at the given key, replacing any
+     *        type already declared for the key.
+     *
+     * \return A reference to this Schema so that declarations can be chained.
+     */
+    Schema& add(const arc::str::UTF8String& key, Type type);
+
+    /*!
+     * \brief Returns the declared types in the order they were first
+     *        declared.
+     */
+    const std::vector<Entry>& get_entries() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    std::vector<Entry> m_entries;
+};
+
+} // namespace metaengine
+
+#endif
@@ -0,0 +1,699 @@
+#include "metaengine/SectionParser.hpp"
+
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "metaengine/KeyPool.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief Parameters of the FNV-1a hash of section data.
+ */
+const arc::uint64 HASH_OFFSET = 14695981039346656037ULL;
+const arc::uint64 HASH_PRIME = 1099511628211ULL;
+
+/*!
+ * \brief The deepest nesting of containers that is scanned, matching the
+ *        limit of Json::Reader.
+ */
+const std::size_t MAX_DEPTH = 1000;
+
+/*!
+ * \brief Adds the bytes to the hash.
+ */
+inline void hash_bytes(arc::uint64& hash, const char* begin, const char* end)
+{
+    for(; begin != end; ++begin)
+    {
+        hash ^= static_cast<unsigned char>(*begin);
+        hash *= HASH_PRIME;
+    }
+}
+
+/*!
+ * \brief Adds the hash of a nested value to the hash.
+ */
+inline void hash_value(arc::uint64& hash, arc::uint64 value)
+{
+    for(std::size_t i = 0; i < 8; ++i)
+    {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= HASH_PRIME;
+    }
+}
+
+/*!
+ * \brief Returns whether the sections were parsed from the same data.
+ */
+bool is_same(
+        const std::vector<ArenaTree::Section>& a,
+        const std::vector<ArenaTree::Section>& b)
+{
+    if(a.size() != b.size())
+    {
+        return false;
+    }
+    for(std::size_t i = 0; i < a.size(); ++i)
+    {
+        // sections which share a tree are the same, otherwise the same data
+        // may still have been built twice (e.g. if it is repeated)
+        if(a[i].tree != b[i].tree &&
+           (a[i].hash    != b[i].hash    ||
+            a[i].length  != b[i].length  ||
+            a[i].content != b[i].content ||
+            !is_same(a[i].tree->get_sections(), b[i].tree->get_sections())))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Returns whether the character ends a number or literal.
+ */
+inline bool is_delimiter(char c)
+{
+    switch(c)
+    {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+        case ',':
+        case ':':
+        case ']':
+        case '}':
+        case '[':
+        case '{':
+        case '"':
+        case '/':
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                PRIVATE CLASSES
+//------------------------------------------------------------------------------
+
+struct SectionParser::Member
+{
+    /*!
+     * \brief The raw key between its quotes, null for an element of an array.
+     */
+    const char* key_begin;
+    const char* key_end;
+    /*!
+     * \brief Whether the key contains escape sequences.
+     */
+    bool key_escaped;
+    const char* value_begin;
+    const char* value_end;
+    /*!
+     * \brief The section the value is built as, or null if the value is
+     *        parsed as a whole.
+     */
+    std::unique_ptr<Node> section;
+};
+
+struct SectionParser::Node
+{
+    std::size_t length;
+    /*!
+     * \brief The length and hash of the data excluding whitespace and
+     *        comments, which identify the section.
+     */
+    std::size_t content_length;
+    arc::uint64 hash;
+    /*!
+     * \brief The data excluding whitespace, comments and the data of the
+     *        sections within it.
+     */
+    std::string content;
+    /*!
+     * \brief The length of the data excluding the sections within it.
+     */
+    std::size_t own_length;
+    bool object;
+    std::vector<Member> members;
+};
+
+class SectionParser::Scanner
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    Scanner(const char* begin, const char* end, std::size_t section_size)
+        :
+        m_end         (end),
+        m_section_size(section_size)
+    {
+        // the content can't be any longer than the data
+        m_content.reserve(static_cast<std::size_t>(end - begin));
+    }
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Skips whitespace and comments.
+     *
+     * \return False if a comment is not terminated.
+     */
+    bool skip_space(const char*& c) const
+    {
+        while(c != m_end)
+        {
+            if(*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+            {
+                ++c;
+            }
+            else if(*c == '/')
+            {
+                if(m_end - c < 2)
+                {
+                    return false;
+                }
+                if(c[1] == '/')
+                {
+                    while(c != m_end && *c != '\n' && *c != '\r')
+                    {
+                        ++c;
+                    }
+                }
+                else if(c[1] == '*')
+                {
+                    c += 2;
+                    while(true)
+                    {
+                        if(m_end - c < 2)
+                        {
+                            return false;
+                        }
+                        if(c[0] == '*' && c[1] == '/')
+                        {
+                            c += 2;
+                            break;
+                        }
+                        ++c;
+                    }
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return true;
+            }
+        }
+        return true;
+    }
+
+    /*!
+     * \brief Scans the value at c, leaving c at the end of it.
+     *
+     * \param hash Returns the hash of the value.
+     * \param content_length Returns the length of the value excluding
+     *                       whitespace and comments.
+     * \param node Returns the node of the value if it is a section.
+     * \return False if the value is malformed.
+     */
+    bool scan_value(
+            const char*& c,
+            arc::uint64& hash,
+            std::size_t& content_length,
+            std::unique_ptr<Node>& node,
+            std::size_t depth)
+    {
+        hash = HASH_OFFSET;
+        content_length = 0;
+        const char* begin = c;
+        if(c == m_end)
+        {
+            return false;
+        }
+
+        // scalars are validated when they are parsed
+        if(*c == '"')
+        {
+            bool escaped = false;
+            if(!scan_string(c, escaped))
+            {
+                return false;
+            }
+            add_content(hash, begin, c);
+            content_length = static_cast<std::size_t>(c - begin);
+            return true;
+        }
+        if(*c != '{' && *c != '[')
+        {
+            while(c != m_end && !is_delimiter(*c))
+            {
+                ++c;
+            }
+            add_content(hash, begin, c);
+            content_length = static_cast<std::size_t>(c - begin);
+            return c != begin;
+        }
+
+        if(depth >= MAX_DEPTH)
+        {
+            return false;
+        }
+        // the content of the container is appended to the end of the content
+        // of the containers it is within, until it is known to be a section
+        std::size_t content_begin = m_content.size();
+        bool object = *c == '{';
+        char close = object ? '}' : ']';
+        add_content(hash, c, c + 1);
+        ++content_length;
+        ++c;
+
+        // the members of this container are added to the end of the scratch
+        // list, which the members of any nested container are removed from
+        // once they have been scanned
+        std::size_t first = m_scratch.size();
+        std::size_t section_length = 0;
+        if(!skip_space(c) || c == m_end)
+        {
+            return false;
+        }
+        if(*c != close)
+        {
+            while(true)
+            {
+                Member member;
+                member.key_begin = nullptr;
+                member.key_end = nullptr;
+                member.key_escaped = false;
+                if(object)
+                {
+                    const char* key = c;
+                    if(c == m_end ||
+                       *c != '"' ||
+                       !scan_string(c, member.key_escaped))
+                    {
+                        return false;
+                    }
+                    add_content(hash, key, c);
+                    content_length += static_cast<std::size_t>(c - key);
+                    member.key_begin = key + 1;
+                    member.key_end = c - 1;
+
+                    if(!skip_space(c) || c == m_end || *c != ':')
+                    {
+                        return false;
+                    }
+                    ++c;
+                    if(!skip_space(c))
+                    {
+                        return false;
+                    }
+                }
+
+                member.value_begin = c;
+                member.value_end = c;
+                std::size_t index = m_scratch.size();
+                m_scratch.push_back(std::move(member));
+
+                arc::uint64 value_hash = 0;
+                std::size_t value_length = 0;
+                std::unique_ptr<Node> section;
+                if(!scan_value(
+                        c,
+                        value_hash,
+                        value_length,
+                        section,
+                        depth + 1))
+                {
+                    return false;
+                }
+                hash_value(hash, value_hash);
+                content_length += value_length;
+                if(section != nullptr)
+                {
+                    section_length += section->length;
+                }
+                m_scratch[index].value_end = c;
+                m_scratch[index].section = std::move(section);
+
+                if(!skip_space(c) || c == m_end)
+                {
+                    return false;
+                }
+                if(*c == close)
+                {
+                    break;
+                }
+                if(*c != ',')
+                {
+                    return false;
+                }
+                add_content(hash, c, c + 1);
+                ++content_length;
+                ++c;
+                if(!skip_space(c))
+                {
+                    return false;
+                }
+            }
+        }
+        add_content(hash, c, c + 1);
+        ++content_length;
+        ++c;
+
+        std::size_t length = static_cast<std::size_t>(c - begin);
+        if(length >= m_section_size)
+        {
+            node.reset(new Node());
+            node->length = length;
+            node->content_length = content_length;
+            node->hash = hash;
+            node->own_length = length - section_length;
+            node->content.assign(m_content, content_begin, std::string::npos);
+            m_content.resize(content_begin);
+            node->object = object;
+            node->members.assign(
+                std::make_move_iterator(m_scratch.begin() + first),
+                std::make_move_iterator(m_scratch.end())
+            );
+        }
+        m_scratch.erase(m_scratch.begin() + first, m_scratch.end());
+        return true;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    const char* m_end;
+    std::size_t m_section_size;
+    /*!
+     * \brief The members of the containers currently being scanned.
+     */
+    std::vector<Member> m_scratch;
+    /*!
+     * \brief The content of the containers currently being scanned.
+     */
+    std::string m_content;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the bytes to the hash and to the content of the container
+     *        being scanned.
+     */
+    void add_content(arc::uint64& hash, const char* begin, const char* end)
+    {
+        hash_bytes(hash, begin, end);
+        m_content.append(begin, end);
+    }
+
+    /*!
+     * \brief Scans the string starting at the quote at c, leaving c after the
+     *        closing quote.
+     *
+     * \param escaped Returns whether the string contains escape sequences.
+     */
+    bool scan_string(const char*& c, bool& escaped) const
+    {
+        ++c;
+        while(c != m_end)
+        {
+            if(*c == '"')
+            {
+                ++c;
+                return true;
+            }
+            if(*c == '\\')
+            {
+                escaped = true;
+                if(m_end - c < 2)
+                {
+                    return false;
+                }
+                ++c;
+            }
+            ++c;
+        }
+        return false;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC ATTRIBUTES
+//------------------------------------------------------------------------------
+
+const std::size_t SectionParser::DEFAULT_SECTION_SIZE = 4 * 1024;
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+SectionParser::SectionParser(
+        const std::shared_ptr<KeyPool>& key_pool,
+        std::size_t section_size)
+    :
+    m_key_pool    (key_pool),
+    m_section_size(section_size),
+    m_shared      (0),
+    m_built       (0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+SectionParser::~SectionParser()
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void SectionParser::add_previous(const std::shared_ptr<const ArenaTree>& tree)
+{
+    if(tree == nullptr)
+    {
+        return;
+    }
+    m_previous.push_back(tree);
+    index_sections(*tree);
+}
+
+std::shared_ptr<const ArenaTree> SectionParser::parse(
+        const char* begin,
+        const char* end)
+{
+    m_shared = 0;
+    m_built = 0;
+
+    // find the sections
+    std::unique_ptr<Node> root;
+    {
+        Scanner scanner(begin, end, m_section_size);
+        const char* c = begin;
+        arc::uint64 hash = 0;
+        std::size_t content_length = 0;
+        if(!scanner.skip_space(c) ||
+           !scanner.scan_value(c, hash, content_length, root, 0))
+        {
+            return nullptr;
+        }
+    }
+    if(root == nullptr)
+    {
+        return nullptr;
+    }
+
+    // the root of the tree refers to the section of the root value
+    ArenaTree::Section section;
+    if(!resolve_section(*root, section))
+    {
+        return nullptr;
+    }
+    std::shared_ptr<ArenaTree> tree(new ArenaTree(0, m_key_pool));
+    tree->get_root()->sharePayload(*section.tree->get_root());
+    tree->add_section(section);
+    return tree;
+}
+
+std::size_t SectionParser::get_shared() const
+{
+    return m_shared;
+}
+
+std::size_t SectionParser::get_built() const
+{
+    return m_built;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void SectionParser::index_sections(const ArenaTree& tree)
+{
+    ARC_CONST_FOR_EACH(section, tree.get_sections())
+    {
+        m_index.insert(std::make_pair(section->hash, &(*section)));
+        index_sections(*section->tree);
+    }
+}
+
+bool SectionParser::resolve_section(Node& node, ArenaTree::Section& section)
+{
+    // if this section is shared then so are the sections within it, which
+    // only count as part of it
+    std::size_t shared = m_shared;
+    std::vector<ArenaTree::Section> sections;
+    ARC_FOR_EACH(member, node.members)
+    {
+        if(member->section != nullptr)
+        {
+            sections.push_back(ArenaTree::Section());
+            if(!resolve_section(*member->section, sections.back()))
+            {
+                return false;
+            }
+        }
+    }
+
+    section.length = node.content_length;
+    section.hash = node.hash;
+    section.content.swap(node.content);
+
+    // has the same data been built before? the hash only finds a candidate,
+    // the data must match exactly
+    std::unordered_map<arc::uint64, const ArenaTree::Section*>::const_iterator
+        previous = m_index.find(node.hash);
+    if(previous != m_index.end() &&
+       previous->second->length == section.length &&
+       previous->second->content == section.content &&
+       is_same(previous->second->tree->get_sections(), sections))
+    {
+        section.tree = previous->second->tree;
+        m_shared = shared + 1;
+        return true;
+    }
+
+    std::shared_ptr<ArenaTree> built(
+        new ArenaTree(node.own_length, m_key_pool));
+    {
+        Json::MemoryResource::Scope scope(&built->get_arena());
+        Json::KeyInterner::Scope key_scope(m_key_pool.get());
+        if(!build_container(node, sections, *built->get_root(), *built))
+        {
+            return false;
+        }
+    }
+    section.tree = built;
+    ++m_built;
+    return true;
+}
+
+bool SectionParser::build_container(
+        const Node& node,
+        const std::vector<ArenaTree::Section>& sections,
+        Json::Value& value,
+        ArenaTree& tree)
+{
+    if(node.object)
+    {
+        Json::Value init(Json::objectValue);
+        value.swapPayload(init);
+    }
+    else
+    {
+        Json::Value init(Json::arrayValue);
+        value.swapPayload(init);
+        value.resize(static_cast<Json::ArrayIndex>(node.members.size()));
+    }
+
+    // the members of a container are nodes of a map so do not move as later
+    // members are added
+    std::vector<ArenaTree::Section>::const_iterator section = sections.begin();
+    for(std::size_t i = 0; i < node.members.size(); ++i)
+    {
+        const Member& member = node.members[i];
+
+        Json::Value* slot = nullptr;
+        if(node.object)
+        {
+            const char* key_begin = member.key_begin;
+            const char* key_end = member.key_end;
+            Json::Value decoded;
+            if(member.key_escaped)
+            {
+                if(!m_reader.parse(
+                        member.key_begin - 1,
+                        member.key_end + 1,
+                        decoded,
+                        false) ||
+                   !decoded.getString(&key_begin, &key_end))
+                {
+                    return false;
+                }
+            }
+
+            // a duplicate key would have to replace a value which may refer
+            // to a section
+            Json::ArrayIndex size = value.size();
+            slot = const_cast<Json::Value*>(value.demand(key_begin, key_end));
+            if(value.size() == size)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            slot = &value[static_cast<Json::ArrayIndex>(i)];
+        }
+
+        if(member.section != nullptr)
+        {
+            slot->sharePayload(*section->tree->get_root());
+            tree.add_section(*section);
+            ++section;
+        }
+        else
+        {
+            // the value must span the whole of its data, since anything that
+            // follows it would be ignored
+            if(!m_reader.parse(
+                    member.value_begin,
+                    member.value_end,
+                    *slot,
+                    false) ||
+               slot->getOffsetLimit() != member.value_end - member.value_begin)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace metaengine
@@ -0,0 +1,195 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_SECTIONPARSER_HPP_
+#define METAENGINE_SECTIONPARSER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Arena.hpp"
+
+namespace metaengine
+{
+
+class KeyPool;
+
+/*!
+ * \brief Parses JSON data into an ArenaTree that shares unchanged subtrees
+ *        with previously parsed trees.
+ *
+ * Every object or array whose data is at least the section size is built
+ * into an ArenaTree of its own (an ArenaTree::Section) which the containing
+ * tree refers to rather than copies. Sections are found by the length and a
+ * hash of their data, ignoring whitespace and comments, so when the data is
+ * parsed again any section whose data is unchanged is shared from the
+ * previous tree instead of being built, and the values within it keep their
+ * addresses. A match on the hash is only trusted once the data has been
+ * compared, so each section keeps the data that is not part of the sections
+ * within it, which means the sections of a tree hold a copy of its data
+ * (without whitespace and comments). Only the sections that contain a change are built again,
+ * along with the small values directly inside them, so the cost of parsing
+ * edited data scales with the size of the edit rather than the size of the
+ * data (although the data is still scanned as a whole to find the sections).
+ */
+class SectionParser
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(SectionParser);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The default size in bytes of the smallest subtree that is built
+     *        as a section.
+     */
+    static const std::size_t DEFAULT_SECTION_SIZE;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new parser.
+     *
+     * \param key_pool The pool the keys of parsed trees are interned in (may
+     *                 be null).
+     * \param section_size The size in bytes of the smallest subtree that is
+     *                     built as a section.
+     */
+    explicit SectionParser(
+            const std::shared_ptr<KeyPool>& key_pool,
+            std::size_t section_size = DEFAULT_SECTION_SIZE);
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    ~SectionParser();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Allows the sections of the given tree to be shared by the trees
+     *        this parser parses.
+     *
+     * The parser keeps the tree alive.
+     */
+    void add_previous(const std::shared_ptr<const ArenaTree>& tree);
+
+    /*!
+     * \brief Parses the data into a new tree.
+     *
+     * \return The parsed tree, or null if the data has no sections or cannot
+     *         be parsed in sections (e.g. it is not valid JSON, or an object
+     *         in it has duplicate keys), in which case it should be parsed as
+     *         a whole instead.
+     */
+    std::shared_ptr<const ArenaTree> parse(const char* begin, const char* end);
+
+    /*!
+     * \brief Returns the number of sections the last call to parse() shared
+     *        from previous trees.
+     */
+    std::size_t get_shared() const;
+
+    /*!
+     * \brief Returns the number of sections the last call to parse() built.
+     */
+    std::size_t get_built() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE CLASSES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The location of a section within the data, see Scanner.
+     */
+    struct Node;
+
+    /*!
+     * \brief A member of an object, or element of an array, within a Node.
+     */
+    struct Member;
+
+    /*!
+     * \brief Finds the sections of the data.
+     */
+    class Scanner;
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    std::shared_ptr<KeyPool> m_key_pool;
+    std::size_t m_section_size;
+    /*!
+     * \brief The trees that sections may be shared from.
+     */
+    std::vector<std::shared_ptr<const ArenaTree>> m_previous;
+    /*!
+     * \brief The sections of the previous trees mapped by hash.
+     */
+    std::unordered_map<arc::uint64, const ArenaTree::Section*> m_index;
+    /*!
+     * \brief Reader used to parse the values which are not sections.
+     */
+    Json::Reader m_reader;
+    std::size_t m_shared;
+    std::size_t m_built;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds the sections of the tree, and of those sections, to the
+     *        index.
+     */
+    void index_sections(const ArenaTree& tree);
+
+    /*!
+     * \brief Returns the section for the node, either shared from a previous
+     *        tree or newly built.
+     *
+     * The sections within the node are resolved first, since the section can
+     * only be shared if they are identical too.
+     *
+     * \return False if the section could not be built.
+     */
+    bool resolve_section(Node& node, ArenaTree::Section& section);
+
+    /*!
+     * \brief Builds the container of the node into the null value, making the
+     *        members which are sections refer to the given sections (in the
+     *        order of the members) and adding them to the tree.
+     *
+     * \return False if the container could not be built.
+     */
+    bool build_container(
+            const Node& node,
+            const std::vector<ArenaTree::Section>& sections,
+            Json::Value& value,
+            ArenaTree& tree);
+};
+
+} // namespace metaengine
+
+#endif
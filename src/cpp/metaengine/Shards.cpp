@@ -0,0 +1,439 @@
+#include "metaengine/Shards.hpp"
+
+#include <string>
+
+#include "metaengine/KeyPool.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The deepest nesting of containers that is scanned, matching the
+ *        limit of Json::Reader.
+ */
+const std::size_t MAX_DEPTH = 1000;
+
+/*!
+ * \brief Returns whether the character ends a number or literal.
+ */
+inline bool is_delimiter(char c)
+{
+    switch(c)
+    {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+        case ',':
+        case ':':
+        case ']':
+        case '}':
+        case '[':
+        case '{':
+        case '"':
+        case '/':
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*!
+ * \brief Skips whitespace and comments.
+ *
+ * \return False if a comment is not terminated.
+ */
+bool skip_space(const char*& c, const char* end)
+{
+    while(c != end)
+    {
+        if(*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+        {
+            ++c;
+        }
+        else if(*c == '/')
+        {
+            if(end - c < 2)
+            {
+                return false;
+            }
+            if(c[1] == '/')
+            {
+                while(c != end && *c != '\n' && *c != '\r')
+                {
+                    ++c;
+                }
+            }
+            else if(c[1] == '*')
+            {
+                c += 2;
+                while(true)
+                {
+                    if(end - c < 2)
+                    {
+                        return false;
+                    }
+                    if(c[0] == '*' && c[1] == '/')
+                    {
+                        c += 2;
+                        break;
+                    }
+                    ++c;
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return true;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Skips the string starting at the quote at c, leaving c after the
+ *        closing quote.
+ *
+ * \param escaped Set to true if the string contains escape sequences.
+ */
+bool skip_string(const char*& c, const char* end, bool& escaped)
+{
+    ++c;
+    while(c != end)
+    {
+        if(*c == '"')
+        {
+            ++c;
+            return true;
+        }
+        if(*c == '\\')
+        {
+            escaped = true;
+            if(end - c < 2)
+            {
+                return false;
+            }
+            ++c;
+        }
+        ++c;
+    }
+    return false;
+}
+
+/*!
+ * \brief Skips the value at c, leaving c at the end of it.
+ *
+ * Only the structure of containers is checked, the value is validated when it
+ * is parsed.
+ *
+ * \return False if the structure of the value is malformed.
+ */
+bool skip_value(const char*& c, const char* end)
+{
+    if(c == end)
+    {
+        return false;
+    }
+    if(*c == '"')
+    {
+        bool escaped = false;
+        return skip_string(c, end, escaped);
+    }
+    if(*c != '{' && *c != '[')
+    {
+        const char* begin = c;
+        while(c != end && !is_delimiter(*c))
+        {
+            ++c;
+        }
+        return c != begin;
+    }
+
+    // containers are skipped by tracking how deeply they are nested, strings
+    // are skipped as a whole since they may contain brackets
+    std::size_t depth = 0;
+    while(c != end)
+    {
+        if(*c == '"')
+        {
+            bool escaped = false;
+            if(!skip_string(c, end, escaped))
+            {
+                return false;
+            }
+            continue;
+        }
+        if(*c == '/')
+        {
+            if(!skip_space(c, end))
+            {
+                return false;
+            }
+            continue;
+        }
+        if(*c == '{' || *c == '[')
+        {
+            if(++depth > MAX_DEPTH)
+            {
+                return false;
+            }
+        }
+        else if(*c == '}' || *c == ']')
+        {
+            --depth;
+            if(depth == 0)
+            {
+                ++c;
+                return true;
+            }
+        }
+        ++c;
+    }
+    return false;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Shards::Shards(
+        const std::shared_ptr<const arc::str::UTF8String>& data,
+        const std::shared_ptr<KeyPool>& key_pool,
+        const error_callback& on_error)
+    :
+    m_data    (data),
+    m_key_pool(key_pool),
+    m_on_error(on_error),
+    m_loaded  (0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::shared_ptr<const ArenaTree> Shards::build(
+        const std::shared_ptr<const arc::str::UTF8String>& data,
+        const std::shared_ptr<KeyPool>& key_pool,
+        const error_callback& on_error)
+{
+    const char* c = data->get_raw();
+    const char* end = c + (data->get_byte_length() - 1);
+
+    std::shared_ptr<Shards> shards(new Shards(data, key_pool, on_error));
+    std::shared_ptr<ArenaTree> tree(new ArenaTree(0, key_pool));
+    Json::Reader reader;
+    {
+        Json::MemoryResource::Scope scope(&tree->get_arena());
+        Json::KeyInterner::Scope key_scope(key_pool.get());
+        Json::Value init(Json::objectValue);
+        tree->get_root()->swapPayload(init);
+
+        if(!skip_space(c, end) || c == end || *c != '{')
+        {
+            return nullptr;
+        }
+        ++c;
+        if(!skip_space(c, end) || c == end)
+        {
+            return nullptr;
+        }
+        while(*c != '}')
+        {
+            const char* name = c;
+            bool escaped = false;
+            if(*c != '"' || !skip_string(c, end, escaped))
+            {
+                return nullptr;
+            }
+            const char* name_end = c;
+            if(!skip_space(c, end) || c == end || *c != ':')
+            {
+                return nullptr;
+            }
+            ++c;
+            if(!skip_space(c, end))
+            {
+                return nullptr;
+            }
+            const char* value = c;
+            if(!skip_value(c, end))
+            {
+                return nullptr;
+            }
+
+            // the placeholder is added under the decoded name
+            const char* key_begin = name + 1;
+            const char* key_end = name_end - 1;
+            Json::Value decoded;
+            if(escaped)
+            {
+                if(!reader.parse(name, name_end, decoded, false) ||
+                   !decoded.getString(&key_begin, &key_end))
+                {
+                    return nullptr;
+                }
+            }
+            Json::Value* placeholder = const_cast<Json::Value*>(
+                tree->get_root()->demand(key_begin, key_end));
+
+            // the last of duplicate members is the one that is kept
+            Shard* shard = nullptr;
+            std::unordered_map<const Json::Value*, Shard*>::iterator indexed =
+                shards->m_index.find(placeholder);
+            if(indexed != shards->m_index.end())
+            {
+                shard = indexed->second;
+            }
+            else
+            {
+                shards->m_shards.emplace_back(new Shard());
+                shard = shards->m_shards.back().get();
+                shard->placeholder = placeholder;
+                shards->m_index[placeholder] = shard;
+            }
+            shard->name_begin = name + 1;
+            shard->name_end = name_end - 1;
+            shard->value_begin = value;
+            shard->value_end = c;
+
+            if(!skip_space(c, end) || c == end)
+            {
+                return nullptr;
+            }
+            if(*c == ',')
+            {
+                ++c;
+                if(!skip_space(c, end) || c == end || *c == '}')
+                {
+                    return nullptr;
+                }
+            }
+            else if(*c != '}')
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    // nothing but whitespace and comments may follow the root object
+    ++c;
+    if(!skip_space(c, end) || c != end)
+    {
+        return nullptr;
+    }
+
+    tree->set_shards(shards);
+    return tree;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Shards::load(const Json::Value* member)
+{
+    std::unordered_map<const Json::Value*, Shard*>::const_iterator shard =
+        m_index.find(member);
+    if(shard == m_index.end())
+    {
+        return;
+    }
+    std::call_once(
+        shard->second->once,
+        &Shards::parse,
+        this,
+        std::ref(*shard->second)
+    );
+}
+
+void Shards::load_all()
+{
+    // there is nothing left to do once every shard is parsed
+    if(m_loaded.load(std::memory_order_acquire) == m_shards.size())
+    {
+        return;
+    }
+    ARC_FOR_EACH(shard, m_shards)
+    {
+        std::call_once(
+            (*shard)->once,
+            &Shards::parse,
+            this,
+            std::ref(**shard)
+        );
+    }
+}
+
+std::size_t Shards::get_count() const
+{
+    return m_shards.size();
+}
+
+std::size_t Shards::get_loaded_count() const
+{
+    return m_loaded.load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Shards::parse(Shard& shard)
+{
+    std::size_t length =
+        static_cast<std::size_t>(shard.value_end - shard.value_begin);
+    std::shared_ptr<ArenaTree> parsed(new ArenaTree(length, m_key_pool));
+
+    // the value must span the whole of its data, since anything that follows
+    // it would be ignored
+    Json::Reader reader;
+    bool parse_success = false;
+    {
+        Json::MemoryResource::Scope scope(&parsed->get_arena());
+        Json::KeyInterner::Scope key_scope(m_key_pool.get());
+        parse_success =
+            reader.parse(
+                shard.value_begin,
+                shard.value_end,
+                *parsed->get_root(),
+                false
+            ) &&
+            parsed->get_root()->getOffsetLimit() ==
+                static_cast<std::ptrdiff_t>(length);
+    }
+
+    if(parse_success)
+    {
+        shard.placeholder->sharePayload(*parsed->get_root());
+        shard.tree = parsed;
+    }
+    else if(m_on_error)
+    {
+        arc::str::UTF8String message;
+        if(reader.getFormattedErrorMessages().empty())
+        {
+            message = "Unexpected data following the value.";
+        }
+        else
+        {
+            message = reader.getFormattedErrorMessages().c_str();
+        }
+        m_on_error(
+            std::string(shard.name_begin, shard.name_end).c_str(),
+            message
+        );
+    }
+    m_loaded.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace metaengine
@@ -0,0 +1,187 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_SHARDS_HPP_
+#define METAENGINE_SHARDS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Arena.hpp"
+
+namespace metaengine
+{
+
+class KeyPool;
+
+/*!
+ * \brief Parses each member of the root object of JSON data only when it is
+ *        first accessed.
+ *
+ * Building a sharded tree (see build()) only scans the data to find where
+ * each member of the root object (a shard) begins and ends, which is much
+ * cheaper than parsing it. The root object of the tree is built with a null
+ * placeholder for each member, and the value of a member is parsed into an
+ * ArenaTree of its own the first time load() is called for it, at which
+ * point the placeholder is made to refer to the parsed value. The Shards keep
+ * the data alive so that the remaining shards can be parsed later.
+ *
+ * Each shard is parsed exactly once, and loading is thread safe: any number
+ * of threads may load the same or different shards at the same time, and the
+ * value of a shard may be read by a thread once load() has returned for it
+ * on that thread. The placeholders are the only values of the tree which are
+ * modified after it is built, so the tree may otherwise be read as normal.
+ */
+class Shards
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Shards);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Function called with the name of a shard and the message of the
+     *        error when the shard fails to parse.
+     */
+    typedef std::function<void(
+            const arc::str::UTF8String&,
+            const arc::str::UTF8String&)> error_callback;
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Builds a sharded tree from the data.
+     *
+     * \param data The JSON data, which the returned tree keeps alive.
+     * \param key_pool The pool the keys of the tree are interned in (may be
+     *                 null).
+     * \param on_error Called (once, by the thread that parsed it) for each
+     *                 member whose value fails to parse (may be empty).
+     * \return The sharded tree, or null if the data is not an object or its
+     *         structure is not valid, in which case it should be parsed as a
+     *         whole instead (which raises the error). Errors within the value
+     *         of a member are only found when the member is loaded.
+     */
+    static std::shared_ptr<const ArenaTree> build(
+            const std::shared_ptr<const arc::str::UTF8String>& data,
+            const std::shared_ptr<KeyPool>& key_pool,
+            const error_callback& on_error);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Parses the value of the given member of the root object, if it
+     *        has not been parsed yet.
+     *
+     * If the value fails to parse, the error callback is called and the member
+     * is left null, so behaves as if it does not exist.
+     *
+     * \param member The placeholder of the member, which must be a member of
+     *               the root object of the tree these Shards were built for.
+     */
+    void load(const Json::Value* member);
+
+    /*!
+     * \brief Parses the value of every member of the root object that has not
+     *        been parsed yet.
+     */
+    void load_all();
+
+    /*!
+     * \brief Returns the number of members of the root object.
+     */
+    std::size_t get_count() const;
+
+    /*!
+     * \brief Returns the number of members of the root object that have been
+     *        parsed so far.
+     */
+    std::size_t get_loaded_count() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The data of a member of the root object.
+     */
+    struct Shard
+    {
+        /*!
+         * \brief The raw name of the member between its quotes.
+         */
+        const char* name_begin;
+        const char* name_end;
+        const char* value_begin;
+        const char* value_end;
+        /*!
+         * \brief The placeholder of the member in the root object.
+         */
+        Json::Value* placeholder;
+        std::once_flag once;
+        /*!
+         * \brief The tree the value is parsed into, null until it is parsed
+         *        or if it failed to parse.
+         */
+        std::shared_ptr<const ArenaTree> tree;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    std::shared_ptr<const arc::str::UTF8String> m_data;
+    std::shared_ptr<KeyPool> m_key_pool;
+    error_callback m_on_error;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    /*!
+     * \brief The shard of each placeholder.
+     */
+    std::unordered_map<const Json::Value*, Shard*> m_index;
+    std::atomic<std::size_t> m_loaded;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    Shards(
+            const std::shared_ptr<const arc::str::UTF8String>& data,
+            const std::shared_ptr<KeyPool>& key_pool,
+            const error_callback& on_error);
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Parses the value of the shard into its tree, and makes the
+     *        placeholder refer to it.
+     */
+    void parse(Shard& shard);
+};
+
+} // namespace metaengine
+
+#endif
@@ -0,0 +1,572 @@
+#include "metaengine/Stack.hpp"
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Arena.hpp"
+#include "metaengine/FileData.hpp"
+#include "metaengine/ParseCache.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The column of the table holding the data loaded from memory.
+ */
+static const std::size_t MEMORY_COLUMN = 0;
+/*!
+ * \brief The column of the table holding the data loaded from the file system.
+ */
+static const std::size_t FILE_COLUMN = 1;
+/*!
+ * \brief The column of the table holding the first pushed layer.
+ */
+static const std::size_t LAYER_COLUMN = 2;
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTORS
+//------------------------------------------------------------------------------
+
+Stack::Stack(const arc::io::sys::Path& file_path, bool load_immediately)
+    :
+    Document(file_path, false)
+{
+    if(load_immediately)
+    {
+        reload();
+    }
+}
+
+Stack::Stack(const arc::str::UTF8String* memory, bool load_immediately)
+    :
+    Document(memory, false)
+{
+    if(load_immediately)
+    {
+        reload();
+    }
+}
+
+Stack::Stack(
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String* memory,
+        bool load_immediately)
+    :
+    Document(file_path, memory, false)
+{
+    if(load_immediately)
+    {
+        reload();
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+Stack::~Stack()
+{
+    wait_for_load();
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Stack::push_layer(const arc::io::sys::Path& file_path)
+{
+    Layer layer;
+    layer.file_path = file_path;
+    layer.memory = nullptr;
+    push(layer);
+}
+
+void Stack::push_layer(const arc::str::UTF8String* memory)
+{
+    Layer layer;
+    layer.memory = memory;
+    push(layer);
+}
+
+void Stack::pop_layer()
+{
+    wait_for_load();
+
+    if(m_layers.empty())
+    {
+        return;
+    }
+
+    std::vector<std::shared_ptr<const ArenaTree>> previous;
+    if(has_subscriptions())
+    {
+        get_trees(previous);
+    }
+    m_layers.pop_back();
+    resolve();
+    new_version();
+    notify_subscribers(previous);
+}
+
+std::size_t Stack::get_layer_count() const
+{
+    return m_layers.size();
+}
+
+bool Stack::has_valid_layer_data(std::size_t index) const
+{
+    wait_for_load();
+
+    if(index >= m_layers.size())
+    {
+        arc::str::UTF8String error_message;
+        error_message << "No layer exists at index " << index << ".";
+        throw arc::ex::IndexOutOfBoundsError(error_message);
+    }
+    return m_layers[index].tree != nullptr;
+}
+
+//------------------------------------------------------------------------------
+//                           PROTECTED MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Stack::load()
+{
+    // the table references the previous data so must not outlive it
+    m_table.reset();
+    m_winners.clear();
+
+    // super call
+    Document::load();
+
+    ARC_FOR_EACH(layer, m_layers)
+    {
+        // keep the existing data until the new data has been parsed if its
+        // subtrees may be shared
+        std::shared_ptr<const ArenaTree> previous;
+        if(is_subtree_sharing_enabled())
+        {
+            previous = layer->tree;
+        }
+        layer->tree.reset();
+        load_layer(*layer, previous);
+    }
+
+    resolve();
+}
+
+void Stack::validate()
+{
+    // the base data alone does not decide the winning values, so these are
+    // proven against the schema by resolve() instead
+}
+
+VisitorBase* Stack::get(
+        const arc::str::UTF8String& key,
+        VisitorBase* visitor)
+{
+    // not loaded yet
+    if(m_table == nullptr)
+    {
+        return Document::get(key, visitor);
+    }
+
+    // the winning value of keys in the table is already resolved
+    std::size_t row = m_table->find_row(key);
+    std::size_t column = m_table->get_column_count();
+    const Json::Value* data = nullptr;
+    bool proven = false;
+    if(row != VariantTable::NO_ROW)
+    {
+        data = m_winners[row].data;
+        column = m_winners[row].column;
+        proven = m_winners[row].proven;
+    }
+    else
+    {
+        data = find_below(key, row, column);
+    }
+
+    if(data == nullptr)
+    {
+        if(m_statistics != nullptr)
+        {
+            m_statistics->record_key_error();
+        }
+        arc::str::UTF8String error_message;
+        error_message << "No value exists with the key \"" << key << "\".";
+        throw arc::ex::KeyError(error_message);
+    }
+
+    while(true)
+    {
+        bool retrieve_success = false;
+        Diagnostic diagnostic;
+        // only the winning value was checked against the schema
+        if(proven)
+        {
+            diagnostic.set_proven_type(m_winners[row].type);
+        }
+        try
+        {
+            retrieve_success = visitor->retrieve(data, key, this, diagnostic);
+        }
+        catch(...)
+        {
+            retrieve_success = false;
+        }
+
+        // if everything was successful we're done
+        if(retrieve_success)
+        {
+            if(m_statistics != nullptr)
+            {
+                m_statistics->record_hit(get_source(column));
+            }
+            return visitor;
+        }
+
+        if(m_statistics != nullptr)
+        {
+            m_statistics->record_type_error();
+        }
+        diagnostic.set_context(key, get_source(column));
+
+        // throw if no lower layer has a value for the key
+        std::size_t lower_column = column;
+        const Json::Value* lower = find_below(key, row, lower_column);
+        if(lower == nullptr)
+        {
+            throw arc::ex::TypeError(diagnostic.format());
+        }
+
+        if(m_statistics != nullptr)
+        {
+            m_statistics->record_fallback();
+        }
+        // trigger a warning and fallback (the diagnostic is only formatted if
+        // something is listening and it is not a duplicate)
+        if(is_reporting(FallbackEvent::TYPE_GET))
+        {
+            report_fallback(
+                FallbackEvent::TYPE_GET,
+                get_path(column),
+                key,
+                "Falling back to retrieving value from a lower layer.",
+                "TypeError",
+                diagnostic
+            );
+        }
+        data = lower;
+        column = lower_column;
+        proven = false;
+    }
+}
+
+const Json::Value* Stack::find_resolved(
+        const arc::str::UTF8String& key) const
+{
+    // not loaded yet
+    if(m_table == nullptr)
+    {
+        return Document::find_resolved(key);
+    }
+
+    std::size_t row = m_table->find_row(key);
+    if(row != VariantTable::NO_ROW)
+    {
+        return m_winners[row].data;
+    }
+    std::size_t column = m_table->get_column_count();
+    return find_below(key, row, column);
+}
+
+void Stack::get_trees(
+        std::vector<std::shared_ptr<const ArenaTree>>& trees) const
+{
+    // layers are retrieved from the top down
+    for(std::size_t i = m_layers.size(); i > 0; --i)
+    {
+        trees.push_back(m_layers[i - 1].tree);
+    }
+
+    // super call
+    Document::get_trees(trees);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Stack::load_layer(
+        Layer& layer,
+        const std::shared_ptr<const ArenaTree>& previous)
+{
+    // load from memory
+    if(layer.memory != nullptr)
+    {
+        try
+        {
+            LoadTimings::Scope timing(
+                m_load_timings.phases[LoadTimings::PHASE_LAYER_PARSE]);
+            timing.add_bytes(layer.memory->get_byte_length() - 1);
+            parse(
+                *layer.memory,
+                layer.tree,
+                ParseCache::memory_source(layer.memory),
+                previous
+            );
+        }
+        catch(const arc::ex::ParseError& exc)
+        {
+            // trigger a warning, identifying the layer by its index since
+            // memory layers have no path
+            arc::str::UTF8String details;
+            details << "Layer "
+                    << static_cast<arc::uint64>(&layer - &m_layers[0])
+                    << ": " << exc.what();
+            report_fallback(
+                FallbackEvent::TYPE_LOAD,
+                layer.file_path,
+                "",
+                "Failed to parse data from memory for layer with",
+                exc.get_type(),
+                details
+            );
+        }
+        return;
+    }
+
+    // construct an optimised string to contain the file data
+    arc::str::UTF8String file_data(
+        arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+    // or the chunks of the file when streaming
+    std::unique_ptr<FileChunks> chunks;
+
+    // attempt to read data from the file
+    try
+    {
+        LoadTimings::Scope timing(
+            m_load_timings.phases[LoadTimings::PHASE_LAYER_READ]);
+        if(is_streaming())
+        {
+            // the file is read as it is parsed
+            chunks.reset(new FileChunks(layer.file_path));
+        }
+        else
+        {
+            FileData::read(layer.file_path, file_data);
+            timing.add_bytes(file_data.get_byte_length() - 1);
+        }
+    }
+    catch(const arc::ex::ArcException& exc)
+    {
+        // trigger a warning
+        report_fallback(
+            FallbackEvent::TYPE_LOAD,
+            layer.file_path,
+            "",
+            "Failed to load data for layer with",
+            exc.get_type(),
+            exc.get_message()
+        );
+        return;
+    }
+
+    // parse
+    try
+    {
+        if(chunks != nullptr)
+        {
+            stream_parse(
+                *chunks,
+                layer.file_path,
+                layer.tree,
+                LoadTimings::PHASE_LAYER_READ,
+                LoadTimings::PHASE_LAYER_PARSE
+            );
+        }
+        else
+        {
+            LoadTimings::Scope timing(
+                m_load_timings.phases[LoadTimings::PHASE_LAYER_PARSE]);
+            timing.add_bytes(file_data.get_byte_length() - 1);
+            parse(
+                file_data,
+                layer.tree,
+                ParseCache::file_source(layer.file_path),
+                previous
+            );
+        }
+    }
+    catch(const arc::ex::ParseError& exc)
+    {
+        // trigger a warning
+        report_fallback(
+            FallbackEvent::TYPE_LOAD,
+            layer.file_path,
+            "",
+            "Failed to parse data for layer with",
+            exc.get_type(),
+            exc.what()
+        );
+    }
+}
+
+void Stack::push(const Layer& layer)
+{
+    wait_for_load();
+
+    std::vector<std::shared_ptr<const ArenaTree>> previous;
+    if(has_subscriptions())
+    {
+        get_trees(previous);
+    }
+    m_layers.push_back(layer);
+    load_layer(m_layers.back());
+    resolve();
+    new_version();
+    notify_subscribers(previous);
+}
+
+void Stack::resolve()
+{
+    std::unique_ptr<VariantTable> table(new VariantTable());
+    std::size_t column_count = LAYER_COLUMN + m_layers.size();
+    for(std::size_t column = 0; column < column_count; ++column)
+    {
+        table->add_column(get_root(column));
+    }
+
+    // the winner of each row is the highest column with a value, since every
+    // row has a value in at least one column there is always a winner
+    std::vector<Winner> winners(table->get_row_count());
+    for(std::size_t row = 0; row < winners.size(); ++row)
+    {
+        std::size_t column = column_count;
+        while(column > 0)
+        {
+            --column;
+            const Json::Value* data = table->get_cell(column, row);
+            if(data != nullptr)
+            {
+                winners[row].data = data;
+                winners[row].column = column;
+                winners[row].proven = false;
+                break;
+            }
+        }
+    }
+
+    // the winning values of the keys of the schema are checked once here
+    // rather than on each get
+    const std::shared_ptr<const Schema>& schema = get_schema();
+    if(schema != nullptr)
+    {
+        ARC_CONST_FOR_EACH(entry, schema->get_entries())
+        {
+            std::size_t row = table->find_row(entry->key);
+            if(row == VariantTable::NO_ROW)
+            {
+                continue;
+            }
+            Diagnostic diagnostic;
+            if(Schema::matches(entry->type, *winners[row].data, diagnostic))
+            {
+                winners[row].proven = true;
+                winners[row].type = entry->type;
+            }
+        }
+    }
+
+    m_table = std::move(table);
+    m_winners.swap(winners);
+}
+
+const Json::Value* Stack::get_root(std::size_t column) const
+{
+    const std::shared_ptr<const ArenaTree>* tree = nullptr;
+    if(column == MEMORY_COLUMN)
+    {
+        tree = &m_mem_root;
+    }
+    else if(column == FILE_COLUMN)
+    {
+        tree = &m_file_root;
+    }
+    else
+    {
+        tree = &m_layers[column - LAYER_COLUMN].tree;
+    }
+
+    if(*tree == nullptr)
+    {
+        return nullptr;
+    }
+    // the table holds every section of sharded data
+    return get_tree_root(**tree, "");
+}
+
+Statistics::Source Stack::get_source(std::size_t column) const
+{
+    if(column == MEMORY_COLUMN ||
+       (column >= LAYER_COLUMN &&
+        m_layers[column - LAYER_COLUMN].memory != nullptr))
+    {
+        return Statistics::SOURCE_MEMORY;
+    }
+    return Statistics::SOURCE_FILE;
+}
+
+const arc::io::sys::Path& Stack::get_path(std::size_t column) const
+{
+    static const arc::io::sys::Path no_path;
+    if(column == MEMORY_COLUMN)
+    {
+        return no_path;
+    }
+    if(column == FILE_COLUMN)
+    {
+        return m_file_path;
+    }
+    return m_layers[column - LAYER_COLUMN].file_path;
+}
+
+const Json::Value* Stack::find_below(
+        const arc::str::UTF8String& key,
+        std::size_t row,
+        std::size_t& column) const
+{
+    while(column > 0)
+    {
+        --column;
+        const Json::Value* data = nullptr;
+        if(row != VariantTable::NO_ROW)
+        {
+            data = m_table->get_cell(column, row);
+        }
+        else
+        {
+            // keys that are not in the table are found in each layer
+            const Json::Value* root = get_root(column);
+            if(root != nullptr)
+            {
+                data = find_value(root, key);
+            }
+        }
+
+        if(data != nullptr)
+        {
+            return data;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace metaengine
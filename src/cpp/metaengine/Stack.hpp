@@ -0,0 +1,320 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_STACK_HPP_
+#define METAENGINE_STACK_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "metaengine/Document.hpp"
+#include "metaengine/VariantTable.hpp"
+
+namespace metaengine
+{
+
+/*!
+ * \brief A derived implementation of Document which layers any number of
+ *        override files or memory data over the Document's own data.
+ *
+ * The data a Stack is constructed with forms the bottom of the stack, the
+ * data loaded from memory (e.g. embedded defaults) followed by the data loaded
+ * from the file system (e.g. the shipped file). Layers pushed with
+ * push_layer() are stacked on top of these in order, for example a
+ * per-environment file, then a per-host file, then runtime overrides held in
+ * memory. Each key is retrieved from the highest layer that has a value for
+ * it, and containers are not merged between layers: retrieving an object
+ * retrieves the object of the highest layer that has one.
+ *
+ * Rather than falling back through the layers on each get, the winning layer
+ * of every key is resolved into a columnar table (see VariantTable) whenever
+ * the stack changes (when it is loaded, or a layer is pushed or popped). This
+ * means retrieving a value costs a single probe of the table regardless of
+ * how many layers there are. Only when a value is not a valid type for the
+ * Visitor are the lower layers with a value for the key tried, reporting each
+ * fallback. Keys which address the elements of arrays are not in the table
+ * and are found by looking through the layers from the top.
+ *
+ * If a Schema is set (see set_schema()), the winning value of each key it
+ * declares is checked against the declared type when the table is resolved,
+ * so retrieving a matching value with a Visitor of that type skips the
+ * Visitor's own type check. Since the winning value may come from any layer,
+ * values which do not match are not reported when the stack is loaded, the
+ * lower layers are fallen back to on get() as usual.
+ *
+ * A layer that fails to load is reported and treated as empty, so the layers
+ * below it are used instead.
+ */
+class Stack : public Document
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new Stack whose bottom layer is loaded from the given
+     *        file path.
+     *
+     * \param file_path Path to a JSON file to load the bottom layer from.
+     * \param load_immediately Whether constructing the Stack will also load
+     *                         the internal data.
+     */
+    Stack(const arc::io::sys::Path& file_path, bool load_immediately = true);
+
+    /*!
+     * \brief Creates a new Stack whose bottom layer is loaded from memory.
+     *
+     * \param memory Pointer to a arc::str::UTF8String that will contain JSON
+     *               to load the bottom layer from.
+     * \param load_immediately Whether constructing the Stack will also load
+     *                         the internal data.
+     */
+    Stack(const arc::str::UTF8String* memory, bool load_immediately = true);
+
+    /*!
+     * \brief Creates a new Stack whose bottom layers are loaded from memory
+     *        and then from the given file path.
+     *
+     * \param file_path Path to a JSON file to load the layer above the memory
+     *                  data from.
+     * \param memory Pointer to a arc::str::UTF8String that will contain JSON
+     *               to load the bottom layer from.
+     * \param load_immediately Whether constructing the Stack will also load
+     *                         the internal data.
+     */
+    Stack(
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String* memory,
+            bool load_immediately = true);
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    virtual ~Stack();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Pushes a layer loaded from the given file path on top of the
+     *        stack.
+     *
+     * The layer is loaded immediately (and again each time this Stack is
+     * reloaded), and the winning layer of each key is resolved again.
+     */
+    void push_layer(const arc::io::sys::Path& file_path);
+
+    /*!
+     * \brief Pushes a layer loaded from memory on top of the stack.
+     *
+     * The layer is loaded immediately (and again each time this Stack is
+     * reloaded), and the winning layer of each key is resolved again.
+     *
+     * \param memory Pointer to a arc::str::UTF8String that will contain JSON
+     *               to load the layer from, which must outlive the layer.
+     */
+    void push_layer(const arc::str::UTF8String* memory);
+
+    /*!
+     * \brief Removes the top layer pushed with push_layer(), and resolves the
+     *        winning layer of each key again.
+     *
+     * Does nothing if no layers have been pushed.
+     */
+    void pop_layer();
+
+    /*!
+     * \brief Returns the number of layers that have been pushed on top of the
+     *        data this Stack was constructed with.
+     */
+    std::size_t get_layer_count() const;
+
+    /*!
+     * \brief Returns whether the pushed layer at the given index (where 0 is
+     *        the first layer pushed) currently has valid loaded data.
+     *
+     * \throws arc::ex::IndexOutOfBoundsError If there is no layer at the
+     *                                        index.
+     */
+    bool has_valid_layer_data(std::size_t index) const;
+
+    /*!
+     * \brief Retrieves data from the highest layer of this Stack with a value
+     *        for the key, using the given Visitor object.
+     *
+     * \tparam VisitorType The type of the Visitor being passed in which will be
+     *                     used to retrieve the value.
+     *
+     * \param key The key of the value to retrieve from the data.
+     * \param visitor The visitor object to use to retrieve the value from the
+     *                data.
+     * \return A reference to the visitor object that was passed in to this
+     *         function.
+     *
+     * \throws arc::ex::KeyError If there is no value in any layer with the
+     *                           given key.
+     * \throws arc::ex::TypeError If no layer has a value with the key that is a
+     *                            valid type for the Visitor.
+     */
+    template <typename VisitorType>
+    VisitorType& get(
+            const arc::str::UTF8String& key,
+            VisitorType& visitor)
+    {
+        instrumented_get(key, static_cast<VisitorBase*>(&visitor));
+        return visitor;
+    }
+
+protected:
+
+    //--------------------------------------------------------------------------
+    //                         PROTECTED MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    // override
+    virtual void load();
+
+    // override
+    virtual void validate();
+
+    // override
+    virtual VisitorBase* get(
+            const arc::str::UTF8String& key,
+            VisitorBase* visitor);
+
+    // override
+    virtual const Json::Value* find_resolved(
+            const arc::str::UTF8String& key) const;
+
+    // override
+    virtual void get_trees(
+            std::vector<std::shared_ptr<const ArenaTree>>& trees) const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A layer pushed on top of the stack.
+     */
+    struct Layer
+    {
+        /// The path to load the layer from, if it is not loaded from memory.
+        arc::io::sys::Path file_path;
+        /// The data to load the layer from, or null if it is loaded from the
+        /// file path.
+        const arc::str::UTF8String* memory;
+        /// The loaded data of the layer, null if it failed to load.
+        std::shared_ptr<const ArenaTree> tree;
+    };
+
+    /*!
+     * \brief The value of the highest layer with a value for a row of the
+     *        table.
+     */
+    struct Winner
+    {
+        const Json::Value* data;
+        std::size_t column;
+        /*!
+         * \brief Whether the value matched the type declared for its key by
+         *        the Schema.
+         */
+        bool proven;
+        /*!
+         * \brief The type declared for the key by the Schema, only valid if
+         *        the value is proven.
+         */
+        Schema::Type type;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The layers pushed on top of the stack, from the bottom up.
+     */
+    std::vector<Layer> m_layers;
+    /*!
+     * \brief The table of every layer, null if this Stack has not been loaded.
+     *        Column 0 is the memory data, column 1 is the file data, followed
+     *        by a column for each of the pushed layers.
+     */
+    std::unique_ptr<VariantTable> m_table;
+    /*!
+     * \brief The winning value of each row of the table.
+     */
+    std::vector<Winner> m_winners;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Reads and parses the data of the layer into its tree.
+     *
+     * If the data cannot be read or parsed a fallback is reported and the tree
+     * is left null. If subtree sharing is enabled the unchanged sections of
+     * the previous tree are shared with the new tree.
+     */
+    void load_layer(
+            Layer& layer,
+            const std::shared_ptr<const ArenaTree>& previous = nullptr);
+
+    /*!
+     * \brief Pushes the given layer, loads it and resolves the stack.
+     */
+    void push(const Layer& layer);
+
+    /*!
+     * \brief Rebuilds the table from the current data of each layer and
+     *        resolves the winning value of each row.
+     */
+    void resolve();
+
+    /*!
+     * \brief Returns the root of the data of the given column, or null if it
+     *        has no data.
+     */
+    const Json::Value* get_root(std::size_t column) const;
+
+    /*!
+     * \brief Returns the source the data of the given column was loaded from.
+     */
+    Statistics::Source get_source(std::size_t column) const;
+
+    /*!
+     * \brief Returns the file path of the given column, which is empty if its
+     *        data is loaded from memory.
+     */
+    const arc::io::sys::Path& get_path(std::size_t column) const;
+
+    /*!
+     * \brief Finds the value of the highest column below the given column with
+     *        a value for the key.
+     *
+     * \param row The row of the key in the table, or VariantTable::NO_ROW if
+     *            the key is not in the table.
+     * \param column The column to search below, which is set to the column of
+     *               the value found.
+     * \return The value found, or null if no lower column has a value for the
+     *         key.
+     */
+    const Json::Value* find_below(
+            const arc::str::UTF8String& key,
+            std::size_t row,
+            std::size_t& column) const;
+};
+
+} // namespace metaengine
+
+#endif
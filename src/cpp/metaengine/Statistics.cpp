@@ -0,0 +1,392 @@
+#include "metaengine/Statistics.hpp"
+
+#include <cstring>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+//------------------------------------------------------------------------------
+//                                  KEY COUNTERS
+//------------------------------------------------------------------------------
+
+struct Statistics::KeyCounters
+{
+    const Statistics* owner;
+    arc::str::UTF8String key;
+
+    std::atomic<arc::uint64> gets;
+    std::atomic<arc::uint64> hits[3];
+    std::atomic<arc::uint64> variant_misses;
+    std::atomic<arc::uint64> fallbacks;
+    std::atomic<arc::uint64> type_errors;
+    std::atomic<arc::uint64> key_errors;
+    std::atomic<arc::uint64> lookup_time;
+
+    KeyCounters(const Statistics* o, const arc::str::UTF8String& k)
+        :
+        owner(o),
+        key  (k)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        gets.store(0, std::memory_order_relaxed);
+        hits[SOURCE_VARIANT].store(0, std::memory_order_relaxed);
+        hits[SOURCE_FILE].store(0, std::memory_order_relaxed);
+        hits[SOURCE_MEMORY].store(0, std::memory_order_relaxed);
+        variant_misses.store(0, std::memory_order_relaxed);
+        fallbacks.store(0, std::memory_order_relaxed);
+        type_errors.store(0, std::memory_order_relaxed);
+        key_errors.store(0, std::memory_order_relaxed);
+        lookup_time.store(0, std::memory_order_relaxed);
+    }
+
+    Counters snapshot() const
+    {
+        Counters ret;
+        ret.gets           = gets.load(std::memory_order_relaxed);
+        ret.variant_hits   = hits[SOURCE_VARIANT].load(
+            std::memory_order_relaxed);
+        ret.file_hits      = hits[SOURCE_FILE].load(std::memory_order_relaxed);
+        ret.memory_hits    = hits[SOURCE_MEMORY].load(
+            std::memory_order_relaxed);
+        ret.variant_misses = variant_misses.load(std::memory_order_relaxed);
+        ret.fallbacks      = fallbacks.load(std::memory_order_relaxed);
+        ret.type_errors    = type_errors.load(std::memory_order_relaxed);
+        ret.key_errors     = key_errors.load(std::memory_order_relaxed);
+        ret.lookup_time    = lookup_time.load(std::memory_order_relaxed);
+        return ret;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                           PRIVATE STATIC ATTRIBUTES
+//------------------------------------------------------------------------------
+
+thread_local Statistics::KeyCounters* Statistics::s_active = nullptr;
+
+namespace
+{
+
+/*!
+ * \brief FNV-1a hash of a key.
+ */
+arc::uint64 hash_key(const arc::str::UTF8String& key)
+{
+    arc::uint64 hash = 14695981039346656037ULL;
+    const char* c = key.get_raw();
+    for(; *c != '\0'; ++c)
+    {
+        hash ^= static_cast<unsigned char>(*c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*!
+ * \brief Converts a set of counters to a JSON value.
+ */
+Json::Value counters_to_json(const Statistics::Counters& counters)
+{
+    Json::Value ret(Json::objectValue);
+    ret["gets"]           = Json::UInt64(counters.gets);
+    ret["variant_hits"]   = Json::UInt64(counters.variant_hits);
+    ret["file_hits"]      = Json::UInt64(counters.file_hits);
+    ret["memory_hits"]    = Json::UInt64(counters.memory_hits);
+    ret["variant_misses"] = Json::UInt64(counters.variant_misses);
+    ret["fallbacks"]      = Json::UInt64(counters.fallbacks);
+    ret["type_errors"]    = Json::UInt64(counters.type_errors);
+    ret["key_errors"]     = Json::UInt64(counters.key_errors);
+    ret["lookup_time_ns"] = Json::UInt64(counters.lookup_time);
+    return ret;
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                    COUNTERS
+//------------------------------------------------------------------------------
+
+Statistics::Counters::Counters()
+    :
+    gets          (0),
+    variant_hits  (0),
+    file_hits     (0),
+    memory_hits   (0),
+    variant_misses(0),
+    fallbacks     (0),
+    type_errors   (0),
+    key_errors    (0),
+    lookup_time   (0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                                     SCOPE
+//------------------------------------------------------------------------------
+
+Statistics::Scope::Scope(
+        Statistics& statistics,
+        const arc::str::UTF8String& key)
+    :
+    m_counters(statistics.acquire(key)),
+    m_previous(s_active),
+    m_start   (std::chrono::steady_clock::now())
+{
+    m_counters->gets.fetch_add(1, std::memory_order_relaxed);
+    statistics.m_totals->gets.fetch_add(1, std::memory_order_relaxed);
+    s_active = m_counters;
+}
+
+Statistics::Scope::~Scope()
+{
+    arc::uint64 elapsed = static_cast<arc::uint64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start
+        ).count()
+    );
+    m_counters->lookup_time.fetch_add(elapsed, std::memory_order_relaxed);
+    m_counters->owner->m_totals->lookup_time.fetch_add(
+        elapsed,
+        std::memory_order_relaxed
+    );
+    s_active = m_previous;
+}
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+Statistics::Statistics()
+    :
+    m_totals  (new KeyCounters(this, "")),
+    m_overflow(new KeyCounters(this, "<overflow>")),
+    m_table   (new std::atomic<KeyCounters*>[SHARD_COUNT * SHARD_CAPACITY])
+{
+    for(std::size_t i = 0; i < SHARD_COUNT * SHARD_CAPACITY; ++i)
+    {
+        m_table[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+Statistics::~Statistics()
+{
+    for(std::size_t i = 0; i < SHARD_COUNT * SHARD_CAPACITY; ++i)
+    {
+        delete m_table[i].load(std::memory_order_relaxed);
+    }
+    delete[] m_table;
+    delete m_overflow;
+    delete m_totals;
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Statistics::record_hit(Source source)
+{
+    KeyCounters* counters = active();
+    if(counters != nullptr)
+    {
+        counters->hits[source].fetch_add(1, std::memory_order_relaxed);
+    }
+    m_totals->hits[source].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_variant_miss()
+{
+    KeyCounters* counters = active();
+    if(counters != nullptr)
+    {
+        counters->variant_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_totals->variant_misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_fallback()
+{
+    KeyCounters* counters = active();
+    if(counters != nullptr)
+    {
+        counters->fallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_totals->fallbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_type_error()
+{
+    KeyCounters* counters = active();
+    if(counters != nullptr)
+    {
+        counters->type_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_totals->type_errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_key_error()
+{
+    KeyCounters* counters = active();
+    if(counters != nullptr)
+    {
+        counters->key_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_totals->key_errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+Statistics::Counters Statistics::get_totals() const
+{
+    return m_totals->snapshot();
+}
+
+Statistics::Counters Statistics::get_counters(
+        const arc::str::UTF8String& key) const
+{
+    const KeyCounters* counters = find(key);
+    if(counters == nullptr)
+    {
+        return Counters();
+    }
+    return counters->snapshot();
+}
+
+std::map<arc::str::UTF8String, Statistics::Counters>
+        Statistics::get_all_counters() const
+{
+    std::map<arc::str::UTF8String, Counters> ret;
+    for(std::size_t i = 0; i < SHARD_COUNT * SHARD_CAPACITY; ++i)
+    {
+        const KeyCounters* counters = m_table[i].load(std::memory_order_acquire);
+        if(counters != nullptr)
+        {
+            ret[counters->key] = counters->snapshot();
+        }
+    }
+    Counters overflow(m_overflow->snapshot());
+    if(overflow.gets != 0)
+    {
+        ret[m_overflow->key] = overflow;
+    }
+    return ret;
+}
+
+arc::str::UTF8String Statistics::to_json() const
+{
+    Json::Value root(Json::objectValue);
+    root["totals"] = counters_to_json(get_totals());
+
+    Json::Value& keys = root["keys"] = Json::Value(Json::objectValue);
+    std::map<arc::str::UTF8String, Counters> all(get_all_counters());
+    ARC_CONST_FOR_EACH(it, all)
+    {
+        keys[it->first.get_raw()] = counters_to_json(it->second);
+    }
+
+    Json::StyledWriter writer;
+    return arc::str::UTF8String(writer.write(root).c_str());
+}
+
+void Statistics::reset()
+{
+    for(std::size_t i = 0; i < SHARD_COUNT * SHARD_CAPACITY; ++i)
+    {
+        KeyCounters* counters = m_table[i].load(std::memory_order_acquire);
+        if(counters != nullptr)
+        {
+            counters->reset();
+        }
+    }
+    m_overflow->reset();
+    m_totals->reset();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+Statistics::KeyCounters* Statistics::acquire(const arc::str::UTF8String& key)
+{
+    arc::uint64 hash = hash_key(key);
+    std::atomic<KeyCounters*>* shard =
+        m_table + (hash % SHARD_COUNT) * SHARD_CAPACITY;
+    std::size_t start = (hash / SHARD_COUNT) % SHARD_CAPACITY;
+
+    // linear probe the shard
+    KeyCounters* created = nullptr;
+    for(std::size_t i = 0; i < SHARD_CAPACITY; ++i)
+    {
+        std::atomic<KeyCounters*>& slot =
+            shard[(start + i) % SHARD_CAPACITY];
+        KeyCounters* counters = slot.load(std::memory_order_acquire);
+
+        // claim the empty slot
+        if(counters == nullptr)
+        {
+            if(created == nullptr)
+            {
+                created = new KeyCounters(this, key);
+            }
+            if(slot.compare_exchange_strong(
+                    counters,
+                    created,
+                    std::memory_order_acq_rel))
+            {
+                return created;
+            }
+            // another thread claimed the slot, counters now holds its value
+        }
+
+        if(std::strcmp(counters->key.get_raw(), key.get_raw()) == 0)
+        {
+            delete created;
+            return counters;
+        }
+    }
+
+    // the shard is full
+    delete created;
+    return m_overflow;
+}
+
+const Statistics::KeyCounters* Statistics::find(
+        const arc::str::UTF8String& key) const
+{
+    arc::uint64 hash = hash_key(key);
+    const std::atomic<KeyCounters*>* shard =
+        m_table + (hash % SHARD_COUNT) * SHARD_CAPACITY;
+    std::size_t start = (hash / SHARD_COUNT) % SHARD_CAPACITY;
+
+    for(std::size_t i = 0; i < SHARD_CAPACITY; ++i)
+    {
+        const KeyCounters* counters =
+            shard[(start + i) % SHARD_CAPACITY].load(std::memory_order_acquire);
+        if(counters == nullptr)
+        {
+            return nullptr;
+        }
+        if(std::strcmp(counters->key.get_raw(), key.get_raw()) == 0)
+        {
+            return counters;
+        }
+    }
+    return nullptr;
+}
+
+Statistics::KeyCounters* Statistics::active() const
+{
+    if(s_active != nullptr && s_active->owner == this)
+    {
+        return s_active;
+    }
+    return nullptr;
+}
+
+} // namespace metaengine
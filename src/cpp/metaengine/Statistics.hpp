@@ -0,0 +1,248 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_STATISTICS_HPP_
+#define METAENGINE_STATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+
+#include <arcanecore/base/str/UTF8String.hpp>
+
+namespace metaengine
+{
+
+/*!
+ * \brief Records how the values of a Document are accessed.
+ *
+ * Statistics are opt-in, a Document will only record them once
+ * Document::set_statistics_enabled() has been called. While disabled the only
+ * cost to Document::get() is a single null check.
+ *
+ * Counters are kept both for the Document as a whole and for each individual
+ * key. All counters are atomics and the per-key counters are stored in a
+ * sharded, fixed size, lock-free hash table, so recording statistics never
+ * blocks, even when the Document is being accessed from multiple threads. If
+ * the table fills up, further keys are recorded under a single overflow
+ * entry.
+ */
+class Statistics
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Statistics);
+
+    // the atomic counters of a single key, defined in the source file
+    struct KeyCounters;
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The sources a value can be retrieved from.
+     */
+    enum Source
+    {
+        /// The current variant of a Variant.
+        SOURCE_VARIANT = 0,
+        /// Data loaded from the file system.
+        SOURCE_FILE,
+        /// Data loaded from memory.
+        SOURCE_MEMORY
+    };
+
+    //--------------------------------------------------------------------------
+    //                                  STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A snapshot of a set of counters.
+     */
+    struct Counters
+    {
+        /// The number of times get() has been called.
+        arc::uint64 gets;
+        /// The number of values retrieved from the current variant.
+        arc::uint64 variant_hits;
+        /// The number of values retrieved from file data.
+        arc::uint64 file_hits;
+        /// The number of values retrieved from memory data.
+        arc::uint64 memory_hits;
+        /// The number of times a key was missing from the current variant.
+        arc::uint64 variant_misses;
+        /// The number of times retrieval fell back from file to memory data.
+        arc::uint64 fallbacks;
+        /// The number of times a Visitor failed to convert a value.
+        arc::uint64 type_errors;
+        /// The number of times get() failed because a key did not exist.
+        arc::uint64 key_errors;
+        /// The total time spent in get() in nanoseconds. This includes the
+        /// time spent in nested gets (e.g. resolving path references).
+        arc::uint64 lookup_time;
+
+        Counters();
+    };
+
+    /*!
+     * \brief Records the statistics for a single call to Document::get().
+     *
+     * While a Scope exists any event recorded by the Statistics object on the
+     * same thread will be counted against the key the Scope was created for.
+     */
+    class Scope
+    {
+    private:
+
+        ARC_DISALLOW_COPY_AND_ASSIGN(Scope);
+
+    public:
+
+        Scope(Statistics& statistics, const arc::str::UTF8String& key);
+
+        ~Scope();
+
+    private:
+
+        KeyCounters* m_counters;
+        KeyCounters* m_previous;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    Statistics();
+
+    //--------------------------------------------------------------------------
+    //                                 DESTRUCTOR
+    //--------------------------------------------------------------------------
+
+    ~Statistics();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Records that a value was retrieved from the given source.
+     */
+    void record_hit(Source source);
+
+    /*!
+     * \brief Records that a key was missing from the current variant.
+     */
+    void record_variant_miss();
+
+    /*!
+     * \brief Records that retrieval fell back from file data to memory data.
+     */
+    void record_fallback();
+
+    /*!
+     * \brief Records that a Visitor failed to convert a value.
+     */
+    void record_type_error();
+
+    /*!
+     * \brief Records that get() failed because the key does not exist.
+     */
+    void record_key_error();
+
+    /*!
+     * \brief Returns the counters for the Document as a whole.
+     */
+    Counters get_totals() const;
+
+    /*!
+     * \brief Returns the counters for the given key.
+     *
+     * If the key has never been accessed the counters will all be zero.
+     */
+    Counters get_counters(const arc::str::UTF8String& key) const;
+
+    /*!
+     * \brief Returns a snapshot of the counters of every key that has been
+     *        accessed.
+     */
+    std::map<arc::str::UTF8String, Counters> get_all_counters() const;
+
+    /*!
+     * \brief Exports the totals and the per-key counters as a JSON string.
+     */
+    arc::str::UTF8String to_json() const;
+
+    /*!
+     * \brief Resets all counters to zero.
+     *
+     * \note Keys that have been recorded are not removed from the table.
+     */
+    void reset();
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                         PRIVATE STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The number of shards the key table is split into.
+     */
+    static const std::size_t SHARD_COUNT = 16;
+    /*!
+     * \brief The number of keys each shard can hold.
+     */
+    static const std::size_t SHARD_CAPACITY = 256;
+
+    /*!
+     * \brief The counters of the key currently being accessed on this thread.
+     */
+    static thread_local KeyCounters* s_active;
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The counters for the Document as a whole.
+     */
+    KeyCounters* m_totals;
+    /*!
+     * \brief The counters used for keys that do not fit in the table.
+     */
+    KeyCounters* m_overflow;
+    /*!
+     * \brief The lock-free table of per-key counters.
+     */
+    std::atomic<KeyCounters*>* m_table;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the counters for the key, inserting them into the table
+     *        if they don't exist yet.
+     */
+    KeyCounters* acquire(const arc::str::UTF8String& key);
+
+    /*!
+     * \brief Returns the counters for the key, or null if they do not exist.
+     */
+    const KeyCounters* find(const arc::str::UTF8String& key) const;
+
+    /*!
+     * \brief Returns the counters of the key being accessed by the current
+     *        thread if they belong to this object, else null.
+     */
+    KeyCounters* active() const;
+};
+
+} // namespace metaengine
+
+#endif
@@ -0,0 +1,1024 @@
+#include "metaengine/StreamParser.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include "metaengine/FileData.hpp"
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The UTF-8 byte order mark.
+ */
+static const unsigned char BYTE_ORDER_MARK[] = {0xEF, 0xBB, 0xBF};
+
+/*!
+ * \brief Appends the UTF-8 encoding of the code point to the string.
+ */
+void append_code_point(unsigned int code_point, std::string& s)
+{
+    if(code_point <= 0x7F)
+    {
+        s += static_cast<char>(code_point);
+    }
+    else if(code_point <= 0x7FF)
+    {
+        s += static_cast<char>(0xC0 | (code_point >> 6));
+        s += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if(code_point <= 0xFFFF)
+    {
+        s += static_cast<char>(0xE0 | (code_point >> 12));
+        s += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if(code_point <= 0x10FFFF)
+    {
+        s += static_cast<char>(0xF0 | (code_point >> 18));
+        s += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        s += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+/*!
+ * \brief Decodes the four hex digits from c into code_point.
+ */
+bool decode_hex(const char*& c, const char* end, unsigned int& code_point)
+{
+    if(end - c < 4)
+    {
+        return false;
+    }
+    code_point = 0;
+    for(std::size_t i = 0; i < 4; ++i, ++c)
+    {
+        code_point *= 16;
+        if(*c >= '0' && *c <= '9')
+        {
+            code_point += *c - '0';
+        }
+        else if(*c >= 'a' && *c <= 'f')
+        {
+            code_point += *c - 'a' + 10;
+        }
+        else if(*c >= 'A' && *c <= 'F')
+        {
+            code_point += *c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Returns whether the character is JSON whitespace.
+ */
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/*!
+ * \brief Returns whether the character is a decimal digit.
+ */
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                    HANDLER
+//------------------------------------------------------------------------------
+
+StreamParser::Handler::~Handler()
+{
+}
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+StreamParser::StreamParser(Handler& handler)
+    :
+    m_handler     (handler),
+    m_expect      (EXPECT_VALUE),
+    m_lex         (LEX_NONE),
+    m_escaped     (false),
+    m_literal     (nullptr),
+    m_literal_read(0),
+    m_bom_read    (0),
+    m_line        (1),
+    m_line_start  (0),
+    m_offset      (0)
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void StreamParser::feed(const char* data, std::size_t length)
+{
+    const char* chunk = data;
+    const char* c = data;
+    const char* end = data + length;
+
+    // skip a byte order mark
+    while(m_bom_read < 3 && c != end)
+    {
+        if(static_cast<unsigned char>(*c) != BYTE_ORDER_MARK[m_bom_read])
+        {
+            if(m_bom_read != 0)
+            {
+                error("Invalid byte order mark.", c, chunk);
+            }
+            m_bom_read = 3;
+            break;
+        }
+        ++m_bom_read;
+        ++c;
+    }
+
+    while(c != end && m_expect != EXPECT_NOTHING)
+    {
+        switch(m_lex)
+        {
+            case LEX_NONE:
+            {
+                begin_token(c, chunk);
+                ++c;
+                break;
+            }
+            case LEX_STRING:
+            {
+                const char* start = c;
+                while(c != end && *c != '"' && *c != '\\')
+                {
+                    ++c;
+                }
+                if(c == end)
+                {
+                    m_token.append(start, c);
+                }
+                else if(*c == '\\')
+                {
+                    m_token.append(start, c + 1);
+                    m_escaped = true;
+                    m_lex = LEX_STRING_ESCAPE;
+                    ++c;
+                }
+                else if(m_token.empty())
+                {
+                    // the whole string is in this chunk
+                    end_string(start, c, c, chunk);
+                    ++c;
+                }
+                else
+                {
+                    m_token.append(start, c);
+                    end_string(
+                        m_token.data(),
+                        m_token.data() + m_token.size(),
+                        c,
+                        chunk
+                    );
+                    ++c;
+                }
+                break;
+            }
+            case LEX_STRING_ESCAPE:
+            {
+                m_token += *c;
+                m_lex = LEX_STRING;
+                ++c;
+                break;
+            }
+            case LEX_NUMBER_INTEGER:
+            {
+                if(is_digit(*c))
+                {
+                    m_token += *c;
+                    ++c;
+                }
+                else if(*c == '.')
+                {
+                    m_token += *c;
+                    m_lex = LEX_NUMBER_FRACTION;
+                    ++c;
+                }
+                else if(*c == 'e' || *c == 'E')
+                {
+                    m_token += *c;
+                    m_lex = LEX_NUMBER_EXPONENT_SIGN;
+                    ++c;
+                }
+                else
+                {
+                    // the terminating character is read as the next token
+                    end_number(c, chunk);
+                }
+                break;
+            }
+            case LEX_NUMBER_FRACTION:
+            {
+                if(is_digit(*c))
+                {
+                    m_token += *c;
+                    ++c;
+                }
+                else if(*c == 'e' || *c == 'E')
+                {
+                    m_token += *c;
+                    m_lex = LEX_NUMBER_EXPONENT_SIGN;
+                    ++c;
+                }
+                else
+                {
+                    end_number(c, chunk);
+                }
+                break;
+            }
+            case LEX_NUMBER_EXPONENT_SIGN:
+            {
+                if(*c == '+' || *c == '-' || is_digit(*c))
+                {
+                    m_token += *c;
+                    m_lex = LEX_NUMBER_EXPONENT;
+                    ++c;
+                }
+                else
+                {
+                    end_number(c, chunk);
+                }
+                break;
+            }
+            case LEX_NUMBER_EXPONENT:
+            {
+                if(is_digit(*c))
+                {
+                    m_token += *c;
+                    ++c;
+                }
+                else
+                {
+                    end_number(c, chunk);
+                }
+                break;
+            }
+            case LEX_LITERAL:
+            {
+                if(*c != m_literal[m_literal_read])
+                {
+                    error(
+                        "Syntax error: value, object or array expected.",
+                        c,
+                        chunk
+                    );
+                }
+                ++m_literal_read;
+                ++c;
+                if(m_literal[m_literal_read] == '\0')
+                {
+                    m_lex = LEX_NONE;
+                    if(m_literal[0] == 'n')
+                    {
+                        m_handler.null_value();
+                    }
+                    else
+                    {
+                        m_handler.bool_value(m_literal[0] == 't');
+                    }
+                    end_value();
+                }
+                break;
+            }
+            case LEX_COMMENT_START:
+            {
+                if(*c == '*')
+                {
+                    m_lex = LEX_BLOCK_COMMENT;
+                }
+                else if(*c == '/')
+                {
+                    m_lex = LEX_LINE_COMMENT;
+                }
+                else
+                {
+                    error("Syntax error: invalid comment.", c, chunk);
+                }
+                ++c;
+                break;
+            }
+            case LEX_LINE_COMMENT:
+            {
+                while(c != end && *c != '\n' && *c != '\r')
+                {
+                    ++c;
+                }
+                if(c != end)
+                {
+                    m_lex = LEX_NONE;
+                    ++c;
+                }
+                break;
+            }
+            case LEX_BLOCK_COMMENT:
+            {
+                const char* star =
+                    static_cast<const char*>(std::memchr(c, '*', end - c));
+                if(star == nullptr)
+                {
+                    c = end;
+                }
+                else
+                {
+                    m_lex = LEX_BLOCK_COMMENT_STAR;
+                    c = star + 1;
+                }
+                break;
+            }
+            case LEX_BLOCK_COMMENT_STAR:
+            {
+                if(*c == '/')
+                {
+                    m_lex = LEX_NONE;
+                }
+                else if(*c != '*')
+                {
+                    m_lex = LEX_BLOCK_COMMENT;
+                }
+                ++c;
+                break;
+            }
+        }
+    }
+
+    // track the line for error messages
+    const char* newline = chunk;
+    while(true)
+    {
+        newline = static_cast<const char*>(
+            std::memchr(newline, '\n', (chunk + length) - newline));
+        if(newline == nullptr)
+        {
+            break;
+        }
+        ++newline;
+        ++m_line;
+        m_line_start = m_offset + (newline - chunk);
+    }
+    m_offset += static_cast<arc::int64>(length);
+}
+
+void StreamParser::finish()
+{
+    switch(m_lex)
+    {
+        case LEX_NUMBER_INTEGER:
+        case LEX_NUMBER_FRACTION:
+        case LEX_NUMBER_EXPONENT_SIGN:
+        case LEX_NUMBER_EXPONENT:
+        {
+            end_number(nullptr, nullptr);
+            break;
+        }
+        case LEX_STRING:
+        case LEX_STRING_ESCAPE:
+        {
+            error("Missing '\"' at the end of a string.", nullptr, nullptr);
+            break;
+        }
+        case LEX_BLOCK_COMMENT:
+        case LEX_BLOCK_COMMENT_STAR:
+        {
+            error("Missing '*/' at the end of a comment.", nullptr, nullptr);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    if(m_expect != EXPECT_NOTHING)
+    {
+        // report what was expected
+        begin_token(nullptr, nullptr);
+    }
+}
+
+bool StreamParser::is_complete() const
+{
+    return m_expect == EXPECT_NOTHING;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void StreamParser::begin_token(const char* c, const char* chunk)
+{
+    bool expects_value =
+        m_expect == EXPECT_VALUE || m_expect == EXPECT_VALUE_OR_ARRAY_END;
+    char first = c == nullptr ? '\0' : *c;
+
+    if(is_space(first))
+    {
+        return;
+    }
+    if(first == '/')
+    {
+        m_lex = LEX_COMMENT_START;
+        return;
+    }
+
+    if(expects_value)
+    {
+        switch(first)
+        {
+            case '{':
+            {
+                m_handler.begin_object();
+                m_containers.push_back('{');
+                m_expect = EXPECT_KEY_OR_OBJECT_END;
+                return;
+            }
+            case '[':
+            {
+                m_handler.begin_array();
+                m_containers.push_back('[');
+                m_expect = EXPECT_VALUE_OR_ARRAY_END;
+                return;
+            }
+            case '"':
+            {
+                m_lex = LEX_STRING;
+                m_token.clear();
+                m_escaped = false;
+                return;
+            }
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+            {
+                m_lex = LEX_NUMBER_INTEGER;
+                m_token.assign(1, first);
+                return;
+            }
+            case 't':
+            {
+                m_lex = LEX_LITERAL;
+                m_literal = "true";
+                m_literal_read = 1;
+                return;
+            }
+            case 'f':
+            {
+                m_lex = LEX_LITERAL;
+                m_literal = "false";
+                m_literal_read = 1;
+                return;
+            }
+            case 'n':
+            {
+                m_lex = LEX_LITERAL;
+                m_literal = "null";
+                m_literal_read = 1;
+                return;
+            }
+            case ']':
+            {
+                if(m_expect == EXPECT_VALUE_OR_ARRAY_END)
+                {
+                    m_containers.pop_back();
+                    m_handler.end_array();
+                    end_value();
+                    return;
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+        error("Syntax error: value, object or array expected.", c, chunk);
+    }
+
+    switch(m_expect)
+    {
+        case EXPECT_KEY:
+        case EXPECT_KEY_OR_OBJECT_END:
+        {
+            if(first == '"')
+            {
+                m_lex = LEX_STRING;
+                m_token.clear();
+                m_escaped = false;
+                return;
+            }
+            if(first == '}' && m_expect == EXPECT_KEY_OR_OBJECT_END)
+            {
+                m_containers.pop_back();
+                m_handler.end_object();
+                end_value();
+                return;
+            }
+            error("Missing '}' or object member name", c, chunk);
+            break;
+        }
+        case EXPECT_COLON:
+        {
+            if(first == ':')
+            {
+                m_expect = EXPECT_VALUE;
+                return;
+            }
+            error("Missing ':' after object member name", c, chunk);
+            break;
+        }
+        case EXPECT_SEPARATOR:
+        {
+            bool in_object = m_containers.back() == '{';
+            if(first == ',')
+            {
+                m_expect = in_object ? EXPECT_KEY : EXPECT_VALUE;
+                return;
+            }
+            if(in_object && first == '}')
+            {
+                m_containers.pop_back();
+                m_handler.end_object();
+                end_value();
+                return;
+            }
+            if(!in_object && first == ']')
+            {
+                m_containers.pop_back();
+                m_handler.end_array();
+                end_value();
+                return;
+            }
+            if(in_object)
+            {
+                error("Missing ',' or '}' in object declaration", c, chunk);
+            }
+            error("Missing ',' or ']' in array declaration", c, chunk);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+void StreamParser::end_value()
+{
+    m_expect = m_containers.empty() ? EXPECT_NOTHING : EXPECT_SEPARATOR;
+}
+
+void StreamParser::end_string(
+        const char* begin,
+        const char* end,
+        const char* c,
+        const char* chunk)
+{
+    m_lex = LEX_NONE;
+
+    if(!FileData::is_valid_utf8(begin, end - begin))
+    {
+        error("Invalid UTF-8 in string.", c, chunk);
+    }
+
+    // decode escape sequences
+    if(m_escaped)
+    {
+        m_decoded.clear();
+        m_decoded.reserve(end - begin);
+        const char* s = begin;
+        while(s != end)
+        {
+            const char* escape =
+                static_cast<const char*>(std::memchr(s, '\\', end - s));
+            if(escape == nullptr)
+            {
+                m_decoded.append(s, end);
+                break;
+            }
+            m_decoded.append(s, escape);
+            s = escape + 1;
+            if(s == end)
+            {
+                error("Empty escape sequence in string", c, chunk);
+            }
+            switch(*s++)
+            {
+                case '"':
+                    m_decoded += '"';
+                    break;
+                case '/':
+                    m_decoded += '/';
+                    break;
+                case '\\':
+                    m_decoded += '\\';
+                    break;
+                case 'b':
+                    m_decoded += '\b';
+                    break;
+                case 'f':
+                    m_decoded += '\f';
+                    break;
+                case 'n':
+                    m_decoded += '\n';
+                    break;
+                case 'r':
+                    m_decoded += '\r';
+                    break;
+                case 't':
+                    m_decoded += '\t';
+                    break;
+                case 'u':
+                {
+                    unsigned int code_point = 0;
+                    if(!decode_hex(s, end, code_point))
+                    {
+                        error(
+                            "Bad unicode escape sequence in string: four "
+                            "hexadecimal digits expected.",
+                            c,
+                            chunk
+                        );
+                    }
+                    if(code_point >= 0xD800 && code_point <= 0xDBFF)
+                    {
+                        // surrogate pair
+                        unsigned int low = 0;
+                        if(end - s < 6 ||
+                           s[0] != '\\' ||
+                           s[1] != 'u' ||
+                           !decode_hex(s += 2, end, low))
+                        {
+                            error(
+                                "expecting another \\u token to begin the "
+                                "second half of a unicode surrogate pair",
+                                c,
+                                chunk
+                            );
+                        }
+                        code_point = 0x10000 +
+                                     ((code_point & 0x3FF) << 10) +
+                                     (low & 0x3FF);
+                    }
+                    append_code_point(code_point, m_decoded);
+                    break;
+                }
+                default:
+                    error("Bad escape sequence in string", c, chunk);
+            }
+        }
+        begin = m_decoded.data();
+        end = begin + m_decoded.size();
+    }
+
+    if(m_expect == EXPECT_KEY || m_expect == EXPECT_KEY_OR_OBJECT_END)
+    {
+        m_handler.key(begin, end);
+        m_expect = EXPECT_COLON;
+    }
+    else
+    {
+        m_handler.string_value(begin, end);
+        end_value();
+    }
+}
+
+void StreamParser::end_number(const char* c, const char* chunk)
+{
+    m_lex = LEX_NONE;
+
+    // decoded the same way as Json::Reader, as an integer if it fits
+    const char* current = m_token.data();
+    const char* end = current + m_token.size();
+    bool negative = *current == '-';
+    if(negative)
+    {
+        ++current;
+    }
+    Json::LargestUInt max_value = negative ?
+        Json::LargestUInt(Json::Value::maxLargestInt) + 1 :
+        Json::Value::maxLargestUInt;
+    Json::LargestUInt threshold = max_value / 10;
+    Json::LargestUInt value = 0;
+    bool is_integer = current != end;
+    while(current != end)
+    {
+        char digit_c = *current++;
+        if(!is_digit(digit_c))
+        {
+            is_integer = false;
+            break;
+        }
+        Json::LargestUInt digit = static_cast<Json::LargestUInt>(digit_c - '0');
+        if(value >= threshold &&
+           (value > threshold || current != end || digit > max_value % 10))
+        {
+            is_integer = false;
+            break;
+        }
+        value = value * 10 + digit;
+    }
+
+    if(is_integer)
+    {
+        if(negative && value == max_value)
+        {
+            m_handler.int_value(Json::Value::minLargestInt);
+        }
+        else if(negative)
+        {
+            m_handler.int_value(-Json::LargestInt(value));
+        }
+        else if(value <= Json::LargestUInt(Json::Value::maxInt))
+        {
+            m_handler.int_value(Json::LargestInt(value));
+        }
+        else
+        {
+            m_handler.uint_value(value);
+        }
+        end_value();
+        return;
+    }
+
+    double d = 0.0;
+    char* parsed_end = nullptr;
+    d = std::strtod(m_token.c_str(), &parsed_end);
+    if(parsed_end != m_token.c_str() + m_token.size())
+    {
+        // fall back to the stream conversion Json::Reader uses
+        std::istringstream stream(m_token);
+        if(!(stream >> d))
+        {
+            std::string message("'" + m_token + "' is not a number.");
+            error(message.c_str(), c, chunk);
+        }
+    }
+    m_handler.double_value(d);
+    end_value();
+}
+
+void StreamParser::error(
+        const char* message,
+        const char* c,
+        const char* chunk)
+{
+    // find the line of the character within the chunk
+    std::size_t line = m_line;
+    arc::int64 line_start = m_line_start;
+    for(const char* p = chunk; p != c; ++p)
+    {
+        if(*p == '\n')
+        {
+            ++line;
+            line_start = m_offset + (p - chunk) + 1;
+        }
+    }
+    arc::int64 column = m_offset + (c - chunk) - line_start + 1;
+
+    arc::str::UTF8String error_message;
+    error_message << "* Line " << line << ", Column " << column << "\n  "
+                  << message << "\n";
+    throw arc::ex::ParseError(error_message);
+}
+
+//------------------------------------------------------------------------------
+//                                  TREE BUILDER
+//------------------------------------------------------------------------------
+
+TreeBuilder::TreeBuilder(
+        Json::Value& root,
+        const std::vector<arc::str::UTF8String>& projection)
+    :
+    m_root      (root),
+    m_skip_depth(0)
+{
+    ARC_CONST_FOR_EACH(key, projection)
+    {
+        m_projection.push_back(
+            std::string(key->get_raw(), key->get_byte_length() - 1));
+    }
+}
+
+void TreeBuilder::begin_object()
+{
+    begin_container(Json::objectValue);
+}
+
+void TreeBuilder::end_object()
+{
+    end_container();
+}
+
+void TreeBuilder::begin_array()
+{
+    begin_container(Json::arrayValue);
+}
+
+void TreeBuilder::end_array()
+{
+    end_container();
+}
+
+void TreeBuilder::key(const char* begin, const char* end)
+{
+    if(m_skip_depth == 0)
+    {
+        m_key.assign(begin, end);
+    }
+}
+
+void TreeBuilder::null_value()
+{
+    // values are null when they are created
+    next_scalar();
+}
+
+void TreeBuilder::bool_value(bool value)
+{
+    Json::Value* target = next_scalar();
+    if(target != nullptr)
+    {
+        Json::Value decoded(value);
+        target->swapPayload(decoded);
+    }
+}
+
+void TreeBuilder::int_value(Json::LargestInt value)
+{
+    Json::Value* target = next_scalar();
+    if(target != nullptr)
+    {
+        Json::Value decoded(value);
+        target->swapPayload(decoded);
+    }
+}
+
+void TreeBuilder::uint_value(Json::LargestUInt value)
+{
+    Json::Value* target = next_scalar();
+    if(target != nullptr)
+    {
+        Json::Value decoded(value);
+        target->swapPayload(decoded);
+    }
+}
+
+void TreeBuilder::double_value(double value)
+{
+    Json::Value* target = next_scalar();
+    if(target != nullptr)
+    {
+        Json::Value decoded(value);
+        target->swapPayload(decoded);
+    }
+}
+
+void TreeBuilder::string_value(const char* begin, const char* end)
+{
+    Json::Value* target = next_scalar();
+    if(target != nullptr)
+    {
+        Json::Value decoded(begin, end);
+        target->swapPayload(decoded);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+Json::Value* TreeBuilder::next_value(bool container, Mode& mode)
+{
+    if(m_skip_depth != 0)
+    {
+        return nullptr;
+    }
+
+    if(m_frames.empty())
+    {
+        m_path.clear();
+        if(m_projection.empty())
+        {
+            mode = MODE_ALL;
+            return &m_root;
+        }
+        mode = MODE_PARTIAL;
+        return container ? &m_root : nullptr;
+    }
+
+    Frame& frame = m_frames.back();
+    if(frame.value->type() == Json::arrayValue)
+    {
+        mode = MODE_ALL;
+        return &(*frame.value)[frame.index++];
+    }
+    if(frame.mode == MODE_ALL)
+    {
+        mode = MODE_ALL;
+        return &(*frame.value)[m_key];
+    }
+
+    // is the member, or something below it, projected?
+    m_path.resize(frame.path_length);
+    if(!m_path.empty())
+    {
+        m_path += '.';
+    }
+    m_path += m_key;
+    bool ancestor = false;
+    ARC_CONST_FOR_EACH(key, m_projection)
+    {
+        if(key->size() < m_path.size() ||
+           key->compare(0, m_path.size(), m_path) != 0)
+        {
+            continue;
+        }
+        if(key->size() == m_path.size())
+        {
+            mode = MODE_ALL;
+            return &(*frame.value)[m_key];
+        }
+        if((*key)[m_path.size()] == '.')
+        {
+            ancestor = true;
+        }
+    }
+    // only containers can hold the projected keys
+    if(!ancestor || !container)
+    {
+        return nullptr;
+    }
+    mode = MODE_PARTIAL;
+    return &(*frame.value)[m_key];
+}
+
+Json::Value* TreeBuilder::next_scalar()
+{
+    Mode mode = MODE_ALL;
+    return next_value(false, mode);
+}
+
+void TreeBuilder::begin_container(Json::ValueType type)
+{
+    Mode mode = MODE_ALL;
+    Json::Value* value = next_value(true, mode);
+    if(value == nullptr)
+    {
+        ++m_skip_depth;
+        return;
+    }
+
+    Json::Value init(type);
+    value->swapPayload(init);
+
+    Frame frame;
+    frame.value       = value;
+    frame.mode        = mode;
+    frame.path_length = m_path.size();
+    frame.index       = 0;
+    m_frames.push_back(frame);
+}
+
+void TreeBuilder::end_container()
+{
+    if(m_skip_depth != 0)
+    {
+        --m_skip_depth;
+        return;
+    }
+    m_frames.pop_back();
+}
+
+} // namespace metaengine
@@ -0,0 +1,396 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_STREAMPARSER_HPP_
+#define METAENGINE_STREAMPARSER_HPP_
+
+#include <string>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+/*!
+ * \brief Event driven JSON parser that is fed its input in chunks.
+ *
+ * Rather than requiring the whole input to be in memory, data is passed to
+ * feed() as it becomes available (e.g. as a file is read) and the parser
+ * reports each value to a Handler as soon as it is complete, keeping only the
+ * token currently being read. Tokens may be split across any number of
+ * chunks.
+ *
+ * The accepted syntax matches Json::Reader: C and C++ style comments are
+ * allowed, numbers are decoded to the same types, and anything following the
+ * root value is ignored. Additionally a leading UTF-8 byte order mark is
+ * skipped, and strings that are not valid UTF-8 are rejected.
+ */
+class StreamParser
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(StreamParser);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                  CLASSES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Receives the events of a StreamParser.
+     *
+     * Every value is reported exactly once: a scalar with one of the value
+     * functions, and an object or array as a begin, its contents, then an end.
+     * Each member of an object is preceded by a call to key().
+     */
+    class Handler
+    {
+    public:
+
+        virtual ~Handler();
+
+        virtual void begin_object() = 0;
+
+        virtual void end_object() = 0;
+
+        virtual void begin_array() = 0;
+
+        virtual void end_array() = 0;
+
+        /*!
+         * \brief Called with the decoded name of the next member of the
+         *        current object.
+         */
+        virtual void key(const char* begin, const char* end) = 0;
+
+        virtual void null_value() = 0;
+
+        virtual void bool_value(bool value) = 0;
+
+        virtual void int_value(Json::LargestInt value) = 0;
+
+        virtual void uint_value(Json::LargestUInt value) = 0;
+
+        virtual void double_value(double value) = 0;
+
+        /*!
+         * \brief Called with a decoded string value.
+         */
+        virtual void string_value(const char* begin, const char* end) = 0;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new parser which reports to the given handler.
+     */
+    explicit StreamParser(Handler& handler);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Parses the next chunk of the input.
+     *
+     * \throws arc::ex::ParseError If the input is not valid JSON. The parser
+     *                             should not be used again.
+     */
+    void feed(const char* data, std::size_t length);
+
+    /*!
+     * \brief Signals the end of the input.
+     *
+     * \throws arc::ex::ParseError If the input ended before the root value
+     *                             was complete.
+     */
+    void finish();
+
+    /*!
+     * \brief Returns whether the root value has been completely parsed.
+     */
+    bool is_complete() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                            PRIVATE ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief What the parser expects to read next.
+     */
+    enum Expect
+    {
+        EXPECT_VALUE = 0,
+        EXPECT_VALUE_OR_ARRAY_END,
+        EXPECT_KEY,
+        EXPECT_KEY_OR_OBJECT_END,
+        EXPECT_COLON,
+        EXPECT_SEPARATOR,
+        EXPECT_NOTHING
+    };
+
+    /*!
+     * \brief The token that is currently being read.
+     */
+    enum Lex
+    {
+        LEX_NONE = 0,
+        LEX_STRING,
+        LEX_STRING_ESCAPE,
+        LEX_NUMBER_INTEGER,
+        LEX_NUMBER_FRACTION,
+        LEX_NUMBER_EXPONENT_SIGN,
+        LEX_NUMBER_EXPONENT,
+        LEX_LITERAL,
+        LEX_COMMENT_START,
+        LEX_LINE_COMMENT,
+        LEX_BLOCK_COMMENT,
+        LEX_BLOCK_COMMENT_STAR
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    Handler& m_handler;
+    Expect m_expect;
+    Lex m_lex;
+    /*!
+     * \brief The open containers, '{' or '['.
+     */
+    std::vector<char> m_containers;
+    /*!
+     * \brief The raw text of the current token if it spans more than one
+     *        chunk, or is a number.
+     */
+    std::string m_token;
+    /*!
+     * \brief Whether the current string token contains escape sequences.
+     */
+    bool m_escaped;
+    /*!
+     * \brief The literal ("true", "false" or "null") being read, and how many
+     *        of its characters have been read.
+     */
+    const char* m_literal;
+    std::size_t m_literal_read;
+    /*!
+     * \brief The number of bytes of the byte order mark that have been read,
+     *        or 3 once the start of the input has been passed.
+     */
+    std::size_t m_bom_read;
+    /*!
+     * \brief Buffer strings are decoded into.
+     */
+    std::string m_decoded;
+    /*!
+     * \brief The line number, and the number of bytes read before the start
+     *        of the current line (relative to m_offset).
+     */
+    std::size_t m_line;
+    arc::int64 m_line_start;
+    /*!
+     * \brief The number of bytes in the chunks before the current chunk.
+     */
+    arc::int64 m_offset;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Handles the first character of a token, or a structural
+     *        character.
+     */
+    void begin_token(const char* c, const char* chunk);
+
+    /*!
+     * \brief Called once a value (scalar or container) has been completed.
+     */
+    void end_value();
+
+    /*!
+     * \brief Decodes and reports the complete raw string token.
+     */
+    void end_string(
+            const char* begin,
+            const char* end,
+            const char* c,
+            const char* chunk);
+
+    /*!
+     * \brief Decodes and reports the complete number in m_token.
+     */
+    void end_number(const char* c, const char* chunk);
+
+    /*!
+     * \brief Throws a ParseError with the location of the given character in
+     *        the current chunk.
+     */
+    void error(
+            const char* message,
+            const char* c,
+            const char* chunk);
+};
+
+/*!
+ * \brief StreamParser Handler which builds a Json::Value tree.
+ *
+ * Values are allocated as usual, so a Json::MemoryResource::Scope and
+ * Json::KeyInterner::Scope may be used to allocate the tree from an Arena.
+ *
+ * A projection can be given to only build part of the tree: a list of keys in
+ * the form Document::get() takes, e.g. "window.size". Only the values at
+ * those keys (and everything below them) and the objects containing them are
+ * built, while every other value is parsed but immediately discarded. The
+ * elements of an array are either all kept or all discarded.
+ */
+class TreeBuilder : public StreamParser::Handler
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(TreeBuilder);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Creates a new builder which builds into the given root value.
+     *
+     * \param projection The keys to build, or empty to build everything.
+     */
+    TreeBuilder(
+            Json::Value& root,
+            const std::vector<arc::str::UTF8String>& projection);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    virtual void begin_object(); // override
+
+    virtual void end_object(); // override
+
+    virtual void begin_array(); // override
+
+    virtual void end_array(); // override
+
+    virtual void key(const char* begin, const char* end); // override
+
+    virtual void null_value(); // override
+
+    virtual void bool_value(bool value); // override
+
+    virtual void int_value(Json::LargestInt value); // override
+
+    virtual void uint_value(Json::LargestUInt value); // override
+
+    virtual void double_value(double value); // override
+
+    virtual void string_value(const char* begin, const char* end); // override
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                            PRIVATE ENUMERATORS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief How much of a value is built.
+     */
+    enum Mode
+    {
+        /// The value and everything below it is built.
+        MODE_ALL = 0,
+        /// The value is an ancestor of a projected key, so only some of its
+        /// members are built.
+        MODE_PARTIAL
+    };
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A container that is being built.
+     */
+    struct Frame
+    {
+        Json::Value* value;
+        Mode mode;
+        /// The length of the key of the container within m_path.
+        std::size_t path_length;
+        /// The index of the next element if the container is an array.
+        Json::ArrayIndex index;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    Json::Value& m_root;
+    /*!
+     * \brief The projected keys.
+     */
+    std::vector<std::string> m_projection;
+    std::vector<Frame> m_frames;
+    /*!
+     * \brief The number of containers being discarded.
+     */
+    std::size_t m_skip_depth;
+    /*!
+     * \brief The name of the next member of the current object.
+     */
+    std::string m_key;
+    /*!
+     * \brief The key of the value being built, when in MODE_PARTIAL.
+     */
+    std::string m_path;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the value the next value should be built into, or null if
+     *        it should be discarded.
+     *
+     * \param container Whether the next value is an object or an array.
+     * \param mode Returns how much of the value should be built.
+     */
+    Json::Value* next_value(bool container, Mode& mode);
+
+    /*!
+     * \brief Returns the value the next scalar should be stored in, or null if
+     *        it should be discarded.
+     */
+    Json::Value* next_scalar();
+
+    /*!
+     * \brief Begins building a container of the given type.
+     */
+    void begin_container(Json::ValueType type);
+
+    /*!
+     * \brief Ends the current container.
+     */
+    void end_container();
+};
+
+} // namespace metaengine
+
+#endif
@@ -1,17 +1,25 @@
 #include "metaengine/Variant.hpp"
 
+#include <algorithm>
+
 #include <arcanecore/base/Exceptions.hpp>
 #include <arcanecore/base/str/StringOperations.hpp>
-#include <arcanecore/io/sys/FileReader.hpp>
 
 #include <json/json.h>
 
-// TODO: REMOVE ME
-#include <iostream>
+#include "metaengine/Arena.hpp"
+#include "metaengine/FileData.hpp"
+#include "metaengine/ParseCache.hpp"
 
 namespace metaengine
 {
 
+//------------------------------------------------------------------------------
+//                           PRIVATE STATIC ATTRIBUTES
+//------------------------------------------------------------------------------
+
+const std::size_t Variant::NO_COLUMN = static_cast<std::size_t>(-1);
+
 //------------------------------------------------------------------------------
 //                                  CONSTRUCTORS
 //------------------------------------------------------------------------------
@@ -24,7 +32,8 @@ Variant::Variant(
     Document         (apply_variant(file_path, default_variant), false),
     m_base_path      (file_path),
     m_default_variant(default_variant),
-    m_current_variant(default_variant)
+    m_current_variant(default_variant),
+    m_column         (NO_COLUMN)
 {
     if(load_immediately)
     {
@@ -41,7 +50,8 @@ Variant::Variant(
     Document         (apply_variant(file_path, default_variant), memory, false),
     m_base_path      (file_path),
     m_default_variant(default_variant),
-    m_current_variant(default_variant)
+    m_current_variant(default_variant),
+    m_column         (NO_COLUMN)
 {
     if(load_immediately)
     {
@@ -49,23 +59,227 @@ Variant::Variant(
     }
 }
 
+//------------------------------------------------------------------------------
+//                                   DESTRUCTOR
+//------------------------------------------------------------------------------
+
+Variant::~Variant()
+{
+    wait_for_load();
+}
+
 //------------------------------------------------------------------------------
 //                            PUBLIC MEMBER FUNCTIONS
 //------------------------------------------------------------------------------
 
-void Variant::reload()
+void Variant::set_variant(const arc::str::UTF8String& variant)
+{
+    wait_for_load();
+
+    std::vector<std::shared_ptr<const ArenaTree>> previous;
+    if(has_subscriptions())
+    {
+        get_trees(previous);
+    }
+    switch_variant(variant);
+    notify_subscribers(previous);
+}
+
+void Variant::load_table(const std::vector<arc::str::UTF8String>& variants)
+{
+    wait_for_load();
+
+    m_table_variants.clear();
+    ARC_CONST_FOR_EACH(variant, variants)
+    {
+        // the default variant is always the first column
+        if(*variant == m_default_variant ||
+           std::find(
+                m_table_variants.begin(),
+                m_table_variants.end(),
+                *variant
+           ) != m_table_variants.end())
+        {
+            continue;
+        }
+        m_table_variants.push_back(*variant);
+    }
+
+    build_table();
+    m_variant_root.reset();
+    switch_variant(m_current_variant);
+}
+
+void Variant::clear_table()
+{
+    wait_for_load();
+
+    if(m_table == nullptr)
+    {
+        return;
+    }
+
+    m_table_variants.clear();
+    build_table();
+    switch_variant(m_current_variant);
+}
+
+//------------------------------------------------------------------------------
+//                           PROTECTED MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Variant::load()
 {
     // super call
-    Document::reload();
+    Document::load();
+
+    // the table references the previous data so must be rebuilt
+    build_table();
 
     // load the variant
-    set_variant(m_current_variant);
+    switch_variant(m_current_variant);
 }
 
-void Variant::set_variant(const arc::str::UTF8String& variant)
+VisitorBase* Variant::get(
+        const arc::str::UTF8String& key,
+        VisitorBase* visitor)
+{
+    // is the current variant in the table?
+    if(m_column != NO_COLUMN)
+    {
+        return table_get(key, visitor);
+    }
+
+    // is there variant data?
+    if(m_variant_root != nullptr)
+    {
+        // attempt to get the JSON value (null if the key couldn't be found)
+        const Json::Value* data = find_value(m_variant_root->get_root(), key);
+        if (data != nullptr)
+        {
+            // hand off to the base implementation with data
+            return Document::get(
+                data,
+                key,
+                visitor,
+                Statistics::SOURCE_VARIANT
+            );
+        }
+
+        if(m_statistics != nullptr)
+        {
+            m_statistics->record_variant_miss();
+        }
+    }
+
+    // hand off to the base implementation without data
+    return Document::get(key, visitor);
+}
+
+const Json::Value* Variant::find_resolved(
+        const arc::str::UTF8String& key) const
+{
+    // mirrors get(), the variant is tried before the default variant
+    if(m_column != NO_COLUMN)
+    {
+        std::size_t row = m_table->find_row(key);
+        if(m_column != 0 && m_table_trees[m_column - 1] != nullptr)
+        {
+            const Json::Value* data = find_variant_value(key, row);
+            if(data != nullptr)
+            {
+                return data;
+            }
+        }
+        if(row != VariantTable::NO_ROW)
+        {
+            const Json::Value* data = m_table->get_cell(0, row);
+            if(data != nullptr)
+            {
+                return data;
+            }
+        }
+    }
+    else if(m_variant_root != nullptr)
+    {
+        const Json::Value* data = find_value(m_variant_root->get_root(), key);
+        if(data != nullptr)
+        {
+            return data;
+        }
+    }
+
+    return Document::find_resolved(key);
+}
+
+void Variant::get_trees(
+        std::vector<std::shared_ptr<const ArenaTree>>& trees) const
+{
+    // the current variant is retrieved from before the default variant, and
+    // is null when the current variant is the default variant
+    if(m_column == NO_COLUMN)
+    {
+        trees.push_back(m_variant_root);
+    }
+    else if(m_column == 0)
+    {
+        trees.push_back(nullptr);
+    }
+    else
+    {
+        trees.push_back(m_table_trees[m_column - 1]);
+    }
+
+    // super call
+    Document::get_trees(trees);
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+arc::io::sys::Path Variant::apply_variant(
+        const arc::io::sys::Path& file_path,
+        const arc::str::UTF8String& variant)
+{
+    // is the variant empty? then just return the original path
+    if(variant.is_empty())
+    {
+        return file_path;
+    }
+
+    // extract the filename from the path
+    arc::io::sys::Path ret(file_path);
+    arc::str::UTF8String filename(ret.get_back());
+    ret.remove(ret.get_length() - 1);
+
+    // split the filename to find the suffix
+    std::vector<arc::str::UTF8String> components(filename.split("."));
+    assert(!components.empty());
+    // no extension on the path?
+    if(components.size() == 1)
+    {
+        components.push_back(variant);
+    }
+    else
+    {
+        components.insert(components.end() - 1, variant);
+    }
+
+    // append the filename again and return
+    ret.join(arc::str::join(components, "."));
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+void Variant::switch_variant(const arc::str::UTF8String& variant)
 {
     // is the same as the current variant?
-    if(variant == m_current_variant && m_variant_root != nullptr)
+    if(variant == m_current_variant &&
+       (m_variant_root != nullptr || m_column != NO_COLUMN))
     {
         // do nothing
         return;
@@ -74,6 +288,14 @@ void Variant::set_variant(const arc::str::UTF8String& variant)
     m_current_variant = variant;
     // unload the current variant
     m_variant_root.reset();
+    new_version();
+
+    // is the variant in the table? then it's already loaded
+    m_column = find_column(m_current_variant);
+    if(m_column != NO_COLUMN)
+    {
+        return;
+    }
 
     // is the default variant?
     if(m_current_variant == m_default_variant)
@@ -82,38 +304,54 @@ void Variant::set_variant(const arc::str::UTF8String& variant)
         return;
     }
 
+    load_variant(m_current_variant, m_variant_root);
+}
+
+void Variant::load_variant(
+        const arc::str::UTF8String& variant,
+        std::shared_ptr<const ArenaTree>& tree,
+        const std::shared_ptr<const ArenaTree>& previous)
+{
     // evaluate the file path for the variant
     arc::io::sys::Path variant_path(
-        apply_variant(m_base_path, m_current_variant));
+        apply_variant(m_base_path, variant));
 
     // construct an optimised string to contain the file data
     arc::str::UTF8String file_data(
         arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+    // or the chunks of the file when streaming
+    std::unique_ptr<FileChunks> chunks;
 
     // attempt to read data from the file
     bool read_success = false;
     try
     {
-        // open the reader
-        arc::io::sys::FileReader json_file(
-            variant_path,
-            arc::io::sys::FileReader::ENCODING_DETECT,
-            arc::io::sys::FileReader::NEWLINE_UNIX
-        );
-        // read
-        json_file.read(file_data);
-        // close
-        json_file.close();
+        LoadTimings::Scope timing(
+            m_load_timings.phases[LoadTimings::PHASE_VARIANT_READ]);
+        if(is_streaming())
+        {
+            // the file is read as it is parsed
+            chunks.reset(new FileChunks(variant_path));
+        }
+        else
+        {
+            FileData::read(variant_path, file_data);
+            timing.add_bytes(file_data.get_byte_length() - 1);
+        }
         read_success = true;
     }
     catch(const arc::ex::ArcException& exc)
     {
         // trigger a warning
-        arc::str::UTF8String error_message;
-        error_message << "Failed to load data for variant \""
-                      << m_current_variant << "\": " << exc.get_type() << ": "
-                      << exc.get_message();
-        Document::s_load_reporter(variant_path, error_message);
+        report_fallback(
+            FallbackEvent::TYPE_LOAD,
+            variant_path,
+            "",
+            "Failed to load data with",
+            exc.get_type(),
+            exc.get_message(),
+            variant
+        );
         return;
     }
 
@@ -122,89 +360,168 @@ void Variant::set_variant(const arc::str::UTF8String& variant)
     {
         try
         {
-            parse(file_data, m_variant_root);
+            if(chunks != nullptr)
+            {
+                stream_parse(
+                    *chunks,
+                    variant_path,
+                    tree,
+                    LoadTimings::PHASE_VARIANT_READ,
+                    LoadTimings::PHASE_VARIANT_PARSE
+                );
+            }
+            else
+            {
+                LoadTimings::Scope timing(
+                    m_load_timings.phases[LoadTimings::PHASE_VARIANT_PARSE]);
+                timing.add_bytes(file_data.get_byte_length() - 1);
+                parse(
+                    file_data,
+                    tree,
+                    ParseCache::file_source(variant_path),
+                    previous
+                );
+            }
         }
         catch(const arc::ex::ParseError& exc)
         {
             // trigger a warning
-            arc::str::UTF8String error_message;
-            error_message << "Failed to parse data for variant \""
-                          << m_current_variant << "\" with message:\n"
-                          << exc.what();
-            Document::s_load_reporter(variant_path, error_message);
+            report_fallback(
+                FallbackEvent::TYPE_LOAD,
+                variant_path,
+                "",
+                "Failed to parse data with",
+                exc.get_type(),
+                exc.what(),
+                variant
+            );
             return;
         }
     }
 }
 
-//------------------------------------------------------------------------------
-//                           PROTECTED MEMBER FUNCTIONS
-//------------------------------------------------------------------------------
-
-VisitorBase* Variant::get(
-        const arc::str::UTF8String& key,
-        VisitorBase* visitor)
+void Variant::build_table()
 {
-    // is there variant data?
-    if(m_variant_root != nullptr)
+    // keep the existing trees until the new trees have been parsed if their
+    // subtrees may be shared
+    std::vector<std::shared_ptr<const ArenaTree>> previous_trees;
+    if(is_subtree_sharing_enabled())
     {
-        // attempt to get the JSON value
-        const Json::Value* data = nullptr;
-        try
-        {
-            data = get_value(m_variant_root.get(), key);
-        }
-        catch(...)
+        previous_trees.swap(m_table_trees);
+    }
+
+    m_table.reset();
+    m_table_trees.clear();
+    m_column = NO_COLUMN;
+    if(m_table_variants.empty())
+    {
+        return;
+    }
+
+    std::unique_ptr<VariantTable> table(new VariantTable());
+
+    // the default variant, the table holds every section of sharded data
+    const Json::Value* default_root = nullptr;
+    if(m_file_root != nullptr)
+    {
+        default_root = get_tree_root(*m_file_root, "");
+    }
+    table->add_column(default_root);
+
+    // each of the other variants
+    ARC_CONST_FOR_EACH(variant, m_table_variants)
+    {
+        std::shared_ptr<const ArenaTree> tree;
+        std::shared_ptr<const ArenaTree> previous;
+        if(m_table_trees.size() < previous_trees.size())
         {
-            // the key couldn't be found
-            data = nullptr;
+            previous = previous_trees[m_table_trees.size()];
         }
-        if (data != nullptr)
+        load_variant(*variant, tree, previous);
+        const Json::Value* root = nullptr;
+        if(tree != nullptr)
         {
-            // hand off to the base implementation with data
-            return Document::get(data, key, visitor);
+            root = tree->get_root();
         }
+        table->add_column(root);
+        m_table_trees.push_back(std::move(tree));
     }
 
-    // hand off to the base implementation without data
-    return Document::get(key, visitor);
+    m_table = std::move(table);
 }
 
-//------------------------------------------------------------------------------
-//                            PRIVATE STATIC FUNCTIONS
-//------------------------------------------------------------------------------
-
-arc::io::sys::Path Variant::apply_variant(
-        const arc::io::sys::Path& file_path,
-        const arc::str::UTF8String& variant)
+std::size_t Variant::find_column(const arc::str::UTF8String& variant) const
 {
-    // is the variant empty? then just return the original path
-    if(variant.is_empty())
+    if(m_table == nullptr)
     {
-        return file_path;
+        return NO_COLUMN;
+    }
+    if(variant == m_default_variant)
+    {
+        return 0;
+    }
+    for(std::size_t i = 0; i < m_table_variants.size(); ++i)
+    {
+        if(m_table_variants[i] == variant)
+        {
+            return i + 1;
+        }
     }
+    return NO_COLUMN;
+}
 
-    // extract the filename from the path
-    arc::io::sys::Path ret(file_path);
-    arc::str::UTF8String filename(ret.get_back());
-    ret.remove(ret.get_length() - 1);
+VisitorBase* Variant::table_get(
+        const arc::str::UTF8String& key,
+        VisitorBase* visitor)
+{
+    std::size_t row = m_table->find_row(key);
 
-    // split the filename to find the suffix
-    std::vector<arc::str::UTF8String> components(filename.split("."));
-    assert(!components.empty());
-    // no extension on the path?
-    if(components.size() == 1)
+    // is the current variant a non-default variant that loaded successfully?
+    if(m_column != 0 && m_table_trees[m_column - 1] != nullptr)
     {
-        components.push_back(variant);
+        const Json::Value* data = find_variant_value(key, row);
+        if(data != nullptr)
+        {
+            return Document::get(
+                data,
+                key,
+                visitor,
+                Statistics::SOURCE_VARIANT
+            );
+        }
+
+        if(m_statistics != nullptr)
+        {
+            m_statistics->record_variant_miss();
+        }
     }
-    else
+
+    // fallback to the default variant
+    if(row != VariantTable::NO_ROW)
     {
-        components.insert(components.end() - 1, variant);
+        const Json::Value* data = m_table->get_cell(0, row);
+        if(data != nullptr)
+        {
+            return Document::get(data, key, visitor);
+        }
     }
 
-    // append the filename again and return
-    ret.join(arc::str::join(components, "."));
-    return ret;
+    // the base implementation handles falling back to memory and reporting
+    // missing keys
+    return Document::get(key, visitor);
+}
+
+const Json::Value* Variant::find_variant_value(
+        const arc::str::UTF8String& key,
+        std::size_t row) const
+{
+    if(row != VariantTable::NO_ROW)
+    {
+        return m_table->get_cell(m_column, row);
+    }
+    // keys that are not in the table (e.g. the elements of arrays) are found
+    // in the variant's own tree
+    return find_value(m_table_trees[m_column - 1]->get_root(), key);
 }
 
 } // namespace metaengine
@@ -6,6 +6,7 @@
 #define METAENGINE_VARIANT_HPP_
 
 #include "metaengine/Document.hpp"
+#include "metaengine/VariantTable.hpp"
 
 namespace metaengine
 {
@@ -27,6 +28,10 @@ namespace metaengine
  * would be applied like so: ```path/to/my/file.variant.json```.
  * However if the file has no extension e.g. ```path/to/my/file``` the variant
  * will be applied as the extension: ```path/to/my/file.variant```
+ *
+ * If the set of variants that will be used is known up front they can be
+ * loaded into a columnar table with load_table(). Each variant is then parsed
+ * once, and switching between them is just a change of the active column.
  */
 class Variant : public Document
 {
@@ -85,17 +90,12 @@ public:
     //                                 DESTRUCTOR
     //--------------------------------------------------------------------------
 
-    virtual ~Variant()
-    {
-    }
+    virtual ~Variant();
 
     //--------------------------------------------------------------------------
     //                          PUBLIC MEMBER FUNCTIONS
     //--------------------------------------------------------------------------
 
-    // override
-    virtual void reload();
-
     /*!
      * \brief Sets the current variant to use for this Document.
      *
@@ -104,6 +104,31 @@ public:
      */
     void set_variant(const arc::str::UTF8String& variant);
 
+    /*!
+     * \brief Loads the given variants, along with the default variant, into a
+     *        single columnar table.
+     *
+     * Every variant file is parsed once, here (and again on each reload),
+     * after which calling set_variant() with any of the variants only switches
+     * the active column of the table without reading or parsing anything.
+     * Retrieving a value is a single probe of the table's key index followed
+     * by a read of the active column, falling back to the default variant's
+     * column if the current variant has no value for the key.
+     *
+     * Variants that are not in the table can still be set, they are loaded
+     * the same way as they are without a table. Data loaded from memory is
+     * not part of the table and is still fallen back to as usual.
+     *
+     * \param variants The variants to load into the table, the default
+     *                 variant is always included.
+     */
+    void load_table(const std::vector<arc::str::UTF8String>& variants);
+
+    /*!
+     * \brief Discards the table loaded by load_table(), if there is one.
+     */
+    void clear_table();
+
     /*!
      * \brief Retrieves data from this Variant object using the given Visitor
      *        object.
@@ -133,7 +158,7 @@ public:
             const arc::str::UTF8String& key,
             VisitorType& visitor)
     {
-        get(key, static_cast<VisitorBase*>(&visitor));
+        instrumented_get(key, static_cast<VisitorBase*>(&visitor));
         return visitor;
     }
 
@@ -143,11 +168,22 @@ protected:
     //                         PROTECTED MEMBER FUNCTIONS
     //--------------------------------------------------------------------------
 
+    // override
+    virtual void load();
+
     // override
     virtual VisitorBase* get(
             const arc::str::UTF8String& key,
             VisitorBase* visitor);
 
+    // override
+    virtual const Json::Value* find_resolved(
+            const arc::str::UTF8String& key) const;
+
+    // override
+    virtual void get_trees(
+            std::vector<std::shared_ptr<const ArenaTree>>& trees) const;
+
 private:
 
     //--------------------------------------------------------------------------
@@ -175,7 +211,38 @@ private:
     /*!
      * \brief The JSON data for the current variant.
      */
-    std::unique_ptr<Json::Value> m_variant_root;
+    std::shared_ptr<const ArenaTree> m_variant_root;
+
+    /*!
+     * \brief The variants (excluding the default variant) that were requested
+     *        to be loaded into the table.
+     */
+    std::vector<arc::str::UTF8String> m_table_variants;
+    /*!
+     * \brief The table of all variants, null if load_table() has not been
+     *        called. Column 0 is the default variant, followed by a column for
+     *        each of the table variants.
+     */
+    std::unique_ptr<VariantTable> m_table;
+    /*!
+     * \brief The JSON data for each of the table variants, null for variants
+     *        that failed to load.
+     */
+    std::vector<std::shared_ptr<const ArenaTree>> m_table_trees;
+    /*!
+     * \brief The column of the table for the current variant, or NO_COLUMN if
+     *        the current variant is not in the table.
+     */
+    std::size_t m_column;
+
+    //--------------------------------------------------------------------------
+    //                         PRIVATE STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Value of m_column when the current variant is not in the table.
+     */
+    static const std::size_t NO_COLUMN;
 
     //--------------------------------------------------------------------------
     //                          PRIVATE STATIC FUNCTIONS
@@ -188,6 +255,58 @@ private:
             const arc::io::sys::Path& file_path,
             const arc::str::UTF8String& variant);
 
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Reads and parses the file of the given variant into the tree.
+     *
+     * If the file cannot be read or parsed a fallback is reported and the tree
+     * is left null. If subtree sharing is enabled the unchanged sections of
+     * the previous tree are shared with the new tree.
+     */
+    void load_variant(
+            const arc::str::UTF8String& variant,
+            std::shared_ptr<const ArenaTree>& tree,
+            const std::shared_ptr<const ArenaTree>& previous = nullptr);
+
+    /*!
+     * \brief Implementation of set_variant() which does not wait for a
+     *        pending load.
+     */
+    void switch_variant(const arc::str::UTF8String& variant);
+
+    /*!
+     * \brief Rebuilds the table from the current data of this Document.
+     */
+    void build_table();
+
+    /*!
+     * \brief Returns the column of the table for the given variant, or
+     *        NO_COLUMN if the variant is not in the table.
+     */
+    std::size_t find_column(const arc::str::UTF8String& variant) const;
+
+    /*!
+     * \brief Implementation of get used while the current variant is in the
+     *        table.
+     */
+    VisitorBase* table_get(
+            const arc::str::UTF8String& key,
+            VisitorBase* visitor);
+
+    /*!
+     * \brief Returns the value of the key in the current variant, which must
+     *        be a non-default variant of the table that loaded successfully,
+     *        or null if the variant has no value for the key.
+     *
+     * \param row The row of the key in the table, or VariantTable::NO_ROW if
+     *            the key is not in the table.
+     */
+    const Json::Value* find_variant_value(
+            const arc::str::UTF8String& key,
+            std::size_t row) const;
 };
 
 } // namespace metaengine
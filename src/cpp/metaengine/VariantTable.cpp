@@ -0,0 +1,213 @@
+#include "metaengine/VariantTable.hpp"
+
+#include <cstring>
+
+#include <arcanecore/base/Types.hpp>
+
+namespace metaengine
+{
+
+namespace
+{
+
+/*!
+ * \brief The initial number of slots in the key index.
+ */
+const std::size_t INITIAL_CAPACITY = 256;
+
+/*!
+ * \brief FNV-1a hash of a key.
+ */
+std::size_t hash_key(const char* key, std::size_t length)
+{
+    arc::uint64 hash = 14695981039346656037ULL;
+    for(std::size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC ATTRIBUTES
+//------------------------------------------------------------------------------
+
+const std::size_t VariantTable::NO_ROW = static_cast<std::size_t>(-1);
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+VariantTable::VariantTable()
+    :
+    m_keys     (4096),
+    m_row_count(0)
+{
+    Slot empty = {0, 0, nullptr, NO_ROW};
+    m_index.resize(INITIAL_CAPACITY, empty);
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::size_t VariantTable::add_column(const Json::Value* root)
+{
+    m_columns.push_back(std::vector<const Json::Value*>());
+    if(root != nullptr && root->isObject())
+    {
+        std::string prefix;
+        flatten(*root, prefix, m_columns.back());
+    }
+    return m_columns.size() - 1;
+}
+
+std::size_t VariantTable::find_row(const arc::str::UTF8String& key) const
+{
+    const char* raw = key.get_raw();
+    std::size_t length = std::strlen(raw);
+    std::size_t hash = hash_key(raw, length);
+
+    // linear probe for the key
+    std::size_t mask = m_index.size() - 1;
+    std::size_t i = hash & mask;
+    while(m_index[i].key != nullptr)
+    {
+        const Slot& slot = m_index[i];
+        if(slot.hash   == hash   &&
+           slot.length == length &&
+           std::memcmp(slot.key, raw, length) == 0)
+        {
+            return slot.row;
+        }
+        i = (i + 1) & mask;
+    }
+    return NO_ROW;
+}
+
+const Json::Value* VariantTable::get_cell(
+        std::size_t column,
+        std::size_t row) const
+{
+    const std::vector<const Json::Value*>& values = m_columns[column];
+    if(row >= values.size())
+    {
+        return nullptr;
+    }
+    return values[row];
+}
+
+std::size_t VariantTable::get_row_count() const
+{
+    return m_row_count;
+}
+
+std::size_t VariantTable::get_column_count() const
+{
+    return m_columns.size();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+std::size_t VariantTable::insert(const char* key, std::size_t length)
+{
+    std::size_t hash = hash_key(key, length);
+
+    // keep the load factor below a half
+    if((m_row_count + 1) * 2 > m_index.size())
+    {
+        grow();
+    }
+
+    // linear probe for the key
+    std::size_t mask = m_index.size() - 1;
+    std::size_t i = hash & mask;
+    while(m_index[i].key != nullptr)
+    {
+        const Slot& slot = m_index[i];
+        if(slot.hash   == hash   &&
+           slot.length == length &&
+           std::memcmp(slot.key, key, length) == 0)
+        {
+            return slot.row;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // insert a copy of the key
+    char* storage = static_cast<char*>(m_keys.allocate(length + 1));
+    std::memcpy(storage, key, length);
+    storage[length] = '\0';
+
+    m_index[i].hash   = hash;
+    m_index[i].length = length;
+    m_index[i].key    = storage;
+    m_index[i].row    = m_row_count;
+    return m_row_count++;
+}
+
+void VariantTable::flatten(
+        const Json::Value& object,
+        std::string& prefix,
+        std::vector<const Json::Value*>& column)
+{
+    std::size_t prefix_length = prefix.size();
+    for(Json::Value::const_iterator member = object.begin();
+        member != object.end();
+        ++member)
+    {
+        const Json::Value& value = *member;
+        const char* name_end = nullptr;
+        const char* name = member.memberName(&name_end);
+        // members that can't be addressed by a key are skipped, along with
+        // null values since they are treated as missing
+        if(value.isNull() ||
+           std::memchr(name, '.', name_end - name) != nullptr)
+        {
+            continue;
+        }
+
+        prefix.append(name, name_end);
+        std::size_t row = insert(prefix.data(), prefix.size());
+        if(row >= column.size())
+        {
+            column.resize(row + 1, nullptr);
+        }
+        column[row] = &value;
+
+        if(value.isObject())
+        {
+            prefix.push_back('.');
+            flatten(value, prefix, column);
+        }
+        prefix.resize(prefix_length);
+    }
+}
+
+void VariantTable::grow()
+{
+    Slot empty = {0, 0, nullptr, NO_ROW};
+    std::vector<Slot> index(m_index.size() * 2, empty);
+    std::size_t mask = index.size() - 1;
+    ARC_CONST_FOR_EACH(slot, m_index)
+    {
+        if(slot->key == nullptr)
+        {
+            continue;
+        }
+        std::size_t i = slot->hash & mask;
+        while(index[i].key != nullptr)
+        {
+            i = (i + 1) & mask;
+        }
+        index[i] = *slot;
+    }
+    m_index.swap(index);
+}
+
+} // namespace metaengine
@@ -0,0 +1,163 @@
+/*!
+ * \file
+ * \author David Saxon
+ */
+#ifndef METAENGINE_VARIANTTABLE_HPP_
+#define METAENGINE_VARIANTTABLE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/str/UTF8String.hpp>
+
+#include <json/json.h>
+
+#include "metaengine/Arena.hpp"
+
+namespace metaengine
+{
+
+/*!
+ * \brief Columnar index of the values of a set of JSON trees.
+ *
+ * Every key reachable in the trees (in the dotted form used by Document::get)
+ * is given a single row of the table, and each tree added as a column stores a
+ * pointer to the value it holds for each row. Finding the value a tree has for
+ * a key is then a single hash probe and a column read, regardless of how deeply
+ * the key is nested or how many trees are in the table.
+ *
+ * The table does not own the trees, they must outlive it. Object members whose
+ * names contain a "." cannot be addressed by a key and so are not indexed, nor
+ * are null values (which Document::get treats as missing).
+ */
+class VariantTable
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(VariantTable);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returned by find_row() when the key is not in the table.
+     */
+    static const std::size_t NO_ROW;
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    VariantTable();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Adds a column holding the values of the given tree, adding rows
+     *        for any of its keys that are not yet in the table.
+     *
+     * \param root The root of the tree, may be null in which case the column
+     *             holds no values.
+     * \return The index of the new column.
+     */
+    std::size_t add_column(const Json::Value* root);
+
+    /*!
+     * \brief Returns the row of the given key, or NO_ROW if the key is not in
+     *        the table.
+     *
+     * This does not allocate.
+     */
+    std::size_t find_row(const arc::str::UTF8String& key) const;
+
+    /*!
+     * \brief Returns the value the given column holds for the row, or null if
+     *        it has no value for the row.
+     */
+    const Json::Value* get_cell(std::size_t column, std::size_t row) const;
+
+    /*!
+     * \brief Returns the number of unique keys in this table.
+     */
+    std::size_t get_row_count() const;
+
+    /*!
+     * \brief Returns the number of columns in this table.
+     */
+    std::size_t get_column_count() const;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                              PRIVATE STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A slot of the key index.
+     */
+    struct Slot
+    {
+        std::size_t hash;
+        std::size_t length;
+        const char* key;
+        std::size_t row;
+    };
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The storage of the keys.
+     */
+    Arena m_keys;
+    /*!
+     * \brief Open addressing hash table of the keys, the size is always a
+     *        power of two.
+     */
+    std::vector<Slot> m_index;
+    std::size_t m_row_count;
+    /*!
+     * \brief The value of each row, for each column. A column may be shorter
+     *        than the number of rows if rows were added after it.
+     */
+    std::vector<std::vector<const Json::Value*>> m_columns;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the row of the given key, adding it if it is not yet in
+     *        the table.
+     */
+    std::size_t insert(const char* key, std::size_t length);
+
+    /*!
+     * \brief Adds rows for the members of the given object value and stores
+     *        their values in the column.
+     *
+     * \param prefix The key of the object value followed by a ".", or empty
+     *               for the root.
+     */
+    void flatten(
+            const Json::Value& object,
+            std::string& prefix,
+            std::vector<const Json::Value*>& column);
+
+    /*!
+     * \brief Doubles the size of the key index.
+     */
+    void grow();
+};
+
+} // namespace metaengine
+
+#endif
@@ -7,6 +7,8 @@
 
 #include <arcanecore/base/str/UTF8String.hpp>
 
+#include "metaengine/Diagnostic.hpp"
+
 //------------------------------------------------------------------------------
 //                              FORWARD DECLARATIONS
 //------------------------------------------------------------------------------
@@ -69,24 +71,64 @@ public:
      *
      * To implement this function the JSON data should be checked to see if it
      * is convertible to this Visitor's type, if not the function should
-     * return ```false``` and let the Document::get() function preform the error
-     * handling. If the data is convertible to the type then it should be
-     * converted and stored in this object's Visitor::m_value and then should
-     * return ```true```.
+     * describe the failure using the Diagnostic (e.g.
+     * Diagnostic::set_type_mismatch()) and return ```false``` and let the
+     * Document::get() function preform the error handling. If the data is
+     * convertible to the type then it should be converted and stored in this
+     * object's Visitor::m_value and then should return ```true```.
      *
      * \param data The JSON value to attempt to convert to this Visitor's type.
      * \param key The key that was used to retrieve the given JSON data from the
      *             Document.
      * \param requester The Document that has called this function and provided
      *                  the JSON data.
-     * \param error_message Can be used to return an error message if the
-     *                      conversion was not successful.
+     * \param diagnostic Used to describe why the conversion was not
+     *                   successful. Messages should not be formatted eagerly
+     *                   since the Document may successfully fallback to other
+     *                   data.
+     *
+     * The default implementation forwards to the deprecated overload which
+     * takes an error message, so that Visitors written before Diagnostics
+     * were introduced still work, using their message as the explicit
+     * message of the Diagnostic.
      */
     virtual bool retrieve(
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message) = 0;
+            Diagnostic& diagnostic)
+    {
+        arc::str::UTF8String error_message;
+        bool success = retrieve(data, key, requester, error_message);
+        if(!success && !error_message.is_empty())
+        {
+            diagnostic << error_message;
+        }
+        return success;
+    }
+
+    /*!
+     * \brief Attempts to parse the given JSON data as this Visitor's type,
+     *        describing a failure with a formatted message.
+     *
+     * \deprecated Implement the overload which takes a Diagnostic instead,
+     *             which only formats a message if the failure is reported.
+     *             This is only called by the default implementation of that
+     *             overload, and fails with a message saying the Visitor does
+     *             not implement retrieve() unless it is overridden.
+     *
+     * \param error_message Set to describe why the conversion was not
+     *                      successful.
+     */
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            Document* requester,
+            arc::str::UTF8String& error_message)
+    {
+        error_message << "The Visitor does not implement retrieve().";
+        return false;
+    }
 };
 
 /*!
@@ -103,6 +145,15 @@ class Visitor : public VisitorBase
 {
 public:
 
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The type this Visitor is retrieving.
+     */
+    typedef ReturnType value_type;
+
     //--------------------------------------------------------------------------
     //                                CONSTRUCTOR
     //--------------------------------------------------------------------------
@@ -17,7 +17,8 @@ PathV::PathV(metaengine::Document* external_document)
     :
     metaengine::Visitor<arc::io::sys::Path>(),
     m_external                             (external_document),
-    m_is_recursive                         (false)
+    m_is_recursive                         (false),
+    m_cacheable                            (true)
 {
 }
 
@@ -40,7 +41,7 @@ bool PathV::retrieve(
         const Json::Value* data,
         const arc::str::UTF8String& key,
         Document* requester,
-        arc::str::UTF8String& error_message)
+        Diagnostic& diagnostic)
 {
     // if this visitor has not been recursively created ensure we have no
     // records of any visited reference keys
@@ -48,12 +49,111 @@ bool PathV::retrieve(
     {
         m_visited_refs.clear();
     }
+    m_dependencies.reset();
+    m_cacheable = true;
 
+    // has this path already been resolved? (the path is only used if the
+    // entry is successful so it is returned straight into the value)
+    PathCache& cache = requester->get_path_cache();
+    bool cached_success = false;
+    arc::str::UTF8String cached_error;
+    PathCache::Dependencies cached_dependencies;
+    if(cache.find(
+            requester,
+            m_external,
+            key,
+            data,
+            cached_success,
+            m_value,
+            cached_error,
+            cached_dependencies))
+    {
+        // a cached path that references a key which has already been visited
+        // would be cyclic in this context, so resolve it again to report the
+        // error properly
+        bool cyclic = false;
+        if(cached_dependencies)
+        {
+            ARC_CONST_FOR_EACH(dependency, *cached_dependencies)
+            {
+                if(dependency->document == nullptr &&
+                   std::find(
+                        m_visited_refs.begin(),
+                        m_visited_refs.end(),
+                        dependency->key
+                   ) != m_visited_refs.end())
+                {
+                    cyclic = true;
+                    break;
+                }
+            }
+        }
+
+        if(!cyclic)
+        {
+            if(!cached_success)
+            {
+                diagnostic << cached_error;
+                return false;
+            }
+            m_dependencies = cached_dependencies;
+            return true;
+        }
+    }
+
+    // resolve
+    arc::str::UTF8String resolve_error;
+    std::shared_ptr<std::vector<PathCache::Dependency>> dependencies(
+        new std::vector<PathCache::Dependency>());
+    bool success =
+        resolve(data, key, requester, resolve_error, *dependencies);
+    diagnostic << resolve_error;
+    m_dependencies = dependencies;
+
+    // failures are only cached from the top level since whether a path
+    // resolves as part of a recursive expansion depends on what has been
+    // visited so far
+    if(m_cacheable && (success || !m_is_recursive))
+    {
+        cache.insert(
+            requester,
+            m_external,
+            key,
+            data,
+            success,
+            m_value,
+            resolve_error,
+            m_dependencies
+        );
+    }
+    return success;
+}
+
+metaengine::Document* PathV::get_external_document() const
+{
+    return m_external;
+}
+
+void PathV::set_external_document(metaengine::Document* external_document)
+{
+    m_external = external_document;
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool PathV::resolve(
+        const Json::Value* data,
+        const arc::str::UTF8String& key,
+        Document* requester,
+        arc::str::UTF8String& error_message,
+        std::vector<PathCache::Dependency>& dependencies)
+{
     // is the data a list
     if(!data->isArray())
     {
-        Json::FastWriter j_writer;
-        error_message << "\"" << j_writer.write(*data) << "\" cannot be "
+        error_message << Diagnostic::write_value(*data) << " cannot be "
                       << "converted to array type, which is required to build "
                       << "a path.";
         return false;
@@ -69,9 +169,8 @@ bool PathV::retrieve(
         // check if the data can be converted
         if(!child->isString())
         {
-            Json::FastWriter j_writer;
-            error_message << "Path element \"" << j_writer.write(*child)
-                          << "\" cannot be converted to UTF-8 string type.";
+            error_message << "Path element " << Diagnostic::write_value(*child)
+                          << " cannot be converted to UTF-8 string type.";
             return false;
         }
         // get as string
@@ -111,6 +210,17 @@ bool PathV::retrieve(
                 sub_visitor.m_visited_refs.push_back(key);
 
                 temp += *requester->get(ref_key, sub_visitor);
+                add_dependency(
+                    requester,
+                    requester,
+                    ref_key,
+                    sub_visitor.m_dependencies,
+                    dependencies
+                );
+                if(!sub_visitor.m_cacheable)
+                {
+                    m_cacheable = false;
+                }
             }
             catch(...)
             {
@@ -118,6 +228,13 @@ bool PathV::retrieve(
                 try
                 {
                     temp << *requester->get(ref_key, UTF8StringV::instance());
+                    add_dependency(
+                        requester,
+                        requester,
+                        ref_key,
+                        PathCache::Dependencies(),
+                        dependencies
+                    );
                 }
                 catch(...)
                 {
@@ -156,6 +273,17 @@ bool PathV::retrieve(
                 sub_visitor.m_is_recursive = false;
 
                 temp += *m_external->get(ref_key, sub_visitor);
+                add_dependency(
+                    requester,
+                    m_external,
+                    ref_key,
+                    sub_visitor.m_dependencies,
+                    dependencies
+                );
+                if(!sub_visitor.m_cacheable)
+                {
+                    m_cacheable = false;
+                }
             }
             catch(...)
             {
@@ -163,6 +291,13 @@ bool PathV::retrieve(
                 try
                 {
                     temp << *m_external->get(ref_key, UTF8StringV::instance());
+                    add_dependency(
+                        requester,
+                        m_external,
+                        ref_key,
+                        PathCache::Dependencies(),
+                        dependencies
+                    );
                 }
                 catch(...)
                 {
@@ -186,14 +321,48 @@ bool PathV::retrieve(
     return true;
 }
 
-metaengine::Document* PathV::get_external_document() const
+void PathV::add_dependency(
+        Document* requester,
+        Document* source,
+        const arc::str::UTF8String& ref_key,
+        const PathCache::Dependencies& sub_dependencies,
+        std::vector<PathCache::Dependency>& dependencies)
 {
-    return m_external;
-}
+    const Json::Value* value = PathCache::fetch(source, ref_key);
+    if(value == nullptr)
+    {
+        // should not happen since the key was just retrieved, but there's
+        // nothing to validate the cache entry against later
+        m_cacheable = false;
+        return;
+    }
 
-void PathV::set_external_document(metaengine::Document* external_document)
-{
-    m_external = external_document;
+    // dependencies are recorded relative to the requester
+    Document* document = nullptr;
+    if(source != requester)
+    {
+        document = source;
+    }
+
+    PathCache::Dependency dependency;
+    dependency.document = document;
+    dependency.key      = ref_key;
+    dependency.value    = *value;
+    dependencies.push_back(dependency);
+
+    // the sub dependencies are relative to the source Document
+    if(!sub_dependencies)
+    {
+        return;
+    }
+    ARC_CONST_FOR_EACH(sub_dependency, *sub_dependencies)
+    {
+        dependencies.push_back(*sub_dependency);
+        if(sub_dependency->document == nullptr)
+        {
+            dependencies.back().document = document;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -210,14 +379,12 @@ bool PathVectorV::retrieve(
         const Json::Value* data,
         const arc::str::UTF8String& key,
         Document* requester,
-        arc::str::UTF8String& error_message)
+        Diagnostic& diagnostic)
 {
     // check type
     if(!data->isArray())
     {
-        Json::FastWriter j_writer;
-        error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                      << "converted to array type.";
+        diagnostic.set_type_mismatch(data, "array");
         return false;
     }
 
@@ -229,7 +396,7 @@ bool PathVectorV::retrieve(
     for(child = data->begin(); child != data->end(); ++child)
     {
         // attempt to get a path using the PathV visitor
-        if(!PathV::instance().retrieve(&*child, key, requester, error_message))
+        if(!PathV::instance().retrieve(&*child, key, requester, diagnostic))
         {
             return false;
         }
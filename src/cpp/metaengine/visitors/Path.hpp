@@ -8,6 +8,7 @@
 
 #include "metaengine/Document.hpp"
 #include "metaengine/Visitor.hpp"
+#include "metaengine/visitors/PathCache.hpp"
 
 namespace metaengine
 {
@@ -40,6 +41,12 @@ namespace metaengine
  *     "my_path":  ["example", "path", "#{key_in_another_document}"]
  * }
  * \endcode
+ *
+ * Resolved paths are memoised by the Document they are retrieved from (see
+ * PathCache), so retrieving the same path multiple times only expands its
+ * references the first time. Reloading the Document, or the external Document,
+ * only causes paths whose value or references have changed to be expanded
+ * again.
  */
 class PathV : public metaengine::Visitor<arc::io::sys::Path>
 {
@@ -79,7 +86,7 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message);
+            Diagnostic& diagnostic);
 
     /*!
      * \brief Returns a pointer to the metaengine::Document which this Visitor
@@ -115,6 +122,50 @@ private:
      *        recursive path expansion.
      */
     std::vector<arc::str::UTF8String> m_visited_refs;
+    /*!
+     * \brief The keys (and their values) that were referenced by the last
+     *        path this Visitor retrieved.
+     */
+    PathCache::Dependencies m_dependencies;
+    /*!
+     * \brief Whether the last path this Visitor retrieved can be stored in the
+     *        requesting Document's path cache.
+     */
+    bool m_cacheable;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Expands the given JSON data into a path, without consulting the
+     *        path cache.
+     *
+     * \param dependencies Returns the keys the path references.
+     */
+    bool resolve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            Document* requester,
+            arc::str::UTF8String& error_message,
+            std::vector<PathCache::Dependency>& dependencies);
+
+    /*!
+     * \brief Adds the given referenced key to the dependencies of the path
+     *        being resolved, along with the dependencies of the path the key
+     *        resolved to.
+     *
+     * \param requester The Document the path is being resolved from.
+     * \param source The Document the key was referenced from, either the
+     *               requester or the external Document.
+     * \param dependencies The dependencies of the path being resolved.
+     */
+    void add_dependency(
+            Document* requester,
+            Document* source,
+            const arc::str::UTF8String& ref_key,
+            const PathCache::Dependencies& sub_dependencies,
+            std::vector<PathCache::Dependency>& dependencies);
 };
 
 //------------------------------------------------------------------------------
@@ -141,7 +192,7 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message);
+            Diagnostic& diagnostic);
 };
 
 } // namespace metaengine
@@ -0,0 +1,205 @@
+#include "metaengine/visitors/PathCache.hpp"
+
+#include "metaengine/Document.hpp"
+
+namespace metaengine
+{
+
+//------------------------------------------------------------------------------
+//                                  CONSTRUCTOR
+//------------------------------------------------------------------------------
+
+PathCache::PathCache()
+{
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC STATIC FUNCTIONS
+//------------------------------------------------------------------------------
+
+const Json::Value* PathCache::fetch(
+        Document* document,
+        const arc::str::UTF8String& key)
+{
+    return document->find_resolved(key);
+}
+
+//------------------------------------------------------------------------------
+//                            PUBLIC MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool PathCache::find(
+        Document* document,
+        Document* external,
+        const arc::str::UTF8String& key,
+        const Json::Value* data,
+        bool& success,
+        arc::io::sys::Path& path,
+        arc::str::UTF8String& error_message,
+        Dependencies& dependencies)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // the result is copied out under the lock since the entry may be replaced
+    // by another thread as soon as it is released
+    const Entry* found = nullptr;
+    std::map<arc::str::UTF8String, std::vector<Entry>>::iterator entries =
+        m_entries.find(key);
+    if(entries == m_entries.end())
+    {
+        return false;
+    }
+
+    // look for an entry from the current snapshots first
+    arc::uint64 version = document->get_version();
+    arc::uint64 external_version = 0;
+    if(external != nullptr)
+    {
+        external_version = external->get_version();
+    }
+    ARC_FOR_EACH(entry, entries->second)
+    {
+        if(entry->version          == version          &&
+           entry->data             == data             &&
+           entry->external         == external         &&
+           entry->external_version == external_version)
+        {
+            found = &(*entry);
+            break;
+        }
+    }
+
+    // attempt to carry over an entry from previous snapshots
+    for(std::vector<Entry>::iterator entry = entries->second.begin();
+        found == nullptr && entry != entries->second.end();
+        ++entry)
+    {
+        if(entry->external != external || !entry->success)
+        {
+            continue;
+        }
+        if(entry->version == version &&
+           entry->external_version == external_version)
+        {
+            continue;
+        }
+        if(revalidate(document, *entry, data))
+        {
+            entry->version          = version;
+            entry->data             = data;
+            entry->external_version = external_version;
+            found = &(*entry);
+        }
+    }
+
+    if(found == nullptr)
+    {
+        return false;
+    }
+    success = found->success;
+    if(success)
+    {
+        path = found->path;
+    }
+    else
+    {
+        error_message = found->error_message;
+    }
+    dependencies = found->dependencies;
+    return true;
+}
+
+void PathCache::insert(
+        Document* document,
+        Document* external,
+        const arc::str::UTF8String& key,
+        const Json::Value* data,
+        bool success,
+        const arc::io::sys::Path& path,
+        const arc::str::UTF8String& error_message,
+        const Dependencies& dependencies)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Entry>& entries = m_entries[key];
+    arc::uint64 version = document->get_version();
+    arc::uint64 external_version = 0;
+    if(external != nullptr)
+    {
+        external_version = external->get_version();
+    }
+
+    // discard stale entries and any existing entry for the same data and
+    // external Document
+    std::vector<Entry>::iterator entry = entries.begin();
+    while(entry != entries.end())
+    {
+        if(entry->version != version ||
+           (entry->data == data && entry->external == external))
+        {
+            entry = entries.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+
+    Entry e;
+    e.version          = version;
+    e.data             = data;
+    e.external         = external;
+    e.external_version = external_version;
+    e.value            = *data;
+    e.success          = success;
+    e.path             = path;
+    e.error_message    = error_message;
+    e.dependencies     = dependencies;
+    entries.push_back(e);
+}
+
+void PathCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+//------------------------------------------------------------------------------
+//                            PRIVATE MEMBER FUNCTIONS
+//------------------------------------------------------------------------------
+
+bool PathCache::revalidate(
+        Document* document,
+        const Entry& entry,
+        const Json::Value* data) const
+{
+    // has the value itself changed?
+    if(entry.value != *data)
+    {
+        return false;
+    }
+
+    // have any of the values it references changed? (the entry was matched
+    // on its external Document so any Document it references is still valid)
+    if(!entry.dependencies)
+    {
+        return true;
+    }
+    ARC_CONST_FOR_EACH(dependency, *entry.dependencies)
+    {
+        Document* source = document;
+        if(dependency->document != nullptr)
+        {
+            source = dependency->document;
+        }
+        const Json::Value* current = fetch(source, dependency->key);
+        if(current == nullptr || *current != dependency->value)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace metaengine
@@ -0,0 +1,237 @@
+/*!
+ * \file
+ * \brief Cache used to memoise the results of PathV reference expansion.
+ * \author David Saxon
+ */
+#ifndef METAENGINE_VISITORS_PATHCACHE_HPP_
+#define METAENGINE_VISITORS_PATHCACHE_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <arcanecore/io/sys/Path.hpp>
+
+#include <json/json.h>
+
+namespace metaengine
+{
+
+class Document;
+
+/*!
+ * \brief Stores the paths that have been resolved from a Document along with
+ *        the references each of them depends on.
+ *
+ * Each Document owns one of these, which is populated by the PathV visitor.
+ * Entries are tagged with the version of the Document snapshot they were
+ * resolved from, and if the path references an external Document, the version
+ * of the external Document's snapshot too. While both snapshots are unchanged
+ * an entry is returned without any further lookups. Once either Document has
+ * been reloaded an entry is revalidated by comparing the JSON value it was
+ * resolved from, and the values of each of the keys it references (in either
+ * Document), against the new snapshots. This means a reload only invalidates
+ * the entries which are actually affected by the change.
+ *
+ * The cache is thread safe, so paths may be retrieved from the same Document
+ * by multiple threads at once.
+ */
+class PathCache
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(PathCache);
+
+public:
+
+    //--------------------------------------------------------------------------
+    //                                   STRUCTS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief A key that a resolved path references and the JSON value that key
+     *        had when the path was resolved.
+     */
+    struct Dependency
+    {
+        /*!
+         * \brief The Document the key is referenced from, null if this is the
+         *        Document the path was resolved from.
+         */
+        Document* document;
+        arc::str::UTF8String key;
+        Json::Value value;
+    };
+
+    //--------------------------------------------------------------------------
+    //                              TYPE DEFINITIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The dependencies of a resolved path, which are never modified
+     *        once resolved so are shared between the cache and the visitors
+     *        that retrieve the path (null if there are none).
+     */
+    typedef std::shared_ptr<const std::vector<Dependency>> Dependencies;
+
+    /*!
+     * \brief The memoised result of resolving a single path.
+     */
+    struct Entry
+    {
+        /*!
+         * \brief The version of the Document snapshot this entry is valid for.
+         */
+        arc::uint64 version;
+        /*!
+         * \brief The JSON value in the snapshot this entry was resolved from.
+         */
+        const Json::Value* data;
+        /*!
+         * \brief The external Document used to resolve external references
+         *        (may be null).
+         */
+        Document* external;
+        /*!
+         * \brief The version of the external Document's snapshot this entry
+         *        is valid for.
+         */
+        arc::uint64 external_version;
+        /*!
+         * \brief Copy of the JSON value this entry was resolved from, used to
+         *        revalidate the entry against new snapshots.
+         */
+        Json::Value value;
+        /*!
+         * \brief Whether resolving the path was successful.
+         */
+        bool success;
+        /*!
+         * \brief The resolved path (if successful).
+         */
+        arc::io::sys::Path path;
+        /*!
+         * \brief The error message the resolution failed with (if not
+         *        successful).
+         */
+        arc::str::UTF8String error_message;
+        /*!
+         * \brief All the keys that are referenced (directly or indirectly)
+         *        when resolving the path.
+         */
+        Dependencies dependencies;
+    };
+
+    //--------------------------------------------------------------------------
+    //                                CONSTRUCTOR
+    //--------------------------------------------------------------------------
+
+    PathCache();
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC STATIC FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns the JSON value that is used for the key in the given
+     *        Document, or null if the Document has no value for the key.
+     *
+     * This resolves the value using the same fallback rules as Document::get,
+     * but does not record statistics or report fallbacks, since it is only
+     * used to check values the cache depends on.
+     */
+    static const Json::Value* fetch(
+            Document* document,
+            const arc::str::UTF8String& key);
+
+    //--------------------------------------------------------------------------
+    //                          PUBLIC MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Looks up the entry for resolving the given JSON data with the key
+     *        from the Document.
+     *
+     * Only entries that were resolved using the same external Document are
+     * considered. Entries that were resolved from a previous snapshot of either
+     * Document are revalidated, and updated to the current snapshots if they
+     * are still valid. Failed resolutions are only ever valid for the
+     * snapshots they were found in.
+     *
+     * \param success Returns whether resolving the path was successful.
+     * \param path Returns the resolved path (if successful).
+     * \param error_message Returns the error message the resolution failed
+     *                      with (if not successful).
+     * \param dependencies Returns the dependencies of the path.
+     * \return Whether there is a valid entry, if not the other return
+     *         parameters are left unmodified.
+     */
+    bool find(
+            Document* document,
+            Document* external,
+            const arc::str::UTF8String& key,
+            const Json::Value* data,
+            bool& success,
+            arc::io::sys::Path& path,
+            arc::str::UTF8String& error_message,
+            Dependencies& dependencies);
+
+    /*!
+     * \brief Stores the result of resolving the given JSON data with the key
+     *        from the Document.
+     *
+     * Any existing entries for the key that were resolved from a previous
+     * snapshot of the Document are discarded.
+     */
+    void insert(
+            Document* document,
+            Document* external,
+            const arc::str::UTF8String& key,
+            const Json::Value* data,
+            bool success,
+            const arc::io::sys::Path& path,
+            const arc::str::UTF8String& error_message,
+            const Dependencies& dependencies);
+
+    /*!
+     * \brief Removes all entries from this cache.
+     */
+    void clear();
+
+private:
+
+    //--------------------------------------------------------------------------
+    //                             PRIVATE ATTRIBUTES
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief The entries of this cache mapped by the key they were resolved
+     *        from. There may be multiple entries for a key since a Document may
+     *        resolve the same key from both file and memory data.
+     */
+    std::map<arc::str::UTF8String, std::vector<Entry>> m_entries;
+    /*!
+     * \brief Guards the entries, since paths may be retrieved from multiple
+     *        threads.
+     */
+    std::mutex m_mutex;
+
+    //--------------------------------------------------------------------------
+    //                          PRIVATE MEMBER FUNCTIONS
+    //--------------------------------------------------------------------------
+
+    /*!
+     * \brief Returns whether the given entry (which is from a previous
+     *        snapshot) is still valid for the JSON data from the current
+     *        snapshot of the Document.
+     */
+    bool revalidate(
+            Document* document,
+            const Entry& entry,
+            const Json::Value* data) const;
+};
+
+} // namespace metaengine
+
+#endif
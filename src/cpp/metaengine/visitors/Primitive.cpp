@@ -17,14 +17,12 @@ bool BoolV::retrieve(
         const Json::Value* data,
         const arc::str::UTF8String& key,
         Document* requester,
-        arc::str::UTF8String& error_message)
+        Diagnostic& diagnostic)
 {
-    // check type
-    if(!data->isBool())
+    // check type, unless the schema has already proven it
+    if(!diagnostic.is_proven(Schema::TYPE_BOOL) && !data->isBool())
     {
-        Json::FastWriter j_writer;
-        error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                      << "converted to boolean type.";
+        diagnostic.set_type_mismatch(data, "boolean");
         return false;
     }
 
@@ -46,38 +44,44 @@ bool BoolVectorV::retrieve(
         const Json::Value* data,
         const arc::str::UTF8String& key,
         Document* requester,
-        arc::str::UTF8String& error_message)
+        Diagnostic& diagnostic)
 {
-    // check type
-    if(!data->isArray())
-    {
-        Json::FastWriter j_writer;
-        error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                      << "converted to array type.";
-        return false;
-    }
-
-    // temp value
-    std::vector<bool> temp;
-
-    // iterate over the values
+    std::size_t index = 0;
     Json::Value::const_iterator child;
-    for(child = data->begin(); child != data->end(); ++child)
+    // the type of a proven value and its elements was already checked
+    // when the Document was loaded
+    if(!diagnostic.is_proven(Schema::TYPE_BOOL_ARRAY))
     {
-        // check if the data can be converted
-        if(!child->isBool())
+        // check type
+        if(!data->isArray())
         {
-            Json::FastWriter j_writer;
-            error_message << "Array element \"" << j_writer.write(*child)
-                          << "\" cannot be converted to boolean type.";
+            diagnostic.set_type_mismatch(data, "array");
             return false;
         }
-        // perform conversion
-        temp.push_back(child->asBool());
+
+        // check that every value can be converted before touching the current
+        // value
+        for(child = data->begin(); child != data->end(); ++child, ++index)
+        {
+            if(!child->isBool())
+            {
+                diagnostic.set_element_type_mismatch(
+                    &(*child),
+                    index,
+                    "boolean"
+                );
+                return false;
+            }
+        }
     }
 
-    // no errors, use the temp value
-    m_value = temp;
+    // perform conversion in place so that the existing capacity is reused
+    m_value.resize(data->size());
+    index = 0;
+    for(child = data->begin(); child != data->end(); ++child, ++index)
+    {
+        m_value[index] = child->asBool();
+    }
     return true;
 }
 
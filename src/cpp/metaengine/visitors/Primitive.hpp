@@ -36,7 +36,7 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message);
+            Diagnostic& diagnostic);
 };
 
 //------------------------------------------------------------------------------
@@ -61,7 +61,7 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message);
+            Diagnostic& diagnostic);
 };
 
 //------------------------------------------------------------------------------
@@ -94,14 +94,12 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message)
+            Diagnostic& diagnostic)
     {
-        // check type
-        if(!data->isInt())
+        // check type, unless the schema has already proven it
+        if(!diagnostic.is_proven(Schema::TYPE_INT) && !data->isInt())
         {
-            Json::FastWriter j_writer;
-            error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                          << "converted to integral type.";
+            diagnostic.set_type_mismatch(data, "integral");
             return false;
         }
 
@@ -141,38 +139,46 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message)
+            Diagnostic& diagnostic)
     {
-        // check type
-        if(!data->isArray())
-        {
-            Json::FastWriter j_writer;
-            error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                          << "converted to array type.";
-            return false;
-        }
-
-        // temp value
-        std::vector<IntType> temp;
-
-        // iterate over the values
+        std::size_t index = 0;
         Json::Value::const_iterator child;
-        for(child = data->begin(); child != data->end(); ++child)
+        // the type of a proven value and its elements was already checked
+        // when the Document was loaded
+        if(!diagnostic.is_proven(Schema::TYPE_INT_ARRAY))
         {
-            // check if the data can be converted
-            if(!child->isInt())
+            // check type
+            if(!data->isArray())
             {
-                Json::FastWriter j_writer;
-                error_message << "Array element \"" << j_writer.write(*child)
-                              << "\" cannot be converted to integral type.";
+                diagnostic.set_type_mismatch(data, "array");
                 return false;
             }
-            // perform conversion
-            temp.push_back(static_cast<IntType>(child->asInt()));
+
+            // check that every value can be converted before touching the
+            // current value
+            for(child = data->begin(); child != data->end(); ++child, ++index)
+            {
+                if(!child->isInt())
+                {
+                    diagnostic.set_element_type_mismatch(
+                        &(*child),
+                        index,
+                        "integral"
+                    );
+                    return false;
+                }
+            }
         }
 
-        // no errors, use the temp value
-        metaengine::Visitor<std::vector<IntType>>::m_value = temp;
+        // perform conversion in place so that the existing capacity is reused
+        std::vector<IntType>& value =
+            metaengine::Visitor<std::vector<IntType>>::m_value;
+        value.resize(data->size());
+        index = 0;
+        for(child = data->begin(); child != data->end(); ++child, ++index)
+        {
+            value[index] = static_cast<IntType>(child->asInt());
+        }
         return true;
     }
 };
@@ -207,14 +213,12 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message)
+            Diagnostic& diagnostic)
     {
-        // check type
-        if(!data->isDouble())
+        // check type, unless the schema has already proven it
+        if(!diagnostic.is_proven(Schema::TYPE_FLOAT) && !data->isDouble())
         {
-            Json::FastWriter j_writer;
-            error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                          << "converted to floating point type.";
+            diagnostic.set_type_mismatch(data, "floating point");
             return false;
         }
 
@@ -255,39 +259,46 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message)
+            Diagnostic& diagnostic)
     {
-        // check type
-        if(!data->isArray())
-        {
-            Json::FastWriter j_writer;
-            error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                          << "converted to array type.";
-            return false;
-        }
-
-        // temp value
-        std::vector<FloatType> temp;
-
-        // iterate over the values
+        std::size_t index = 0;
         Json::Value::const_iterator child;
-        for(child = data->begin(); child != data->end(); ++child)
+        // the type of a proven value and its elements was already checked
+        // when the Document was loaded
+        if(!diagnostic.is_proven(Schema::TYPE_FLOAT_ARRAY))
         {
-            // check if the data can be converted
-            if(!child->isDouble())
+            // check type
+            if(!data->isArray())
             {
-                Json::FastWriter j_writer;
-                error_message << "Array element \"" << j_writer.write(*child)
-                              << "\" cannot be converted to floating point "
-                              << "type.";
+                diagnostic.set_type_mismatch(data, "array");
                 return false;
             }
-            // perform conversion
-            temp.push_back(static_cast<FloatType>(child->asDouble()));
+
+            // check that every value can be converted before touching the
+            // current value
+            for(child = data->begin(); child != data->end(); ++child, ++index)
+            {
+                if(!child->isDouble())
+                {
+                    diagnostic.set_element_type_mismatch(
+                        &(*child),
+                        index,
+                        "floating point"
+                    );
+                    return false;
+                }
+            }
         }
 
-        // no errors, use the temp value
-        metaengine::Visitor<std::vector<FloatType>>::m_value = temp;
+        // perform conversion in place so that the existing capacity is reused
+        std::vector<FloatType>& value =
+            metaengine::Visitor<std::vector<FloatType>>::m_value;
+        value.resize(data->size());
+        index = 0;
+        for(child = data->begin(); child != data->end(); ++child, ++index)
+        {
+            value[index] = static_cast<FloatType>(child->asDouble());
+        }
         return true;
     }
 };
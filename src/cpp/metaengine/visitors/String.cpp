@@ -19,14 +19,12 @@ bool UTF8StringV::retrieve(
         const Json::Value* data,
         const arc::str::UTF8String& key,
         Document* requester,
-        arc::str::UTF8String& error_message)
+        Diagnostic& diagnostic)
 {
-    // check type
-    if(!data->isString())
+    // check type, unless the schema has already proven it
+    if(!diagnostic.is_proven(Schema::TYPE_STRING) && !data->isString())
     {
-        Json::FastWriter j_writer;
-        error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                      << "converted to UTF-8 string type.";
+        diagnostic.set_type_mismatch(data, "UTF-8 string");
         return false;
     }
 
@@ -48,38 +46,44 @@ bool UTF8StringVectorV::retrieve(
         const Json::Value* data,
         const arc::str::UTF8String& key,
         Document* requester,
-        arc::str::UTF8String& error_message)
+        Diagnostic& diagnostic)
 {
-    // check type
-    if(!data->isArray())
-    {
-        Json::FastWriter j_writer;
-        error_message << "\"" << j_writer.write(*data) << "\" cannot be "
-                      << "converted to array type.";
-        return false;
-    }
-
-    // temp value
-    std::vector<arc::str::UTF8String> temp;
-
-    // iterate over the values
+    std::size_t index = 0;
     Json::Value::const_iterator child;
-    for(child = data->begin(); child != data->end(); ++child)
+    // the type of a proven value and its elements was already checked
+    // when the Document was loaded
+    if(!diagnostic.is_proven(Schema::TYPE_STRING_ARRAY))
     {
-        // check if the data can be converted
-        if(!child->isString())
+        // check type
+        if(!data->isArray())
         {
-            Json::FastWriter j_writer;
-            error_message << "Array element \"" << j_writer.write(*child)
-                          << "\" cannot be converted to UTF-8 string type.";
+            diagnostic.set_type_mismatch(data, "array");
             return false;
         }
-        // perform conversion
-        temp.push_back(arc::str::UTF8String(child->asCString()));
+
+        // check that every value can be converted before touching the current
+        // value
+        for(child = data->begin(); child != data->end(); ++child, ++index)
+        {
+            if(!child->isString())
+            {
+                diagnostic.set_element_type_mismatch(
+                    &(*child),
+                    index,
+                    "UTF-8 string"
+                );
+                return false;
+            }
+        }
     }
 
-    // no errors, use the temp value
-    m_value = temp;
+    // perform conversion in place so that the existing capacity is reused
+    m_value.resize(data->size());
+    index = 0;
+    for(child = data->begin(); child != data->end(); ++child, ++index)
+    {
+        m_value[index] = arc::str::UTF8String(child->asCString());
+    }
     return true;
 }
 
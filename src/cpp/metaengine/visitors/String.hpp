@@ -34,7 +34,7 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message);
+            Diagnostic& diagnostic);
 };
 
 //------------------------------------------------------------------------------
@@ -60,7 +60,7 @@ public:
             const Json::Value* data,
             const arc::str::UTF8String& key,
             Document* requester,
-            arc::str::UTF8String& error_message);
+            Diagnostic& diagnostic);
 };
 
 } // namespace metaengine
@@ -0,0 +1,164 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+// plain thread locals so that no initialisation (and therefore no allocation)
+// is needed the first time the allocator is used on a thread
+thread_local arc::uint64 t_allocations = 0;
+thread_local arc::uint64 t_bytes = 0;
+thread_local arc::uint64 t_deallocations = 0;
+
+/*!
+ * \brief Allocates the given number of bytes in the same way as the default
+ *        operator new, returning null on failure.
+ */
+void* counted_allocate(std::size_t size)
+{
+    ++t_allocations;
+    t_bytes += size;
+
+    if(size == 0)
+    {
+        size = 1;
+    }
+    while(true)
+    {
+        void* ptr = std::malloc(size);
+        if(ptr != nullptr)
+        {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if(handler == nullptr)
+        {
+            return nullptr;
+        }
+        handler();
+    }
+}
+
+void counted_free(void* ptr)
+{
+    if(ptr != nullptr)
+    {
+        ++t_deallocations;
+        std::free(ptr);
+    }
+}
+
+} // namespace anonymous
+
+//------------------------------------------------------------------------------
+//                                GLOBAL ALLOCATOR
+//------------------------------------------------------------------------------
+
+void* operator new(std::size_t size)
+{
+    void* ptr = counted_allocate(size);
+    if(ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    counted_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    counted_free(ptr);
+}
+
+namespace alloc
+{
+
+//------------------------------------------------------------------------------
+//                                     COUNTS
+//------------------------------------------------------------------------------
+
+Counts::Counts()
+    :
+    allocations  (0),
+    bytes        (0),
+    deallocations(0)
+{
+}
+
+Counts Counts::operator-(const Counts& other) const
+{
+    Counts ret;
+    ret.allocations   = allocations   - other.allocations;
+    ret.bytes         = bytes         - other.bytes;
+    ret.deallocations = deallocations - other.deallocations;
+    return ret;
+}
+
+Counts& Counts::operator+=(const Counts& other)
+{
+    allocations   += other.allocations;
+    bytes         += other.bytes;
+    deallocations += other.deallocations;
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+//                                   FUNCTIONS
+//------------------------------------------------------------------------------
+
+Counts current()
+{
+    Counts ret;
+    ret.allocations   = t_allocations;
+    ret.bytes         = t_bytes;
+    ret.deallocations = t_deallocations;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//                                     SCOPE
+//------------------------------------------------------------------------------
+
+Scope::Scope()
+    :
+    m_start(current())
+{
+}
+
+Counts Scope::get() const
+{
+    return current() - m_start;
+}
+
+} // namespace alloc
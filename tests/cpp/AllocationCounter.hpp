@@ -0,0 +1,102 @@
+/*!
+ * \file
+ * \brief Replaces the global allocator so that the tests and benchmarks can
+ *        count the heap allocations performed by a region of code.
+ * \author David Saxon
+ */
+#ifndef METAENGINE_TESTS_ALLOCATIONCOUNTER_HPP_
+#define METAENGINE_TESTS_ALLOCATIONCOUNTER_HPP_
+
+#include <arcanecore/base/Preproc.hpp>
+#include <arcanecore/base/Types.hpp>
+
+namespace alloc
+{
+
+/*!
+ * \brief A snapshot of the allocations performed by the current thread.
+ */
+struct Counts
+{
+    /// The number of calls to operator new.
+    arc::uint64 allocations;
+    /// The total number of bytes requested from operator new.
+    arc::uint64 bytes;
+    /// The number of calls to operator delete with a non-null pointer.
+    arc::uint64 deallocations;
+
+    Counts();
+
+    Counts operator-(const Counts& other) const;
+
+    Counts& operator+=(const Counts& other);
+};
+
+/*!
+ * \brief Returns the allocations that have been performed by the current
+ *        thread since it started.
+ *
+ * Linking AllocationCounter.cpp into an executable replaces the global
+ * operator new and delete, which keep a set of per-thread counters. Counting is
+ * always on, it only costs an increment of a thread local per call.
+ */
+Counts current();
+
+/*!
+ * \brief Measures the allocations performed by the current thread while this
+ *        object exists.
+ *
+ * \code
+ * alloc::Scope scope;
+ * doc.get(key, metaengine::BoolV::instance());
+ * ARC_CHECK_EQUAL(scope.get().allocations, 0);
+ * \endcode
+ */
+class Scope
+{
+private:
+
+    ARC_DISALLOW_COPY_AND_ASSIGN(Scope);
+
+public:
+
+    Scope();
+
+    /*!
+     * \brief Returns the allocations performed since this Scope was
+     *        constructed.
+     */
+    Counts get() const;
+
+private:
+
+    Counts m_start;
+};
+
+} // namespace alloc
+
+/*!
+ * \brief Checks that evaluating the given expression does not perform any heap
+ *        allocations on the current thread.
+ */
+#define CHECK_NO_ALLOCATIONS(expression)                                       \
+    {                                                                          \
+        alloc::Scope alloc_scope_;                                             \
+        expression;                                                            \
+        arc::uint64 alloc_count_ = alloc_scope_.get().allocations;             \
+        ARC_CHECK_EQUAL(alloc_count_, 0);                                      \
+    }
+
+/*!
+ * \brief Checks that evaluating the given expression performs at most the
+ *        given number of heap allocations on the current thread.
+ */
+#define CHECK_ALLOCATIONS_AT_MOST(expression, limit)                           \
+    {                                                                          \
+        alloc::Scope alloc_scope_;                                             \
+        expression;                                                            \
+        arc::uint64 alloc_count_ = alloc_scope_.get().allocations;             \
+        ARC_CHECK_TRUE(alloc_count_ <= (limit));                               \
+    }
+
+#endif
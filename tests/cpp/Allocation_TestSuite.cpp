@@ -0,0 +1,188 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Allocation)
+
+#include <json/json.h>
+
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Path.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+#include "AllocationCounter.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    COUNTER
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(counter)
+{
+    alloc::Scope scope;
+    ARC_CHECK_EQUAL(scope.get().allocations, 0);
+
+    int* i = new int(12);
+    ARC_CHECK_EQUAL(scope.get().allocations, 1);
+    ARC_CHECK_EQUAL(scope.get().bytes, sizeof(int));
+    delete i;
+    ARC_CHECK_EQUAL(scope.get().deallocations, 1);
+
+    char* c = new char[64];
+    delete[] c;
+    ARC_CHECK_EQUAL(scope.get().allocations, 2);
+    ARC_CHECK_EQUAL(scope.get().bytes, sizeof(int) + 64);
+    ARC_CHECK_EQUAL(scope.get().deallocations, 2);
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+class DocumentFixture : public arc::test::Fixture
+{
+public:
+
+    //----------------------------PUBLIC ATTRIBUTES-----------------------------
+
+    arc::str::UTF8String memory;
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        memory =
+            "{"
+            "    \"bool\": true,"
+            "    \"int\": 12,"
+            "    \"float\": 3.5,"
+            "    \"string\": \"Hello world!\","
+            "    \"bool_array\": [true, false, true],"
+            "    \"int_array\": [1, 2, 3, 4],"
+            "    \"float_array\": [0.5, 1.5],"
+            "    \"string_array\": [\"a\", \"b\"],"
+            "    \"path\": [\"a\", \"b\", \"c\"],"
+            "    \"nested\": {\"deeper\": {\"int\": 7}}"
+            "}";
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(document, DocumentFixture)
+{
+    metaengine::Document doc(&fixture->memory);
+
+    // keys are built up front, like a precompiled key would be, so only the
+    // lookup itself is measured
+    arc::str::UTF8String bool_key("bool");
+    arc::str::UTF8String int_key("int");
+    arc::str::UTF8String float_key("float");
+    arc::str::UTF8String bool_array_key("bool_array");
+    arc::str::UTF8String int_array_key("int_array");
+    arc::str::UTF8String float_array_key("float_array");
+    arc::str::UTF8String nested_key("nested.deeper.int");
+    arc::str::UTF8String element_key("int_array.3");
+
+    metaengine::BoolV bool_v;
+    metaengine::IntV<arc::int32> int_v;
+    metaengine::FloatV<float> float_v;
+    metaengine::BoolVectorV bool_vector_v;
+    metaengine::IntVectorV<arc::int32> int_vector_v;
+    metaengine::FloatVectorV<float> float_vector_v;
+
+    // warm up, this sizes the visitors' vectors
+    doc.get(bool_array_key, bool_vector_v);
+    doc.get(int_array_key, int_vector_v);
+    doc.get(float_array_key, float_vector_v);
+
+    ARC_TEST_MESSAGE("Checking primitive visitors");
+    CHECK_NO_ALLOCATIONS(doc.get(bool_key, bool_v));
+    CHECK_NO_ALLOCATIONS(doc.get(int_key, int_v));
+    CHECK_NO_ALLOCATIONS(doc.get(float_key, float_v));
+    CHECK_NO_ALLOCATIONS(doc.get(nested_key, int_v));
+    ARC_CHECK_EQUAL(*int_v, 7);
+    CHECK_NO_ALLOCATIONS(doc.get(element_key, int_v));
+    ARC_CHECK_EQUAL(*int_v, 4);
+
+    ARC_TEST_MESSAGE("Checking primitive vector visitors");
+    CHECK_NO_ALLOCATIONS(doc.get(bool_array_key, bool_vector_v));
+    CHECK_NO_ALLOCATIONS(doc.get(int_array_key, int_vector_v));
+    CHECK_NO_ALLOCATIONS(doc.get(float_array_key, float_vector_v));
+    ARC_CHECK_EQUAL((*int_vector_v).size(), 4);
+    ARC_CHECK_EQUAL((*int_vector_v)[3], 4);
+}
+
+ARC_TEST_UNIT_FIXTURE(document_strings, DocumentFixture)
+{
+    metaengine::Document doc(&fixture->memory);
+
+    arc::str::UTF8String string_key("string");
+    arc::str::UTF8String string_array_key("string_array");
+    arc::str::UTF8String path_key("path");
+
+    metaengine::UTF8StringV string_v;
+    metaengine::UTF8StringVectorV string_vector_v;
+    metaengine::PathV path_v;
+
+    doc.get(string_key, string_v);
+    doc.get(string_array_key, string_vector_v);
+    doc.get(path_key, path_v);
+
+    // these visitors have to copy their strings out of the document, but
+    // nothing else on the path should allocate: at most one allocation per
+    // string that is produced
+    ARC_TEST_MESSAGE("Checking string visitors");
+    CHECK_ALLOCATIONS_AT_MOST(doc.get(string_key, string_v), 1);
+    CHECK_ALLOCATIONS_AT_MOST(doc.get(string_array_key, string_vector_v), 2);
+    ARC_CHECK_EQUAL((*string_vector_v)[1], "b");
+
+    // a cached path is copied out of the PathCache, which is the path itself
+    // plus each of its components
+    ARC_TEST_MESSAGE("Checking path visitor");
+    CHECK_ALLOCATIONS_AT_MOST(doc.get(path_key, path_v), 4);
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant v(v_path, "uk", true);
+    v.set_variant("de");
+
+    arc::str::UTF8String hit_key("number");
+    arc::str::UTF8String nested_hit_key("nest.string");
+    arc::str::UTF8String miss_key("nest.number");
+
+    metaengine::IntV<arc::int32> int_v;
+    v.get(hit_key, int_v);
+    v.get(miss_key, int_v);
+
+    ARC_TEST_MESSAGE("Checking variant hits");
+    CHECK_NO_ALLOCATIONS(v.get(hit_key, int_v));
+    ARC_CHECK_EQUAL(*int_v, 1337);
+
+    ARC_TEST_MESSAGE("Checking variant misses");
+    CHECK_NO_ALLOCATIONS(v.get(miss_key, int_v));
+    ARC_CHECK_EQUAL(*int_v, 3);
+
+    std::vector<arc::str::UTF8String> variants;
+    variants.push_back("de");
+    v.load_table(variants);
+
+    ARC_TEST_MESSAGE("Checking table hits");
+    CHECK_NO_ALLOCATIONS(v.get(hit_key, int_v));
+    ARC_CHECK_EQUAL(*int_v, 1337);
+
+    ARC_TEST_MESSAGE("Checking table misses");
+    CHECK_NO_ALLOCATIONS(v.get(miss_key, int_v));
+    ARC_CHECK_EQUAL(*int_v, 3);
+
+    ARC_TEST_MESSAGE("Checking table switches");
+    CHECK_NO_ALLOCATIONS(v.set_variant("uk"));
+}
+
+} // namespace anonymous
@@ -0,0 +1,116 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Arena)
+
+#include <cstdint>
+
+#include <json/json.h>
+
+#include <metaengine/Arena.hpp>
+#include <metaengine/Document.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+#include "AllocationCounter.hpp"
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                     ARENA
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(arena)
+{
+    metaengine::Arena arena(64);
+    ARC_CHECK_EQUAL(arena.get_used(), 0);
+    ARC_CHECK_EQUAL(arena.get_reserved(), 0);
+
+    ARC_TEST_MESSAGE("Checking alignment");
+    for(std::size_t i = 1; i < 40; ++i)
+    {
+        void* p = arena.allocate(i);
+        ARC_CHECK_EQUAL(
+            reinterpret_cast<std::uintptr_t>(p) % (2 * sizeof(void*)),
+            0
+        );
+    }
+
+    ARC_TEST_MESSAGE("Checking large allocations");
+    char* large = static_cast<char*>(arena.allocate(100000));
+    large[0] = 'a';
+    large[99999] = 'b';
+    ARC_CHECK_TRUE(arena.get_reserved() >= arena.get_used());
+    ARC_CHECK_TRUE(arena.get_used() >= 100000);
+}
+
+//------------------------------------------------------------------------------
+//                                   ARENA TREE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(tree)
+{
+    std::string data(
+        "{"
+        "    \"string\": \"Hello world!\","
+        "    \"array\": [1, 2, 3],"
+        "    \"object\": {\"nested\": \"value\"}"
+        "}"
+    );
+
+    Json::Value copy;
+    {
+        metaengine::ArenaTree tree(data.size());
+        Json::Reader reader;
+
+        alloc::Scope scope;
+        {
+            Json::MemoryResource::Scope resource_scope(&tree.get_arena());
+            ARC_CHECK_TRUE(
+                Json::MemoryResource::current() == &tree.get_arena());
+            ARC_CHECK_TRUE(reader.parse(data, *tree.get_root()));
+        }
+        ARC_CHECK_TRUE(Json::MemoryResource::current() == nullptr);
+
+        ARC_TEST_MESSAGE("Checking values are allocated from the arena");
+        ARC_CHECK_TRUE(tree.get_arena().get_used() > data.size());
+        ARC_CHECK_EQUAL(
+            (*tree.get_root())["object"]["nested"].asString(),
+            "value"
+        );
+
+        // values copied out of the tree are allocated from the heap
+        arc::uint64 before = scope.get().allocations;
+        copy = (*tree.get_root())["object"];
+        ARC_CHECK_TRUE(scope.get().allocations > before);
+    }
+
+    ARC_TEST_MESSAGE("Checking copies outlive the tree");
+    ARC_CHECK_EQUAL(copy["nested"].asString(), "value");
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(document_reload)
+{
+    arc::str::UTF8String memory(
+        "{"
+        "    \"string\": \"Hello world!\","
+        "    \"int\": 12"
+        "}"
+    );
+    metaengine::Document doc(&memory);
+    for(std::size_t i = 0; i < 10; ++i)
+    {
+        doc.reload();
+        ARC_CHECK_EQUAL(
+            *doc.get("string", metaengine::UTF8StringV::instance()),
+            "Hello world!"
+        );
+        ARC_CHECK_EQUAL(*doc.get("int", metaengine::IntV<int>::instance()), 12);
+    }
+}
+
+} // namespace anonymous
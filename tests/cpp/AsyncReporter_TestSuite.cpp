@@ -0,0 +1,364 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(AsyncReporter)
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <metaengine/AsyncReporter.hpp>
+#include <metaengine/Document.hpp>
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    FIXTURE
+//------------------------------------------------------------------------------
+
+class ReporterFixture : public arc::test::Fixture
+{
+public:
+
+    //-------------------------PUBLIC STATIC ATTRIBUTES-------------------------
+
+    static std::mutex mutex;
+    static std::vector<metaengine::FallbackEvent> events;
+    static std::atomic<bool> blocking;
+    static std::atomic<bool> blocked;
+
+    //----------------------------CALLBACK FUNCTIONS----------------------------
+
+    static void reporter_func(const metaengine::FallbackEvent& event)
+    {
+        blocked = true;
+        while(blocking)
+        {
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+    }
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        events.clear();
+        blocking = false;
+        blocked = false;
+    }
+
+    metaengine::FallbackEvent make_event(const arc::str::UTF8String& key)
+    {
+        return metaengine::FallbackEvent(
+            metaengine::FallbackEvent::TYPE_GET,
+            arc::io::sys::Path(),
+            key,
+            "Falling back to retrieving value from memory.",
+            "KeyError",
+            "No such key"
+        );
+    }
+};
+
+std::mutex ReporterFixture::mutex;
+std::vector<metaengine::FallbackEvent> ReporterFixture::events;
+std::atomic<bool> ReporterFixture::blocking(false);
+std::atomic<bool> ReporterFixture::blocked(false);
+
+//------------------------------------------------------------------------------
+//                                    DELIVERY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(delivery, ReporterFixture)
+{
+    metaengine::AsyncReporter reporter(ReporterFixture::reporter_func, 16, 0);
+
+    ARC_CHECK_TRUE(reporter.push(fixture->make_event("a")));
+    ARC_CHECK_TRUE(reporter.push(fixture->make_event("b")));
+    ARC_CHECK_TRUE(reporter.push(fixture->make_event("c")));
+    reporter.flush();
+
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 3);
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].key, "a");
+    ARC_CHECK_EQUAL(ReporterFixture::events[1].key, "b");
+    ARC_CHECK_EQUAL(ReporterFixture::events[2].key, "c");
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].suppressed, 0);
+    ARC_CHECK_EQUAL(
+        ReporterFixture::events[0].format(),
+        "Falling back to retrieving value from memory. KeyError: No such key"
+    );
+    ARC_CHECK_EQUAL(reporter.get_dropped_count(), 0);
+
+    ARC_TEST_MESSAGE("Checking events wake the idle background thread");
+    ARC_CHECK_TRUE(reporter.push(fixture->make_event("d")));
+    std::chrono::steady_clock::time_point timeout =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    std::size_t delivered = 0;
+    while(std::chrono::steady_clock::now() < timeout)
+    {
+        {
+            std::lock_guard<std::mutex> lock(ReporterFixture::mutex);
+            delivered = ReporterFixture::events.size();
+        }
+        if(delivered == 4)
+        {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    ARC_CHECK_EQUAL(delivered, 4);
+}
+
+//------------------------------------------------------------------------------
+//                                 DEDUPLICATION
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(deduplication, ReporterFixture)
+{
+    // a rate limit long enough that nothing is repeated within the test
+    metaengine::AsyncReporter reporter(
+        ReporterFixture::reporter_func,
+        64,
+        1000 * 60 * 60
+    );
+
+    for(std::size_t i = 0; i < 10; ++i)
+    {
+        reporter.push(fixture->make_event("a"));
+    }
+    reporter.push(fixture->make_event("b"));
+    reporter.flush();
+
+    ARC_TEST_MESSAGE("Checking first occurrences");
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 3);
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].key, "a");
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].suppressed, 0);
+    ARC_CHECK_EQUAL(ReporterFixture::events[1].key, "b");
+    ARC_CHECK_EQUAL(ReporterFixture::events[1].suppressed, 0);
+
+    ARC_TEST_MESSAGE("Checking suppressed summary");
+    ARC_CHECK_EQUAL(ReporterFixture::events[2].key, "a");
+    ARC_CHECK_EQUAL(ReporterFixture::events[2].suppressed, 9);
+    ARC_CHECK_EQUAL(
+        ReporterFixture::events[2].format(),
+        "Falling back to retrieving value from memory. KeyError: No such key "
+        "(9 identical reports suppressed)"
+    );
+
+    ARC_TEST_MESSAGE("Checking summaries are not repeated");
+    reporter.flush();
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 3);
+}
+
+//------------------------------------------------------------------------------
+//                                    EVICTION
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(eviction, ReporterFixture)
+{
+    // more distinct events than there are slots to deduplicate them in, so
+    // events with suppressed counts are evicted
+    metaengine::AsyncReporter reporter(
+        ReporterFixture::reporter_func,
+        64,
+        1000 * 60 * 60
+    );
+
+    for(std::size_t i = 0; i < 200; ++i)
+    {
+        arc::str::UTF8String key;
+        key << i;
+        for(std::size_t j = 0; j < 5; ++j)
+        {
+            ARC_CHECK_TRUE(reporter.push(fixture->make_event(key)));
+        }
+        // don't let the queue fill up
+        if(i % 8 == 7)
+        {
+            reporter.flush();
+        }
+    }
+    reporter.flush();
+    ARC_CHECK_EQUAL(reporter.get_dropped_count(), 0);
+
+    ARC_TEST_MESSAGE("Checking every event is reported or counted");
+    std::map<arc::str::UTF8String, arc::uint64> reported;
+    std::map<arc::str::UTF8String, arc::uint64> suppressed;
+    ARC_CONST_FOR_EACH(event, ReporterFixture::events)
+    {
+        if(event->suppressed == 0)
+        {
+            ++reported[event->key];
+        }
+        suppressed[event->key] += event->suppressed;
+    }
+    ARC_CHECK_EQUAL(reported.size(), 200);
+    ARC_CONST_FOR_EACH(count, reported)
+    {
+        ARC_CHECK_EQUAL(count->second, 1);
+        ARC_CHECK_EQUAL(suppressed[count->first], 4);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                   FULL QUEUE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(full_queue, ReporterFixture)
+{
+    metaengine::AsyncReporter reporter(ReporterFixture::reporter_func, 2, 0);
+
+    // stall the background thread inside the reporter function
+    ReporterFixture::blocking = true;
+    reporter.push(fixture->make_event("first"));
+    while(!ReporterFixture::blocked)
+    {
+        std::this_thread::yield();
+    }
+
+    ARC_CHECK_TRUE(reporter.push(fixture->make_event("a")));
+    ARC_CHECK_TRUE(reporter.push(fixture->make_event("b")));
+    ARC_CHECK_FALSE(reporter.push(fixture->make_event("c")));
+    ARC_CHECK_FALSE(reporter.push(fixture->make_event("d")));
+    ARC_CHECK_EQUAL(reporter.get_dropped_count(), 2);
+
+    ReporterFixture::blocking = false;
+    reporter.flush();
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 3);
+    ARC_CHECK_EQUAL(ReporterFixture::events[2].key, "b");
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(document, ReporterFixture)
+{
+    metaengine::AsyncReporter reporter(
+        ReporterFixture::reporter_func,
+        256,
+        1000 * 60 * 60
+    );
+    metaengine::Document::set_async_reporter(&reporter);
+
+    // the file does not contain "value_3" so it falls back to memory
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "get" << "correct.json";
+    arc::str::UTF8String memory("{\"value_3\": 4}");
+    metaengine::Document doc(file_path, &memory);
+
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < 4; ++i)
+    {
+        threads.push_back(std::thread([&doc]()
+        {
+            for(std::size_t j = 0; j < 25; ++j)
+            {
+                doc.get("value_3", metaengine::IntV<arc::int32>::instance());
+            }
+        }));
+    }
+    ARC_FOR_EACH(thread, threads)
+    {
+        thread->join();
+    }
+    reporter.flush();
+    metaengine::Document::set_async_reporter(nullptr);
+
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 2);
+    ARC_CHECK_EQUAL(
+        ReporterFixture::events[0].type,
+        metaengine::FallbackEvent::TYPE_GET
+    );
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].file_path, file_path);
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].key, "value_3");
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].error_type, "KeyError");
+    ARC_CHECK_EQUAL(ReporterFixture::events[1].suppressed, 99);
+}
+
+//------------------------------------------------------------------------------
+//                                  DIAGNOSTICS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(diagnostics, ReporterFixture)
+{
+    metaengine::AsyncReporter reporter(
+        ReporterFixture::reporter_func,
+        64,
+        1000 * 60 * 60
+    );
+    metaengine::Document::set_async_reporter(&reporter);
+
+    // "value_1" is a string in the file, so falls back to memory
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String memory("{\"value_1\": 4}");
+    metaengine::Document doc(file_path, &memory);
+    for(std::size_t i = 0; i < 10; ++i)
+    {
+        doc.get("value_1", metaengine::IntV<arc::int32>::instance());
+    }
+    doc.get("value_1", metaengine::FloatV<float>::instance());
+    reporter.flush();
+    metaengine::Document::set_async_reporter(nullptr);
+
+    ARC_TEST_MESSAGE("Checking diagnostics are formatted once per event");
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 3);
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].error_type, "TypeError");
+    ARC_CHECK_EQUAL(
+        ReporterFixture::events[0].details,
+        "Failed to retrieve value for key \"value_1\" from file data with "
+        "message: \"Hello world!\" (string) cannot be converted to integral "
+        "type."
+    );
+
+    ARC_TEST_MESSAGE("Checking differing diagnostics are not suppressed");
+    ARC_CHECK_TRUE(
+        ReporterFixture::events[1].details !=
+        ReporterFixture::events[0].details
+    );
+    ARC_CHECK_EQUAL(ReporterFixture::events[1].suppressed, 0);
+    ARC_CHECK_EQUAL(
+        ReporterFixture::events[2].details,
+        ReporterFixture::events[0].details
+    );
+    ARC_CHECK_EQUAL(ReporterFixture::events[2].suppressed, 9);
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(variant, ReporterFixture)
+{
+    metaengine::AsyncReporter reporter(ReporterFixture::reporter_func, 16, 0);
+    metaengine::Document::set_async_reporter(&reporter);
+
+    // there is no file for the French variant
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant v(v_path, "uk", true);
+    v.set_variant("fr");
+    reporter.flush();
+    metaengine::Document::set_async_reporter(nullptr);
+
+    ARC_CHECK_EQUAL(ReporterFixture::events.size(), 1);
+    ARC_CHECK_EQUAL(
+        ReporterFixture::events[0].type,
+        metaengine::FallbackEvent::TYPE_LOAD
+    );
+    ARC_CHECK_EQUAL(ReporterFixture::events[0].variant, "fr");
+    ARC_CHECK_TRUE(
+        ReporterFixture::events[0].format().starts_with(
+            "Variant \"fr\": Failed to load data with"
+        )
+    );
+}
+
+} // namespace anonymous
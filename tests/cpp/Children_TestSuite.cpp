@@ -0,0 +1,189 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Children)
+
+#include <string>
+
+#include <metaengine/Children.hpp>
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Returns the keys (or indices) of the children joined into a single
+ *        string.
+ */
+std::string join_keys(const metaengine::Children& children)
+{
+    std::string ret;
+    ARC_CONST_FOR_EACH(child, children)
+    {
+        ret += "<";
+        if(child->is_element())
+        {
+            ret += std::to_string(child->get_index());
+        }
+        else
+        {
+            ret += child->get_key();
+        }
+        ret += ">";
+    }
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//                                     OBJECT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(object)
+{
+    arc::str::UTF8String memory(
+        "{\"units\": {\"archer\": {\"hp\": 10}, \"knight\": {\"hp\": 30}, "
+        "\"removed\": null}, \"empty\": {}, \"value\": 1}"
+    );
+    metaengine::Document doc(&memory);
+
+    metaengine::Children units(doc.get_children("units"));
+    ARC_CHECK_FALSE(units.is_array());
+    ARC_CHECK_EQUAL(units.get_key(), "units");
+    // null values are missing
+    ARC_CHECK_EQUAL(join_keys(units), "<archer><knight>");
+
+    ARC_TEST_MESSAGE("Checking the children can be retrieved");
+    arc::int32 total = 0;
+    ARC_CONST_FOR_EACH(unit, units)
+    {
+        ARC_CHECK_FALSE(unit->is_element());
+        metaengine::Children stats(
+            doc.get_children(unit->get_full_key()));
+        ARC_CHECK_EQUAL(join_keys(stats), "<hp>");
+        total +=
+            *stats.begin()->get(metaengine::IntV<arc::int32>::instance());
+    }
+    ARC_CHECK_EQUAL(total, 40);
+    ARC_CHECK_EQUAL(units.begin()->get_full_key(), "units.archer");
+    ARC_CHECK_EQUAL(units.begin()->get_index(), 0);
+
+    ARC_TEST_MESSAGE("Checking the root and empty objects");
+    ARC_CHECK_EQUAL(
+        join_keys(doc.get_children("")),
+        "<empty><units><value>"
+    );
+    ARC_CHECK_EQUAL(join_keys(doc.get_children("empty")), "");
+    ARC_CHECK_TRUE(
+        doc.get_children("empty").begin() == doc.get_children("empty").end());
+
+    ARC_TEST_MESSAGE("Checking errors");
+    ARC_CHECK_THROW(doc.get_children("missing"), arc::ex::KeyError);
+    ARC_CHECK_THROW(doc.get_children("value"), arc::ex::TypeError);
+    ARC_CHECK_THROW(
+        units.begin()->get(metaengine::IntV<arc::int32>::instance()),
+        arc::ex::TypeError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     ARRAY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(array)
+{
+    arc::str::UTF8String memory("{\"list\": [\"a\", null, \"b\", \"c\"]}");
+    metaengine::Document doc(&memory);
+
+    metaengine::Children list(doc.get_children("list"));
+    ARC_CHECK_TRUE(list.is_array());
+    ARC_CHECK_EQUAL(join_keys(list), "<0><2><3>");
+
+    std::string values;
+    for(metaengine::Children::const_iterator element = list.begin();
+        element != list.end();
+        ++element)
+    {
+        ARC_CHECK_TRUE(element->is_element());
+        ARC_CHECK_TRUE(element->get_key() == nullptr);
+        values += element->get(
+            metaengine::UTF8StringV::instance()).get_value().get_raw();
+    }
+    ARC_CHECK_EQUAL(values, "abc");
+    ARC_CHECK_EQUAL((++list.begin())->get_full_key(), "list.2");
+}
+
+//------------------------------------------------------------------------------
+//                                    FALLBACK
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(fallback)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String memory(
+        "{\"value_2\": {\"a\": 1}, \"value_4\": {\"b\": 2, \"c\": \"x\"}}");
+    metaengine::Document doc(file_path, &memory);
+
+    ARC_TEST_MESSAGE("Checking the file data is used first");
+    ARC_CHECK_EQUAL(
+        join_keys(doc.get_children("")),
+        "<value_1><value_2><value_3>"
+    );
+
+    ARC_TEST_MESSAGE("Checking falling back to the memory data");
+    // missing from the file
+    ARC_CHECK_EQUAL(join_keys(doc.get_children("value_4")), "<b><c>");
+    // not an object in the file
+    ARC_CHECK_EQUAL(join_keys(doc.get_children("value_2")), "<a>");
+
+    ARC_TEST_MESSAGE("Checking retrieving a child falls back");
+    metaengine::Children children(doc.get_children("value_4"));
+    metaengine::Children::const_iterator c = ++children.begin();
+    ARC_CHECK_EQUAL(*c->get(metaengine::UTF8StringV::instance()), "x");
+    ARC_CHECK_THROW(
+        c->get(metaengine::IntV<arc::int32>::instance()),
+        arc::ex::TypeError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant variant(file_path, "uk");
+    ARC_CHECK_EQUAL(
+        join_keys(variant.get_children("nest")),
+        "<number><string>"
+    );
+
+    ARC_TEST_MESSAGE("Checking the current variant is used first");
+    variant.set_variant("de");
+    ARC_CHECK_EQUAL(join_keys(variant.get_children("nest")), "<string>");
+    ARC_CHECK_EQUAL(
+        join_keys(variant.get_children("")),
+        "<hello_world><nest><number>"
+    );
+
+    ARC_TEST_MESSAGE("Checking table columns");
+    std::vector<arc::str::UTF8String> variants;
+    variants.push_back("de");
+    variant.load_table(variants);
+    ARC_CHECK_EQUAL(join_keys(variant.get_children("nest")), "<string>");
+    metaengine::Children nest(variant.get_children("nest"));
+    ARC_CHECK_EQUAL(
+        *nest.begin()->get(metaengine::UTF8StringV::instance()),
+        "zw\xC3\xB6lf"
+    );
+    variant.set_variant("uk");
+    ARC_CHECK_EQUAL(
+        join_keys(variant.get_children("nest")),
+        "<number><string>"
+    );
+}
+
+} // namespace anonymous
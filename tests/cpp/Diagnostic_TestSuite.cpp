@@ -0,0 +1,218 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Diagnostic)
+
+#include <string>
+
+#include <json/json.h>
+
+#include <metaengine/Diagnostic.hpp>
+#include <metaengine/Document.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Visitor which only implements the deprecated overload of retrieve().
+ */
+class LegacyV : public metaengine::Visitor<arc::str::UTF8String>
+{
+public:
+
+    // override
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            metaengine::Document* requester,
+            arc::str::UTF8String& error_message)
+    {
+        if(!data->isString())
+        {
+            error_message << "Legacy value is not a string.";
+            return false;
+        }
+        m_value = data->asCString();
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                  TYPE MISMATCH
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(type_mismatch)
+{
+    Json::Value value("Hello world!");
+    arc::str::UTF8String key("my_key");
+
+    ARC_TEST_MESSAGE("Checking empty diagnostic");
+    metaengine::Diagnostic empty;
+    ARC_CHECK_TRUE(empty.is_empty());
+    empty.set_context(key, metaengine::Statistics::SOURCE_MEMORY);
+    ARC_CHECK_EQUAL(
+        empty.format(),
+        "Failed to retrieve value for key \"my_key\" from memory data as the "
+        "requested type."
+    );
+
+    ARC_TEST_MESSAGE("Checking structured data");
+    metaengine::IntV<arc::int32> v;
+    metaengine::Diagnostic diagnostic;
+    ARC_CHECK_FALSE(v.retrieve(&value, key, nullptr, diagnostic));
+    ARC_CHECK_FALSE(diagnostic.is_empty());
+    ARC_CHECK_TRUE(diagnostic.get_value() == &value);
+    ARC_CHECK_EQUAL(
+        arc::str::UTF8String(diagnostic.get_expected_type()),
+        "integral"
+    );
+    ARC_CHECK_EQUAL(
+        arc::str::UTF8String(diagnostic.get_actual_type()),
+        "string"
+    );
+    ARC_CHECK_FALSE(diagnostic.has_element_index());
+
+    ARC_TEST_MESSAGE("Checking format");
+    diagnostic.set_context(key, metaengine::Statistics::SOURCE_FILE);
+    ARC_CHECK_EQUAL(
+        diagnostic.format(),
+        "Failed to retrieve value for key \"my_key\" from file data with "
+        "message: \"Hello world!\" (string) cannot be converted to integral "
+        "type."
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                ELEMENT MISMATCH
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(element_mismatch)
+{
+    Json::Value value(Json::arrayValue);
+    value.append("a");
+    value.append("b");
+    value.append(12);
+    arc::str::UTF8String key("my_key");
+
+    metaengine::UTF8StringVectorV v;
+    metaengine::Diagnostic diagnostic;
+    ARC_CHECK_FALSE(v.retrieve(&value, key, nullptr, diagnostic));
+    diagnostic.set_context(key, metaengine::Statistics::SOURCE_FILE);
+    ARC_CHECK_TRUE(diagnostic.has_element_index());
+    ARC_CHECK_EQUAL(diagnostic.get_element_index(), 2);
+    ARC_CHECK_EQUAL(
+        arc::str::UTF8String(diagnostic.get_actual_type()),
+        "integer"
+    );
+    ARC_CHECK_EQUAL(
+        diagnostic.format(),
+        "Failed to retrieve value for key \"my_key\" from file data with "
+        "message: Array element 2: 12 (integer) cannot be converted to UTF-8 "
+        "string type."
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                   TRUNCATION
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(truncation)
+{
+    std::size_t previous = metaengine::Diagnostic::get_max_value_length();
+    metaengine::Diagnostic::set_max_value_length(16);
+
+    ARC_TEST_MESSAGE("Checking small values");
+    Json::Value small(Json::arrayValue);
+    small.append(1);
+    small.append("two");
+    ARC_CHECK_EQUAL(metaengine::Diagnostic::write_value(small), "[1,\"two\"]");
+
+    ARC_TEST_MESSAGE("Checking large arrays");
+    Json::Value large(Json::arrayValue);
+    for(int i = 0; i < 100000; ++i)
+    {
+        large.append(i);
+    }
+    ARC_CHECK_EQUAL(
+        metaengine::Diagnostic::write_value(large),
+        "[0,1,2,3,4,5,6,7..."
+    );
+
+    ARC_TEST_MESSAGE("Checking large strings");
+    Json::Value str(std::string(100000, 'x'));
+    ARC_CHECK_EQUAL(
+        metaengine::Diagnostic::write_value(str),
+        "\"xxxxxxxxxxxxxxx..."
+    );
+
+    ARC_TEST_MESSAGE("Checking large objects");
+    Json::Value object(Json::objectValue);
+    object["a"] = large;
+    object["b"] = str;
+    ARC_CHECK_EQUAL(
+        metaengine::Diagnostic::write_value(object),
+        "{\"a\":[0,1,2,3,4,..."
+    );
+
+    metaengine::Diagnostic::set_max_value_length(previous);
+}
+
+//------------------------------------------------------------------------------
+//                                    MESSAGE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(message)
+{
+    arc::str::UTF8String key("my_key");
+    metaengine::Diagnostic diagnostic;
+    diagnostic << "Value " << 12 << " is out of range.";
+    diagnostic.set_context(key, metaengine::Statistics::SOURCE_VARIANT);
+
+    ARC_CHECK_FALSE(diagnostic.is_empty());
+    ARC_CHECK_TRUE(diagnostic.get_value() == nullptr);
+    ARC_CHECK_EQUAL(diagnostic.get_message(), "Value 12 is out of range.");
+    ARC_CHECK_EQUAL(
+        diagnostic.format(),
+        "Failed to retrieve value for key \"my_key\" from variant data with "
+        "message: Value 12 is out of range."
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     LEGACY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(legacy)
+{
+    arc::str::UTF8String memory("{\"text\": \"abc\", \"number\": 1}");
+    metaengine::Document doc(&memory);
+    LegacyV v;
+
+    ARC_TEST_MESSAGE("Checking Visitors implementing the old overload");
+    ARC_CHECK_EQUAL(*doc.get("text", v), "abc");
+
+    ARC_TEST_MESSAGE("Checking their message is used by the Diagnostic");
+    metaengine::Diagnostic diagnostic;
+    Json::Value value(1);
+    metaengine::VisitorBase& base = v;
+    ARC_CHECK_FALSE(base.retrieve(&value, "number", nullptr, diagnostic));
+    ARC_CHECK_EQUAL(
+        diagnostic.get_message(),
+        "Legacy value is not a string."
+    );
+    std::string what;
+    try
+    {
+        doc.get("number", v);
+    }
+    catch(const arc::ex::TypeError& exc)
+    {
+        what = exc.what();
+    }
+    ARC_CHECK_TRUE(
+        what.find("Legacy value is not a string.") != std::string::npos
+    );
+}
+
+} // namespace anonymous
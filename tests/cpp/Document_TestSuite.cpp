@@ -7,6 +7,7 @@ ARC_TEST_MODULE(Document)
 #include <json/json.h>
 
 #include <metaengine/Document.hpp>
+#include <metaengine/visitors/Primitive.hpp>
 
 namespace
 {
@@ -193,6 +194,20 @@ ARC_TEST_UNIT_FIXTURE(load_memory, LoadMemoryFixture)
         ARC_CHECK_TRUE(doc.has_valid_memory_data());
     }
 
+    ARC_TEST_MESSAGE("Checking versions");
+    {
+        metaengine::Document doc(&fixture->valid[0], false);
+        ARC_CHECK_EQUAL(doc.get_version(), 0);
+        doc.reload();
+        arc::uint64 first_version = doc.get_version();
+        ARC_CHECK_NOT_EQUAL(first_version, 0);
+        doc.reload();
+        ARC_CHECK_NOT_EQUAL(doc.get_version(), first_version);
+
+        metaengine::Document other(&fixture->valid[0]);
+        ARC_CHECK_NOT_EQUAL(other.get_version(), doc.get_version());
+    }
+
     ARC_TEST_MESSAGE("Checking loading invalid JSON strings");
     ARC_CONST_FOR_EACH(it, fixture->invalid)
     {
@@ -351,6 +366,60 @@ ARC_TEST_UNIT_FIXTURE(load_fallback, LoadFallbackFixture)
     LoadFallbackFixture::reset_state();
 }
 
+//------------------------------------------------------------------------------
+//                                   LOAD ASYNC
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(load_async, LoadFilePathFixture)
+{
+    ARC_TEST_MESSAGE("Checking loading valid files");
+    ARC_CONST_FOR_EACH(it, fixture->valid_paths)
+    {
+        metaengine::Document doc(*it, false);
+        ARC_CHECK_EQUAL(doc.get_version(), 0);
+        std::shared_future<void> loaded(doc.load_async());
+        // blocks until the load has completed
+        ARC_CHECK_TRUE(doc.has_valid_file_data());
+        ARC_CHECK_FALSE(doc.is_loading());
+        ARC_CHECK_NOT_EQUAL(doc.get_version(), 0);
+        loaded.get();
+    }
+
+    ARC_TEST_MESSAGE("Checking reloading");
+    {
+        metaengine::Document doc(fixture->valid_paths[0]);
+        arc::uint64 version = doc.get_version();
+        doc.load_async();
+        doc.load_async();
+        arc::uint64 async_version = doc.get_version();
+        ARC_CHECK_NOT_EQUAL(async_version, version);
+        doc.reload();
+        ARC_CHECK_NOT_EQUAL(doc.get_version(), async_version);
+    }
+
+    ARC_TEST_MESSAGE("Checking loading invalid file paths");
+    ARC_CONST_FOR_EACH(it, fixture->invalid_paths)
+    {
+        metaengine::Document doc(*it, false);
+        std::shared_future<void> loaded(doc.load_async());
+        ARC_CHECK_THROW(loaded.get(), arc::ex::IOError);
+        ARC_CHECK_FALSE(doc.has_valid_file_data());
+    }
+
+    ARC_TEST_MESSAGE("Checking loading non-JSON files");
+    ARC_CONST_FOR_EACH(it, fixture->non_json_paths)
+    {
+        metaengine::Document doc(*it, false);
+        ARC_CHECK_THROW(doc.load_async().get(), arc::ex::ParseError);
+    }
+
+    ARC_TEST_MESSAGE("Checking destroying while loading");
+    {
+        metaengine::Document doc(fixture->valid_paths[1], false);
+        doc.load_async();
+    }
+}
+
 //------------------------------------------------------------------------------
 //                             VISITOR IMPLEMENTATION
 //------------------------------------------------------------------------------
@@ -369,7 +438,7 @@ public:
             const Json::Value* value,
             const arc::str::UTF8String& key,
             metaengine::Document* requester,
-            arc::str::UTF8String& error_message)
+            metaengine::Diagnostic& diagnostic)
     {
         // check type
         if(!value->isString())
@@ -772,6 +841,38 @@ ARC_TEST_UNIT_FIXTURE(get, GetFixture)
     }
 }
 
+//------------------------------------------------------------------------------
+//                               GET ARRAY ELEMENT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(get_array_element)
+{
+    arc::str::UTF8String memory(
+        "{\"colour\": [255, 120, 0], \"grid\": [[1, 2], [3, 4]], "
+        "\"items\": [{\"hp\": 10}, null], \"object\": {\"0\": 5}}");
+    metaengine::Document doc(&memory);
+    metaengine::IntV<arc::int32>& v = metaengine::IntV<arc::int32>::instance();
+
+    ARC_CHECK_EQUAL(*doc.get("colour.0", v), 255);
+    ARC_CHECK_EQUAL(*doc.get("colour.1", v), 120);
+    ARC_CHECK_EQUAL(*doc.get("grid.1.0", v), 3);
+    ARC_CHECK_EQUAL(*doc.get("items.0.hp", v), 10);
+    // object members are still found by name
+    ARC_CHECK_EQUAL(*doc.get("object.0", v), 5);
+
+    ARC_TEST_MESSAGE("Checking invalid indices");
+    ARC_CHECK_THROW(doc.get("colour.3", v), arc::ex::KeyError);
+    ARC_CHECK_THROW(doc.get("colour.01", v), arc::ex::KeyError);
+    ARC_CHECK_THROW(doc.get("colour.-1", v), arc::ex::KeyError);
+    ARC_CHECK_THROW(doc.get("colour.x", v), arc::ex::KeyError);
+    ARC_CHECK_THROW(
+        doc.get("colour.99999999999999999999", v),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_THROW(doc.get("items.1", v), arc::ex::KeyError);
+    ARC_CHECK_THROW(doc.get("colour.0.1", v), arc::ex::KeyError);
+}
+
 // TODO: check null callback functions
 
 } // namespace anonymous
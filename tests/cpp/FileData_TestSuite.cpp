@@ -0,0 +1,97 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(FileData)
+
+#include <string>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include <metaengine/FileData.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Returns whether the string is plain UTF-8.
+ */
+bool is_plain(const std::string& data)
+{
+    return metaengine::FileData::is_plain_utf8(data.data(), data.size());
+}
+
+//------------------------------------------------------------------------------
+//                                 IS PLAIN UTF8
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(is_plain_utf8)
+{
+    ARC_TEST_MESSAGE("Checking valid data");
+    ARC_CHECK_TRUE(is_plain(""));
+    ARC_CHECK_TRUE(is_plain("{\"value\": 1}"));
+    ARC_CHECK_TRUE(is_plain("{\r\n    \"value\": 1\r\n}\r\n"));
+    // 2, 3 and 4 byte sequences at their boundaries
+    ARC_CHECK_TRUE(is_plain("\xC2\x80 \xDF\xBF"));
+    ARC_CHECK_TRUE(is_plain("\xE0\xA0\x80 \xED\x9F\xBF \xEF\xBF\xBF"));
+    ARC_CHECK_TRUE(is_plain("\xF0\x90\x80\x80 \xF4\x8F\xBF\xBF"));
+    ARC_CHECK_TRUE(is_plain("\xEC\x95\x88\xEB\x85\x95\xED\x95\x98\xEC\x84\xB8"));
+
+    ARC_TEST_MESSAGE("Checking invalid data");
+    ARC_CHECK_FALSE(is_plain("\xEF\xBB\xBF{}"));
+    ARC_CHECK_FALSE(is_plain("\xFF\xFE{\0}\0"));
+    ARC_CHECK_FALSE(is_plain(std::string("{\0}", 3)));
+    // overlong
+    ARC_CHECK_FALSE(is_plain("\xC0\xAF"));
+    ARC_CHECK_FALSE(is_plain("\xE0\x9F\xBF"));
+    ARC_CHECK_FALSE(is_plain("\xF0\x8F\xBF\xBF"));
+    // surrogate
+    ARC_CHECK_FALSE(is_plain("\xED\xA0\x80"));
+    // beyond U+10FFFF
+    ARC_CHECK_FALSE(is_plain("\xF4\x90\x80\x80"));
+    ARC_CHECK_FALSE(is_plain("\xF5\x80\x80\x80"));
+    // stray continuation and truncated sequences
+    ARC_CHECK_FALSE(is_plain("\x80"));
+    ARC_CHECK_FALSE(is_plain("\xE2\x82"));
+    ARC_CHECK_FALSE(is_plain("\xE2\x82 "));
+    // latin-1
+    ARC_CHECK_FALSE(is_plain("caf\xE9"));
+
+    ARC_TEST_MESSAGE("Checking every position within a block");
+    for(std::size_t i = 0; i < 40; ++i)
+    {
+        std::string data(40, 'a');
+        data[i] = '\xE9';
+        ARC_CHECK_FALSE(is_plain(data));
+        data[i] = '\0';
+        ARC_CHECK_FALSE(is_plain(data));
+        data.replace(i, 1, "\xC3\xA9");
+        ARC_CHECK_TRUE(is_plain(data));
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                      READ
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(read)
+{
+    arc::io::sys::Path path;
+    path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String data(arc::str::UTF8String::Opt::SKIP_VALID_CHECK);
+    ARC_CHECK_TRUE(metaengine::FileData::read(path, data));
+    ARC_CHECK_EQUAL(data.get_byte_length(), 76);
+
+    ARC_TEST_MESSAGE("Checking files with a byte order mark are decoded");
+    arc::io::sys::Path bom_path;
+    bom_path << "tests" << "meta" << "bom.json";
+    ARC_CHECK_FALSE(metaengine::FileData::read(bom_path, data));
+
+    ARC_TEST_MESSAGE("Checking missing files");
+    arc::io::sys::Path missing_path;
+    missing_path << "tests" << "meta" << "does_not_exist.json";
+    ARC_CHECK_THROW(
+        metaengine::FileData::read(missing_path, data),
+        arc::ex::IOError
+    );
+}
+
+} // namespace anonymous
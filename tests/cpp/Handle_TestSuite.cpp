@@ -0,0 +1,136 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Handle)
+
+#include <json/json.h>
+
+#include <metaengine/Handle.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Integer visitor which counts how many times it has been passed data.
+ */
+class CountingV : public metaengine::Visitor<arc::int32>
+{
+public:
+
+    static std::size_t retrieved;
+
+    // override
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            metaengine::Document* requester,
+            metaengine::Diagnostic& diagnostic)
+    {
+        ++retrieved;
+        if(!data->isInt())
+        {
+            diagnostic.set_type_mismatch(data, "integral");
+            return false;
+        }
+        m_value = data->asInt();
+        return true;
+    }
+};
+
+std::size_t CountingV::retrieved = 0;
+
+//------------------------------------------------------------------------------
+//                                      GET
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(get)
+{
+    arc::str::UTF8String memory("{\"speed\": 4, \"name\": \"hero\"}");
+    metaengine::Document doc(&memory);
+
+    CountingV::retrieved = 0;
+    metaengine::Handle<CountingV> speed(&doc, "speed");
+    ARC_CHECK_EQUAL(CountingV::retrieved, 1);
+    ARC_CHECK_TRUE(speed.get_document() == &doc);
+    ARC_CHECK_EQUAL(speed.get_key(), "speed");
+
+    ARC_TEST_MESSAGE("Checking the value is only retrieved once");
+    for(std::size_t i = 0; i < 10; ++i)
+    {
+        ARC_CHECK_EQUAL(*speed, 4);
+    }
+    ARC_CHECK_EQUAL(CountingV::retrieved, 1);
+
+    metaengine::Handle<metaengine::UTF8StringV> name(&doc, "name");
+    ARC_CHECK_EQUAL(*name, "hero");
+    ARC_CHECK_EQUAL(name->get_length(), 4);
+
+    ARC_TEST_MESSAGE("Checking the value is retrieved again after a reload");
+    memory = "{\"speed\": 7, \"name\": \"villain\"}";
+    doc.reload();
+    ARC_CHECK_EQUAL(*speed, 7);
+    ARC_CHECK_EQUAL(*speed, 7);
+    ARC_CHECK_EQUAL(CountingV::retrieved, 2);
+    ARC_CHECK_EQUAL(*name, "villain");
+
+    ARC_TEST_MESSAGE("Checking refreshing explicitly");
+    speed.refresh();
+    ARC_CHECK_EQUAL(CountingV::retrieved, 3);
+    ARC_CHECK_EQUAL(*speed, 7);
+    ARC_CHECK_EQUAL(CountingV::retrieved, 3);
+}
+
+//------------------------------------------------------------------------------
+//                                     ERRORS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(errors)
+{
+    arc::str::UTF8String memory("{\"speed\": 4}");
+    metaengine::Document doc(&memory);
+
+    ARC_CHECK_THROW(
+        metaengine::Handle<metaengine::IntV<arc::int32>>(&doc, "missing"),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_THROW(
+        metaengine::Handle<metaengine::BoolV>(&doc, "speed"),
+        arc::ex::TypeError
+    );
+
+    metaengine::Handle<metaengine::IntV<arc::int32>> speed(&doc, "speed");
+
+    ARC_TEST_MESSAGE("Checking errors after a reload are raised on each read");
+    memory = "{\"speed\": \"fast\"}";
+    doc.reload();
+    ARC_CHECK_THROW(*speed, arc::ex::TypeError);
+    ARC_CHECK_THROW(*speed, arc::ex::TypeError);
+
+    ARC_TEST_MESSAGE("Checking the handle recovers once the data is valid");
+    memory = "{\"speed\": 5}";
+    doc.reload();
+    ARC_CHECK_EQUAL(*speed, 5);
+}
+
+//------------------------------------------------------------------------------
+//                                  LOAD ASYNC
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(load_async)
+{
+    arc::str::UTF8String memory("{\"speed\": 4}");
+    metaengine::Document doc(&memory);
+    metaengine::Handle<metaengine::IntV<arc::int32>> speed(&doc, "speed");
+
+    memory = "{\"speed\": 9}";
+    std::shared_future<void> loaded(doc.load_async());
+    // either the previous value or, once the new version is assigned, the new
+    // value after waiting for the load
+    arc::int32 value = *speed;
+    ARC_CHECK_TRUE(value == 4 || value == 9);
+    loaded.get();
+    ARC_CHECK_EQUAL(*speed, 9);
+}
+
+} // namespace anonymous
@@ -0,0 +1,124 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(KeyPool)
+
+#include <cstring>
+
+#include <json/json.h>
+
+#include <metaengine/KeyPool.hpp>
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Parses the data into the tree, interning its keys in the pool.
+ */
+void parse(
+        const std::string& data,
+        metaengine::KeyPool& pool,
+        metaengine::ArenaTree& tree)
+{
+    Json::MemoryResource::Scope scope(&tree.get_arena());
+    Json::KeyInterner::Scope key_scope(&pool);
+    Json::Reader reader;
+    reader.parse(data, *tree.get_root());
+}
+
+/*!
+ * \brief Returns the storage of the first key of the object.
+ */
+const char* first_key(const Json::Value& object)
+{
+    const char* end = nullptr;
+    return object.begin().memberName(&end);
+}
+
+//------------------------------------------------------------------------------
+//                                     INTERN
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(intern)
+{
+    metaengine::KeyPool pool;
+    ARC_CHECK_EQUAL(pool.get_size(), 0);
+
+    const char* hello = pool.intern("hello", 5);
+    ARC_CHECK_EQUAL(std::strcmp(hello, "hello"), 0);
+    ARC_CHECK_TRUE(pool.intern("hello", 5) == hello);
+    ARC_CHECK_TRUE(pool.intern("hello world", 5) == hello);
+    ARC_CHECK_TRUE(pool.intern("hell", 4) != hello);
+    ARC_CHECK_EQUAL(pool.get_size(), 2);
+
+    ARC_TEST_MESSAGE("Checking growth");
+    std::vector<const char*> keys;
+    for(std::size_t i = 0; i < 1000; ++i)
+    {
+        std::string key("key_" + std::to_string(i));
+        keys.push_back(pool.intern(key.c_str(), key.size()));
+    }
+    ARC_CHECK_EQUAL(pool.get_size(), 1002);
+    for(std::size_t i = 0; i < 1000; ++i)
+    {
+        std::string key("key_" + std::to_string(i));
+        ARC_CHECK_TRUE(pool.intern(key.c_str(), key.size()) == keys[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                     TREES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(trees)
+{
+    std::shared_ptr<metaengine::KeyPool> pool(new metaengine::KeyPool());
+    metaengine::ArenaTree uk(0, pool);
+    metaengine::ArenaTree de(0, pool);
+    parse("{\"greeting\": \"Hello\", \"nest\": {\"value\": 1}}", *pool, uk);
+    parse("{\"greeting\": \"Hallo\", \"nest\": {\"value\": 2}}", *pool, de);
+
+    ARC_TEST_MESSAGE("Checking keys share storage");
+    ARC_CHECK_EQUAL(pool->get_size(), 3);
+    ARC_CHECK_TRUE(first_key(*uk.get_root()) == first_key(*de.get_root()));
+    ARC_CHECK_EQUAL((*de.get_root())["nest"]["value"].asInt(), 2);
+
+    ARC_TEST_MESSAGE("Checking copies don't depend on the pool");
+    Json::Value copy;
+    {
+        std::shared_ptr<metaengine::KeyPool> other(new metaengine::KeyPool());
+        metaengine::ArenaTree tree(0, other);
+        parse("{\"nest\": {\"value\": 3}}", *other, tree);
+        copy = *tree.get_root();
+        ARC_CHECK_TRUE(first_key(copy) != first_key(*tree.get_root()));
+    }
+    ARC_CHECK_EQUAL(copy["nest"]["value"].asInt(), 3);
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant v(v_path, "uk", true);
+
+    // the de variant only has keys that are also in the uk variant
+    std::size_t size = v.get_key_pool().get_size();
+    v.set_variant("de");
+    ARC_CHECK_EQUAL(v.get_key_pool().get_size(), size);
+    ARC_CHECK_EQUAL(
+        *v.get("nest.string", metaengine::UTF8StringV::instance()),
+        "zwölf"
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("number", metaengine::IntV<arc::int32>::instance()),
+        1337
+    );
+}
+
+} // namespace anonymous
@@ -0,0 +1,176 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(LoadTimings)
+
+#include <json/json.h>
+
+#include <metaengine/LoadReport.hpp>
+#include <metaengine/Variant.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Sets a LoadReport for the duration of a test.
+ */
+class ReportFixture : public arc::test::Fixture
+{
+public:
+
+    //----------------------------PUBLIC ATTRIBUTES-----------------------------
+
+    metaengine::LoadReport report;
+    arc::io::sys::Path file_path;
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        file_path << "tests" << "meta" << "simple.json";
+        metaengine::Document::set_load_report(&report);
+    }
+
+    virtual void teardown()
+    {
+        metaengine::Document::set_load_report(nullptr);
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                      FILE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(file)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    metaengine::Document doc(file_path);
+
+    const metaengine::LoadTimings& timings = doc.get_load_timings();
+    const metaengine::LoadTimings::Timing& read =
+        timings.phases[metaengine::LoadTimings::PHASE_READ];
+    const metaengine::LoadTimings::Timing& parse =
+        timings.phases[metaengine::LoadTimings::PHASE_PARSE];
+
+    ARC_CHECK_EQUAL(read.bytes, 75);
+    ARC_CHECK_EQUAL(parse.bytes, 75);
+    ARC_CHECK_TRUE(read.wall_time > 0);
+    ARC_CHECK_TRUE(parse.wall_time > 0);
+    ARC_CHECK_TRUE(timings.total.wall_time >= read.wall_time);
+    ARC_CHECK_EQUAL(
+        timings.phases[metaengine::LoadTimings::PHASE_MEMORY_PARSE].bytes,
+        0
+    );
+
+    ARC_TEST_MESSAGE("Checking reload resets the timings");
+    doc.reload();
+    ARC_CHECK_EQUAL(read.bytes, 75);
+    ARC_CHECK_EQUAL(parse.bytes, 75);
+}
+
+//------------------------------------------------------------------------------
+//                                     MEMORY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(memory)
+{
+    arc::str::UTF8String memory("{\"value\": 1}");
+    metaengine::Document doc(&memory);
+
+    const metaengine::LoadTimings& timings = doc.get_load_timings();
+    ARC_CHECK_EQUAL(
+        timings.phases[metaengine::LoadTimings::PHASE_MEMORY_PARSE].bytes,
+        12
+    );
+    ARC_CHECK_EQUAL(
+        timings.phases[metaengine::LoadTimings::PHASE_READ].bytes,
+        0
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant doc(v_path, "uk");
+
+    const metaengine::LoadTimings& timings = doc.get_load_timings();
+    const metaengine::LoadTimings::Timing& read =
+        timings.phases[metaengine::LoadTimings::PHASE_VARIANT_READ];
+    const metaengine::LoadTimings::Timing& parse =
+        timings.phases[metaengine::LoadTimings::PHASE_VARIANT_PARSE];
+    // the default variant is the Document's own file
+    ARC_CHECK_EQUAL(
+        timings.phases[metaengine::LoadTimings::PHASE_READ].bytes,
+        186
+    );
+    ARC_CHECK_EQUAL(read.bytes, 0);
+
+    ARC_TEST_MESSAGE("Checking set_variant accumulates");
+    doc.set_variant("de");
+    ARC_CHECK_EQUAL(read.bytes, 117);
+    ARC_CHECK_EQUAL(parse.bytes, 117);
+    doc.set_variant("ko");
+    ARC_CHECK_EQUAL(read.bytes, 322);
+    ARC_CHECK_EQUAL(parse.bytes, 322);
+    ARC_CHECK_TRUE(read.wall_time > 0);
+}
+
+//------------------------------------------------------------------------------
+//                                     REPORT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(report, ReportFixture)
+{
+    arc::str::UTF8String memory("{\"value\": 1}");
+    metaengine::Document file_doc(fixture->file_path);
+    metaengine::Document mem_doc(&memory);
+    ARC_CHECK_EQUAL(fixture->report.get_entries().size(), 2);
+
+    file_doc.load_async().wait();
+    std::vector<metaengine::LoadReport::Entry> entries(
+        fixture->report.get_entries());
+    ARC_CHECK_EQUAL(entries.size(), 3);
+    for(std::size_t i = 1; i < entries.size(); ++i)
+    {
+        ARC_CHECK_TRUE(
+            entries[i - 1].timings.total.wall_time >=
+            entries[i].timings.total.wall_time
+        );
+    }
+
+    metaengine::LoadTimings totals(fixture->report.get_totals());
+    ARC_CHECK_EQUAL(
+        totals.phases[metaengine::LoadTimings::PHASE_READ].bytes,
+        150
+    );
+    ARC_CHECK_EQUAL(
+        totals.phases[metaengine::LoadTimings::PHASE_MEMORY_PARSE].bytes,
+        12
+    );
+
+    ARC_TEST_MESSAGE("Checking the JSON export");
+    Json::Value root;
+    Json::Reader reader;
+    ARC_CHECK_TRUE(
+        reader.parse(fixture->report.to_json().get_raw(), root));
+    ARC_CHECK_EQUAL(root["loads"].size(), 3);
+    ARC_CHECK_EQUAL(
+        root["totals"]["phases"]["read"]["bytes"].asUInt64(),
+        150
+    );
+
+    ARC_TEST_MESSAGE("Checking disabling the report");
+    metaengine::Document::set_load_report(nullptr);
+    file_doc.reload();
+    ARC_CHECK_EQUAL(fixture->report.get_entries().size(), 3);
+
+    fixture->report.clear();
+    ARC_CHECK_TRUE(fixture->report.get_entries().empty());
+}
+
+} // namespace anonymous
@@ -0,0 +1,169 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(ParseCache)
+
+#include <metaengine/KeyPool.hpp>
+#include <metaengine/ParseCache.hpp>
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Sets a ParseCache for the duration of a test.
+ */
+class CacheFixture : public arc::test::Fixture
+{
+public:
+
+    //----------------------------PUBLIC ATTRIBUTES-----------------------------
+
+    metaengine::ParseCache cache;
+    arc::io::sys::Path file_path;
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        file_path << "tests" << "meta" << "simple.json";
+        metaengine::Document::set_parse_cache(&cache);
+    }
+
+    virtual void teardown()
+    {
+        metaengine::Document::set_parse_cache(nullptr);
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                      FILE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(file, CacheFixture)
+{
+    metaengine::Document first(fixture->file_path);
+    ARC_CHECK_EQUAL(fixture->cache.get_size(), 1);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 0);
+
+    ARC_TEST_MESSAGE("Checking the tree is shared");
+    metaengine::Document second(fixture->file_path);
+    ARC_CHECK_EQUAL(fixture->cache.get_size(), 1);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 1);
+    // the second Document never parsed anything itself
+    ARC_CHECK_EQUAL(second.get_key_pool().get_size(), 0);
+    ARC_CHECK_EQUAL(
+        *second.get("value_2", metaengine::IntV<arc::int32>::instance()),
+        175
+    );
+
+    ARC_TEST_MESSAGE("Checking different paths to the same file");
+    arc::io::sys::Path other_path;
+    other_path << "tests" << "meta" << ".." << "meta" << "simple.json";
+    metaengine::Document third(other_path);
+    ARC_CHECK_EQUAL(fixture->cache.get_size(), 1);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 2);
+
+    ARC_TEST_MESSAGE("Checking reload shares the tree again");
+    first.reload();
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 3);
+    ARC_CHECK_EQUAL(
+        *first.get("value_1", metaengine::UTF8StringV::instance()),
+        "Hello world!"
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     MEMORY
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(memory, CacheFixture)
+{
+    arc::str::UTF8String memory("{\"value\": 1}");
+    arc::str::UTF8String other_memory("{\"value\": 1}");
+
+    metaengine::Document first(&memory);
+    metaengine::Document second(&memory);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 1);
+
+    ARC_TEST_MESSAGE("Checking other strings are separate sources");
+    metaengine::Document other(&other_memory);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 1);
+    ARC_CHECK_EQUAL(fixture->cache.get_size(), 2);
+
+    ARC_TEST_MESSAGE("Checking changed data is parsed again");
+    memory = "{\"value\": 2}";
+    second.reload();
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 1);
+    ARC_CHECK_EQUAL(
+        *second.get("value", metaengine::IntV<arc::int32>::instance()),
+        2
+    );
+    // the first Document keeps its data until it is reloaded
+    ARC_CHECK_EQUAL(
+        *first.get("value", metaengine::IntV<arc::int32>::instance()),
+        1
+    );
+    first.reload();
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 2);
+    ARC_CHECK_EQUAL(
+        *first.get("value", metaengine::IntV<arc::int32>::instance()),
+        2
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(variant, CacheFixture)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant first(v_path, "uk");
+    first.set_variant("de");
+
+    // both the default and the current variant are shared
+    metaengine::Variant second(v_path, "uk");
+    second.set_variant("de");
+    ARC_CHECK_EQUAL(fixture->cache.get_size(), 2);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 2);
+    ARC_CHECK_EQUAL(
+        *second.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hallo Welt!"
+    );
+
+    // and so is a plain Document of the default variant
+    arc::io::sys::Path uk_path;
+    uk_path << "tests" << "meta" << "variants" << "lang.uk.json";
+    metaengine::Document uk(uk_path);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 3);
+}
+
+//------------------------------------------------------------------------------
+//                                    RELEASE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(release, CacheFixture)
+{
+    {
+        metaengine::Document first(fixture->file_path);
+        metaengine::Document second(fixture->file_path);
+        ARC_CHECK_EQUAL(fixture->cache.get_size(), 1);
+    }
+    // the cache does not keep trees alive
+    ARC_CHECK_EQUAL(fixture->cache.get_size(), 0);
+
+    metaengine::Document third(fixture->file_path);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 1);
+    ARC_CHECK_EQUAL(third.get_key_pool().get_size(), 3);
+
+    ARC_TEST_MESSAGE("Checking disabling the cache");
+    metaengine::Document::set_parse_cache(nullptr);
+    metaengine::Document fourth(fixture->file_path);
+    ARC_CHECK_EQUAL(fixture->cache.get_hits(), 1);
+    ARC_CHECK_EQUAL(fourth.get_key_pool().get_size(), 3);
+}
+
+} // namespace anonymous
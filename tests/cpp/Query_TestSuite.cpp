@@ -0,0 +1,319 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Query)
+
+#include <algorithm>
+#include <string>
+
+#include <metaengine/Document.hpp>
+#include <metaengine/Query.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+static const char* const DATA =
+    "{"
+    "\"abilities\": {"
+        "\"dash\": {\"cooldown\": 2, \"range\": 4}, "
+        "\"fireball\": {\"cooldown\": 8}, "
+        "\"block\": {\"range\": 1}, "
+        "\"removed\": null"
+    "}, "
+    "\"items\": ["
+        "{\"name\": \"sword\", \"type\": \"weapon\", \"damage\": 12}, "
+        "{\"name\": \"shield\", \"type\": \"armour\"}, "
+        "null, "
+        "{\"name\": \"bow\", \"type\": \"weapon\", \"damage\": 7}"
+    "], "
+    "\"levels\": [10, 20, 30, 40, 50], "
+    "\"value\": 1"
+    "}";
+
+/*!
+ * \brief Runs the query and returns the keys and integer values matched,
+ *        joined into a single string.
+ */
+std::string run_int(
+        metaengine::Document& doc,
+        const metaengine::Query& query)
+{
+    std::string ret;
+    metaengine::IntV<arc::int32>& v = metaengine::IntV<arc::int32>::instance();
+    std::size_t matches = doc.query(
+        query,
+        v,
+        [&](const arc::str::UTF8String& key)
+        {
+            ret += "<";
+            ret += key.get_raw();
+            ret += "=";
+            ret += std::to_string(*v);
+            ret += ">";
+        }
+    );
+    ARC_CHECK_EQUAL(matches, std::count(ret.begin(), ret.end(), '<'));
+    return ret;
+}
+
+/*!
+ * \brief Runs the query and returns the keys matched joined into a single
+ *        string.
+ */
+std::string run_keys(
+        metaengine::Document& doc,
+        const arc::str::UTF8String& expression)
+{
+    std::string ret;
+    metaengine::Query query(expression);
+    metaengine::UTF8StringV& v = metaengine::UTF8StringV::instance();
+    doc.query(
+        query,
+        v,
+        [&](const arc::str::UTF8String& key)
+        {
+            ret += "<";
+            ret += key.get_raw();
+            ret += ">";
+        }
+    );
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//                                    WILDCARD
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(wildcard)
+{
+    arc::str::UTF8String memory(DATA);
+    metaengine::Document doc(&memory);
+
+    metaengine::Query query("abilities.*.cooldown");
+    ARC_CHECK_EQUAL(query.get_expression(), "abilities.*.cooldown");
+    ARC_CHECK_EQUAL(query.get_prefix(), "abilities");
+    ARC_CHECK_EQUAL(
+        run_int(doc, query),
+        "<abilities.dash.cooldown=2><abilities.fireball.cooldown=8>"
+    );
+
+    ARC_TEST_MESSAGE("Checking wildcards over arrays");
+    ARC_CHECK_EQUAL(
+        run_keys(doc, "items.*.name"),
+        "<items.0.name><items.1.name><items.3.name>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels.*")),
+        "<levels.0=10><levels.1=20><levels.2=30><levels.3=40><levels.4=50>"
+    );
+
+    ARC_TEST_MESSAGE("Checking wildcards at the root");
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("*.dash.range")),
+        "<abilities.dash.range=4>"
+    );
+    ARC_CHECK_EQUAL(run_int(doc, metaengine::Query("value")), "<value=1>");
+
+    ARC_TEST_MESSAGE("Checking queries without matches");
+    ARC_CHECK_EQUAL(run_int(doc, metaengine::Query("missing.*")), "");
+    ARC_CHECK_EQUAL(run_int(doc, metaengine::Query("value.*")), "");
+    ARC_CHECK_EQUAL(run_int(doc, metaengine::Query("abilities.*.x")), "");
+}
+
+//------------------------------------------------------------------------------
+//                                     SLICE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(slice)
+{
+    arc::str::UTF8String memory(DATA);
+    metaengine::Document doc(&memory);
+
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[1]")),
+        "<levels.1=20>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[-1]")),
+        "<levels.4=50>"
+    );
+    ARC_CHECK_EQUAL(run_int(doc, metaengine::Query("levels[5]")), "");
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[1:3]")),
+        "<levels.1=20><levels.2=30>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[-2:]")),
+        "<levels.3=40><levels.4=50>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[::2]")),
+        "<levels.0=10><levels.2=30><levels.4=50>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[-100:100:3]")),
+        "<levels.0=10><levels.3=40>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels.2")),
+        "<levels.2=30>"
+    );
+
+    ARC_TEST_MESSAGE("Checking slices followed by names");
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("items[:3].damage")),
+        "<items.0.damage=12>"
+    );
+    ARC_CHECK_EQUAL(run_int(doc, metaengine::Query("abilities[0]")), "");
+}
+
+//------------------------------------------------------------------------------
+//                                   PREDICATE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(predicate)
+{
+    arc::str::UTF8String memory(DATA);
+    metaengine::Document doc(&memory);
+
+    ARC_CHECK_EQUAL(
+        run_keys(doc, "items[?type == \"weapon\"].name"),
+        "<items.0.name><items.3.name>"
+    );
+    ARC_CHECK_EQUAL(
+        run_keys(doc, "items[?type != \"weapon\"].name"),
+        "<items.1.name>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("items[?damage < 10].damage")),
+        "<items.3.damage=7>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("items[?damage].damage")),
+        "<items.0.damage=12><items.3.damage=7>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("*[?range>=4].range")),
+        "<abilities.dash.range=4>"
+    );
+
+    ARC_TEST_MESSAGE("Checking predicates on the value itself");
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[?@ >= 30]")),
+        "<levels.2=30><levels.3=40><levels.4=50>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[?@ <= 20.5]")),
+        "<levels.0=10><levels.1=20>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("abilities[?range > 1].range")),
+        "<abilities.dash.range=4>"
+    );
+
+    ARC_TEST_MESSAGE("Checking values of different types");
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[?@ == \"10\"]")),
+        ""
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[?@ > true]")),
+        ""
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("levels[?@ != \"10\"]")),
+        "<levels.0=10><levels.1=20><levels.2=30><levels.3=40><levels.4=50>"
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                  PARSE ERRORS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(parse_errors)
+{
+    const char* invalid[] = {
+        "",
+        "a..b",
+        "a.",
+        "a[",
+        "a[]",
+        "a[x]",
+        "a[1:2:0]",
+        "a[1:2:-1]",
+        "a[?]",
+        "a[?b ==]",
+        "a[?b == weapon]",
+        "a[?b == \"weapon]",
+        "a[?b = 1]",
+        "a[?b == [1]]",
+        "a]"
+    };
+    for(std::size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        ARC_CHECK_THROW(metaengine::Query(invalid[i]), arc::ex::ParseError);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                    FALLBACK
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(fallback)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String memory(
+        "{\"value_2\": {\"a\": 1, \"b\": 2}, \"value_4\": {\"c\": 3}}");
+    metaengine::Document doc(file_path, &memory);
+
+    ARC_TEST_MESSAGE("Checking the prefix falls back to the memory data");
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("value_2.*")),
+        "<value_2.a=1><value_2.b=2>"
+    );
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("value_4.*")),
+        "<value_4.c=3>"
+    );
+
+    ARC_CHECK_EQUAL(
+        run_int(doc, metaengine::Query("value_2")),
+        "<value_2=175>"
+    );
+
+    ARC_TEST_MESSAGE("Checking matches of the wrong type are errors");
+    ARC_CHECK_THROW(
+        run_int(doc, metaengine::Query("*")),
+        arc::ex::KeyError
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     RELOAD
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(reload)
+{
+    arc::str::UTF8String memory(DATA);
+    metaengine::Document doc(&memory);
+
+    metaengine::Query query("abilities.*.cooldown");
+    ARC_CHECK_EQUAL(
+        run_int(doc, query),
+        "<abilities.dash.cooldown=2><abilities.fireball.cooldown=8>"
+    );
+
+    ARC_TEST_MESSAGE("Checking the query is reused after reloading");
+    memory =
+        "{\"abilities\": {\"block\": {\"cooldown\": 1}, "
+        "\"dash\": {\"cooldown\": 3}}}";
+    doc.reload();
+    ARC_CHECK_EQUAL(
+        run_int(doc, query),
+        "<abilities.block.cooldown=1><abilities.dash.cooldown=3>"
+    );
+}
+
+} // namespace anonymous
@@ -0,0 +1,229 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Schema)
+
+#include <json/json.h>
+
+#include <metaengine/Document.hpp>
+#include <metaengine/Schema.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Visitor which retrieves whether the value was proven to be a string.
+ */
+class ProvenStringV : public metaengine::Visitor<bool>
+{
+public:
+
+    // override
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            metaengine::Document* requester,
+            metaengine::Diagnostic& diagnostic)
+    {
+        m_value = diagnostic.is_proven(metaengine::Schema::TYPE_STRING);
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                    MATCHES
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(matches)
+{
+    Json::Value root;
+    Json::Reader reader;
+    reader.parse(
+        "{\"b\": true, \"i\": 3, \"f\": 1.5, \"s\": \"x\", "
+        "\"ia\": [1, 2], \"mixed\": [1, \"2\"], \"empty\": []}",
+        root
+    );
+
+    struct Case
+    {
+        const char* key;
+        metaengine::Schema::Type type;
+        bool matches;
+    };
+    Case cases[] = {
+        {"b", metaengine::Schema::TYPE_BOOL, true},
+        {"i", metaengine::Schema::TYPE_BOOL, false},
+        {"i", metaengine::Schema::TYPE_INT, true},
+        {"f", metaengine::Schema::TYPE_INT, false},
+        {"i", metaengine::Schema::TYPE_FLOAT, true},
+        {"f", metaengine::Schema::TYPE_FLOAT, true},
+        {"s", metaengine::Schema::TYPE_STRING, true},
+        {"ia", metaengine::Schema::TYPE_STRING, false},
+        {"ia", metaengine::Schema::TYPE_INT_ARRAY, true},
+        {"ia", metaengine::Schema::TYPE_FLOAT_ARRAY, true},
+        {"ia", metaengine::Schema::TYPE_BOOL_ARRAY, false},
+        {"i", metaengine::Schema::TYPE_INT_ARRAY, false},
+        {"mixed", metaengine::Schema::TYPE_INT_ARRAY, false},
+        {"empty", metaengine::Schema::TYPE_STRING_ARRAY, true}
+    };
+    for(std::size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        metaengine::Diagnostic diagnostic;
+        ARC_CHECK_EQUAL(
+            metaengine::Schema::matches(
+                cases[i].type,
+                root[cases[i].key],
+                diagnostic
+            ),
+            cases[i].matches
+        );
+        ARC_CHECK_EQUAL(diagnostic.is_empty(), cases[i].matches);
+    }
+
+    ARC_TEST_MESSAGE("Checking the diagnostic of an element");
+    metaengine::Diagnostic diagnostic;
+    metaengine::Schema::matches(
+        metaengine::Schema::TYPE_INT_ARRAY,
+        root["mixed"],
+        diagnostic
+    );
+    ARC_CHECK_TRUE(diagnostic.has_element_index());
+    ARC_CHECK_EQUAL(diagnostic.get_element_index(), 1);
+    ARC_CHECK_EQUAL(
+        arc::str::UTF8String(diagnostic.get_expected_type()),
+        "integral"
+    );
+
+    ARC_TEST_MESSAGE("Checking declarations");
+    metaengine::Schema schema;
+    schema.add("a", metaengine::Schema::TYPE_INT)
+          .add("b", metaengine::Schema::TYPE_BOOL)
+          .add("a", metaengine::Schema::TYPE_STRING);
+    ARC_CHECK_EQUAL(schema.get_entries().size(), 2);
+    ARC_CHECK_EQUAL(schema.get_entries()[0].key, "a");
+    ARC_CHECK_EQUAL(
+        schema.get_entries()[0].type,
+        metaengine::Schema::TYPE_STRING
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+class DocumentFixture : public arc::test::Fixture
+{
+public:
+
+    //-------------------------PUBLIC STATIC ATTRIBUTES-------------------------
+
+    static std::size_t load_reports;
+    static std::size_t get_reports;
+
+    //----------------------------CALLBACK FUNCTIONS----------------------------
+
+    static void load_reporter(
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& message)
+    {
+        ++load_reports;
+    }
+
+    static void get_reporter(
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& message)
+    {
+        ++get_reports;
+    }
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        load_reports = 0;
+        get_reports = 0;
+        metaengine::Document::set_load_fallback_reporter(load_reporter);
+        metaengine::Document::set_get_fallback_reporter(get_reporter);
+    }
+
+    virtual void teardown()
+    {
+        metaengine::Document::set_load_fallback_reporter(nullptr);
+        metaengine::Document::set_get_fallback_reporter(nullptr);
+    }
+};
+
+std::size_t DocumentFixture::load_reports = 0;
+std::size_t DocumentFixture::get_reports = 0;
+
+ARC_TEST_UNIT_FIXTURE(document, DocumentFixture)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String memory(
+        "{\"value_2\": \"from memory\", \"value_3\": 1.5, "
+        "\"value_4\": [1, 2, 3]}");
+    metaengine::Document doc(file_path, &memory);
+
+    std::shared_ptr<metaengine::Schema> schema(new metaengine::Schema());
+    schema->add("value_1", metaengine::Schema::TYPE_STRING)
+            .add("value_2", metaengine::Schema::TYPE_STRING)
+            .add("value_3", metaengine::Schema::TYPE_INT)
+            .add("value_4", metaengine::Schema::TYPE_INT_ARRAY);
+    doc.set_schema(schema);
+    ARC_CHECK_TRUE(doc.get_schema() == schema);
+    doc.reload();
+
+    ARC_TEST_MESSAGE("Checking fallbacks are reported during the load");
+    // value_2 and value_3 have the wrong type in the file and value_4 is
+    // missing
+    ARC_CHECK_EQUAL(DocumentFixture::load_reports, 3);
+
+    ProvenStringV proven_v;
+    ARC_CHECK_TRUE(*doc.get("value_1", proven_v));
+    ARC_CHECK_TRUE(*doc.get("value_2", proven_v));
+    ARC_CHECK_EQUAL(
+        *doc.get("value_2", metaengine::UTF8StringV::instance()),
+        "from memory"
+    );
+    std::vector<arc::int32> expected;
+    expected.push_back(1);
+    expected.push_back(2);
+    expected.push_back(3);
+    ARC_CHECK_EQUAL(
+        *doc.get("value_4", metaengine::IntVectorV<arc::int32>::instance()),
+        expected
+    );
+    ARC_CHECK_EQUAL(DocumentFixture::get_reports, 0);
+
+    ARC_TEST_MESSAGE("Checking other types are retrieved as normal");
+    ARC_CHECK_EQUAL(
+        *doc.get("value_2", metaengine::IntV<arc::int32>::instance()),
+        175
+    );
+    // value_3 matched in neither source
+    ARC_CHECK_FALSE(*doc.get("value_3", proven_v));
+    ARC_CHECK_THROW(
+        doc.get("value_3", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::TypeError
+    );
+    ARC_CHECK_EQUAL(DocumentFixture::get_reports, 1);
+
+    ARC_TEST_MESSAGE("Checking the data is validated again when reloaded");
+    memory = "{\"value_2\": \"from memory\", \"value_4\": [1, \"2\"]}";
+    doc.reload();
+    ARC_CHECK_EQUAL(DocumentFixture::load_reports, 6);
+    ARC_CHECK_THROW(
+        doc.get("value_4", metaengine::IntVectorV<arc::int32>::instance()),
+        arc::ex::TypeError
+    );
+
+    ARC_TEST_MESSAGE("Checking removing the schema");
+    doc.set_schema(nullptr);
+    doc.reload();
+    ARC_CHECK_EQUAL(DocumentFixture::load_reports, 6);
+    ARC_CHECK_FALSE(*doc.get("value_1", proven_v));
+}
+
+} // namespace anonymous
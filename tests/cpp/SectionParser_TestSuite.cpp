@@ -0,0 +1,228 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(SectionParser)
+
+#include <string>
+
+#include <json/json.h>
+
+#include <metaengine/Document.hpp>
+#include <metaengine/KeyPool.hpp>
+#include <metaengine/SectionParser.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+
+namespace
+{
+
+/*!
+ * \brief The section size used by the tests, so that small data still has
+ *        sections.
+ */
+static const std::size_t SECTION_SIZE = 32;
+
+/*!
+ * \brief Returns data with a few large objects, one of which contains the
+ *        given value.
+ */
+std::string make_data(const std::string& value)
+{
+    return
+        "{\n"
+        "    // the first section\n"
+        "    \"render\": {\"quality\": 2, \"shadows\": true, "
+        "\"resolution\": [1920, 1080]},\n"
+        "    \"audio\": {\"volume\": " + value + ", \"channels\": "
+        "[\"left\", \"right\"], \"muted\": false},\n"
+        "    \"esc\\u0061ped\": {\"name\": \"a \\\"quoted\\\" name\", "
+        "\"list\": [[1, 2, 3], [4.5, -6e2, null]]},\n"
+        "    \"small\": 1\n"
+        "}";
+}
+
+/*!
+ * \brief Parses the data with both a SectionParser and a Json::Reader, and
+ *        checks the results are equal.
+ */
+std::shared_ptr<const metaengine::ArenaTree> parse_equivalent(
+        metaengine::SectionParser& parser,
+        const std::string& data)
+{
+    std::shared_ptr<const metaengine::ArenaTree> tree =
+        parser.parse(data.data(), data.data() + data.size());
+    ARC_CHECK_TRUE(tree != nullptr);
+    if(tree == nullptr)
+    {
+        return tree;
+    }
+
+    Json::Reader reader;
+    Json::Value expected;
+    ARC_CHECK_TRUE(reader.parse(data, expected));
+    ARC_CHECK_TRUE(*tree->get_root() == expected);
+    return tree;
+}
+
+//------------------------------------------------------------------------------
+//                                  EQUIVALENCE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(equivalence)
+{
+    std::shared_ptr<metaengine::KeyPool> key_pool(new metaengine::KeyPool());
+    metaengine::SectionParser parser(key_pool, SECTION_SIZE);
+
+    std::shared_ptr<const metaengine::ArenaTree> tree =
+        parse_equivalent(parser, make_data("5"));
+    // the root and the three large objects
+    ARC_CHECK_EQUAL(parser.get_built(), 4);
+    ARC_CHECK_EQUAL(parser.get_shared(), 0);
+    ARC_CHECK_EQUAL(tree->get_sections().size(), 1);
+    ARC_CHECK_EQUAL(
+        tree->get_sections()[0].tree->get_sections().size(),
+        3
+    );
+    ARC_CHECK_TRUE(tree->get_root()->isMember("escaped"));
+
+    ARC_TEST_MESSAGE("Checking a root array");
+    parse_equivalent(
+        parser,
+        "[{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9]}, \"a long string value\", 0]"
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                    SHARING
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(sharing)
+{
+    std::shared_ptr<metaengine::KeyPool> key_pool(new metaengine::KeyPool());
+    metaengine::SectionParser first_parser(key_pool, SECTION_SIZE);
+    std::shared_ptr<const metaengine::ArenaTree> first =
+        parse_equivalent(first_parser, make_data("5"));
+
+    ARC_TEST_MESSAGE("Checking unchanged sections are shared");
+    metaengine::SectionParser second_parser(key_pool, SECTION_SIZE);
+    second_parser.add_previous(first);
+    std::shared_ptr<const metaengine::ArenaTree> second =
+        parse_equivalent(second_parser, make_data("6"));
+    // the root and the audio section changed
+    ARC_CHECK_EQUAL(second_parser.get_built(), 2);
+    ARC_CHECK_EQUAL(second_parser.get_shared(), 2);
+
+    const Json::Value& first_root = *first->get_root();
+    const Json::Value& second_root = *second->get_root();
+    ARC_CHECK_EQUAL(
+        &first_root["render"]["quality"],
+        &second_root["render"]["quality"]
+    );
+    ARC_CHECK_EQUAL(
+        &first_root["escaped"]["list"][1],
+        &second_root["escaped"]["list"][1]
+    );
+    ARC_CHECK_TRUE(first_root["render"].sharesPayload(second_root["render"]));
+    ARC_CHECK_FALSE(first_root["audio"].sharesPayload(second_root["audio"]));
+    ARC_CHECK_EQUAL(first_root["audio"]["volume"].asInt(), 5);
+    ARC_CHECK_EQUAL(second_root["audio"]["volume"].asInt(), 6);
+
+    ARC_TEST_MESSAGE("Checking whitespace changes are shared");
+    metaengine::SectionParser third_parser(key_pool, SECTION_SIZE);
+    third_parser.add_previous(second);
+    std::string data = make_data("6");
+    data.insert(data.find("\"channels\""), "  ");
+    parse_equivalent(third_parser, data);
+    ARC_CHECK_EQUAL(third_parser.get_built(), 0);
+    ARC_CHECK_EQUAL(third_parser.get_shared(), 1);
+
+    ARC_TEST_MESSAGE("Checking shared sections outlive the previous tree");
+    first.reset();
+    ARC_CHECK_EQUAL(second_root["render"]["resolution"][0].asInt(), 1920);
+
+    ARC_TEST_MESSAGE("Checking a matching hash is not enough to be shared");
+    // sections with the hashes and lengths of the sections in the root but
+    // other data, as if the hashes had collided
+    std::shared_ptr<metaengine::ArenaTree> forged(
+        new metaengine::ArenaTree(0, key_pool));
+    ARC_CONST_FOR_EACH(
+        section,
+        second->get_sections()[0].tree->get_sections())
+    {
+        metaengine::ArenaTree::Section collision(*section);
+        collision.content[1] = 'x';
+        forged->add_section(collision);
+    }
+    metaengine::SectionParser fourth_parser(key_pool, SECTION_SIZE);
+    fourth_parser.add_previous(forged);
+    parse_equivalent(fourth_parser, make_data("6"));
+    ARC_CHECK_EQUAL(fourth_parser.get_shared(), 0);
+}
+
+//------------------------------------------------------------------------------
+//                                    FALLBACK
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(fallback)
+{
+    std::shared_ptr<metaengine::KeyPool> key_pool(new metaengine::KeyPool());
+    metaengine::SectionParser parser(key_pool, SECTION_SIZE);
+
+    const char* invalid[] = {
+        // too small to have sections
+        "{\"a\": 1}",
+        // malformed
+        "{\"render\": {\"quality\": 2, \"shadows\": true,",
+        "{\"render\": {\"quality\": 2, \"shadows\": true} /* unterminated",
+        "{\"render\": {\"quality\": 2 \"shadows\": true}}",
+        // values which do not span their data
+        "{\"render\": {\"quality\": 12abc, \"shadows\": true}}",
+        "{\"render\": {\"quality\": nul, \"shadows\": true}}",
+        // duplicate keys
+        "{\"render\": {\"quality\": 2, \"shadows\": true, \"quality\": 3}}"
+    };
+    for(std::size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        std::string data(invalid[i]);
+        ARC_CHECK_TRUE(
+            parser.parse(data.data(), data.data() + data.size()) == nullptr);
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(document)
+{
+    // data large enough for the default section size
+    std::string large("{\"large\": {");
+    for(std::size_t i = 0;
+        large.size() < metaengine::SectionParser::DEFAULT_SECTION_SIZE;
+        ++i)
+    {
+        large += "\"key_" + std::to_string(i) + "\": 1234567, ";
+    }
+    large += "\"last\": 0}";
+    arc::str::UTF8String memory((large + ", \"value\": 1}").c_str());
+    metaengine::Document doc(&memory);
+    doc.set_subtree_sharing_enabled(true);
+    ARC_CHECK_TRUE(doc.is_subtree_sharing_enabled());
+    doc.reload();
+
+    ARC_TEST_MESSAGE("Checking reloading changed data");
+    memory = (large + ", \"value\": 2}").c_str();
+    doc.reload();
+    ARC_CHECK_EQUAL(
+        *doc.get("value", metaengine::IntV<arc::int32>::instance()),
+        2
+    );
+    ARC_CHECK_EQUAL(
+        *doc.get("large.key_10", metaengine::IntV<arc::int32>::instance()),
+        1234567
+    );
+
+    ARC_TEST_MESSAGE("Checking invalid data is still an error");
+    memory = (large + ", \"value\": 2").c_str();
+    ARC_CHECK_THROW(doc.reload(), arc::ex::ParseError);
+}
+
+} // namespace anonymous
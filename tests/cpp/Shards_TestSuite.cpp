@@ -0,0 +1,329 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Shards)
+
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <json/json.h>
+
+#include <metaengine/Children.hpp>
+#include <metaengine/Document.hpp>
+#include <metaengine/KeyPool.hpp>
+#include <metaengine/Shards.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Counts the load fallbacks reported.
+ */
+class ReportFixture : public arc::test::Fixture
+{
+public:
+
+    //-------------------------PUBLIC STATIC ATTRIBUTES-------------------------
+
+    static std::size_t load_reports;
+
+    //----------------------------CALLBACK FUNCTIONS----------------------------
+
+    static void load_reporter(
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& message)
+    {
+        ++load_reports;
+    }
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        load_reports = 0;
+        metaengine::Document::set_load_fallback_reporter(load_reporter);
+    }
+
+    virtual void teardown()
+    {
+        metaengine::Document::set_load_fallback_reporter(nullptr);
+    }
+};
+
+std::size_t ReportFixture::load_reports = 0;
+
+/*!
+ * \brief Builds a sharded tree from the data.
+ */
+std::shared_ptr<const metaengine::ArenaTree> build(
+        const std::string& data,
+        std::vector<std::string>* errors = nullptr)
+{
+    std::shared_ptr<const arc::str::UTF8String> json(
+        new arc::str::UTF8String(data.c_str()));
+    metaengine::Shards::error_callback on_error;
+    if(errors != nullptr)
+    {
+        on_error = [errors](
+                const arc::str::UTF8String& name,
+                const arc::str::UTF8String& message)
+            {
+                errors->push_back(name.get_raw());
+            };
+    }
+    return metaengine::Shards::build(
+        json,
+        std::shared_ptr<metaengine::KeyPool>(new metaengine::KeyPool()),
+        on_error
+    );
+}
+
+/*!
+ * \brief Returns the path to the sharded test file.
+ */
+arc::io::sys::Path sharded_path()
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "sharded.json";
+    return file_path;
+}
+
+//------------------------------------------------------------------------------
+//                                     BUILD
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(build)
+{
+    std::string data(
+        "{\n"
+        "    // a comment\n"
+        "    \"render\": {\"title\": \"a } \\\" ]\", \"size\": [1, [2]]},\n"
+        "    \"esc\\u0061ped\": [true, null, {\"a\": -6e2}],\n"
+        "    \"count\": 3, /* another comment */\n"
+        "    \"name\": \"text\",\n"
+        "    \"count\": 4\n"
+        "}\n"
+    );
+    std::shared_ptr<const metaengine::ArenaTree> tree(build(data));
+    ARC_CHECK_TRUE(tree != nullptr);
+    metaengine::Shards* shards = tree->get_shards();
+    ARC_CHECK_TRUE(shards != nullptr);
+
+    ARC_TEST_MESSAGE("Checking only the structure is scanned");
+    ARC_CHECK_EQUAL(shards->get_count(), 4);
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 0);
+    const Json::Value& root = *tree->get_root();
+    ARC_CHECK_TRUE(root.isObject());
+    ARC_CHECK_EQUAL(root.size(), 4);
+    ARC_CHECK_TRUE(root["render"].isNull());
+
+    ARC_TEST_MESSAGE("Checking members are parsed on first access");
+    shards->load(&root["render"]);
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 1);
+    ARC_CHECK_EQUAL(root["render"]["title"].asString(), "a } \" ]");
+    shards->load(&root["render"]);
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 1);
+    shards->load(&root["render"]["title"]);
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 1);
+    shards->load(&root["escaped"]);
+    ARC_CHECK_EQUAL(root["escaped"][2]["a"].asInt(), -600);
+
+    ARC_TEST_MESSAGE("Checking the result matches parsing as a whole");
+    shards->load_all();
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 4);
+    Json::Reader reader;
+    Json::Value expected;
+    ARC_CHECK_TRUE(reader.parse(data, expected));
+    ARC_CHECK_TRUE(root == expected);
+    ARC_CHECK_EQUAL(root["count"].asInt(), 4);
+
+    ARC_TEST_MESSAGE("Checking empty objects");
+    tree = build(" {} ");
+    ARC_CHECK_TRUE(tree != nullptr);
+    ARC_CHECK_EQUAL(tree->get_shards()->get_count(), 0);
+    tree->get_shards()->load_all();
+    ARC_CHECK_TRUE(tree->get_root()->isObject());
+}
+
+//------------------------------------------------------------------------------
+//                                     ERRORS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(errors)
+{
+    ARC_TEST_MESSAGE("Checking data which is parsed as a whole instead");
+    ARC_CHECK_TRUE(build("[1, 2]") == nullptr);
+    ARC_CHECK_TRUE(build("\"text\"") == nullptr);
+    ARC_CHECK_TRUE(build("{\"a\": {\"b\": 1}") == nullptr);
+    ARC_CHECK_TRUE(build("{\"a\": 1,}") == nullptr);
+    ARC_CHECK_TRUE(build("{\"a\" 1}") == nullptr);
+    ARC_CHECK_TRUE(build("{\"a\": 1} 2") == nullptr);
+    ARC_CHECK_TRUE(build("{\"a\": \"unterminated}") == nullptr);
+    ARC_CHECK_TRUE(build("{\"a\": 1 /* unterminated}") == nullptr);
+
+    ARC_TEST_MESSAGE("Checking values are only validated when loaded");
+    std::vector<std::string> errors;
+    std::shared_ptr<const metaengine::ArenaTree> tree(
+        build("{\"good\": [1], \"bad\": [1, , 2], \"worse\": nul}", &errors));
+    ARC_CHECK_TRUE(tree != nullptr);
+    metaengine::Shards* shards = tree->get_shards();
+    const Json::Value& root = *tree->get_root();
+    shards->load(&root["good"]);
+    ARC_CHECK_TRUE(errors.empty());
+
+    shards->load(&root["bad"]);
+    ARC_CHECK_EQUAL(errors.size(), 1);
+    ARC_CHECK_EQUAL(errors[0], "bad");
+    ARC_CHECK_TRUE(root["bad"].isNull());
+    shards->load(&root["bad"]);
+    ARC_CHECK_EQUAL(errors.size(), 1);
+
+    shards->load_all();
+    ARC_CHECK_EQUAL(errors.size(), 2);
+    ARC_CHECK_EQUAL(errors[1], "worse");
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 3);
+    ARC_CHECK_EQUAL(root["good"][0].asInt(), 1);
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(document, ReportFixture)
+{
+    ARC_TEST_MESSAGE("Checking the file can not be parsed as a whole");
+    ARC_CHECK_THROW(
+        metaengine::Document(sharded_path(), true),
+        arc::ex::ParseError
+    );
+
+    metaengine::Document doc(sharded_path(), false);
+    ARC_CHECK_FALSE(doc.is_sharding_enabled());
+    doc.set_sharding_enabled(true);
+    ARC_CHECK_TRUE(doc.is_sharding_enabled());
+    doc.reload();
+    ARC_CHECK_TRUE(doc.has_valid_file_data());
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 0);
+
+    ARC_TEST_MESSAGE("Checking values are retrieved from their sections");
+    ARC_CHECK_EQUAL(
+        *doc.get("render.quality", metaengine::IntV<arc::int32>::instance()),
+        2
+    );
+    ARC_CHECK_EQUAL(
+        *doc.get(
+            "render.resolution.1",
+            metaengine::IntV<arc::int32>::instance()
+        ),
+        1080
+    );
+    ARC_CHECK_EQUAL(
+        *doc.get("render.title", metaengine::UTF8StringV::instance()),
+        "a {braced} \"quoted\" [title]"
+    );
+    ARC_CHECK_EQUAL(
+        *doc.get("count", metaengine::IntV<arc::int32>::instance()),
+        7
+    );
+    ARC_CHECK_THROW(
+        doc.get("render.missing", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_THROW(
+        doc.get("missing", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 0);
+
+    ARC_TEST_MESSAGE("Checking a section that fails to parse is missing");
+    ARC_CHECK_THROW(
+        doc.get("broken.list", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 1);
+    ARC_CHECK_THROW(
+        doc.get("broken", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 1);
+
+    ARC_TEST_MESSAGE("Checking the children of the root skip the broken one");
+    metaengine::Children root(doc.get_children(""));
+    ARC_CHECK_EQUAL(std::distance(root.begin(), root.end()), 3);
+    metaengine::Children audio(doc.get_children("audio"));
+    ARC_CHECK_EQUAL(std::distance(audio.begin(), audio.end()), 2);
+
+    ARC_TEST_MESSAGE("Checking the sections are parsed again on reload");
+    doc.reload();
+    ARC_CHECK_EQUAL(
+        *doc.get("audio.volume", metaengine::FloatV<float>::instance()),
+        0.5F
+    );
+    ARC_CHECK_THROW(
+        doc.get("broken.list", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::KeyError
+    );
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 2);
+}
+
+//------------------------------------------------------------------------------
+//                                    THREADS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(threads)
+{
+    // each thread retrieves from every section in a different order, so the
+    // sections are loaded by whichever thread touches them first
+    std::string data("{");
+    for(std::size_t i = 0; i < 64; ++i)
+    {
+        if(i != 0)
+        {
+            data += ", ";
+        }
+        data += "\"section_" + std::to_string(i) + "\": {\"value\": " +
+                std::to_string(i) + ", \"list\": [1, 2, 3]}";
+    }
+    data += "}";
+    std::shared_ptr<const metaengine::ArenaTree> tree(build(data));
+    ARC_CHECK_TRUE(tree != nullptr);
+    metaengine::Shards* shards = tree->get_shards();
+    const Json::Value& root = *tree->get_root();
+
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> failures(4, 0);
+    for(std::size_t t = 0; t < failures.size(); ++t)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            for(std::size_t j = 0; j < 64; ++j)
+            {
+                std::size_t i = (j * (t * 2 + 1)) % 64;
+                std::string name("section_" + std::to_string(i));
+                const Json::Value* member =
+                    root.find(name.data(), name.data() + name.size());
+                shards->load(member);
+                if((*member)["value"].asUInt() != i ||
+                   (*member)["list"].size() != 3)
+                {
+                    ++failures[t];
+                }
+            }
+        }));
+    }
+    ARC_FOR_EACH(thread, threads)
+    {
+        thread->join();
+    }
+
+    ARC_CONST_FOR_EACH(failed, failures)
+    {
+        ARC_CHECK_EQUAL(*failed, 0);
+    }
+    ARC_CHECK_EQUAL(shards->get_loaded_count(), 64);
+}
+
+} // namespace anonymous
@@ -0,0 +1,340 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Stack)
+
+#include <iterator>
+#include <string>
+
+#include <metaengine/Children.hpp>
+#include <metaengine/Handle.hpp>
+#include <metaengine/Schema.hpp>
+#include <metaengine/Stack.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Counts the fallbacks reported.
+ */
+class ReportFixture : public arc::test::Fixture
+{
+public:
+
+    //-------------------------PUBLIC STATIC ATTRIBUTES-------------------------
+
+    static std::size_t load_reports;
+    static std::size_t get_reports;
+    static std::string last_load_message;
+
+    //----------------------------CALLBACK FUNCTIONS----------------------------
+
+    static void load_reporter(
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& message)
+    {
+        ++load_reports;
+        last_load_message = message.get_raw();
+    }
+
+    static void get_reporter(
+            const arc::io::sys::Path& file_path,
+            const arc::str::UTF8String& message)
+    {
+        ++get_reports;
+    }
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        load_reports = 0;
+        get_reports = 0;
+        last_load_message.clear();
+        metaengine::Document::set_load_fallback_reporter(load_reporter);
+        metaengine::Document::set_get_fallback_reporter(get_reporter);
+    }
+
+    virtual void teardown()
+    {
+        metaengine::Document::set_load_fallback_reporter(nullptr);
+        metaengine::Document::set_get_fallback_reporter(nullptr);
+    }
+};
+
+std::size_t ReportFixture::load_reports = 0;
+std::size_t ReportFixture::get_reports = 0;
+std::string ReportFixture::last_load_message;
+
+/*!
+ * \brief Visitor which retrieves whether the value was proven to be a string.
+ */
+class ProvenStringV : public metaengine::Visitor<bool>
+{
+public:
+
+    // override
+    virtual bool retrieve(
+            const Json::Value* data,
+            const arc::str::UTF8String& key,
+            metaengine::Document* requester,
+            metaengine::Diagnostic& diagnostic)
+    {
+        m_value = diagnostic.is_proven(metaengine::Schema::TYPE_STRING);
+        return true;
+    }
+};
+
+/*!
+ * \brief Returns the integer at the key.
+ */
+arc::int32 get_int(metaengine::Stack& stack, const arc::str::UTF8String& key)
+{
+    return *stack.get(key, metaengine::IntV<arc::int32>::instance());
+}
+
+//------------------------------------------------------------------------------
+//                                     LAYERS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(layers)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String defaults(
+        "{\"value_2\": 1, \"value_4\": 4, \"window\": {\"width\": 640, "
+        "\"height\": 480}, \"list\": [1, 2, 3]}");
+    arc::str::UTF8String host(
+        "{\"value_4\": 40, \"window\": {\"width\": 800}}");
+    arc::str::UTF8String runtime("{\"window\": {\"height\": 600}}");
+
+    metaengine::Stack stack(file_path, &defaults);
+    ARC_CHECK_EQUAL(stack.get_layer_count(), 0);
+    ARC_CHECK_EQUAL(get_int(stack, "value_2"), 175);
+    ARC_CHECK_EQUAL(get_int(stack, "value_4"), 4);
+    ARC_CHECK_EQUAL(get_int(stack, "window.width"), 640);
+
+    stack.push_layer(&host);
+    stack.push_layer(&runtime);
+    ARC_CHECK_EQUAL(stack.get_layer_count(), 2);
+    ARC_CHECK_TRUE(stack.has_valid_layer_data(0));
+    ARC_CHECK_TRUE(stack.has_valid_layer_data(1));
+    ARC_CHECK_THROW(
+        stack.has_valid_layer_data(2),
+        arc::ex::IndexOutOfBoundsError
+    );
+
+    ARC_TEST_MESSAGE("Checking each key is retrieved from its highest layer");
+    ARC_CHECK_EQUAL(get_int(stack, "value_2"), 175);
+    ARC_CHECK_EQUAL(get_int(stack, "value_4"), 40);
+    ARC_CHECK_EQUAL(get_int(stack, "window.width"), 800);
+    ARC_CHECK_EQUAL(get_int(stack, "window.height"), 600);
+    ARC_CHECK_EQUAL(
+        *stack.get("value_1", metaengine::UTF8StringV::instance()),
+        "Hello world!"
+    );
+    ARC_CHECK_EQUAL(get_int(stack, "list.2"), 3);
+    ARC_CHECK_THROW(get_int(stack, "missing"), arc::ex::KeyError);
+    ARC_CHECK_THROW(get_int(stack, "list.3"), arc::ex::KeyError);
+
+    ARC_TEST_MESSAGE("Checking containers are not merged between layers");
+    metaengine::Children window(stack.get_children("window"));
+    ARC_CHECK_EQUAL(std::distance(window.begin(), window.end()), 1);
+
+    ARC_TEST_MESSAGE("Checking popping layers");
+    stack.pop_layer();
+    ARC_CHECK_EQUAL(get_int(stack, "window.height"), 480);
+    ARC_CHECK_EQUAL(get_int(stack, "window.width"), 800);
+    stack.pop_layer();
+    stack.pop_layer();
+    ARC_CHECK_EQUAL(stack.get_layer_count(), 0);
+    ARC_CHECK_EQUAL(get_int(stack, "value_4"), 4);
+
+    ARC_TEST_MESSAGE("Checking file layers");
+    arc::io::sys::Path hierarchy_path;
+    hierarchy_path << "tests" << "meta" << "hierarchy.json";
+    stack.push_layer(hierarchy_path);
+    ARC_CHECK_EQUAL(get_int(stack, "first_error"), 3);
+    ARC_CHECK_EQUAL(get_int(stack, "value_2"), 175);
+}
+
+//------------------------------------------------------------------------------
+//                                    FALLBACK
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT_FIXTURE(fallback, ReportFixture)
+{
+    arc::str::UTF8String defaults("{\"a\": 1, \"b\": \"text\", \"list\": [1]}");
+    arc::str::UTF8String env("{\"a\": \"one\", \"list\": [\"x\"]}");
+    arc::str::UTF8String host("{\"a\": true}");
+
+    metaengine::Stack stack(&defaults);
+    stack.push_layer(&env);
+    stack.push_layer(&host);
+
+    ARC_TEST_MESSAGE("Checking falling back through every lower layer");
+    ARC_CHECK_EQUAL(get_int(stack, "a"), 1);
+    ARC_CHECK_EQUAL(ReportFixture::get_reports, 2);
+    ARC_CHECK_EQUAL(
+        *stack.get("a", metaengine::UTF8StringV::instance()),
+        "one"
+    );
+    ARC_CHECK_EQUAL(ReportFixture::get_reports, 3);
+    ARC_CHECK_TRUE(*stack.get("a", metaengine::BoolV::instance()));
+    ARC_CHECK_EQUAL(ReportFixture::get_reports, 3);
+
+    ARC_TEST_MESSAGE("Checking keys that are not in the table fall back");
+    ARC_CHECK_EQUAL(get_int(stack, "list.0"), 1);
+    ARC_CHECK_EQUAL(ReportFixture::get_reports, 4);
+
+    ARC_TEST_MESSAGE("Checking no layer of a valid type is an error");
+    ARC_CHECK_THROW(get_int(stack, "b"), arc::ex::TypeError);
+    ARC_CHECK_EQUAL(ReportFixture::get_reports, 4);
+
+    ARC_TEST_MESSAGE("Checking layers that fail to load are reported");
+    arc::str::UTF8String invalid("{\"a\": ");
+    arc::io::sys::Path missing_path;
+    missing_path << "tests" << "meta" << "missing.json";
+    stack.push_layer(&invalid);
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 1);
+    ARC_CHECK_TRUE(
+        ReportFixture::last_load_message.find("Layer 2: ") !=
+        std::string::npos
+    );
+    stack.push_layer(missing_path);
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 2);
+    ARC_CHECK_FALSE(stack.has_valid_layer_data(2));
+    ARC_CHECK_FALSE(stack.has_valid_layer_data(3));
+    ARC_CHECK_TRUE(*stack.get("a", metaengine::BoolV::instance()));
+}
+
+//------------------------------------------------------------------------------
+//                                     RELOAD
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(reload)
+{
+    arc::str::UTF8String defaults("{\"speed\": 1, \"size\": 2}");
+    arc::str::UTF8String overrides("{\"speed\": 3}");
+
+    metaengine::Stack stack(&defaults);
+    stack.push_layer(&overrides);
+    metaengine::Handle<metaengine::IntV<arc::int32>> speed(&stack, "speed");
+    ARC_CHECK_EQUAL(*speed, 3);
+
+    ARC_TEST_MESSAGE("Checking layers are loaded again on reload");
+    overrides = "{\"size\": 4}";
+    stack.reload();
+    ARC_CHECK_EQUAL(*speed, 1);
+    ARC_CHECK_EQUAL(get_int(stack, "size"), 4);
+
+    ARC_TEST_MESSAGE("Checking handles are refreshed when the stack changes");
+    arc::str::UTF8String runtime("{\"speed\": 9}");
+    stack.push_layer(&runtime);
+    ARC_CHECK_EQUAL(*speed, 9);
+    stack.pop_layer();
+    ARC_CHECK_EQUAL(*speed, 1);
+
+    ARC_TEST_MESSAGE("Checking stacks loaded later");
+    metaengine::Stack later(&defaults, false);
+    later.reload();
+    ARC_CHECK_EQUAL(get_int(later, "speed"), 1);
+}
+
+//------------------------------------------------------------------------------
+//                                     SCHEMA
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(schema)
+{
+    arc::str::UTF8String defaults("{\"name\": 1, \"title\": \"text\"}");
+    arc::str::UTF8String overrides("{\"name\": \"stack\", \"title\": 2}");
+
+    metaengine::Stack stack(&defaults);
+    std::shared_ptr<metaengine::Schema> schema(new metaengine::Schema());
+    schema->add("name", metaengine::Schema::TYPE_STRING)
+            .add("title", metaengine::Schema::TYPE_STRING);
+    stack.set_schema(schema);
+    stack.reload();
+    stack.push_layer(&overrides);
+
+    ARC_TEST_MESSAGE("Checking winning values of the schema type are proven");
+    ProvenStringV proven_v;
+    ARC_CHECK_TRUE(*stack.get("name", proven_v));
+    ARC_CHECK_EQUAL(
+        *stack.get("name", metaengine::UTF8StringV::instance()),
+        "stack"
+    );
+
+    ARC_TEST_MESSAGE("Checking winning values of another type are not");
+    ARC_CHECK_FALSE(*stack.get("title", proven_v));
+    ARC_CHECK_EQUAL(
+        *stack.get("title", metaengine::UTF8StringV::instance()),
+        "text"
+    );
+
+    ARC_TEST_MESSAGE("Checking values are proven again when the stack changes");
+    stack.pop_layer();
+    ARC_CHECK_FALSE(*stack.get("name", proven_v));
+    ARC_CHECK_TRUE(*stack.get("title", proven_v));
+}
+
+ARC_TEST_UNIT_FIXTURE(schema_layers, ReportFixture)
+{
+    // value_2 is not a string in the file, but is in the pushed layer
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String memory("{\"value_2\": \"from memory\"}");
+    arc::str::UTF8String overrides("{\"value_2\": \"from layer\"}");
+
+    metaengine::Stack stack(file_path, &memory);
+    stack.push_layer(&overrides);
+    std::shared_ptr<metaengine::Schema> schema(new metaengine::Schema());
+    schema->add("value_2", metaengine::Schema::TYPE_STRING);
+    stack.set_schema(schema);
+    stack.reload();
+
+    ARC_TEST_MESSAGE("Checking only the winning layer is validated");
+    ARC_CHECK_EQUAL(ReportFixture::load_reports, 0);
+    ProvenStringV proven_v;
+    ARC_CHECK_TRUE(*stack.get("value_2", proven_v));
+    ARC_CHECK_EQUAL(
+        *stack.get("value_2", metaengine::UTF8StringV::instance()),
+        "from layer"
+    );
+    ARC_CHECK_EQUAL(ReportFixture::get_reports, 0);
+}
+
+//------------------------------------------------------------------------------
+//                                 SUBSCRIPTIONS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(subscriptions)
+{
+    arc::str::UTF8String defaults("{\"speed\": 1, \"size\": 2}");
+    arc::str::UTF8String overrides("{\"speed\": 3}");
+
+    metaengine::Stack stack(&defaults);
+    std::string keys;
+    metaengine::Document::change_callback callback =
+        [&](const arc::str::UTF8String& key)
+        {
+            keys += "<";
+            keys += key.get_raw();
+            keys += ">";
+        };
+    stack.subscribe("speed", callback);
+    stack.subscribe("size", callback);
+
+    stack.push_layer(&overrides);
+    ARC_CHECK_EQUAL(keys, "<speed>");
+    keys.clear();
+    stack.pop_layer();
+    ARC_CHECK_EQUAL(keys, "<speed>");
+    keys.clear();
+    stack.reload();
+    ARC_CHECK_EQUAL(keys, "");
+}
+
+} // namespace anonymous
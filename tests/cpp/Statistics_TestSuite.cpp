@@ -0,0 +1,189 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Statistics)
+
+#include <thread>
+
+#include <json/json.h>
+
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+//                                    DISABLED
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(disabled)
+{
+    arc::str::UTF8String data("{\"key\": 12}");
+    metaengine::Document doc(&data);
+
+    ARC_CHECK_TRUE(doc.get_statistics() == nullptr);
+    doc.get("key", metaengine::IntV<arc::int32>::instance());
+    ARC_CHECK_TRUE(doc.get_statistics() == nullptr);
+
+    doc.set_statistics_enabled(true);
+    ARC_CHECK_TRUE(doc.get_statistics() != nullptr);
+    ARC_CHECK_EQUAL(doc.get_statistics()->get_totals().gets, 0);
+    doc.set_statistics_enabled(false);
+    ARC_CHECK_TRUE(doc.get_statistics() == nullptr);
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+class DocumentFixture : public arc::test::Fixture
+{
+public:
+
+    //----------------------------PUBLIC ATTRIBUTES-----------------------------
+
+    arc::io::sys::Path file_path;
+    arc::str::UTF8String memory;
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        // the file contains "value_1": "Hello world!" and "value_2": 175
+        file_path << "tests" << "meta" << "get" << "correct.json";
+        memory =
+            "{"
+            "    \"value_1\": \"Hello world!\","
+            "    \"value_2\": 175,"
+            "    \"value_3\": 4"
+            "}";
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(document, DocumentFixture)
+{
+    metaengine::Document doc(fixture->file_path, &fixture->memory);
+    doc.set_statistics_enabled(true);
+    const metaengine::Statistics* stats = doc.get_statistics();
+
+    ARC_TEST_MESSAGE("Checking file hits");
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        doc.get("value_1", metaengine::UTF8StringV::instance());
+    }
+    metaengine::Statistics::Counters c(stats->get_counters("value_1"));
+    ARC_CHECK_EQUAL(c.gets, 3);
+    ARC_CHECK_EQUAL(c.file_hits, 3);
+    ARC_CHECK_EQUAL(c.memory_hits, 0);
+    ARC_CHECK_EQUAL(c.fallbacks, 0);
+
+    ARC_TEST_MESSAGE("Checking key fallback");
+    doc.get("value_3", metaengine::IntV<arc::int32>::instance());
+    c = stats->get_counters("value_3");
+    ARC_CHECK_EQUAL(c.gets, 1);
+    ARC_CHECK_EQUAL(c.file_hits, 0);
+    ARC_CHECK_EQUAL(c.memory_hits, 1);
+    ARC_CHECK_EQUAL(c.fallbacks, 1);
+    ARC_CHECK_EQUAL(c.type_errors, 0);
+
+    ARC_TEST_MESSAGE("Checking type errors");
+    ARC_CHECK_THROW(
+        doc.get("value_2", metaengine::UTF8StringV::instance()),
+        arc::ex::TypeError
+    );
+    c = stats->get_counters("value_2");
+    ARC_CHECK_EQUAL(c.gets, 1);
+    ARC_CHECK_EQUAL(c.fallbacks, 1);
+    ARC_CHECK_EQUAL(c.type_errors, 2);
+
+    ARC_TEST_MESSAGE("Checking key errors");
+    ARC_CHECK_THROW(
+        doc.get("does_not_exist", metaengine::UTF8StringV::instance()),
+        arc::ex::KeyError
+    );
+    c = stats->get_counters("does_not_exist");
+    ARC_CHECK_EQUAL(c.gets, 1);
+    ARC_CHECK_EQUAL(c.key_errors, 1);
+
+    ARC_TEST_MESSAGE("Checking totals");
+    c = stats->get_totals();
+    ARC_CHECK_EQUAL(c.gets, 6);
+    ARC_CHECK_EQUAL(c.file_hits, 3);
+    ARC_CHECK_EQUAL(c.memory_hits, 1);
+    ARC_CHECK_EQUAL(c.fallbacks, 3);
+    ARC_CHECK_EQUAL(c.type_errors, 2);
+    ARC_CHECK_EQUAL(c.key_errors, 1);
+    ARC_CHECK_EQUAL(stats->get_all_counters().size(), 4);
+
+    ARC_TEST_MESSAGE("Checking export");
+    Json::Value exported;
+    Json::Reader reader;
+    ARC_CHECK_TRUE(reader.parse(stats->to_json().get_raw(), exported));
+    ARC_CHECK_EQUAL(exported["totals"]["gets"].asUInt64(), 6);
+    ARC_CHECK_EQUAL(exported["keys"]["value_1"]["file_hits"].asUInt64(), 3);
+
+    ARC_TEST_MESSAGE("Checking reset");
+    doc.get_statistics()->reset();
+    ARC_CHECK_EQUAL(stats->get_totals().gets, 0);
+    ARC_CHECK_EQUAL(stats->get_counters("value_1").gets, 0);
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant v(v_path, "uk", true);
+    v.set_statistics_enabled(true);
+    v.set_variant("de");
+
+    v.get("hello_world", metaengine::UTF8StringV::instance());
+    v.get("sentence", metaengine::UTF8StringV::instance());
+
+    const metaengine::Statistics* stats = v.get_statistics();
+    ARC_CHECK_EQUAL(stats->get_counters("hello_world").variant_hits, 1);
+    ARC_CHECK_EQUAL(stats->get_counters("hello_world").variant_misses, 0);
+    ARC_CHECK_EQUAL(stats->get_counters("sentence").variant_hits, 0);
+    ARC_CHECK_EQUAL(stats->get_counters("sentence").variant_misses, 1);
+    ARC_CHECK_EQUAL(stats->get_counters("sentence").file_hits, 1);
+}
+
+//------------------------------------------------------------------------------
+//                                  MULTITHREADED
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(multithreaded)
+{
+    metaengine::Statistics stats;
+
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < 4; ++i)
+    {
+        threads.push_back(std::thread([&stats]()
+        {
+            for(std::size_t j = 0; j < 1000; ++j)
+            {
+                arc::str::UTF8String key;
+                key << "key_" << (j % 10);
+                metaengine::Statistics::Scope scope(stats, key);
+                stats.record_hit(metaengine::Statistics::SOURCE_FILE);
+            }
+        }));
+    }
+    ARC_FOR_EACH(thread, threads)
+    {
+        thread->join();
+    }
+
+    ARC_CHECK_EQUAL(stats.get_totals().gets, 4000);
+    ARC_CHECK_EQUAL(stats.get_totals().file_hits, 4000);
+    ARC_CHECK_EQUAL(stats.get_all_counters().size(), 10);
+    ARC_CHECK_EQUAL(stats.get_counters("key_3").gets, 400);
+    ARC_CHECK_EQUAL(stats.get_counters("key_3").file_hits, 400);
+}
+
+} // namespace anonymous
@@ -0,0 +1,314 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(StreamParser)
+
+#include <string>
+#include <vector>
+
+#include <arcanecore/base/Exceptions.hpp>
+
+#include <json/json.h>
+
+#include <metaengine/StreamParser.hpp>
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Parses the data with a StreamParser, feeding it in chunks of the
+ *        given size.
+ */
+void stream(
+        const std::string& data,
+        std::size_t chunk_size,
+        Json::Value& root,
+        const std::vector<arc::str::UTF8String>& projection =
+            std::vector<arc::str::UTF8String>())
+{
+    metaengine::TreeBuilder builder(root, projection);
+    metaengine::StreamParser parser(builder);
+    for(std::size_t i = 0; i < data.size(); i += chunk_size)
+    {
+        parser.feed(
+            data.data() + i,
+            std::min(chunk_size, data.size() - i)
+        );
+    }
+    parser.finish();
+}
+
+/*!
+ * \brief Returns whether parsing the data with a StreamParser throws a
+ *        ParseError.
+ */
+bool fails(const std::string& data)
+{
+    Json::Value root;
+    try
+    {
+        stream(data, data.size() + 1, root);
+    }
+    catch(const arc::ex::ParseError&)
+    {
+        return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief Data which is parsed the same by Json::Reader and StreamParser.
+ */
+static const char* VALID_DATA[] = {
+    "{}",
+    "[]",
+    "  {\"a\": 1}  ",
+    "{\"a\": \"Hello world!\", \"b\": 175, \"c\": 3.14, \"d\": true}",
+    "{\"a\": {\"b\": {\"c\": [1, 2, [3, 4], {\"d\": null}]}}, \"e\": false}",
+    "[\"escape \\\" \\\\ \\/ \\b \\f \\n \\r \\t\", \"\\u00e9\\u4e2d\"]",
+    "[\"\\ud83d\\ude00\", \"\xec\x95\x88\xeb\x85\x95\", \"\"]",
+    "[0, -0, 12, -12, 2147483647, 2147483648, -2147483648, -2147483649]",
+    "[9223372036854775807, 9223372036854775808, -9223372036854775808]",
+    "[18446744073709551615, 18446744073709551616, 1e3, 1.5E-3, -0.25e+2]",
+    "// comment\n{\"a\": /* inline */ 1, // trailing\n \"b\": [1 /**/, 2]}",
+    "{\"a\": 1, \"a\": {\"b\": 2}}",
+    "{\"a\": 1} trailing data is ignored",
+    "\"string root\"",
+    "42"
+};
+
+//------------------------------------------------------------------------------
+//                                  EQUIVALENCE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(equivalence)
+{
+    for(std::size_t i = 0; i < sizeof(VALID_DATA) / sizeof(VALID_DATA[0]); ++i)
+    {
+        std::string data(VALID_DATA[i]);
+        Json::Value expected;
+        Json::Reader reader;
+        ARC_CHECK_TRUE(reader.parse(data, expected));
+
+        // every chunk size, so that every token is split
+        for(std::size_t chunk_size = 1;
+            chunk_size <= data.size();
+            ++chunk_size)
+        {
+            Json::Value root;
+            stream(data, chunk_size, root);
+            if(!(root == expected))
+            {
+                ARC_TEST_MESSAGE(data + " at chunk size " +
+                                 std::to_string(chunk_size));
+                ARC_CHECK_TRUE(root == expected);
+                break;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//                                     ERRORS
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(errors)
+{
+    ARC_CHECK_TRUE(fails(""));
+    ARC_CHECK_TRUE(fails("   "));
+    ARC_CHECK_TRUE(fails("{"));
+    ARC_CHECK_TRUE(fails("{\"a\" 1}"));
+    ARC_CHECK_TRUE(fails("{\"a\": 1,}"));
+    ARC_CHECK_TRUE(fails("{\"a\": 1 \"b\": 2}"));
+    ARC_CHECK_TRUE(fails("{1: 1}"));
+    ARC_CHECK_TRUE(fails("[1,]"));
+    ARC_CHECK_TRUE(fails("[1 2]"));
+    ARC_CHECK_TRUE(fails("[1}"));
+    ARC_CHECK_TRUE(fails("tru"));
+    ARC_CHECK_TRUE(fails("trUe"));
+    ARC_CHECK_TRUE(fails("-"));
+    ARC_CHECK_TRUE(fails("\"abc"));
+    ARC_CHECK_TRUE(fails("\"\\x\""));
+    ARC_CHECK_TRUE(fails("\"\\u12\""));
+    ARC_CHECK_TRUE(fails("\"\\ud83d\""));
+    ARC_CHECK_TRUE(fails("/* unterminated"));
+    ARC_CHECK_TRUE(fails("/ {}"));
+
+    ARC_TEST_MESSAGE("Checking invalid UTF-8 is rejected");
+    ARC_CHECK_TRUE(fails("\"caf\xe9\""));
+    ARC_CHECK_TRUE(fails("{\"\xc3\": 1}"));
+    ARC_CHECK_TRUE(fails("\xff\xfe{\0}\0"));
+
+    ARC_TEST_MESSAGE("Checking a byte order mark is skipped");
+    ARC_CHECK_FALSE(fails("\xef\xbb\xbf{}"));
+    ARC_CHECK_TRUE(fails("\xef\xbb{}"));
+
+    ARC_TEST_MESSAGE("Checking the error location");
+    std::string message;
+    try
+    {
+        Json::Value root;
+        stream("{\n    \"a\": x\n}", 3, root);
+    }
+    catch(const arc::ex::ParseError& exc)
+    {
+        message = exc.what();
+    }
+    ARC_CHECK_TRUE(message.find("Line 2, Column 10") != std::string::npos);
+}
+
+//------------------------------------------------------------------------------
+//                                   PROJECTION
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(projection)
+{
+    std::string data(
+        "{\"a\": {\"b\": 1, \"c\": {\"d\": 2}, \"e\": [1, {\"f\": 3}]}, "
+        "\"g\": \"discarded\", \"h\": {\"i\": [1, 2]}, \"a2\": 4}"
+    );
+    std::vector<arc::str::UTF8String> projection;
+    projection.push_back("a.c");
+    projection.push_back("a.e.f");
+    projection.push_back("h");
+
+    Json::Value expected;
+    Json::Reader reader;
+    reader.parse(
+        "{\"a\": {\"c\": {\"d\": 2}, \"e\": [1, {\"f\": 3}]}, "
+        "\"h\": {\"i\": [1, 2]}}",
+        expected
+    );
+
+    for(std::size_t chunk_size = 1; chunk_size <= data.size(); ++chunk_size)
+    {
+        Json::Value root;
+        stream(data, chunk_size, root, projection);
+        if(!(root == expected))
+        {
+            ARC_CHECK_TRUE(root == expected);
+            break;
+        }
+    }
+
+    ARC_TEST_MESSAGE("Checking scalars above projected keys are discarded");
+    Json::Value root;
+    projection.clear();
+    projection.push_back("g.x");
+    stream(data, data.size(), root, projection);
+    ARC_CHECK_EQUAL(root.size(), 0);
+}
+
+//------------------------------------------------------------------------------
+//                                    DOCUMENT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(document)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "hierarchy.json";
+    metaengine::Document doc(file_path, false);
+    doc.set_streaming(true);
+    ARC_CHECK_TRUE(doc.is_streaming());
+    doc.reload();
+
+    ARC_CHECK_EQUAL(
+        (*doc.get(
+            "fonts.supported_formats",
+            metaengine::UTF8StringVectorV::instance()
+        ))[1],
+        "otf"
+    );
+    ARC_CHECK_TRUE(*doc.get("bool_test", metaengine::BoolV::instance()));
+    const metaengine::LoadTimings& timings = doc.get_load_timings();
+    ARC_CHECK_EQUAL(
+        timings.phases[metaengine::LoadTimings::PHASE_READ].bytes,
+        timings.phases[metaengine::LoadTimings::PHASE_PARSE].bytes
+    );
+    ARC_CHECK_TRUE(
+        timings.phases[metaengine::LoadTimings::PHASE_READ].bytes > 0);
+
+    ARC_TEST_MESSAGE("Checking projection");
+    std::vector<arc::str::UTF8String> projection;
+    projection.push_back("fonts");
+    doc.set_projection(projection);
+    ARC_CHECK_EQUAL(doc.get_projection().size(), 1);
+    doc.reload();
+    ARC_CHECK_EQUAL(
+        (*doc.get(
+            "fonts.supported_formats",
+            metaengine::UTF8StringVectorV::instance()
+        )).size(),
+        2
+    );
+    ARC_CHECK_THROW(
+        doc.get("bool_test", metaengine::BoolV::instance()),
+        arc::ex::KeyError
+    );
+
+    ARC_TEST_MESSAGE("Checking projection of memory data");
+    arc::str::UTF8String memory("{\"a\": 1, \"b\": 2}");
+    metaengine::Document mem_doc(&memory, false);
+    projection.clear();
+    projection.push_back("b");
+    mem_doc.set_projection(projection);
+    mem_doc.reload();
+    ARC_CHECK_EQUAL(
+        *mem_doc.get("b", metaengine::IntV<arc::int32>::instance()),
+        2
+    );
+    ARC_CHECK_THROW(
+        mem_doc.get("a", metaengine::IntV<arc::int32>::instance()),
+        arc::ex::KeyError
+    );
+}
+
+ARC_TEST_UNIT(document_fallback)
+{
+    ARC_TEST_MESSAGE("Checking files that are not UTF-8 are decoded");
+    arc::io::sys::Path latin1_path;
+    latin1_path << "tests" << "meta" << "latin1.json";
+    metaengine::Document doc(latin1_path, false);
+    doc.set_streaming(true);
+    doc.reload();
+    ARC_CHECK_EQUAL(
+        *doc.get("number", metaengine::IntV<arc::int32>::instance()),
+        7
+    );
+
+    ARC_TEST_MESSAGE("Checking invalid files still fail");
+    arc::io::sys::Path bad_path;
+    bad_path << "tests" << "meta" << "bad_1.json";
+    metaengine::Document bad_doc(bad_path, false);
+    bad_doc.set_streaming(true);
+    ARC_CHECK_THROW(bad_doc.reload(), arc::ex::ParseError);
+
+    ARC_TEST_MESSAGE("Checking missing files still fail");
+    arc::io::sys::Path missing_path;
+    missing_path << "tests" << "meta" << "does_not_exist.json";
+    metaengine::Document missing_doc(missing_path, false);
+    missing_doc.set_streaming(true);
+    ARC_CHECK_THROW(missing_doc.reload(), arc::ex::IOError);
+}
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant doc(v_path, "uk", false);
+    doc.set_streaming(true);
+    doc.reload();
+    doc.set_variant("de");
+    ARC_CHECK_EQUAL(
+        *doc.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hallo Welt!"
+    );
+    ARC_CHECK_TRUE(
+        doc.get_load_timings().phases[
+            metaengine::LoadTimings::PHASE_VARIANT_PARSE].bytes > 0
+    );
+}
+
+} // namespace anonymous
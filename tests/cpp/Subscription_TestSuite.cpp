@@ -0,0 +1,260 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(Subscription)
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <metaengine/Variant.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Records the keys of the subscriptions that are called.
+ */
+class Recorder
+{
+public:
+
+    //----------------------------PUBLIC ATTRIBUTES-----------------------------
+
+    std::string keys;
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    /*!
+     * \brief Returns a callback which records its key.
+     */
+    metaengine::Document::change_callback callback()
+    {
+        return [this](const arc::str::UTF8String& key)
+        {
+            keys += "<";
+            keys += key.get_raw();
+            keys += ">";
+        };
+    }
+
+    /*!
+     * \brief Returns and clears the keys recorded so far.
+     */
+    std::string take()
+    {
+        std::string ret(keys);
+        keys.clear();
+        return ret;
+    }
+};
+
+//------------------------------------------------------------------------------
+//                                     RELOAD
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(reload)
+{
+    arc::str::UTF8String memory(
+        "{\"render\": {\"quality\": 2, \"shadows\": true}, "
+        "\"audio\": {\"volume\": 5}, \"list\": [1, 2]}"
+    );
+    metaengine::Document doc(&memory);
+
+    Recorder recorder;
+    doc.subscribe("render", recorder.callback());
+    doc.subscribe("render.quality", recorder.callback());
+    doc.subscribe("audio", recorder.callback());
+    doc.subscribe("missing", recorder.callback());
+    doc.subscribe("", recorder.callback());
+
+    ARC_TEST_MESSAGE("Checking reloading unchanged data calls nothing");
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "");
+
+    ARC_TEST_MESSAGE("Checking only the changed subtree is called");
+    memory =
+        "{\"render\": {\"quality\": 2, \"shadows\": true}, "
+        "\"audio\": {\"volume\": 6}, \"list\": [1, 2]}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<audio><>");
+
+    ARC_TEST_MESSAGE("Checking arrays are compared");
+    memory =
+        "{\"render\": {\"quality\": 2, \"shadows\": true}, "
+        "\"audio\": {\"volume\": 6}, \"list\": [1, 3]}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<>");
+
+    ARC_TEST_MESSAGE("Checking removed values are changes");
+    memory =
+        "{\"render\": {\"quality\": 2}, "
+        "\"audio\": {\"volume\": 6}, \"list\": [1, 3]}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<render><>");
+
+    ARC_TEST_MESSAGE("Checking replacing an ancestor changes its descendants");
+    memory = "{\"render\": 1, \"audio\": {\"volume\": 6}, \"list\": [1, 3]}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<render><render.quality><>");
+
+    ARC_TEST_MESSAGE("Checking added values are changes");
+    memory =
+        "{\"render\": 1, \"audio\": {\"volume\": 6}, \"list\": [1, 3], "
+        "\"missing\": null, \"extra\": {}}";
+    doc.reload();
+    // null values do not exist
+    ARC_CHECK_EQUAL(recorder.take(), "<>");
+    memory =
+        "{\"render\": 1, \"audio\": {\"volume\": 6}, \"list\": [1, 3], "
+        "\"missing\": 0, \"extra\": {}}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<missing><>");
+
+    ARC_TEST_MESSAGE("Checking a failed load calls nothing");
+    memory = "{";
+    ARC_CHECK_THROW(doc.reload(), arc::ex::ParseError);
+    ARC_CHECK_EQUAL(recorder.take(), "");
+}
+
+//------------------------------------------------------------------------------
+//                                    FALLBACK
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(fallback)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "simple.json";
+    arc::str::UTF8String memory("{\"value_2\": 175, \"value_5\": 1}");
+    metaengine::Document doc(file_path, &memory);
+
+    Recorder recorder;
+    doc.subscribe("value_2", recorder.callback());
+    doc.subscribe("value_5", recorder.callback());
+
+    ARC_TEST_MESSAGE("Checking changes to the memory data are calls");
+    memory = "{\"value_2\": 175, \"value_5\": 2}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<value_5>");
+}
+
+//------------------------------------------------------------------------------
+//                                  UNSUBSCRIBE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(unsubscribe)
+{
+    arc::str::UTF8String memory("{\"value\": 1}");
+    metaengine::Document doc(&memory);
+
+    Recorder recorder;
+    arc::uint64 first = doc.subscribe("value", recorder.callback());
+    arc::uint64 second = doc.subscribe("value", recorder.callback());
+    ARC_CHECK_TRUE(first != second);
+
+    doc.unsubscribe(first);
+    memory = "{\"value\": 2}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<value>");
+
+    ARC_TEST_MESSAGE("Checking a callback can unsubscribe itself");
+    doc.unsubscribe(second);
+    arc::uint64 self = 0;
+    self = doc.subscribe("value", [&](const arc::str::UTF8String& key)
+    {
+        recorder.keys += "<self>";
+        doc.unsubscribe(self);
+    });
+    doc.subscribe("value", recorder.callback());
+    memory = "{\"value\": 3}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<self><value>");
+    memory = "{\"value\": 4}";
+    doc.reload();
+    ARC_CHECK_EQUAL(recorder.take(), "<value>");
+
+    ARC_TEST_MESSAGE("Checking unknown ids are ignored");
+    doc.unsubscribe(self);
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(variant)
+{
+    arc::io::sys::Path file_path;
+    file_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant variant(file_path, "uk");
+
+    Recorder recorder;
+    variant.subscribe("hello_world", recorder.callback());
+    variant.subscribe("sentence", recorder.callback());
+    variant.subscribe("nest.number", recorder.callback());
+
+    variant.set_variant("de");
+    ARC_CHECK_EQUAL(recorder.take(), "<hello_world>");
+
+    ARC_TEST_MESSAGE("Checking switching to the same variant calls nothing");
+    variant.set_variant("de");
+    ARC_CHECK_EQUAL(recorder.take(), "");
+
+    ARC_TEST_MESSAGE("Checking switching back to the default variant");
+    variant.set_variant("uk");
+    ARC_CHECK_EQUAL(recorder.take(), "<hello_world>");
+
+    ARC_TEST_MESSAGE("Checking switching between table columns");
+    std::vector<arc::str::UTF8String> variants;
+    variants.push_back("de");
+    variants.push_back("ko");
+    variant.load_table(variants);
+    variant.set_variant("de");
+    ARC_CHECK_EQUAL(recorder.take(), "<hello_world>");
+}
+
+//------------------------------------------------------------------------------
+//                                   LOAD ASYNC
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(load_async)
+{
+    arc::str::UTF8String memory("{\"value\": 1}");
+    metaengine::Document doc(&memory);
+
+    arc::int32 value = 0;
+    doc.subscribe("value", [&](const arc::str::UTF8String& key)
+    {
+        // the new data can be accessed from the callback
+        value = *doc.get(key, metaengine::IntV<arc::int32>::instance());
+    });
+
+    memory = "{\"value\": 2}";
+    doc.load_async().get();
+    ARC_CHECK_EQUAL(value, 2);
+
+    ARC_TEST_MESSAGE("Checking destruction waits for the callbacks");
+    for(std::size_t i = 0; i < 20; ++i)
+    {
+        arc::str::UTF8String data("{\"value\": 1}");
+        std::size_t calls = 0;
+        {
+            metaengine::Document async_doc(&data);
+            async_doc.subscribe("value", [&](const arc::str::UTF8String& key)
+            {
+                // give the destructor the chance to run if it does not wait
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                value = *async_doc.get(
+                    key,
+                    metaengine::IntV<arc::int32>::instance()
+                );
+                ++calls;
+            });
+            data = "{\"value\": 3}";
+            async_doc.load_async();
+        }
+        ARC_CHECK_EQUAL(calls, 1);
+        ARC_CHECK_EQUAL(value, 3);
+    }
+}
+
+} // namespace anonymous
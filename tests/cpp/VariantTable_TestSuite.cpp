@@ -0,0 +1,215 @@
+#include <arcanecore/test/ArcTest.hpp>
+
+ARC_TEST_MODULE(VariantTable)
+
+#include <json/json.h>
+
+#include <metaengine/Variant.hpp>
+#include <metaengine/VariantTable.hpp>
+#include <metaengine/visitors/Primitive.hpp>
+#include <metaengine/visitors/String.hpp>
+
+namespace
+{
+
+/*!
+ * \brief Parses the data into a JSON value.
+ */
+Json::Value parse(const std::string& data)
+{
+    Json::Value ret;
+    Json::Reader reader;
+    reader.parse(data, ret);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+//                                     TABLE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(table)
+{
+    Json::Value a(parse(
+        "{\"one\": 1, \"nest\": {\"two\": 2, \"three\": 3}, \"a.b\": 4,"
+        "\"none\": null}"
+    ));
+    Json::Value b(parse("{\"nest\": {\"two\": 22, \"four\": 44}}"));
+
+    metaengine::VariantTable table;
+    ARC_CHECK_EQUAL(table.add_column(&a), 0);
+    ARC_CHECK_EQUAL(table.add_column(&b), 1);
+    ARC_CHECK_EQUAL(table.add_column(nullptr), 2);
+    ARC_CHECK_EQUAL(table.get_column_count(), 3);
+
+    ARC_TEST_MESSAGE("Checking rows");
+    // one, nest, nest.two, nest.three, nest.four
+    ARC_CHECK_EQUAL(table.get_row_count(), 5);
+    ARC_CHECK_EQUAL(table.find_row("a.b"), metaengine::VariantTable::NO_ROW);
+    ARC_CHECK_EQUAL(table.find_row("none"), metaengine::VariantTable::NO_ROW);
+    ARC_CHECK_EQUAL(table.find_row("nest."), metaengine::VariantTable::NO_ROW);
+    ARC_CHECK_EQUAL(table.find_row("two"), metaengine::VariantTable::NO_ROW);
+
+    ARC_TEST_MESSAGE("Checking cells");
+    std::size_t two = table.find_row("nest.two");
+    ARC_CHECK_TRUE(table.get_cell(0, two) == &a["nest"]["two"]);
+    ARC_CHECK_TRUE(table.get_cell(1, two) == &b["nest"]["two"]);
+    ARC_CHECK_TRUE(table.get_cell(2, two) == nullptr);
+
+    std::size_t one = table.find_row("one");
+    ARC_CHECK_TRUE(table.get_cell(0, one) == &a["one"]);
+    ARC_CHECK_TRUE(table.get_cell(1, one) == nullptr);
+
+    std::size_t four = table.find_row("nest.four");
+    ARC_CHECK_TRUE(table.get_cell(0, four) == nullptr);
+    ARC_CHECK_TRUE(table.get_cell(1, four) == &b["nest"]["four"]);
+
+    ARC_TEST_MESSAGE("Checking growth");
+    Json::Value large(Json::objectValue);
+    for(std::size_t i = 0; i < 1000; ++i)
+    {
+        large["key_" + std::to_string(i)] = static_cast<Json::UInt64>(i);
+    }
+    std::size_t column = table.add_column(&large);
+    ARC_CHECK_EQUAL(table.get_row_count(), 1005);
+    std::size_t row = table.find_row("key_637");
+    ARC_CHECK_EQUAL(table.get_cell(column, row)->asUInt64(), 637);
+    ARC_CHECK_TRUE(table.get_cell(0, table.find_row("one")) == &a["one"]);
+}
+
+//------------------------------------------------------------------------------
+//                                    VARIANT
+//------------------------------------------------------------------------------
+
+class VariantFixture : public arc::test::Fixture
+{
+public:
+
+    //----------------------------PUBLIC ATTRIBUTES-----------------------------
+
+    arc::io::sys::Path v_path;
+    std::vector<arc::str::UTF8String> variants;
+
+    //-------------------------PUBLIC MEMBER FUNCTIONS--------------------------
+
+    virtual void setup()
+    {
+        v_path << "tests" << "meta" << "variants" << "lang.json";
+        variants.push_back("de");
+        variants.push_back("ko");
+        variants.push_back("uk");
+    }
+};
+
+ARC_TEST_UNIT_FIXTURE(variant, VariantFixture)
+{
+    metaengine::Variant v(fixture->v_path, "uk", true);
+    v.load_table(fixture->variants);
+
+    ARC_TEST_MESSAGE("Checking default variant");
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hello world!"
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("nest.number", metaengine::IntV<arc::int32>::instance()),
+        3
+    );
+
+    ARC_TEST_MESSAGE("Checking German (de) variant");
+    v.set_variant("de");
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hallo Welt!"
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("sentence", metaengine::UTF8StringV::instance()),
+        "This is a language variant."
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("nest.string", metaengine::UTF8StringV::instance()),
+        "zwölf"
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("nest.number", metaengine::IntV<arc::int32>::instance()),
+        3
+    );
+    ARC_CHECK_THROW(
+        v.get("does_not_exist", metaengine::UTF8StringV::instance()),
+        arc::ex::KeyError
+    );
+
+    ARC_TEST_MESSAGE("Checking Korean (ko) variant");
+    arc::uint64 version = v.get_version();
+    v.set_variant("ko");
+    ARC_CHECK_TRUE(v.get_version() != version);
+    ARC_CHECK_EQUAL(
+        *v.get("nest.number", metaengine::IntV<arc::int32>::instance()),
+        39
+    );
+
+    ARC_TEST_MESSAGE("Checking variant outside of the table");
+    v.set_variant("fr");
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hello world!"
+    );
+
+    ARC_TEST_MESSAGE("Checking reload");
+    v.set_variant("de");
+    v.reload();
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hallo Welt!"
+    );
+
+    ARC_TEST_MESSAGE("Checking clearing the table");
+    v.clear_table();
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hallo Welt!"
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("sentence", metaengine::UTF8StringV::instance()),
+        "This is a language variant."
+    );
+}
+
+ARC_TEST_UNIT_FIXTURE(memory, VariantFixture)
+{
+    arc::str::UTF8String memory(
+        "{\"hello_world\": 5, \"only_memory\": 7}"
+    );
+    metaengine::Variant v(fixture->v_path, &memory, "uk", true);
+    v.load_table(fixture->variants);
+    v.set_variant("de");
+
+    ARC_CHECK_EQUAL(
+        *v.get("only_memory", metaengine::IntV<arc::int32>::instance()),
+        7
+    );
+    // type errors in the table still fallback to memory
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::IntV<arc::int32>::instance()),
+        5
+    );
+}
+
+ARC_TEST_UNIT_FIXTURE(statistics, VariantFixture)
+{
+    metaengine::Variant v(fixture->v_path, "uk", true);
+    v.load_table(fixture->variants);
+    v.set_statistics_enabled(true);
+    v.set_variant("de");
+
+    v.get("hello_world", metaengine::UTF8StringV::instance());
+    v.get("sentence", metaengine::UTF8StringV::instance());
+
+    const metaengine::Statistics* stats = v.get_statistics();
+    ARC_CHECK_EQUAL(stats->get_counters("hello_world").variant_hits, 1);
+    ARC_CHECK_EQUAL(stats->get_counters("hello_world").variant_misses, 0);
+    ARC_CHECK_EQUAL(stats->get_counters("sentence").variant_hits, 0);
+    ARC_CHECK_EQUAL(stats->get_counters("sentence").variant_misses, 1);
+    ARC_CHECK_EQUAL(stats->get_counters("sentence").file_hits, 1);
+}
+
+} // namespace anonymous
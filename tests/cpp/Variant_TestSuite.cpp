@@ -2,6 +2,8 @@
 
 ARC_TEST_MODULE(Variant)
 
+#include <vector>
+
 #include <json/json.h>
 
 #include <metaengine/Variant.hpp>
@@ -90,4 +92,74 @@ ARC_TEST_UNIT(language)
     );
 }
 
+ARC_TEST_UNIT(load_async)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "lang.json";
+    metaengine::Variant v(v_path, "uk", false);
+    v.set_variant("de");
+
+    // the current variant is loaded along with the default variant
+    std::shared_future<void> loaded(v.load_async());
+    ARC_CHECK_EQUAL(
+        *v.get("hello_world", metaengine::UTF8StringV::instance()),
+        "Hallo Welt!"
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("sentence", metaengine::UTF8StringV::instance()),
+        "This is a language variant."
+    );
+    loaded.get();
+
+    ARC_TEST_MESSAGE("Checking switching variants while loading");
+    v.load_async();
+    v.set_variant("ko");
+    ARC_CHECK_EQUAL(
+        *v.get("nest.number", metaengine::IntV<arc::int32>::instance()),
+        39
+    );
+}
+
+//------------------------------------------------------------------------------
+//                                     TABLE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(table_arrays)
+{
+    arc::io::sys::Path v_path;
+    v_path << "tests" << "meta" << "variants" << "list.json";
+    metaengine::Variant v(v_path, "uk");
+    v.set_variant("fr");
+    std::vector<arc::str::UTF8String> variants;
+    variants.push_back("fr");
+    v.load_table(variants);
+
+    ARC_TEST_MESSAGE("Checking array elements come from the current variant");
+    ARC_CHECK_EQUAL(
+        *v.get("list.1", metaengine::IntV<arc::int32>::instance()),
+        20
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("nest.list.0", metaengine::UTF8StringV::instance()),
+        "un"
+    );
+
+    ARC_TEST_MESSAGE("Checking elements missing from the variant fall back");
+    ARC_CHECK_EQUAL(
+        *v.get("list.2", metaengine::IntV<arc::int32>::instance()),
+        3
+    );
+    ARC_CHECK_EQUAL(
+        *v.get("nest.list.1", metaengine::UTF8StringV::instance()),
+        "two"
+    );
+
+    ARC_TEST_MESSAGE("Checking array elements of the default variant");
+    v.set_variant("uk");
+    ARC_CHECK_EQUAL(
+        *v.get("list.1", metaengine::IntV<arc::int32>::instance()),
+        2
+    );
+}
+
 } // namespace anonymous
@@ -296,4 +296,138 @@ ARC_TEST_UNIT_FIXTURE(external_reference, ExternalReferenceFixture)
 
 }
 
+//------------------------------------------------------------------------------
+//                                     CACHE
+//------------------------------------------------------------------------------
+
+ARC_TEST_UNIT(cache)
+{
+    arc::str::UTF8String data(
+        "{"
+        "   \"resource\": [\"res\"],"
+        "   \"gui\": [\"@{resource}\", \"gui\"],"
+        "   \"fonts\": [\"@{gui}\", \"fonts\"],"
+        "   \"other\": [\"other\", \"@{name}\"],"
+        "   \"name\": \"one\","
+        "   \"cyclic\": [\"@{cyclic_ref}\"],"
+        "   \"cyclic_ref\": [\"@{cyclic}\"]"
+        "}"
+    );
+    metaengine::Document doc(&data);
+
+    arc::io::sys::Path fonts;
+    fonts << "res" << "gui" << "fonts";
+    arc::io::sys::Path other;
+    other << "other" << "one";
+
+    ARC_TEST_MESSAGE("Checking repeated retrieval");
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        ARC_CHECK_EQUAL(*doc.get("fonts", metaengine::PathV::instance()), fonts);
+        ARC_CHECK_EQUAL(*doc.get("other", metaengine::PathV::instance()), other);
+        ARC_CHECK_THROW(
+            *doc.get("cyclic", metaengine::PathV::instance()),
+            arc::ex::TypeError
+        );
+    }
+
+    ARC_TEST_MESSAGE("Checking cached references are still checked for cycles");
+    ARC_CHECK_THROW(
+        *doc.get("cyclic_ref", metaengine::PathV::instance()),
+        arc::ex::TypeError
+    );
+
+    ARC_TEST_MESSAGE("Checking reload without changes");
+    doc.set_statistics_enabled(true);
+    doc.reload();
+    ARC_CHECK_EQUAL(*doc.get("fonts", metaengine::PathV::instance()), fonts);
+    ARC_CHECK_EQUAL(*doc.get("other", metaengine::PathV::instance()), other);
+
+    ARC_TEST_MESSAGE("Checking revalidation does not record statistics");
+    ARC_CHECK_EQUAL(doc.get_statistics()->get_totals().gets, 2);
+    ARC_CHECK_EQUAL(doc.get_statistics()->get_counters("resource").gets, 0);
+    doc.set_statistics_enabled(false);
+
+    ARC_TEST_MESSAGE("Checking reload with a changed reference");
+    data =
+        "{"
+        "   \"resource\": [\"new_res\"],"
+        "   \"gui\": [\"@{resource}\", \"gui\"],"
+        "   \"fonts\": [\"@{gui}\", \"fonts\"],"
+        "   \"other\": [\"other\", \"@{name}\"],"
+        "   \"name\": \"two\","
+        "   \"cyclic\": [\"@{cyclic_ref}\"],"
+        "   \"cyclic_ref\": [\"end\"]"
+        "}";
+    doc.reload();
+
+    arc::io::sys::Path new_fonts;
+    new_fonts << "new_res" << "gui" << "fonts";
+    arc::io::sys::Path new_other;
+    new_other << "other" << "two";
+    arc::io::sys::Path new_cyclic;
+    new_cyclic << "end";
+    ARC_CHECK_EQUAL(
+        *doc.get("fonts", metaengine::PathV::instance()),
+        new_fonts
+    );
+    ARC_CHECK_EQUAL(
+        *doc.get("other", metaengine::PathV::instance()),
+        new_other
+    );
+    ARC_CHECK_EQUAL(
+        *doc.get("cyclic", metaengine::PathV::instance()),
+        new_cyclic
+    );
+}
+
+ARC_TEST_UNIT_FIXTURE(external_cache, ExternalReferenceFixture)
+{
+    arc::str::UTF8String ext_data(fixture->valid);
+    metaengine::Document doc(&fixture->base);
+    metaengine::Document ext_doc(&ext_data);
+
+    ARC_TEST_MESSAGE("Checking repeated retrieval");
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        ARC_CHECK_EQUAL(
+            *doc.get("indirect", metaengine::PathV::instance(&ext_doc)),
+            fixture->result_2
+        );
+    }
+
+    ARC_TEST_MESSAGE("Checking the external document is part of the cache");
+    ARC_CHECK_THROW(
+        *doc.get("indirect", metaengine::PathV::instance()),
+        arc::ex::TypeError
+    );
+
+    ARC_TEST_MESSAGE("Checking reload of the external document");
+    ext_doc.reload();
+    ARC_CHECK_EQUAL(
+        *doc.get("indirect", metaengine::PathV::instance(&ext_doc)),
+        fixture->result_2
+    );
+
+    ext_data =
+        "{"
+        "   \"ext_ref_1\": \"changed\","
+        "   \"ext_ref_2\": [\"ext\", \"path\"]"
+        "}";
+    ext_doc.reload();
+    arc::io::sys::Path changed;
+    changed << "dir" << "base" << "path" << "changed" << "ext" << "path";
+    ARC_CHECK_EQUAL(
+        *doc.get("indirect", metaengine::PathV::instance(&ext_doc)),
+        changed
+    );
+
+    ext_data = fixture->invalid;
+    ext_doc.reload();
+    ARC_CHECK_THROW(
+        *doc.get("indirect", metaengine::PathV::instance(&ext_doc)),
+        arc::ex::TypeError
+    );
+}
+
 } // namespace anonymous